@@ -0,0 +1,78 @@
+#ifndef BAYER_H
+#define BAYER_H
+
+#include "common.h"
+#include "calib.h"
+
+// Linhas brutas na janela do demosaico (o edge-aware lê 7: y−3 a y+3)
+#define BAYER_RAW_SLOTS     8
+// Linhas de verde interpolado na janela (y−1 a y+1)
+#define BAYER_GREEN_SLOTS   4
+// Colunas refletidas de cada lado das linhas brutas
+#define BAYER_MARGIN        2
+// Lado mínimo: a reflexão de 3 linhas/colunas preserva a paridade do mosaico
+#define BAYER_MIN_SIDE      4
+
+typedef enum {
+    BAYER_NONE = 0,             // Imagem já em cores (ou cinza)
+    BAYER_RGGB = 1,
+    BAYER_BGGR = 2,
+    BAYER_GRBG = 3,
+    BAYER_GBRG = 4
+} bayer_pattern_t;
+
+typedef enum {
+    DEMOSAIC_BILINEAR = 0,      // Média dos vizinhos da mesma cor
+    DEMOSAIC_EDGE     = 1       // Verde direcional + diferença de cor
+} demosaic_method_t;
+
+/**
+ * @brief Demosaico de um quadro Bayer (1 amostra por pixel), linha a linha
+ *
+ * Cada linha de saída (RGB intercalado, ou luminância com --bayer-gray)
+ * é interpolada a partir de uma janela circular de linhas brutas com
+ * margens refletidas; dark frame e ganho (calib.h) são aplicados a cada
+ * linha bruta ao entrar na janela. Um estado por faixa de threads: as
+ * faixas leem as linhas de halo direto do quadro bruto, e o RGB completo
+ * nunca existe na memória. A reflexão (−1 → 1, w → w − 2) mantém a cor
+ * de cada posição do mosaico.
+ *
+ * Bilinear: média arredondada dos 2 ou 4 vizinhos de cada cor. Edge:
+ * verde de Hamilton-Adams (interpolação na direção de menor gradiente,
+ * corrigida pelo laplaciano da cor da amostra), seguido de R/B por
+ * diferença de cor (C − G) sobre o verde completo.
+ */
+typedef struct {
+    const void *raw;            // Quadro bruto (8 ou 16 bits)
+    int width, height;
+    int depth;                  // 8 ou 16
+    int rx, ry;                 // Posição do R no bloco 2x2
+    int method;                 // demosaic_method_t
+    int gray;                   // 1 = saída em luminância
+    const calib_t *calib;       // Dark frame / flat-field das linhas brutas (NULL = sem)
+    unsigned char *block;       // Janelas e planos da linha (um bloco)
+    unsigned char *raw_rows[BAYER_RAW_SLOTS];       // Coluna 0 de cada linha da janela
+    int raw_tag[BAYER_RAW_SLOTS];                   // Linha guardada (-1 = vazia)
+    unsigned char *green_rows[BAYER_GREEN_SLOTS];   // Margem de 1 coluna
+    int green_tag[BAYER_GREEN_SLOTS];
+    unsigned char *planes;      // R, G, B da linha atual (planar_stride(width) entre planos)
+} demosaic_t;
+
+const char* bayer_pattern_name(int pattern);
+const char* demosaic_method_name(int method);
+
+// Canais da imagem após o demosaico (3, ou 1 com --bayer-gray)
+int demosaic_channels(const pipeline_config_t *cfg);
+
+// Prepara o demosaico do quadro raw (width × height amostras de 'depth'
+// bits) com o padrão e o método de cfg. Retorna 0 ou -1
+int demosaic_init(demosaic_t *d, const void *raw, int width, int height, int depth,
+                  const pipeline_config_t *cfg, const calib_t *calib);
+void demosaic_free(demosaic_t *d);
+
+// Linha y em dst (width × demosaic_channels amostras). Em 8 bits, planes
+// (se não for NULL) recebe também os planos R, G, B da linha, a
+// planar_stride(width) bytes entre si (layout de planar_t)
+void demosaic_row(demosaic_t *d, int y, void *dst, unsigned char *planes);
+
+#endif // BAYER_H
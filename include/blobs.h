@@ -0,0 +1,52 @@
+#ifndef BLOBS_H
+#define BLOBS_H
+
+#include "common.h"
+#include "thread_pool.h"
+#include <stdint.h>
+
+/**
+ * @brief Medidas de um componente conexo (blob) da máscara binária
+ *
+ * Momentos centrais de segunda ordem normalizados pela área (variâncias
+ * e covariância das coordenadas); angle é a orientação do eixo maior em
+ * radianos, em [-pi/2, pi/2].
+ */
+typedef struct {
+    uint32_t label;             // Rótulo no plano (1..num_blobs)
+    long area;                  // Pixels
+    int x0, y0, x1, y1;         // Retângulo envolvente (inclusivo)
+    double cx, cy;              // Centroide
+    double mu20, mu02, mu11;    // Momentos centrais / área
+    double angle;
+} blob_t;
+
+/**
+ * @brief Rotulação de componentes conexos (8-vizinhança) com estatísticas
+ *
+ * Duas passagens em faixas paralelas: a primeira rotula as corridas de
+ * cada faixa com union-find local e acumula os momentos por rótulo
+ * provisório; as costuras unem os rótulos das faixas vizinhas e a
+ * segunda passagem escreve os rótulos finais. A numeração final segue a
+ * ordem de varredura (independente do número de faixas).
+ */
+typedef struct {
+    int width, height;
+    uint32_t *labels;           // Plano de rótulos (0 = fundo ou descartado)
+    blob_t *blobs;              // blobs[i] tem rótulo i + 1
+    int num_blobs;
+} blob_set_t;
+
+int blob_set_init(blob_set_t *bs, int width, int height);
+void blob_set_free(blob_set_t *bs);
+
+// Rotula os pixels não nulos de mask. Componentes com área < min_area são
+// descartados (rótulo 0). rgb: saída opcional width × height × 3 com uma
+// cor por blob. pool NULL = serial. Retorna 0 ou -1
+int blob_label(blob_set_t *bs, const unsigned char *mask, int min_area, unsigned char *rgb,
+               int num_tiles, thread_pool_t *pool);
+
+// Uma linha CSV por blob (cabeçalho incluso). Retorna 0 ou -1
+int blob_write_csv(const blob_set_t *bs, const char *path);
+
+#endif // BLOBS_H
@@ -0,0 +1,49 @@
+#ifndef CALIB_H
+#define CALIB_H
+
+#include "common.h"
+
+// Ganho do flat-field em Q10 (int16: até 32x)
+#define CALIB_GAIN_BITS     10
+#define CALIB_GAIN_MAX      32767
+
+/**
+ * @brief Calibração da câmera: dark frame e flat-field
+ *
+ * corrigido = (bruto − dark) · ganho, por amostra, com ganho =
+ * média(flat − dark) / (flat − dark) no canal (remove vinheta e ruído de
+ * padrão fixo sem mudar o nível médio). Amostras mortas do flat ficam
+ * com ganho 1; o alpha não é alterado.
+ *
+ * Os quadros de calibração são decodificados uma vez pelo coordenador,
+ * antes do fork, num mapeamento compartilhado protegido contra escrita:
+ * todos os workers leem as mesmas páginas. As imagens devem ter a mesma
+ * geometria (largura, altura e canais) dos quadros.
+ */
+typedef struct {
+    int active;                 // 0 = sem calibração
+    int width, height, channels;
+    const unsigned char *dark8; // Dark frame (8 bits)
+    const uint16_t *dark16;     // Dark frame (16 bits; 8 bits × 257 se o quadro for de 8)
+    const int16_t *gain;        // Ganho por amostra em Q10
+    void *block;                // Mapeamento com os três planos
+    size_t block_bytes;
+} calib_t;
+
+// 1 se --dark ou --flat foi configurado
+int calib_enabled(const pipeline_config_t *cfg);
+
+// Decodifica os quadros configurados. Retorna 0 ou -1
+int calib_load(calib_t *cal, const pipeline_config_t *cfg);
+void calib_free(calib_t *cal);
+
+// 1 se a imagem tem a geometria dos quadros
+int calib_matches(const calib_t *cal, int width, int height, int channels);
+
+// n amostras a partir da amostra 'first' da imagem (src e dst podem coincidir)
+void calib_rows(const calib_t *cal, const unsigned char *src, unsigned char *dst,
+                size_t first, int n);
+void calib_rows_u16(const calib_t *cal, const uint16_t *src, uint16_t *dst,
+                    size_t first, int n);
+
+#endif // CALIB_H
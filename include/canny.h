@@ -0,0 +1,58 @@
+#ifndef CANNY_H
+#define CANNY_H
+
+#include "common.h"
+#include "simd_kernels.h"
+#include "thread_pool.h"
+
+// Limiares máximos: magnitude L1 do Sobel sobre 8 bits (4 × 255 × 2)
+#define CANNY_MAX_THRESHOLD 2040
+
+/**
+ * @brief Canny em streaming (gaussiano → gradiente → supressão)
+ *
+ * Cada linha de luminância empurrada avança a cascata o quanto der:
+ * gaussiano 5x5 separável, Sobel 3x3 na linha suavizada, magnitude L1
+ * (int16, sem saturação) e supressão de não-máximos com classificação
+ * dupla. A saída é o mapa de classes (0, CANNY_WEAK, CANNY_STRONG) das
+ * linhas [out_begin, out_end); a histerese roda depois, sobre o mapa.
+ *
+ * Todos os buffers circulares dos estágios vêm de uma única alocação.
+ */
+typedef struct {
+    int width, height;
+    int low, high;                  // Limiares da magnitude L1
+    int out_begin, out_end;         // Linhas do mapa desta instância
+    int in_begin, in_end;           // Linhas de luminância lidas (halo de 4)
+    int next_smooth, smooth_end;    // Linhas suavizadas (halo de 2)
+    int next_grad, grad_end;        // Linhas de gradiente (halo de 1)
+    int next_out;
+
+    void *block;                    // Alocação única de todos os buffers
+    unsigned char *luma;            // 5 linhas de luminância
+    uint16_t *vert;                 // Passo vertical do gaussiano (w + 4)
+    unsigned char *smooth;          // 3 linhas suavizadas (w + 2, borda replicada)
+    int16_t *gx, *gy;               // Gradiente da linha atual
+    int16_t *mag;                   // 3 linhas de magnitude (w + 2, borda 0)
+    int16_t *mag_zero;              // Linha fora da imagem (magnitude 0)
+    unsigned char *dir;             // 3 linhas de setor (SOBEL_DIR_*)
+} canny_stream_t;
+
+int canny_stream_init(canny_stream_t *cs, int width, int height, int low, int high,
+                      int out_begin, int out_end);
+// map é o plano width × height de classes
+void canny_stream_push(canny_stream_t *cs, const unsigned char *luma, int y,
+                       unsigned char *map);
+void canny_stream_free(canny_stream_t *cs);
+
+// Histerese: pixels fracos conectados (8-vizinhança) a um forte viram
+// borda. Faixas em paralelo; costuras propagadas entre elas até estabilizar.
+// Ao final o mapa é binário (0/255). pool NULL = serial
+int canny_hysteresis(unsigned char *map, int width, int height, int num_tiles,
+                     thread_pool_t *pool);
+
+// Canny completo da imagem inteira (serial)
+int apply_canny(const unsigned char *luma, unsigned char *dst, int width, int height,
+                int low, int high);
+
+#endif // CANNY_H
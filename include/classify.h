@@ -0,0 +1,47 @@
+#ifndef CLASSIFY_H
+#define CLASSIFY_H
+
+#include "common.h"
+#include "colorspace.h"
+
+// LUT 3D: 6 bits por canal, 64x64x64 células de 4x4x4 cores
+#define CLASS_LUT_BITS      6
+#define CLASS_LUT_SIZE      (1 << (3 * CLASS_LUT_BITS))
+// Folga após a tabela: o gather AVX2 lê 4 bytes a partir de cada índice
+#define CLASS_LUT_PAD       4
+// Intervalos direto em RGB (demais espaços de colorspace.h)
+#define CLASS_SPACE_RGB     COLOR_SPACE_COUNT
+
+/**
+ * @brief Classificador de cor por LUT 3D quantizada
+ *
+ * Cada célula da LUT guarda a classe da maioria das suas 64 cores: cada
+ * cor é convertida para o espaço de cada classe (colorspace.h) e recebe
+ * a primeira classe da receita cujos três intervalos a contêm (0 = sem
+ * classe). Na imagem, uma consulta por pixel (gather vetorial) dá a
+ * classe, e as contagens por classe saem do mesmo passo.
+ *
+ * A tabela é montada uma vez pelo coordenador, antes do fork, num
+ * mapeamento compartilhado protegido contra escrita: todos os workers
+ * leem as mesmas páginas.
+ */
+typedef struct {
+    int active;                 // 0 = filtro classify desabilitado
+    int classes;                // Classes da receita (ids 1..classes)
+    const uint8_t *lut;         // CLASS_LUT_SIZE ids (+ CLASS_LUT_PAD)
+    void *block;
+    size_t block_bytes;
+} class_lut_t;
+
+const char* class_space_name(int space);
+
+// Monta a LUT das classes de cfg. Retorna 0 ou -1
+int class_lut_build(class_lut_t *cl, const pipeline_config_t *cfg);
+void class_lut_free(class_lut_t *cl);
+
+// Classe de n pixels de planos R, G, B: dst = id × CLASS_LABEL_STEP e
+// counts[id]++ (counts com classes + 1 posições)
+void class_rows(const class_lut_t *cl, const unsigned char *r, const unsigned char *g,
+                const unsigned char *b, unsigned char *dst, int n, uint32_t *counts);
+
+#endif // CLASSIFY_H
@@ -0,0 +1,36 @@
+#ifndef COLORSPACE_H
+#define COLORSPACE_H
+
+#include "common.h"
+
+// Componentes por espaço de cor (uma saída de 1 canal cada)
+#define COLOR_PLANES        3
+
+typedef enum {
+    COLOR_YCBCR = 0,            // JFIF (BT.601, faixa completa): Y = grayscale, Cb/Cr + 128
+    COLOR_HSV   = 1,            // Matiz em 256 passos por volta; S e V em 0-255
+    COLOR_LAB   = 2,            // CIELAB aproximado em ponto fixo (L·2,55; a/b + 128)
+    COLOR_SPACE_COUNT = 3
+} color_space_t;
+
+#define COLOR_SPACE_BIT(space)  (1u << (space))
+
+// Espaços gerados pelo filtro color sem --color
+#define COLOR_SPACES_DEFAULT    (COLOR_SPACE_BIT(COLOR_YCBCR) | COLOR_SPACE_BIT(COLOR_HSV))
+
+const char* color_space_name(int space);
+
+// Nome da saída do componente k do espaço ("ycbcr_y", "hsv_h", ...)
+const char* color_plane_name(int space, int plane);
+
+/**
+ * @brief Converte n pixels de planos R, G, B para os planos do espaço
+ *
+ * Ponto fixo vetorial (g_kernels): YCbCr e Lab são matrizes 3x3 em Q15,
+ * HSV usa máximo/mínimo e divisões exatas. Imagens em cinza passam o
+ * mesmo plano em r, g e b. dst[k] recebe o componente k.
+ */
+void color_convert_row(int space, const unsigned char *r, const unsigned char *g,
+                       const unsigned char *b, unsigned char *const dst[COLOR_PLANES], int n);
+
+#endif // COLORSPACE_H
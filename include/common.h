@@ -15,6 +15,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include <unistd.h>
 #include <sys/types.h>
@@ -49,18 +50,49 @@
 
 // Paralelismo
 #define NUM_WORKERS         2       // Número de processos worker
-#define NUM_THREADS         3       // Threads por worker (filtros paralelos)
+#define NUM_THREADS         3       // Threads por worker (faixas da imagem em paralelo)
 
 // Limites
 #define MAX_FILENAME        256     // Tamanho máximo de nome de arquivo
 #define MAX_PATH            512     // Tamanho máximo de caminho
 #define MAX_IMAGES          100     // Máximo de imagens por execução
+#define MAX_CHANNELS        4       // Canais por pixel (gray, RGB, RGBA)
 #define MAX_MSG_SIZE        512     // Tamanho máximo de mensagem IPC
 #define MAX_QUEUE_MSGS      10      // Capacidade da fila de mensagens
 
 // Parâmetros de filtros
 #define BLUR_KERNEL_SIZE    5       // Tamanho do kernel de blur (ímpar)
+#define BLUR_MAX_RADIUS     64      // Raio máximo aceito (kernel 129x129)
+#define MEDIAN_RADIUS       2       // Raio da mediana (janela 5x5)
+#define MEDIAN_MAX_RADIUS   15      // Raio máximo da mediana (janela 31x31)
 #define RESIZE_SCALE        0.5     // Fator de redimensionamento padrão
+#define RESIZE_MODE         2       // Interpolação padrão (0=nearest, 1=bilinear, 2=area)
+#define BAND_CACHE_BYTES    (256 * 1024)  // Faixa de linhas do passo fundido (cabe no L2)
+#define SOBEL_NORM          0       // Magnitude do Sobel (0=L1 |gx|+|gy|, 1=L2)
+#define THRESHOLD_MODE      2       // Binarização (0=fixo, 1=média local, 2=Otsu)
+#define THRESHOLD_VALUE     128     // Limiar fixo
+#define THRESHOLD_RADIUS    7       // Janela da média local (2r+1)
+#define THRESHOLD_C         5       // Margem abaixo da média local
+#define CANNY_LOW           50      // Histerese do Canny: limiar fraco (magnitude L1)
+#define CANNY_HIGH          150     // Histerese do Canny: limiar forte
+#define MORPH_OP            3       // Morfologia (0=erode, 1=dilate, 2=open, 3=close)
+#define MORPH_SIZE          5       // Elemento estruturante padrão (5x5)
+#define MORPH_MAX_SIZE      255     // Lado máximo do elemento estruturante (ímpar)
+#define BLOB_MIN_AREA       16      // Blobs menores são descartados como ruído (pixels)
+#define MATCH_MAX_TEMPLATES 8       // Templates por execução (--templates)
+#define MATCH_THRESHOLD     0.8     // Score NCC mínimo de uma ocorrência
+#define IMAGE_STATS         1       // Estatísticas por canal de cada imagem (relatório)
+#define TONE_MAX_CURVE      16      // Pontos da curva de tons (--curve)
+#define REMAP_MAX_PARAMS    8       // Parâmetros da geometria do remap (--remap)
+#define GOLDEN_MAX_REFS     8       // Imagens de referência do golden (--golden)
+#define GOLDEN_THRESHOLD    40      // Diferença acima da tolerância que marca defeito
+#define CLASS_MAX           15      // Classes de cor da receita (--class; id 0 = sem classe)
+#define CLASS_NAME_LEN      32      // Nome de uma classe (com o terminador)
+#define CLASS_LABEL_STEP    17      // Rótulo salvo = id × 17 (classes 0-15 em 0-255)
+
+// Filtros executados por padrão (demais habilitados com --filters)
+#define FILTERS_DEFAULT     (FILTER_BIT(FILTER_GRAYSCALE) | FILTER_BIT(FILTER_BLUR) | \
+                             FILTER_BIT(FILTER_RESIZE))
 
 // ============================================================================
 // RECURSOS IPC
@@ -69,6 +101,7 @@
 // Nomes dos recursos IPC POSIX (devem começar com /)
 #define QUEUE_NAME          "/favis_queue"
 #define SHM_NAME            "/favis_stats"
+#define GOLDEN_SHM_NAME     "/favis_golden"
 #define SEM_IO_NAME         "/favis_io_sem"
 
 // ============================================================================
@@ -86,13 +119,24 @@ typedef enum {
     FILTER_GRAYSCALE = 0,
     FILTER_BLUR      = 1,
     FILTER_RESIZE    = 2,
-    // Reservado para versões futuras:
-    // FILTER_SOBEL     = 3,
-    // FILTER_THRESHOLD = 4,
-    // FILTER_CANNY     = 5,
-    FILTER_COUNT     = 3    // Número total de filtros ativos
+    FILTER_SOBEL     = 3,
+    FILTER_THRESHOLD = 4,
+    FILTER_CANNY     = 5,
+    FILTER_MORPH     = 6,
+    FILTER_BLOBS     = 7,
+    FILTER_MATCH     = 8,
+    FILTER_PYRAMID   = 9,
+    FILTER_REMAP     = 10,
+    FILTER_GOLDEN    = 11,
+    FILTER_MEDIAN    = 12,
+    FILTER_COLOR     = 13,
+    FILTER_CLASSIFY  = 14,
+    FILTER_COUNT     = 15   // Número total de filtros implementados
 } filter_type_t;
 
+// Máscara de filtros habilitados (pipeline_config_t.filters)
+#define FILTER_BIT(type)    (1u << (type))
+
 // ============================================================================
 // CÓDIGOS DE MENSAGEM
 // ============================================================================
@@ -108,6 +152,36 @@ typedef enum {
 // ESTRUTURAS DE DADOS
 // ============================================================================
 
+/**
+ * @brief Estatísticas de um canal da imagem (derivadas do histograma)
+ */
+typedef struct {
+    double mean;
+    double stddev;              // Desvio padrão populacional
+    int min, max;
+    uint32_t hist[256];
+} channel_stats_t;
+
+/**
+ * @brief Resultado de uma imagem no relatório de execução
+ *
+ * Preenchido pelo worker que processou a tarefa (índice = task_id, a
+ * mesma posição da imagem na lista do coordenador).
+ */
+typedef struct {
+    int num_blobs;              // Blobs rotulados (-1 = filtro blobs desabilitado)
+    long blob_area;             // Soma das áreas dos blobs (pixels)
+    long largest_blob;          // Área do maior blob
+    int num_matches;            // Ocorrências de templates (-1 = filtro match desabilitado)
+    double best_match;          // Maior score NCC entre as ocorrências
+    long golden_defects;        // Pixels fora da tolerância (-1 = filtro golden desabilitado)
+    long golden_pixels;         // Pixels comparados
+    int num_classes;            // Classes de cor contadas (-1 = filtro classify desabilitado)
+    long class_counts[CLASS_MAX + 1];  // Pixels por classe (0 = sem classe)
+    int channels;               // Canais com estatísticas (0 = desabilitadas ou falha)
+    channel_stats_t channel[MAX_CHANNELS];
+} image_report_t;
+
 /**
  * @brief Estatísticas compartilhadas entre processos
  * 
@@ -131,8 +205,90 @@ typedef struct {
     int workers_active;         // Workers atualmente ativos
     int workers_done;           // Workers que finalizaram
     char current_files[NUM_WORKERS][MAX_FILENAME];  // Arquivo atual de cada worker
+    
+    // Resultado de cada imagem (relatório final)
+    image_report_t reports[MAX_IMAGES];
 } shared_stats_t;
 
+/**
+ * @brief Classe de cor da receita: intervalo por componente num espaço
+ *
+ * lo > hi é um intervalo que dá a volta (v >= lo ou v <= hi), para a
+ * matiz do HSV ao redor do vermelho.
+ */
+typedef struct {
+    char name[CLASS_NAME_LEN];
+    int space;                  // Espaço dos intervalos (color_space_t ou CLASS_SPACE_RGB)
+    unsigned char lo[3], hi[3];
+} color_class_t;
+
+/**
+ * @brief Parâmetros do pipeline de filtros
+ * 
+ * Preenchidos pelo coordenador (padrões de common.h + linha de comando)
+ * antes do fork; cada worker herda uma cópia somente leitura.
+ */
+typedef struct {
+    int blur_radius;            // Raio do box blur (kernel = 2*raio + 1)
+    int median_radius;          // Raio da mediana (janela = 2*raio + 1)
+    double resize_scale;        // Fator de escala (usado se não houver tamanho fixo)
+    int resize_width;           // Largura de saída (0 = pela escala/proporção)
+    int resize_height;          // Altura de saída (0 = pela escala/proporção)
+    int resize_mode;            // Interpolação (resize_mode_t)
+    int num_threads;            // Threads por worker (faixas paralelas por imagem)
+    unsigned int filters;       // Filtros habilitados (FILTER_BIT)
+    int sobel_norm;             // Magnitude do Sobel (sobel_norm_t)
+    int sobel_direction;        // 1 = salva também o setor de direção
+    int threshold_mode;         // Binarização (threshold_mode_t)
+    int threshold_value;        // Limiar fixo (0-255)
+    int threshold_radius;       // Raio da janela da média local
+    int threshold_c;            // Margem subtraída da média local
+    int canny_low;              // Limiar fraco da histerese (magnitude L1)
+    int canny_high;             // Limiar forte da histerese
+    int morph_op;               // Operação morfológica (morph_op_t)
+    int morph_width;            // Elemento estruturante (ímpar)
+    int morph_height;
+    int morph_input;            // Cinza ou binária (morph_input_t)
+    int blob_min_area;          // Área mínima de um blob (pixels)
+    char match_templates[MATCH_MAX_TEMPLATES][MAX_PATH];  // Imagens dos templates
+    int num_templates;
+    double match_threshold;     // Score NCC mínimo (0-1]
+    int image_stats;            // 1 = estatísticas por canal no relatório
+    // Operações pontuais (compostas em uma LUT aplicada à origem)
+    double tone_gamma;          // Saída = entrada^gama, normalizada (1 = desligada)
+    int tone_contrast_low;      // Faixa [low, high] esticada para 0-255
+    int tone_contrast_high;
+    int tone_curve_points;      // Pontos da curva de tons (0 = desligada)
+    unsigned char tone_curve[TONE_MAX_CURVE][2];  // (entrada, saída), entrada crescente
+    int tone_invert;            // 1 = negativo
+    int tone_clamp_low;         // Saída limitada a [low, high]
+    int tone_clamp_high;
+    // Calibração da câmera (quadros carregados uma vez pelo coordenador)
+    char calib_dark[MAX_PATH];  // Dark frame ("" = sem subtração)
+    char calib_flat[MAX_PATH];  // Flat-field ("" = sem ganho)
+    // Quadros brutos de sensor com mosaico Bayer (bayer.h)
+    int bayer_pattern;          // Padrão do mosaico (bayer_pattern_t, 0 = imagem comum)
+    int demosaic_method;        // Interpolação (demosaic_method_t)
+    int bayer_gray;             // 1 = luminância direto do mosaico
+    // Remap geométrico (mapa calculado uma vez por geometria)
+    int remap_mode;             // Geometria (remap_mode_t)
+    int remap_num_params;
+    double remap_params[REMAP_MAX_PARAMS];  // Parâmetros do modo (remap.h)
+    int remap_width;            // Tamanho da saída (0 = padrão do modo)
+    int remap_height;
+    // Inspeção contra referência (decodificada uma vez pelo coordenador)
+    char golden_refs[GOLDEN_MAX_REFS][MAX_PATH];   // Imagens de referência
+    int num_golden_refs;
+    char golden_masks[GOLDEN_MAX_REFS][MAX_PATH];  // Tolerância por pixel da i-ésima referência
+    int num_golden_masks;
+    int golden_threshold;       // Diferença (além da tolerância) que marca defeito
+    // Conversão de cor (colorspace.h)
+    unsigned int color_spaces;  // Espaços gerados pelo filtro color (COLOR_SPACE_BIT)
+    // Classificação de cor (LUT 3D montada uma vez pelo coordenador)
+    color_class_t classes[CLASS_MAX];  // Em ordem de prioridade (id = posição + 1)
+    int num_classes;
+} pipeline_config_t;
+
 /**
  * @brief Mensagem para fila de tarefas
  * 
@@ -145,15 +301,16 @@ typedef struct {
 } task_message_t;
 
 /**
- * @brief Argumentos para threads de filtro
+ * @brief Argumentos para threads de saída
  * 
- * Passado para cada thread que executa um filtro específico.
+ * Passado para cada thread que salva a saída de um filtro.
  */
 typedef struct {
     unsigned char *image_data;  // Ponteiro para dados da imagem
     int width;                  // Largura em pixels
     int height;                 // Altura em pixels
     int channels;               // Número de canais (1=gray, 3=RGB, 4=RGBA)
+    int depth;                  // Bits por amostra (8 = JPEG/PNG, 16 = PNG de 16 bits)
     char input_file[MAX_FILENAME];  // Arquivo de entrada
     char output_file[MAX_PATH];     // Arquivo de saída
     int filter_type;            // Tipo do filtro (filter_type_t)
@@ -173,6 +330,9 @@ typedef struct {
     shared_stats_t *stats;      // Ponteiro para estatísticas compartilhadas
     sem_t *io_sem;              // Semáforo de controle de I/O
     int pipe_fd;                // File descriptor do pipe de log
+    const pipeline_config_t *config;  // Parâmetros dos filtros (somente leitura)
+    struct thread_pool_s *pool; // Pool de threads do worker (criado após o fork)
+    const struct pipeline_resources_s *resources;  // Dados carregados uma vez por worker
 } worker_context_t;
 
 // ============================================================================
@@ -189,6 +349,13 @@ typedef struct {
 // FUNÇÕES UTILITÁRIAS INLINE
 // ============================================================================
 
+#ifndef MIN
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#endif
+#ifndef MAX
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif
+
 /**
  * @brief Calcula diferença de tempo entre dois timespec
  * @return Diferença em segundos (double)
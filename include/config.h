@@ -0,0 +1,19 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include "common.h"
+
+// Preenche a configuração com os padrões de common.h
+void config_init(pipeline_config_t *cfg);
+
+// Define um parâmetro por nome ("blur_radius", "resize", ...). Retorna 0 ou -1 se inválido
+int config_set(pipeline_config_t *cfg, const char *key, const char *value);
+
+// Processa argv. Retorna 0 para continuar, 1 para sair com sucesso (--help), -1 em erro
+int config_parse_args(pipeline_config_t *cfg, int argc, char *argv[]);
+void config_print_usage(const char *prog);
+
+// Imprime a configuração ativa dos filtros
+void config_print(const pipeline_config_t *cfg);
+
+#endif // CONFIG_H
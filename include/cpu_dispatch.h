@@ -0,0 +1,33 @@
+#ifndef CPU_DISPATCH_H
+#define CPU_DISPATCH_H
+
+#include "common.h"
+
+// Detecta se a arquitetura alvo permite kernels SIMD x86
+#if defined(__x86_64__) || defined(__i386__)
+#define FAVIS_X86 1
+#else
+#define FAVIS_X86 0
+#endif
+
+// Níveis de SIMD suportados (ordem crescente de capacidade)
+typedef enum {
+    SIMD_SCALAR = 0,    // Código C portável (referência)
+    SIMD_SSSE3  = 1,    // SSE2 + pshufb (128 bits)
+    SIMD_AVX2   = 2     // AVX2 (256 bits)
+} simd_level_t;
+
+// Detecção via cpuid (executada uma vez, antes do fork dos workers)
+void cpu_dispatch_init(void);
+
+// Nível detectado / em uso
+simd_level_t cpu_detected_level(void);
+simd_level_t cpu_simd_level(void);
+
+// Força um nível (limitado ao detectado); retorna o nível efetivo
+simd_level_t cpu_set_simd_level(simd_level_t level);
+
+// Nome do nível para logs
+const char* cpu_simd_name(simd_level_t level);
+
+#endif // CPU_DISPATCH_H
@@ -2,23 +2,207 @@
 #define FILTERS_H
 
 #include "common.h"
+#include "integral.h"
+#include <stdint.h>
 
-// Funções de thread para cada filtro
-void* thread_grayscale(void *args);
-void* thread_blur(void *args);
-void* thread_resize(void *args);
+// Seleciona kernels SIMD conforme a CPU (chamar antes do fork)
+void filters_init(void);
+
+// Thread que salva uma saída do pipeline (args: thread_args_t)
+void* thread_save_output(void *args);
 
 // Funções auxiliares dos filtros
+void grayscale_rows(const unsigned char *src, unsigned char *dst, int n, int channels);
+// Plano de luminância (1 byte por pixel) para filtros que operam em cinza
+void luma_rows(const unsigned char *src, unsigned char *dst, int n, int channels);
 void apply_grayscale(unsigned char *image, int width, int height, int channels);
-void apply_blur(unsigned char *src, unsigned char *dst, int width, int height, int channels);
-void apply_resize(unsigned char *src, int src_w, int src_h, int channels,
-                  unsigned char **dst, int *dst_w, int *dst_h);
+int apply_blur(const unsigned char *src, unsigned char *dst, int width, int height,
+               int channels, int radius);
+int apply_median(const unsigned char *src, unsigned char *dst, int width, int height,
+                 int channels, int radius);
+int apply_resize(const unsigned char *src, int src_w, int src_h, int channels,
+                 unsigned char **dst, int dst_w, int dst_h, int mode);
+int apply_sobel(const unsigned char *luma, unsigned char *mag, unsigned char *dir,
+                int width, int height, int norm);
+int apply_threshold(const unsigned char *luma, unsigned char *dst, int width, int height,
+                    int mode, int value, int radius, int c);
+int apply_morphology(const unsigned char *src, unsigned char *dst, int width, int height,
+                     int op, int kw, int kh);
+
+/**
+ * @brief Box blur separável em streaming (somas deslizantes)
+ * 
+ * Recebe as linhas de entrada em ordem e emite cada linha de saída
+ * assim que sua janela vertical está completa. Custo por pixel
+ * constante, independente do raio. A faixa de saída [out_begin, out_end)
+ * permite processar apenas parte da imagem (com halo de 'radius' linhas).
+ *
+ * Internamente tudo é planar (planar.h): as linhas de entrada chegam já
+ * separadas por canal e a saída é reintercalada ao emitir cada linha.
+ * As operações por linha são especializadas no número de canais.
+ */
+typedef struct blur_row_ops_s blur_row_ops_t;
+
+typedef struct {
+    int width, height, channels, radius;
+    int out_begin, out_end;     // Linhas de saída desta instância
+    int in_begin, in_end;       // Linhas de entrada necessárias (com halo)
+    int next_out;               // Próxima linha a emitir
+    int win_lo, win_hi;         // Janela vertical acumulada em colsum
+    int ring_rows;              // Linhas no buffer circular (2r + 2)
+    int col_begin, col_end;     // Colunas com janela horizontal completa
+    size_t stride;              // Elementos por linha de plano (planar_stride)
+    uint16_t *ring;             // Somas horizontais das linhas da janela (planos)
+    uint32_t *colsum;           // Soma vertical por coluna, um plano por canal
+    unsigned char *out_planes;  // Linha de saída em planos (channels > 1)
+    const blur_row_ops_t *ops;  // Variante para 'channels' canais
+} blur_stream_t;
+
+int blur_stream_init(blur_stream_t *bs, int width, int height, int channels,
+                     int radius, int out_begin, int out_end);
+// row: linha y em planos a cada bs->stride bytes; dst: imagem intercalada
+void blur_stream_push(blur_stream_t *bs, const unsigned char *row, int y, unsigned char *dst);
+void blur_stream_free(blur_stream_t *bs);
+
+/**
+ * @brief Mediana em streaming com custo constante por pixel (Perreault/Hébert)
+ *
+ * Cada coluna mantém o histograma das linhas da janela vertical, atualizado
+ * com +linha nova −linha antiga; a mediana de cada pixel sai do histograma
+ * da janela, deslizado ao longo da linha a partir dos histogramas de coluna
+ * (kernel median_row). Mesmo contrato do blur_stream_t: linhas de entrada
+ * em planos, faixa de saída com halo de 'radius' linhas, janela truncada
+ * nas bordas da imagem.
+ */
+typedef struct {
+    int width, height, channels, radius;
+    int out_begin, out_end;     // Linhas de saída desta instância
+    int in_begin, in_end;       // Linhas de entrada necessárias (com halo)
+    int next_out;               // Próxima linha a emitir
+    int win_lo, win_hi;         // Linhas contadas nos histogramas de coluna
+    int ring_rows;              // Linhas guardadas para sair da janela (2r + 2)
+    size_t stride;              // Elementos por linha de plano (planar_stride)
+    unsigned char *ring;        // Linhas de entrada da janela (planos)
+    uint16_t *fine;             // 256 contagens por coluna (por segmento), um bloco por canal
+    uint16_t *coarse;           // 16 contagens por coluna (nível >> 4)
+    unsigned char *out_planes;  // Linha de saída em planos (channels > 1)
+} median_stream_t;
+
+int median_stream_init(median_stream_t *ms, int width, int height, int channels,
+                       int radius, int out_begin, int out_end);
+// row: linha y em planos a cada ms->stride bytes; dst: imagem intercalada
+void median_stream_push(median_stream_t *ms, const unsigned char *row, int y,
+                        unsigned char *dst);
+void median_stream_free(median_stream_t *ms);
+
+/**
+ * @brief Morfologia com elemento estruturante retangular kw × kh
+ *
+ * van Herk/Gil-Werman: custo por pixel constante para qualquer tamanho
+ * de janela (plano de 1 canal). Pixels fora da imagem são ignorados.
+ * Sobre uma imagem binária (0/255) equivale à morfologia binária.
+ */
+typedef enum {
+    MORPH_ERODE  = 0,           // Mínimo da janela
+    MORPH_DILATE = 1,           // Máximo da janela
+    MORPH_OPEN   = 2,           // Erosão seguida de dilatação
+    MORPH_CLOSE  = 3            // Dilatação seguida de erosão
+} morph_op_t;
+
+typedef enum {
+    MORPH_INPUT_GRAY   = 0,     // Plano de luminância
+    MORPH_INPUT_BINARY = 1      // Saída do threshold
+} morph_input_t;
+
+// Linhas [out_begin, out_end) de dst (halo de kh/2 linhas, 2× em open/close).
+// src e dst não podem se sobrepor
+int morph_rows(const unsigned char *src, unsigned char *dst, int width, int height,
+               int op, int kw, int kh, int out_begin, int out_end);
+const char* morph_op_name(int op);
+
+/**
+ * @brief Sobel 3x3 em streaming sobre o plano de luminância
+ * 
+ * gx e gy de cada linha ficam em buffers int16 (L1) e são convertidos
+ * na mesma passada em magnitude (L1 ou L2) e, opcionalmente, no setor
+ * de direção quantizado (SOBEL_DIR_*). Halo de 1 linha por faixa.
+ */
+typedef enum {
+    SOBEL_L1 = 0,               // |gx| + |gy|
+    SOBEL_L2 = 1                // sqrt(gx² + gy²)
+} sobel_norm_t;
+
+typedef struct {
+    int width, height;
+    int norm;                   // sobel_norm_t
+    int out_begin, out_end;     // Linhas de saída desta instância
+    int in_begin, in_end;       // Linhas de entrada necessárias (halo de 1)
+    int next_out;
+    unsigned char *ring;        // 3 linhas × (width + 2), bordas replicadas
+    int16_t *gx, *gy;           // Gradientes da linha em processamento
+} sobel_stream_t;
+
+int sobel_stream_init(sobel_stream_t *ss, int width, int height, int norm,
+                      int out_begin, int out_end);
+// mag/dir são planos width × height; dir pode ser NULL
+void sobel_stream_push(sobel_stream_t *ss, const unsigned char *luma, int y,
+                       unsigned char *mag, unsigned char *dir);
+void sobel_stream_free(sobel_stream_t *ss);
+
+/**
+ * @brief Modos de binarização (saída 0/255 sobre o plano de luminância)
+ */
+typedef enum {
+    THRESH_FIXED = 0,           // luma > valor
+    THRESH_MEAN  = 1,           // luma > média local (2r+1)² - c
+    THRESH_OTSU  = 2            // luma > limiar de Otsu do histograma da imagem
+} threshold_mode_t;
+
+// Limiar de Otsu a partir de um histograma de 256 bins
+int otsu_threshold(const uint32_t *hist);
+// Média, desvio, mínimo e máximo exatos a partir do histograma de um canal
+void channel_stats_from_hist(const uint32_t *hist, channel_stats_t *out);
+// Limiar adaptativo das linhas [out_begin, out_end), médias lidas da
+// imagem integral do plano de luminância
+int threshold_mean_rows(const integral_t *ii, const unsigned char *luma, unsigned char *dst,
+                        int radius, int c, int out_begin, int out_end);
+const char* threshold_mode_name(int mode);
+
+/**
+ * @brief Variantes de 16 bits por amostra (PNG de câmeras de 12/16 bits)
+ *
+ * Mesma aritmética das versões de 8 bits sobre amostras uint16 em ordem
+ * nativa. Parâmetros configurados na escala de 8 bits (limiar fixo,
+ * margem da média local) são multiplicados por 257 (255 → 65535).
+ */
+#define DEPTH16_SCALE       257
+
+void grayscale_rows_u16(const uint16_t *src, uint16_t *dst, int n, int channels);
+void luma_rows_u16(const uint16_t *src, uint16_t *dst, int n, int channels);
+// Box blur das linhas [out_begin, out_end) (src: imagem inteira; dst: linha out_begin)
+int blur_rows_u16(const uint16_t *src, uint16_t *dst, int width, int height, int channels,
+                  int radius, int out_begin, int out_end);
+void threshold_row_u16(const uint16_t *src, unsigned char *dst, int n, int thresh);
+int threshold_mean_rows_u16(const uint16_t *luma, unsigned char *dst, int width, int height,
+                            int radius, int c, int out_begin, int out_end);
+// Histograma de 65536 bins (acumula em hist)
+void histogram_u16(const uint16_t *src, int n, uint32_t *hist);
+// Limiar de Otsu sobre um histograma de 'bins' entradas
+int otsu_threshold_bins(const uint32_t *hist, int bins);
+// Byte alto de cada amostra (entrada dos filtros sem variante de 16 bits)
+void reduce_u16(const uint16_t *src, unsigned char *dst, size_t n);
 
 // Carregamento e salvamento de imagens
 unsigned char* load_image(const char *filename, int *width, int *height, int *channels);
 int save_image(const char *filename, unsigned char *data, int width, int height, int channels);
 void free_image(unsigned char *data);
 
+// 16 bits: detecção pelo cabeçalho, decodificação e PNG de 16 bits
+int image_is_16_bit(const char *filename);
+uint16_t* load_image_16(const char *filename, int *width, int *height, int *channels);
+int save_image_16(const char *filename, const uint16_t *data, int width, int height,
+                  int channels);
+
 // Nome do filtro
 const char* get_filter_name(int filter_type);
 
@@ -0,0 +1,61 @@
+#ifndef GOLDEN_H
+#define GOLDEN_H
+
+#include "common.h"
+
+/**
+ * @brief Referência do golden dentro do objeto compartilhado
+ *
+ * Deslocamentos a partir do início do mapeamento (cada processo mapeia
+ * o objeto num endereço próprio).
+ */
+typedef struct {
+    int width, height;
+    size_t luma_offset;         // Plano de luminância (width × height)
+    size_t tol_offset;          // Tolerância por pixel (0 = sem máscara)
+} golden_ref_t;
+
+// Início do objeto /favis_golden
+typedef struct {
+    int count;
+    golden_ref_t refs[GOLDEN_MAX_REFS];
+} golden_header_t;
+
+/**
+ * @brief Imagens de referência da inspeção golden
+ *
+ * O coordenador decodifica cada referência (e sua máscara de tolerância)
+ * uma única vez, converte para luminância e grava num objeto de memória
+ * compartilhada POSIX (GOLDEN_SHM_NAME, ao lado de SHM_NAME); cada worker
+ * o mapeia somente leitura. Uma referência por geometria: a imagem usa a
+ * de mesma largura e altura.
+ */
+typedef struct {
+    const golden_header_t *header;  // NULL = sem referências
+    void *map;
+    size_t map_bytes;
+    int fd;
+} golden_set_t;
+
+// Coordenador: decodifica as referências de cfg e cria o objeto. Retorna 0 ou -1
+int golden_create(golden_set_t *set, const pipeline_config_t *cfg);
+
+// Worker: mapeia o objeto criado pelo coordenador (somente leitura). Retorna 0 ou -1
+int golden_open(golden_set_t *set);
+
+void golden_close(golden_set_t *set);
+
+// Referência com a geometria dada (NULL se não houver)
+const golden_ref_t* golden_find(const golden_set_t *set, int width, int height);
+
+static inline const unsigned char* golden_luma(const golden_set_t *set,
+                                               const golden_ref_t *ref) {
+    return (const unsigned char*)set->map + ref->luma_offset;
+}
+
+static inline const unsigned char* golden_tolerance(const golden_set_t *set,
+                                                    const golden_ref_t *ref) {
+    return ref->tol_offset ? (const unsigned char*)set->map + ref->tol_offset : NULL;
+}
+
+#endif // GOLDEN_H
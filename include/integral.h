@@ -0,0 +1,57 @@
+#ifndef INTEGRAL_H
+#define INTEGRAL_H
+
+#include "common.h"
+#include "simd_kernels.h"
+#include "thread_pool.h"
+
+// Maior área cuja soma cabe em 32 bits (255 × área < 2^32)
+#define INTEGRAL_MAX_AREA   16843009L
+
+/**
+ * @brief Imagem integral (tabela de somas de área) do plano de luminância
+ *
+ * sum[y][x] = soma dos pixels de [0, x) × [0, y); linha e coluna 0 são
+ * zero, então qualquer retângulo sai de 4 leituras. As somas são
+ * acumuladas módulo 2^32: a diferença de 4 cantos é exata sempre que o
+ * retângulo tem até INTEGRAL_MAX_AREA pixels (qualquer janela de filtro);
+ * retângulos maiores são somados em faixas (integral_sum).
+ *
+ * A tabela de quadrados (opcional, 64 bits) dá a variância local.
+ * Construída uma vez por imagem e depois só lida, por todas as threads.
+ */
+typedef struct {
+    int width, height;
+    size_t stride;              // width + 1
+    uint32_t *sum;              // (height + 1) × stride
+    uint64_t *sqsum;            // Idem, ou NULL
+} integral_t;
+
+int integral_init(integral_t *ii, int width, int height, int with_sq);
+void integral_free(integral_t *ii);
+
+// Linhas [y, y + n) da origem (src aponta para a linha y). A linha 'top'
+// da tabela é tomada como zero: cada faixa monta sua parte de forma
+// independente e integral_merge_bands() soma o acumulado das anteriores.
+void integral_rows(integral_t *ii, const unsigned char *src, int y, int n, int top);
+
+// Corrige as faixas montadas em paralelo (mesma divisão do pipeline:
+// faixa i = [h·i/n, h·(i+1)/n)). pool NULL = serial. Retorna 0 ou -1
+int integral_merge_bands(integral_t *ii, int num_bands, thread_pool_t *pool);
+
+// Tabela completa a partir de um plano width × height (serial)
+void integral_build(integral_t *ii, const unsigned char *src);
+
+// Soma de [x0, x1) × [y0, y1) e soma dos quadrados (requer sqsum)
+uint64_t integral_sum(const integral_t *ii, int x0, int y0, int x1, int y1);
+uint64_t integral_sq_sum(const integral_t *ii, int x0, int y0, int x1, int y1);
+// Média e variância de [x0, x1) × [y0, y1) (variância requer sqsum)
+double integral_mean(const integral_t *ii, int x0, int y0, int x1, int y1);
+double integral_variance(const integral_t *ii, int x0, int y0, int x1, int y1);
+
+// Média da janela (2r+1)² truncada nas bordas para a linha y, com o mesmo
+// arredondamento do box blur. tmp: width elementos
+void integral_box_mean_row(const integral_t *ii, int y, int radius, uint32_t *tmp,
+                           unsigned char *dst);
+
+#endif // INTEGRAL_H
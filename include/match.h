@@ -0,0 +1,82 @@
+#ifndef MATCH_H
+#define MATCH_H
+
+#include "common.h"
+#include "integral.h"
+#include "simd_kernels.h"
+#include "thread_pool.h"
+
+#define MATCH_MAX_LEVELS        4       // Pirâmide de 1/1 a 1/8
+#define MATCH_COARSE_SIDE       16      // Menor lado do template no nível mais grosso
+#define MATCH_COARSE_SLACK      0.15    // Tolerância do score fora do nível 0
+#define MATCH_MAX_CANDIDATES    256     // Candidatos refinados por template
+#define MATCH_REFINE_RADIUS     2       // Busca ±r em volta do candidato a cada nível
+#define MATCH_MAX_AREA          (1L << 22)  // n²·255² cabe em int64 (somas exatas)
+#define MATCH_MAX_SIDE          65535   // Largura de linha dos kernels de produto interno
+#define MATCH_ACC_PIXELS        66051   // Produtos 255² somados num acumulador de 32 bits
+
+/**
+ * @brief Um nível da pirâmide de um template
+ *
+ * var = n·ΣT² − (ΣT)² (n = largura × altura), fixo por template: o
+ * denominador do NCC só precisa do termo da janela da imagem, que vem
+ * da imagem integral.
+ */
+typedef struct {
+    int width, height;
+    unsigned char *data;
+    int64_t sum;
+    int64_t var;
+} match_level_t;
+
+typedef struct {
+    char name[MAX_FILENAME];    // Nome base do arquivo (relatório)
+    int levels;                 // Níveis válidos (lado >= MATCH_COARSE_SIDE)
+    match_level_t level[MATCH_MAX_LEVELS];
+} match_template_t;
+
+/**
+ * @brief Templates carregados uma vez por worker
+ *
+ * Decodificados, convertidos para luminância e reduzidos em pirâmide na
+ * carga; depois só lidos pelas threads de todas as imagens.
+ */
+typedef struct {
+    int count;
+    match_template_t templates[MATCH_MAX_TEMPLATES];
+} match_template_set_t;
+
+int match_templates_load(match_template_set_t *set, const char paths[][MAX_PATH], int count);
+void match_templates_free(match_template_set_t *set);
+
+typedef struct {
+    int template_id;
+    int x, y, width, height;    // Canto superior esquerdo e tamanho (nível 0)
+    double score;               // NCC em [-1, 1]
+} match_t;
+
+typedef struct {
+    match_t *items;
+    int count, cap;
+} match_list_t;
+
+/**
+ * @brief Busca NCC de todos os templates, do grosso para o fino
+ *
+ * Busca exaustiva só no nível mais grosso de cada template (faixas de
+ * linhas em paralelo); os máximos locais acima de threshold − SLACK são
+ * refinados nível a nível numa janela ±MATCH_REFINE_RADIUS. No nível 0
+ * ficam os de score >= threshold, sem sobreposição (supressão de
+ * não-máximos por template). ii: integral de luma com sqsum.
+ */
+int match_find(const match_template_set_t *set, const unsigned char *luma, const integral_t *ii,
+               double threshold, int num_tiles, thread_pool_t *pool, match_list_t *out);
+void match_list_free(match_list_t *list);
+
+// Contorno de cada ocorrência sobre um plano width × height de 1 canal
+void match_draw(const match_list_t *list, unsigned char *dst, int width, int height);
+
+// Uma linha CSV por ocorrência (cabeçalho incluso). Retorna 0 ou -1
+int match_write_csv(const match_list_t *list, const match_template_set_t *set, const char *path);
+
+#endif // MATCH_H
@@ -0,0 +1,178 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "common.h"
+#include "bayer.h"
+#include "blobs.h"
+#include "calib.h"
+#include "classify.h"
+#include "golden.h"
+#include "colorspace.h"
+#include "canny.h"
+#include "filters.h"
+#include "match.h"
+#include "planar.h"
+#include "pyramid.h"
+#include "remap.h"
+#include "resize.h"
+#include "thread_pool.h"
+#include "tone.h"
+
+// Saídas produzidas por imagem (até duas por filtro; pirâmide e cor usam a folga)
+#define PIPELINE_MAX_OUTPUTS    (2 * FILTER_COUNT)
+
+// Altura mínima de uma faixa paralela (abaixo disso o halo domina)
+#define PIPELINE_MIN_TILE_ROWS  32
+
+/**
+ * @brief Dados de apoio carregados uma vez por worker
+ *
+ * Compartilhados somente leitura por todas as imagens e threads do
+ * worker (ex.: templates decodificados, em pirâmide).
+ */
+typedef struct pipeline_resources_s {
+    match_template_set_t templates;     // count 0 = match desabilitado
+    tone_lut_t tone;                    // active 0 = sem operações pontuais
+    const calib_t *calib;               // Dark/flat do coordenador (NULL = sem calibração)
+    const golden_set_t *golden;         // Referências golden do coordenador (NULL = sem)
+    const class_lut_t *class_lut;       // LUT de classes do coordenador (NULL = sem)
+} pipeline_resources_t;
+
+// Carrega o que os filtros habilitados precisam. Retorna 0 ou -1
+int pipeline_resources_load(pipeline_resources_t *res, const pipeline_config_t *config);
+void pipeline_resources_free(pipeline_resources_t *res);
+
+typedef struct {
+    int filter_type;            // filter_type_t que produziu a saída
+    const char *name;           // Sufixo do arquivo ("blur", "sobel_dir", ...)
+    unsigned char *data;        // Amostras uint16 se depth == 16
+    int width, height, channels;
+    int depth;                  // Bits por amostra (8 ou 16)
+} pipeline_output_t;
+
+/**
+ * @brief Pipeline fundido de uma imagem
+ *
+ * A origem é percorrida uma única vez em faixas de linhas do tamanho
+ * do L2 (BAND_CACHE_BYTES). Cada faixa alimenta todos os estágios
+ * (grayscale, blur, resize) enquanto ainda está no cache, em vez de
+ * cada filtro reler a imagem inteira da memória.
+ *
+ * A imagem é dividida em faixas horizontais, uma por thread do pool.
+ * Filtros de vizinhança (blur, mediana, sobel) e o resize leem linhas
+ * extras além da faixa (halo), de modo que as faixas são independentes e
+ * escrevem regiões disjuntas das saídas.
+ *
+ * Calibração (calib.h) e operações pontuais (tone.h) são aplicadas a cada
+ * faixa de cache logo após a leitura, nessa ordem: todos os estágios,
+ * a começar pelo grayscale, consomem a faixa já corrigida. Um quadro
+ * Bayer (--bayer) passa antes pelo demosaico (bayer.h), linha a linha
+ * para dentro da faixa de cache: 'channels' é o da imagem em cores e o
+ * RGB da imagem inteira não é gerado.
+ *
+ * Filtros que operam em cinza (sobel, threshold, canny, morph) compartilham
+ * o plano de luminância da faixa, convertido uma única vez. Estágios que
+ * dependem da imagem inteira (Otsu, média local, histerese do Canny,
+ * morfologia) rodam numa segunda fase, também em faixas paralelas, sobre o
+ * plano de luminância completo guardado na primeira, junto com o histograma
+ * de luminância, ou sobre outra saída (mapa de bordas do Canny, threshold
+ * na morfologia binária). Por último a rotulação de blobs, sobre a máscara
+ * binária final, e o template matching, sobre a luminância e sua integral.
+ *
+ * A conversão de cor (colorspace.h) lê as linhas próprias da faixa já
+ * separadas em planos, no mesmo passo que o grayscale: todos os espaços
+ * pedidos saem de uma única leitura da origem. O classificador de cor
+ * (classify.h) lê as mesmas linhas: uma consulta à LUT 3D por pixel, com
+ * as contagens por classe somadas no mesmo passo.
+ *
+ * A inspeção golden compara a luminância de cada faixa com a referência
+ * de mesma geometria (golden.h) e grava a máscara de defeitos no mesmo
+ * passo, contando os pixels marcados.
+ *
+ * O remap lê linhas de origem de qualquer faixa: a primeira fase só guarda
+ * a origem (já corrigida) em planos e a interpolação roda depois, em faixas
+ * de linhas de destino.
+ */
+typedef struct {
+    const unsigned char *src;   // Quadro bruto (1 canal) se bayer
+    int width, height, channels;
+    const pipeline_config_t *config;
+    resize_plan_t *resize_plan;
+    int bayer;                  // 1 = demosaico da origem nas faixas de cache
+    const calib_t *calib;       // Dark frame / flat-field (NULL = desligados)
+    const tone_lut_t *tone;     // Operações pontuais (NULL = desligadas)
+    pipeline_output_t outputs[PIPELINE_MAX_OUTPUTS];
+    int num_outputs;
+
+    // Saídas de cada estágio (NULL = filtro desabilitado)
+    pipeline_output_t *gray, *blur, *median, *resize;
+    pipeline_output_t *sobel, *sobel_dir;
+    pipeline_output_t *threshold;
+    pipeline_output_t *canny;
+    pipeline_output_t *morph;
+    pipeline_output_t *blobs;
+    pipeline_output_t *match;
+    pipeline_output_t *remap;
+    pipeline_output_t *golden;
+    pipeline_output_t *color[COLOR_SPACE_COUNT][COLOR_PLANES];  // NULL = espaço não pedido
+    pipeline_output_t *classify;
+
+    // Níveis 1/2, 1/4 e 1/8 (saídas pyr2, pyr4, pyr8) num único bloco,
+    // gerados na primeira fase a partir das mesmas faixas de cache
+    pyramid_t pyramid;
+
+    // Remap: mapa da geometria (cache) e origem inteira em planos, copiada
+    // das faixas de cache na primeira fase (+1 linha de folga para as
+    // leituras de 4 bytes dos kernels); interpolado depois dela
+    remap_map_t *remap_map;
+    planar_t remap_src;
+
+    // Golden: referência (e tolerância) da geometria da imagem, na memória
+    // compartilhada; defeitos somados pelas faixas na primeira fase
+    const unsigned char *golden_luma;
+    const unsigned char *golden_tol;        // NULL = sem máscara de tolerância
+    long golden_defects;
+
+    // Classes de cor: LUT compartilhada e pixels por classe (0 = sem classe)
+    const class_lut_t *class_lut;
+    long class_counts[CLASS_MAX + 1];
+
+    // Rótulos e medidas dos blobs da máscara binária (se blobs habilitado)
+    blob_set_t blob_set;
+
+    // Templates (recursos do worker) e ocorrências encontradas (se match)
+    const pipeline_resources_t *resources;
+    match_list_t matches;
+
+    // Plano de luminância da imagem inteira (NULL se nenhum estágio da
+    // segunda fase precisa). Aponta para src em imagens de 1 canal sem
+    // correções (demosaico, calibração ou LUT).
+    const unsigned char *luma;
+    unsigned char *luma_buf;
+
+    // Imagem integral da luminância (sum NULL se nenhum estágio consulta):
+    // cada faixa monta suas linhas na primeira fase; juntada antes da segunda
+    integral_t integral;
+
+    // Histograma de luminância da imagem, reutilizável por qualquer estágio
+    int has_luma_hist;
+    uint32_t luma_hist[256];
+
+    // Histograma de cada canal da origem (estatísticas do relatório),
+    // acumulado na primeira fase junto com os demais estágios
+    int has_stats;
+    uint32_t channel_hist[MAX_CHANNELS][256];
+} pipeline_t;
+
+// Aloca as saídas e obtém os planos dos estágios. Retorna 0 ou -1
+int pipeline_init(pipeline_t *p, const unsigned char *src, int width, int height,
+                  int channels, const pipeline_config_t *config,
+                  const pipeline_resources_t *resources);
+
+// Executa o passo fundido sobre a imagem inteira (pool NULL = serial)
+int pipeline_run(pipeline_t *p, thread_pool_t *pool);
+
+// Libera saídas e planos
+void pipeline_free(pipeline_t *p);
+
+#endif // PIPELINE_H
@@ -0,0 +1,61 @@
+#ifndef PIPELINE16_H
+#define PIPELINE16_H
+
+#include "common.h"
+#include "pipeline.h"
+#include "resize.h"
+#include "thread_pool.h"
+
+// Filtros com variante de 16 bits; os demais rodam sobre a redução a 8 bits
+#define PIPELINE16_FILTERS  (FILTER_BIT(FILTER_GRAYSCALE) | FILTER_BIT(FILTER_BLUR) | \
+                             FILTER_BIT(FILTER_RESIZE) | FILTER_BIT(FILTER_THRESHOLD))
+
+/**
+ * @brief Pipeline de uma imagem de 16 bits por amostra
+ *
+ * Grayscale, blur e resize geram saídas de 16 bits (salvas em PNG de 16
+ * bits); o threshold compara a luminância de 16 bits e gera a máscara
+ * 0/255 de sempre. A imagem é dividida em faixas horizontais, uma por
+ * thread do pool, que leem o halo diretamente da origem. Otsu e média
+ * local rodam numa segunda fase sobre o plano de luminância completo.
+ * Com calibração (calib.h) ou operações pontuais (tone.h) a origem
+ * corrigida (dark frame e ganho em 16 bits, depois a LUT de 65536
+ * entradas) é gerada antes, numa passada paralela própria: as faixas
+ * leem o halo das vizinhas, que precisa estar corrigido. Um quadro Bayer
+ * (--bayer) é demosaicado na mesma passada, para a origem corrigida em
+ * cores (a redução a 8 bits segue bruta e é demosaicada no pipeline
+ * comum, dentro das faixas de cache).
+ */
+typedef struct {
+    const uint16_t *src;        // Origem (ou corrected, com correções)
+    int width, height, channels;
+    const pipeline_config_t *config;
+    resize_plan_t *resize_plan;
+    int bayer;                  // 1 = origem é um quadro Bayer (demosaicado na correção)
+    const calib_t *calib;       // Dark frame / flat-field (NULL = desligados)
+    const tone_lut_t *tone;     // Operações pontuais (NULL = desligadas)
+    const uint16_t *orig;       // Origem antes das correções
+    uint16_t *corrected;        // Origem após demosaico, calibração e LUT
+    pipeline_output_t outputs[4];
+    int num_outputs;
+
+    // Saídas de cada estágio (NULL = filtro desabilitado)
+    pipeline_output_t *gray, *blur, *resize, *threshold;
+
+    // Plano de luminância (Otsu e média local). Aponta para src em 1 canal
+    const uint16_t *luma;
+    uint16_t *luma_buf;
+    uint32_t *luma_hist;        // 65536 bins (Otsu)
+} pipeline16_t;
+
+// Aloca as saídas dos filtros de PIPELINE16_FILTERS habilitados. Retorna 0 ou -1
+int pipeline16_init(pipeline16_t *p, const uint16_t *src, int width, int height,
+                    int channels, const pipeline_config_t *config,
+                    const pipeline_resources_t *resources);
+
+// Executa as duas fases sobre a imagem inteira (pool NULL = serial)
+int pipeline16_run(pipeline16_t *p, thread_pool_t *pool);
+
+void pipeline16_free(pipeline16_t *p);
+
+#endif // PIPELINE16_H
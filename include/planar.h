@@ -0,0 +1,72 @@
+#ifndef PLANAR_H
+#define PLANAR_H
+
+#include "common.h"
+#include "simd_kernels.h"
+
+// Alinhamento (bytes) do início de cada linha de plano: uma linha de cache
+#define PLANAR_ALIGN        64
+
+/**
+ * @brief Faixa de linhas em planos separados por canal (SoA)
+ *
+ * Cada linha da imagem vira 'channels' linhas de plano consecutivas, cada
+ * uma com 'stride' bytes (largura arredondada para PLANAR_ALIGN). Assim
+ * um canal é contíguo dentro da linha, todas as linhas de plano começam
+ * alinhadas e o preenchimento (zerado) pode ser lido pelos kernels sem
+ * tratar o fim da linha. Passos que tratam todos os canais igualmente
+ * (somas verticais) processam os planos de uma linha de uma só vez.
+ */
+typedef struct {
+    int width, rows, channels;
+    size_t stride;              // Bytes por linha de plano
+    unsigned char *data;        // rows × channels × stride
+} planar_t;
+
+// Elementos por linha de plano para a largura dada (múltiplo de PLANAR_ALIGN)
+static inline size_t planar_stride(int width) {
+    return ((size_t)width + PLANAR_ALIGN - 1) & ~(size_t)(PLANAR_ALIGN - 1);
+}
+
+// Linha y: plano k em planar_row(pl, y) + k × stride
+static inline unsigned char* planar_row(const planar_t *pl, int y) {
+    return pl->data + (size_t)y * pl->channels * pl->stride;
+}
+
+// Bloco alinhado em PLANAR_ALIGN e zerado (liberar com free)
+void* planar_alloc(size_t bytes);
+
+int planar_init(planar_t *pl, int width, int rows, int channels);
+void planar_free(planar_t *pl);
+
+// Pixels intercalados ↔ planos de uma linha (planos a planar_stride(width)).
+// Inline: chamadas com 'channels' constante (variantes especializadas por
+// número de canais) resolvem o kernel em tempo de compilação.
+static inline void planar_split_row(const unsigned char *src, unsigned char *dst,
+                                    int width, int channels) {
+    const size_t stride = planar_stride(width);
+    switch (channels) {
+        case 1:  memcpy(dst, src, (size_t)width); break;
+        case 2:  g_kernels.deinterleave_ga(src, dst, stride, width); break;
+        case 3:  g_kernels.deinterleave_rgb(src, dst, stride, width); break;
+        case 4:  g_kernels.deinterleave_rgba(src, dst, stride, width); break;
+        default: deinterleave_scalar(src, dst, stride, width, channels); break;
+    }
+}
+
+static inline void planar_merge_row(const unsigned char *src, unsigned char *dst,
+                                    int width, int channels) {
+    const size_t stride = planar_stride(width);
+    switch (channels) {
+        case 1:  memcpy(dst, src, (size_t)width); break;
+        case 2:  g_kernels.interleave_ga(src, stride, dst, width); break;
+        case 3:  g_kernels.interleave_rgb(src, stride, dst, width); break;
+        case 4:  g_kernels.interleave_rgba(src, stride, dst, width); break;
+        default: interleave_scalar(src, stride, dst, width, channels); break;
+    }
+}
+
+// Separa n linhas intercaladas (src aponta para a primeira) nas linhas [y, y + n)
+void planar_load_rows(planar_t *pl, const unsigned char *src, int y, int n);
+
+#endif // PLANAR_H
@@ -0,0 +1,63 @@
+#ifndef PYRAMID_H
+#define PYRAMID_H
+
+#include "common.h"
+#include "planar.h"
+#include "simd_kernels.h"
+
+#define PYRAMID_LEVELS      3       // Níveis 1/2, 1/4 e 1/8
+
+/**
+ * @brief Pirâmide de resolução de uma imagem (média 2x2 por nível)
+ *
+ * Nível l tem (largura >> l) × (altura >> l) pixels intercalados, todos
+ * em um único bloco alocado (cada nível começa alinhado em PLANAR_ALIGN).
+ * Imagens pequenas demais geram menos níveis. Índice 0 é a origem, que
+ * não é armazenada.
+ */
+typedef struct {
+    int levels;                                 // Níveis gerados (1..PYRAMID_LEVELS)
+    int channels;
+    int width[PYRAMID_LEVELS + 1];
+    int height[PYRAMID_LEVELS + 1];
+    unsigned char *level[PYRAMID_LEVELS + 1];   // Dentro de data (level[0] = NULL)
+    unsigned char *data;                        // Bloco com todos os níveis
+} pyramid_t;
+
+// Dimensiona e aloca os níveis de uma origem width × height. Retorna 0 ou -1
+int pyramid_init(pyramid_t *pyr, int width, int height, int channels);
+void pyramid_free(pyramid_t *pyr);
+
+/**
+ * @brief Geração da pirâmide em streaming
+ *
+ * Cada par de linhas de origem gera uma linha do nível 1, que entra
+ * imediatamente no nível 2 (e assim por diante) enquanto ainda está no
+ * L1: a origem é lida uma vez para todos os níveis. As linhas chegam
+ * separadas por canal (planar.h) e cada nível é reduzido por plano.
+ *
+ * Uma linha do nível l pertence à instância que recebe a primeira das
+ * 2^l linhas de origem que ela cobre: faixas [out_begin, out_end) de
+ * instâncias diferentes escrevem linhas disjuntas de todos os níveis.
+ */
+typedef struct {
+    const pyramid_t *pyr;
+    int out_begin, out_end;     // Linhas de origem desta instância
+    int in_begin, in_end;       // Linhas de origem necessárias
+    size_t stride[PYRAMID_LEVELS + 1];          // Elementos por linha de plano
+    unsigned char *pend;        // Linha par da origem à espera da ímpar (planos)
+    unsigned char *rows[PYRAMID_LEVELS + 1][2]; // Linhas par/ímpar de cada nível
+    const unsigned char *even[PYRAMID_LEVELS + 1];  // Linha par que entra no nível l
+    int even_row[PYRAMID_LEVELS + 1];           // Índice dela (-1 = nenhuma)
+    unsigned char *buf;        // Bloco de pend e rows
+} pyramid_stream_t;
+
+int pyramid_stream_init(pyramid_stream_t *ps, const pyramid_t *pyr, int out_begin, int out_end);
+// row: linha y em planos a cada planar_stride(largura) bytes (1 canal: a própria linha)
+void pyramid_stream_push(pyramid_stream_t *ps, const unsigned char *row, int y);
+void pyramid_stream_free(pyramid_stream_t *ps);
+
+// Todos os níveis de uma imagem intercalada (pyr já inicializada). Retorna 0 ou -1
+int pyramid_build(pyramid_t *pyr, const unsigned char *src);
+
+#endif // PYRAMID_H
@@ -0,0 +1,63 @@
+#ifndef REMAP_H
+#define REMAP_H
+
+#include "common.h"
+#include "simd_kernels.h"
+
+// Mapas mantidos em cache por worker (um por geometria de origem)
+#define REMAP_MAP_CACHE     2
+// Frações das coordenadas em Q7 (pesos bilineares em Q14)
+#define REMAP_FRAC_BITS     7
+// Coordenadas de origem em int16
+#define REMAP_MAX_SIDE      32767
+// fy de um pixel de destino fora da origem
+#define REMAP_OUTSIDE       0xFF
+
+typedef enum {
+    REMAP_NONE        = 0,
+    REMAP_LENS        = 1,  // Distorção radial (k1, k2, cx, cy; centro < 0 = meio da imagem)
+    REMAP_PERSPECTIVE = 2,  // Quadrilátero → retângulo (4 cantos)
+    REMAP_POLAR       = 3   // Anel → faixa retangular (cx, cy, r0, r1)
+} remap_mode_t;
+
+/**
+ * @brief Mapa de coordenadas de um remap
+ *
+ * Para cada pixel de destino, o canto superior esquerdo (x, y) dos 2x2
+ * pixels de origem e as frações fx, fy em Q7 (0 a 128). Calculado em
+ * ponto flutuante uma vez por geometria (cache LRU com contagem de
+ * referências, como os planos de resize) e depois só lido: o custo por
+ * imagem é a interpolação. Pixels de destino fora da origem têm
+ * fy = REMAP_OUTSIDE e saem pretos.
+ */
+typedef struct {
+    int src_w, src_h, dst_w, dst_h;
+    int mode;
+    double params[REMAP_MAX_PARAMS];
+    int16_t *xy;                // dst_w × dst_h pares (x, y), x <= src_w - 2, y <= src_h - 2
+    uint16_t *frac;             // fx | fy << 8
+    int refs;                   // Usuários ativos (protegido pelo mutex do cache)
+    unsigned long last_use;     // Para LRU
+    int cached;                 // 0 = mapa avulso, liberado no release
+} remap_map_t;
+
+// Tamanho da saída para uma origem src_w × src_h (padrão do modo ou --remap-size)
+void remap_target_size(const pipeline_config_t *cfg, int src_w, int src_h,
+                       int *dst_w, int *dst_h);
+
+// Obtém mapa do cache (ou calcula). Devolver com remap_map_release()
+remap_map_t* remap_map_get(const pipeline_config_t *cfg, int src_w, int src_h);
+void remap_map_release(remap_map_t *map);
+
+/**
+ * Linhas de destino [out_begin, out_end) de um plano. src: plano de
+ * origem com src_stride bytes por linha, legível até 2 bytes além do fim
+ * da última linha (leituras de 4 bytes dos kernels); dst: linha
+ * out_begin, dst_stride bytes por linha.
+ */
+void remap_plane_rows(const remap_map_t *map, const unsigned char *src, size_t src_stride,
+                      unsigned char *dst, size_t dst_stride, int out_begin, int out_end);
+
+const char* remap_mode_name(int mode);
+
+#endif // REMAP_H
@@ -0,0 +1,99 @@
+#ifndef RESIZE_H
+#define RESIZE_H
+
+#include "common.h"
+#include "simd_kernels.h"
+
+// Planos de coeficientes mantidos em cache por worker
+#define RESIZE_PLAN_CACHE   4
+
+typedef enum {
+    RESIZE_NEAREST  = 0,    // Vizinho mais próximo
+    RESIZE_BILINEAR = 1,    // Interpolação bilinear
+    RESIZE_AREA     = 2     // Média por área (redução); bilinear na ampliação
+} resize_mode_t;
+
+/**
+ * @brief Coeficientes de um eixo
+ *
+ * Cada amostra de destino lê 'taps' amostras consecutivas a partir de
+ * offset[i]. offset[i] + taps <= src_len sempre (sem teste de borda).
+ */
+typedef struct {
+    int src_len, dst_len;
+    int taps;
+    int *offset;                // dst_len
+    int16_t *weight;            // dst_len × taps (Q14)
+} resize_axis_t;
+
+/**
+ * @brief Plano de resize para um par de geometrias (origem, destino)
+ *
+ * Calculado uma vez e reutilizado por todas as imagens de mesma
+ * geometria (cache LRU com contagem de referências).
+ */
+typedef struct {
+    int src_w, src_h, dst_w, dst_h;
+    resize_mode_t mode;
+    resize_axis_t x, y;
+    int refs;                   // Usuários ativos (protegido pelo mutex do cache)
+    unsigned long last_use;     // Para LRU
+    int cached;                 // 0 = plano avulso, liberado no release
+} resize_plan_t;
+
+// Obtém plano do cache (ou cria). Devolver com resize_plan_release()
+resize_plan_t* resize_plan_get(int src_w, int src_h, int dst_w, int dst_h, resize_mode_t mode);
+void resize_plan_release(resize_plan_t *plan);
+
+/**
+ * @brief Resize em streaming
+ *
+ * Passo vertical primeiro (combina 'taps' linhas de origem em uma linha
+ * intermediária de largura total), depois o passo horizontal na linha
+ * já reduzida. Linhas de saída [out_begin, out_end).
+ *
+ * As linhas de origem chegam separadas por canal (planar.h): o passo
+ * vertical cobre os planos de uma vez e o horizontal roda por plano,
+ * com a linha de saída reintercalada no fim. As operações por linha são
+ * variantes especializadas no número de canais e de taps, escolhidas
+ * no init.
+ */
+typedef struct resize_row_ops_s resize_row_ops_t;
+typedef void (*resize_horiz_fn)(const int16_t *src, unsigned char *dst, const resize_axis_t *ax);
+
+typedef struct {
+    const resize_plan_t *plan;
+    int channels;
+    int out_begin, out_end, next_out;
+    int in_begin, in_end;       // Linhas de origem necessárias
+    size_t stride, out_stride;  // Elementos por linha de plano (origem / destino)
+    unsigned char *ring;        // plan->y.taps linhas de origem (planos)
+    const unsigned char **rows; // Ponteiros para as linhas de cada tap
+    int16_t *vrow;              // Linha intermediária (Q7, planos)
+    unsigned char *out_planes;  // Linha de saída em planos (channels > 1)
+    const resize_row_ops_t *ops;    // Cópia/emissão para 'channels' canais
+    resize_horiz_fn horiz;      // Passo horizontal para plan->x.taps
+} resize_stream_t;
+
+int resize_stream_init(resize_stream_t *rs, const resize_plan_t *plan, int channels,
+                       int out_begin, int out_end);
+// row: linha y em planos a cada rs->stride bytes; dst: imagem intercalada
+void resize_stream_push(resize_stream_t *rs, const unsigned char *row, int y, unsigned char *dst);
+void resize_stream_free(resize_stream_t *rs);
+
+// Resize completo de uma imagem (dst já alocado com dst_w × dst_h × channels)
+int resize_image(const unsigned char *src, int src_w, int src_h, int channels,
+                 unsigned char *dst, int dst_w, int dst_h, resize_mode_t mode);
+
+// Resize de 16 bits das linhas de saída [out_begin, out_end) (src: imagem
+// inteira src_w × src_h; dst: linha out_begin, amostras intercaladas)
+int resize_rows_u16(const resize_plan_t *plan, const uint16_t *src, int channels,
+                    uint16_t *dst, int out_begin, int out_end);
+
+// Calcula dimensões de saída a partir da configuração
+void resize_target_size(const pipeline_config_t *cfg, int src_w, int src_h,
+                        int *dst_w, int *dst_h);
+
+const char* resize_mode_name(resize_mode_t mode);
+
+#endif // RESIZE_H
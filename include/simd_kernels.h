@@ -0,0 +1,676 @@
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+#include "cpu_dispatch.h"
+#include <stdint.h>
+
+// Kernels de linha: processam 'n' pixels contíguos.
+// Cada kernel tem versão escalar (referência) e versões SIMD;
+// a tabela g_kernels é preenchida em runtime por simd_kernels_select().
+
+// ============================================================
+// GRAYSCALE (ponto fixo Q15, BT.601)
+// ============================================================
+
+// Pesos de luminância em Q15 (somam exatamente 32768)
+#define GRAY_WEIGHT_R       9798    // 0.299
+#define GRAY_WEIGHT_G       19235   // 0.587
+#define GRAY_WEIGHT_B       3735    // 0.114
+#define GRAY_SHIFT          15
+
+// Converte pixel RGB em luminância (mesma aritmética de todos os kernels)
+static inline unsigned char gray_pixel(unsigned char r, unsigned char g, unsigned char b) {
+    return (unsigned char)((GRAY_WEIGHT_R * r + GRAY_WEIGHT_G * g + GRAY_WEIGHT_B * b +
+                            (1 << (GRAY_SHIFT - 1))) >> GRAY_SHIFT);
+}
+
+typedef void (*gray_row_fn)(const unsigned char *src, unsigned char *dst, int n);
+
+// RGB → RGB (cinza replicado). src e dst podem ser o mesmo buffer.
+void gray_row_rgb_scalar(const unsigned char *src, unsigned char *dst, int n);
+// RGBA → RGBA (cinza replicado, alpha preservado). src e dst podem ser o mesmo buffer.
+void gray_row_rgba_scalar(const unsigned char *src, unsigned char *dst, int n);
+
+// RGB/RGBA → plano de luminância (1 byte por pixel)
+void gray_plane_rgb_scalar(const unsigned char *src, unsigned char *dst, int n);
+void gray_plane_rgba_scalar(const unsigned char *src, unsigned char *dst, int n);
+
+#if FAVIS_X86
+void gray_row_rgb_ssse3(const unsigned char *src, unsigned char *dst, int n);
+void gray_row_rgba_ssse3(const unsigned char *src, unsigned char *dst, int n);
+void gray_row_rgb_avx2(const unsigned char *src, unsigned char *dst, int n);
+void gray_row_rgba_avx2(const unsigned char *src, unsigned char *dst, int n);
+void gray_plane_rgb_ssse3(const unsigned char *src, unsigned char *dst, int n);
+void gray_plane_rgba_ssse3(const unsigned char *src, unsigned char *dst, int n);
+void gray_plane_rgb_avx2(const unsigned char *src, unsigned char *dst, int n);
+void gray_plane_rgba_avx2(const unsigned char *src, unsigned char *dst, int n);
+#endif
+
+// ============================================================
+// BOX BLUR (somas deslizantes)
+// ============================================================
+
+// acc[i] += add[i] - sub[i]  (atualização da soma vertical por coluna)
+typedef void (*blur_addsub_fn)(uint32_t *acc, const uint16_t *add, const uint16_t *sub, int n);
+// dst[i] = (acc[i] + area/2) / area: média da janela arredondada, exata
+// (acc[i] <= 255·area e area <= (2·BLUR_MAX_RADIUS + 1)², abaixo de 2^24)
+typedef void (*blur_scale_fn)(const uint32_t *acc, unsigned char *dst, int n, uint32_t area);
+
+// Soma deslizante de um plano: sum += src[i + span] - src[i]; dst[i] = sum.
+// Retorna a soma final (aritmética módulo 2^16: exata enquanto a janela cabe em uint16)
+typedef uint16_t (*blur_hsum_fn)(const unsigned char *src, int span, uint16_t *dst,
+                                 int n, uint16_t sum);
+
+void blur_addsub_row_scalar(uint32_t *acc, const uint16_t *add, const uint16_t *sub, int n);
+void blur_scale_row_scalar(const uint32_t *acc, unsigned char *dst, int n, uint32_t area);
+uint16_t blur_hsum_row_scalar(const unsigned char *src, int span, uint16_t *dst,
+                              int n, uint16_t sum);
+
+#if FAVIS_X86
+void blur_addsub_row_ssse3(uint32_t *acc, const uint16_t *add, const uint16_t *sub, int n);
+void blur_scale_row_ssse3(const uint32_t *acc, unsigned char *dst, int n, uint32_t area);
+void blur_addsub_row_avx2(uint32_t *acc, const uint16_t *add, const uint16_t *sub, int n);
+void blur_scale_row_avx2(const uint32_t *acc, unsigned char *dst, int n, uint32_t area);
+uint16_t blur_hsum_row_ssse3(const unsigned char *src, int span, uint16_t *dst,
+                             int n, uint16_t sum);
+uint16_t blur_hsum_row_avx2(const unsigned char *src, int span, uint16_t *dst,
+                            int n, uint16_t sum);
+#endif
+
+// ============================================================
+// RESIZE (passo vertical)
+// ============================================================
+
+// Precisão dos coeficientes (Q14: pesos de um eixo somam 16384)
+#define RESIZE_COEF_BITS    14
+// Bits fracionários da linha intermediária (u8 × Q14 → Q7, cabe em int16)
+#define RESIZE_INTER_BITS   7
+#define RESIZE_VERT_SHIFT   (RESIZE_COEF_BITS - RESIZE_INTER_BITS)
+
+// dst[i] = Σ_k weights[k] × rows[k][i]  (resultado em Q7)
+typedef void (*resize_vert_fn)(const unsigned char *const *rows, const int16_t *weights,
+                               int taps, int16_t *dst, int n);
+
+void resize_vert_row_scalar(const unsigned char *const *rows, const int16_t *weights,
+                            int taps, int16_t *dst, int n);
+
+#if FAVIS_X86
+void resize_vert_row_ssse3(const unsigned char *const *rows, const int16_t *weights,
+                           int taps, int16_t *dst, int n);
+void resize_vert_row_avx2(const unsigned char *const *rows, const int16_t *weights,
+                          int taps, int16_t *dst, int n);
+#endif
+
+// ============================================================
+// SOBEL (plano de luminância, intermediários int16)
+// ============================================================
+
+// tan(22,5°) em Q15: limite entre setores de direção
+#define SOBEL_TAN_22_5      13573
+// Setores de direção do gradiente (× 85 para ficarem visíveis na saída)
+#define SOBEL_DIR_0         0       // Horizontal (0°)
+#define SOBEL_DIR_45        85      // Diagonal descendente (45°)
+#define SOBEL_DIR_90        170     // Vertical (90°)
+#define SOBEL_DIR_135       255     // Diagonal ascendente (135°)
+
+// gx/gy de 'n' pixels. r0, r1, r2 (linhas acima, atual, abaixo) apontam
+// para o pixel -1: cada linha tem 1 pixel de borda replicada em cada lado.
+// |gx|, |gy| <= 1020: cabem em int16 sem saturação.
+typedef void (*sobel_row_fn)(const unsigned char *r0, const unsigned char *r1,
+                             const unsigned char *r2, int16_t *gx, int16_t *gy, int n);
+// Magnitude (L1 = |gx| + |gy|, L2 = sqrt(gx² + gy²)) saturada em 255, ou setor de direção
+typedef void (*sobel_out_fn)(const int16_t *gx, const int16_t *gy, unsigned char *dst, int n);
+
+void sobel_row_scalar(const unsigned char *r0, const unsigned char *r1,
+                      const unsigned char *r2, int16_t *gx, int16_t *gy, int n);
+void sobel_mag_l1_scalar(const int16_t *gx, const int16_t *gy, unsigned char *dst, int n);
+void sobel_mag_l2_scalar(const int16_t *gx, const int16_t *gy, unsigned char *dst, int n);
+void sobel_dir_scalar(const int16_t *gx, const int16_t *gy, unsigned char *dst, int n);
+
+#if FAVIS_X86
+void sobel_row_ssse3(const unsigned char *r0, const unsigned char *r1,
+                     const unsigned char *r2, int16_t *gx, int16_t *gy, int n);
+void sobel_mag_l1_ssse3(const int16_t *gx, const int16_t *gy, unsigned char *dst, int n);
+void sobel_mag_l2_ssse3(const int16_t *gx, const int16_t *gy, unsigned char *dst, int n);
+void sobel_dir_ssse3(const int16_t *gx, const int16_t *gy, unsigned char *dst, int n);
+void sobel_row_avx2(const unsigned char *r0, const unsigned char *r1,
+                    const unsigned char *r2, int16_t *gx, int16_t *gy, int n);
+void sobel_mag_l1_avx2(const int16_t *gx, const int16_t *gy, unsigned char *dst, int n);
+void sobel_mag_l2_avx2(const int16_t *gx, const int16_t *gy, unsigned char *dst, int n);
+void sobel_dir_avx2(const int16_t *gx, const int16_t *gy, unsigned char *dst, int n);
+#endif
+
+// ============================================================
+// CANNY (gaussiano 5x5, magnitude int16, supressão de não-máximos)
+// ============================================================
+
+// Gaussiano separável [1 4 6 4 1] / 16 por eixo (σ ≈ 1)
+#define GAUSS5_SHIFT        8       // 16 × 16 = 256
+// Classes do mapa de bordas antes da histerese
+#define CANNY_WEAK          1
+#define CANNY_STRONG        255
+
+// dst[i] = r0 + 4·r1 + 6·r2 + 4·r3 + r4  (<= 4080)
+typedef void (*gauss5_vert_fn)(const unsigned char *r0, const unsigned char *r1,
+                               const unsigned char *r2, const unsigned char *r3,
+                               const unsigned char *r4, uint16_t *dst, int n);
+// dst[i] = (src[i-2] + 4·src[i-1] + 6·src[i] + 4·src[i+1] + src[i+2] + 128) >> 8
+// src aponta para o elemento -2 (2 elementos de borda em cada lado)
+typedef void (*gauss5_horiz_fn)(const uint16_t *src, unsigned char *dst, int n);
+// dst[i] = |gx| + |gy| sem saturação (<= 2040)
+typedef void (*grad_mag16_fn)(const int16_t *gx, const int16_t *gy, int16_t *dst, int n);
+// Supressão de não-máximos + classificação dupla. m0/m1/m2 apontam para o
+// pixel -1 (borda 0); dir em setores SOBEL_DIR_*. dst: 0, CANNY_WEAK ou CANNY_STRONG
+typedef void (*canny_nms_fn)(const int16_t *m0, const int16_t *m1, const int16_t *m2,
+                             const unsigned char *dir, unsigned char *dst, int n,
+                             int low, int high);
+
+void gauss5_vert_row_scalar(const unsigned char *r0, const unsigned char *r1,
+                            const unsigned char *r2, const unsigned char *r3,
+                            const unsigned char *r4, uint16_t *dst, int n);
+void gauss5_horiz_row_scalar(const uint16_t *src, unsigned char *dst, int n);
+void grad_mag16_row_scalar(const int16_t *gx, const int16_t *gy, int16_t *dst, int n);
+void canny_nms_row_scalar(const int16_t *m0, const int16_t *m1, const int16_t *m2,
+                          const unsigned char *dir, unsigned char *dst, int n,
+                          int low, int high);
+
+#if FAVIS_X86
+void gauss5_vert_row_ssse3(const unsigned char *r0, const unsigned char *r1,
+                           const unsigned char *r2, const unsigned char *r3,
+                           const unsigned char *r4, uint16_t *dst, int n);
+void gauss5_horiz_row_ssse3(const uint16_t *src, unsigned char *dst, int n);
+void grad_mag16_row_ssse3(const int16_t *gx, const int16_t *gy, int16_t *dst, int n);
+void canny_nms_row_ssse3(const int16_t *m0, const int16_t *m1, const int16_t *m2,
+                         const unsigned char *dir, unsigned char *dst, int n,
+                         int low, int high);
+void gauss5_vert_row_avx2(const unsigned char *r0, const unsigned char *r1,
+                          const unsigned char *r2, const unsigned char *r3,
+                          const unsigned char *r4, uint16_t *dst, int n);
+void gauss5_horiz_row_avx2(const uint16_t *src, unsigned char *dst, int n);
+void grad_mag16_row_avx2(const int16_t *gx, const int16_t *gy, int16_t *dst, int n);
+void canny_nms_row_avx2(const int16_t *m0, const int16_t *m1, const int16_t *m2,
+                        const unsigned char *dir, unsigned char *dst, int n,
+                        int low, int high);
+#endif
+
+// ============================================================
+// MORFOLOGIA (van Herk/Gil-Werman)
+// ============================================================
+
+// dst[i] = min/max(a[i], b[i]); dst pode ser a ou b
+typedef void (*morph_row_fn)(const unsigned char *a, const unsigned char *b,
+                             unsigned char *dst, int n);
+// dst[c·dst_stride + r] = src[r·src_stride + c] (blocos 16x16 em SIMD)
+typedef void (*transpose_u8_fn)(const unsigned char *src, size_t src_stride,
+                                unsigned char *dst, size_t dst_stride, int rows, int cols);
+
+void morph_min_row_scalar(const unsigned char *a, const unsigned char *b, unsigned char *dst, int n);
+void morph_max_row_scalar(const unsigned char *a, const unsigned char *b, unsigned char *dst, int n);
+void transpose_u8_scalar(const unsigned char *src, size_t src_stride,
+                         unsigned char *dst, size_t dst_stride, int rows, int cols);
+
+#if FAVIS_X86
+void morph_min_row_ssse3(const unsigned char *a, const unsigned char *b, unsigned char *dst, int n);
+void morph_max_row_ssse3(const unsigned char *a, const unsigned char *b, unsigned char *dst, int n);
+void transpose_u8_ssse3(const unsigned char *src, size_t src_stride,
+                        unsigned char *dst, size_t dst_stride, int rows, int cols);
+void morph_min_row_avx2(const unsigned char *a, const unsigned char *b, unsigned char *dst, int n);
+void morph_max_row_avx2(const unsigned char *a, const unsigned char *b, unsigned char *dst, int n);
+#endif
+
+// ============================================================
+// IMAGEM INTEGRAL
+// ============================================================
+
+// dst[i] = prev[i] + src[0] + ... + src[i] (módulo 2^32)
+typedef void (*integral_row_fn)(const unsigned char *src, const uint32_t *prev,
+                                uint32_t *dst, int n);
+// dst[i] = prev[i] + src[0]² + ... + src[i]²
+typedef void (*integral_sq_row_fn)(const unsigned char *src, const uint64_t *prev,
+                                   uint64_t *dst, int n);
+// Soma de caixa: dst[i] = bot[i+span] - bot[i] - top[i+span] + top[i]
+typedef void (*box_sum_row_fn)(const uint32_t *top, const uint32_t *bot,
+                               uint32_t *dst, int n, int span);
+
+void integral_row_scalar(const unsigned char *src, const uint32_t *prev, uint32_t *dst, int n);
+void integral_sq_row_scalar(const unsigned char *src, const uint64_t *prev, uint64_t *dst, int n);
+void box_sum_row_scalar(const uint32_t *top, const uint32_t *bot, uint32_t *dst, int n, int span);
+
+#if FAVIS_X86
+void integral_row_ssse3(const unsigned char *src, const uint32_t *prev, uint32_t *dst, int n);
+void integral_sq_row_ssse3(const unsigned char *src, const uint64_t *prev, uint64_t *dst, int n);
+void box_sum_row_ssse3(const uint32_t *top, const uint32_t *bot, uint32_t *dst, int n, int span);
+void integral_row_avx2(const unsigned char *src, const uint32_t *prev, uint32_t *dst, int n);
+void integral_sq_row_avx2(const unsigned char *src, const uint64_t *prev, uint64_t *dst, int n);
+void box_sum_row_avx2(const uint32_t *top, const uint32_t *bot, uint32_t *dst, int n, int span);
+#endif
+
+// ============================================================
+// TEMPLATE MATCHING
+// ============================================================
+
+// Produto interno Σ a[i]·b[i] (n até 65535: acumuladores de 32 bits)
+typedef uint64_t (*dot_u8_fn)(const unsigned char *a, const unsigned char *b, int n);
+// Redução 2x2 pela média: dst[i] = (r0[2i] + r0[2i+1] + r1[2i] + r1[2i+1] + 2) / 4
+typedef void (*pyr_down_fn)(const unsigned char *r0, const unsigned char *r1,
+                            unsigned char *dst, int n);
+// Dois coeficientes do template sobre a linha inteira da imagem:
+// acc[i] += src[i]·c0 + src[i+1]·c1 (lê src[0..n], c0/c1 em 0-255)
+typedef void (*ncc_mac_fn)(const unsigned char *src, int c0, int c1, uint32_t *acc, int n);
+
+uint64_t dot_u8_scalar(const unsigned char *a, const unsigned char *b, int n);
+void ncc_mac_row_scalar(const unsigned char *src, int c0, int c1, uint32_t *acc, int n);
+void pyr_down_row_scalar(const unsigned char *r0, const unsigned char *r1,
+                         unsigned char *dst, int n);
+
+#if FAVIS_X86
+uint64_t dot_u8_ssse3(const unsigned char *a, const unsigned char *b, int n);
+void ncc_mac_row_ssse3(const unsigned char *src, int c0, int c1, uint32_t *acc, int n);
+void pyr_down_row_ssse3(const unsigned char *r0, const unsigned char *r1,
+                        unsigned char *dst, int n);
+uint64_t dot_u8_avx2(const unsigned char *a, const unsigned char *b, int n);
+void ncc_mac_row_avx2(const unsigned char *src, int c0, int c1, uint32_t *acc, int n);
+void pyr_down_row_avx2(const unsigned char *r0, const unsigned char *r1,
+                       unsigned char *dst, int n);
+#endif
+
+// ============================================================
+// THRESHOLD / HISTOGRAMA
+// ============================================================
+
+// dst[i] = src[i] > thresh ? 255 : 0
+typedef void (*threshold_row_fn)(const unsigned char *src, unsigned char *dst, int n, int thresh);
+// dst[i] = src[i] > mean[i] - c ? 255 : 0  (limiar adaptativo por média local)
+typedef void (*threshold_mean_fn)(const unsigned char *src, const unsigned char *mean,
+                                  unsigned char *dst, int n, int c);
+
+void threshold_row_scalar(const unsigned char *src, unsigned char *dst, int n, int thresh);
+void threshold_mean_row_scalar(const unsigned char *src, const unsigned char *mean,
+                               unsigned char *dst, int n, int c);
+
+#if FAVIS_X86
+void threshold_row_ssse3(const unsigned char *src, unsigned char *dst, int n, int thresh);
+void threshold_mean_row_ssse3(const unsigned char *src, const unsigned char *mean,
+                              unsigned char *dst, int n, int c);
+void threshold_row_avx2(const unsigned char *src, unsigned char *dst, int n, int thresh);
+void threshold_mean_row_avx2(const unsigned char *src, const unsigned char *mean,
+                             unsigned char *dst, int n, int c);
+#endif
+
+// Bancos independentes do histograma (incrementos consecutivos no mesmo
+// bin não dependem um do outro; evita a latência de store-to-load)
+#define HIST_BANKS          4
+
+/**
+ * @brief Acumula o histograma de 256 bins de 'n' bytes em hist
+ *
+ * Sem versão SIMD: x86 não tem scatter com detecção de conflito fora do
+ * AVX-512CD. O ganho vem dos bancos e das leituras de 8 bytes.
+ */
+void histogram_u8(const unsigned char *src, int n, uint32_t *hist);
+
+// Um histograma por canal de 'n' pixels intercalados (1 a MAX_CHANNELS canais)
+void histogram_channels_u8(const unsigned char *src, int n, int channels,
+                           uint32_t (*hist)[256]);
+
+// ============================================================
+// LUT (operações pontuais)
+// ============================================================
+
+// dst[i] = lut[src[i]] para n bytes. alpha_stride 2 ou 4: o último byte de
+// cada grupo (alpha) é copiado sem passar pela tabela; 0 = todos os bytes.
+// src e dst podem coincidir
+typedef void (*lut_row_fn)(const unsigned char *src, unsigned char *dst, int n,
+                           const unsigned char *lut, int alpha_stride);
+
+void lut_row_scalar(const unsigned char *src, unsigned char *dst, int n,
+                    const unsigned char *lut, int alpha_stride);
+
+#if FAVIS_X86
+void lut_row_ssse3(const unsigned char *src, unsigned char *dst, int n,
+                   const unsigned char *lut, int alpha_stride);
+void lut_row_avx2(const unsigned char *src, unsigned char *dst, int n,
+                  const unsigned char *lut, int alpha_stride);
+#endif
+
+// ============================================================
+// REMAP (bilinear guiado por mapa)
+// ============================================================
+
+// dst[i] = interpolação bilinear dos 2x2 pixels a partir de src + y·stride + x,
+// com (x, y) = xy[2i], xy[2i+1] e frações frac[i] = fx | fy << 8 em Q7
+// (0 a 128); fy = 0xFF → 0 (fora da origem). Pesos Q14, arredondados:
+// (Σ p·(128−fx|fx)·(128−fy|fy) + 2^13) >> 14. Pode ler até 4 bytes a
+// partir de cada canto superior esquerdo e da linha seguinte
+typedef void (*remap_row_fn)(const unsigned char *src, size_t stride, const int16_t *xy,
+                             const uint16_t *frac, unsigned char *dst, int n);
+
+void remap_row_scalar(const unsigned char *src, size_t stride, const int16_t *xy,
+                      const uint16_t *frac, unsigned char *dst, int n);
+
+#if FAVIS_X86
+void remap_row_ssse3(const unsigned char *src, size_t stride, const int16_t *xy,
+                     const uint16_t *frac, unsigned char *dst, int n);
+void remap_row_avx2(const unsigned char *src, size_t stride, const int16_t *xy,
+                    const uint16_t *frac, unsigned char *dst, int n);
+#endif
+
+// ============================================================
+// CALIBRAÇÃO (dark frame / flat-field)
+// ============================================================
+
+// dst[i] = sat8(((src[i] −sat dark[i]) · gain[i] + 2^9) >> 10), ganho em Q10
+// (0 a 32767). Mesmo arredondamento de pmulhrsw sobre (src − dark) << 5.
+// src e dst podem coincidir
+typedef void (*calib_row_fn)(const unsigned char *src, const unsigned char *dark,
+                             const int16_t *gain, unsigned char *dst, int n);
+
+void calib_row_scalar(const unsigned char *src, const unsigned char *dark,
+                      const int16_t *gain, unsigned char *dst, int n);
+
+#if FAVIS_X86
+void calib_row_ssse3(const unsigned char *src, const unsigned char *dark,
+                     const int16_t *gain, unsigned char *dst, int n);
+void calib_row_avx2(const unsigned char *src, const unsigned char *dark,
+                    const int16_t *gain, unsigned char *dst, int n);
+#endif
+
+// ============================================================
+// DEMOSAICO (Bayer)
+// ============================================================
+// Uma linha do mosaico com as vizinhas; as linhas brutas têm margem de 2
+// amostras refletidas (row[-2] a row[n + 1] legíveis) e as de verde, de 1.
+// Nas colunas com (x & 1) == phase a amostra é da cor da linha ('own', R
+// ou B); nas demais é verde. 'other' é a outra cor (R/B).
+
+// Bilinear: média arredondada dos 2 ((a + b + 1) >> 1) ou 4 vizinhos da
+// cor ((Σ + 2) >> 2); a amostra da própria cor é copiada
+typedef void (*bayer_bilinear_fn)(const unsigned char *up, const unsigned char *row,
+                                  const unsigned char *dn, unsigned char *own,
+                                  unsigned char *g, unsigned char *other, int n, int phase);
+
+// Verde direcional (Hamilton-Adams) nas amostras R/B: gh = (2(G[x−1] +
+// G[x+1]) + 2C − C[x−2] − C[x+2] + 2) >> 2 e gv igual na vertical (até 2
+// linhas acima/abaixo); usa a direção de menor |ΔG| + |2C − C[±2]| (empate:
+// (gh + gv + 1) >> 1), saturado em 0-255
+typedef void (*bayer_green_fn)(const unsigned char *up2, const unsigned char *up,
+                               const unsigned char *row, const unsigned char *dn,
+                               const unsigned char *dn2, unsigned char *g, int n, int phase);
+
+// R/B por diferença de cor sobre o verde completo (gu, g, gd: linhas de
+// verde acima, atual e abaixo): no verde, own = G + média(C − G) dos
+// vizinhos horizontais e other = G + média dos verticais; nas amostras
+// R/B, other = G + média(C − G) das 4 diagonais. Saturado em 0-255
+typedef void (*bayer_rb_fn)(const unsigned char *up, const unsigned char *row,
+                            const unsigned char *dn, const unsigned char *gu,
+                            const unsigned char *g, const unsigned char *gd,
+                            unsigned char *own, unsigned char *other, int n, int phase);
+
+// Luminância de planos R, G, B (mesma aritmética de gray_pixel)
+typedef void (*gray_planes_fn)(const unsigned char *r, const unsigned char *g,
+                               const unsigned char *b, unsigned char *dst, int n);
+
+void bayer_bilinear_row_scalar(const unsigned char *up, const unsigned char *row,
+                               const unsigned char *dn, unsigned char *own, unsigned char *g,
+                               unsigned char *other, int n, int phase);
+void bayer_green_row_scalar(const unsigned char *up2, const unsigned char *up,
+                            const unsigned char *row, const unsigned char *dn,
+                            const unsigned char *dn2, unsigned char *g, int n, int phase);
+void bayer_rb_row_scalar(const unsigned char *up, const unsigned char *row,
+                         const unsigned char *dn, const unsigned char *gu,
+                         const unsigned char *g, const unsigned char *gd,
+                         unsigned char *own, unsigned char *other, int n, int phase);
+void gray_planes_row_scalar(const unsigned char *r, const unsigned char *g,
+                            const unsigned char *b, unsigned char *dst, int n);
+
+#if FAVIS_X86
+void bayer_bilinear_row_ssse3(const unsigned char *up, const unsigned char *row,
+                              const unsigned char *dn, unsigned char *own, unsigned char *g,
+                              unsigned char *other, int n, int phase);
+void bayer_green_row_ssse3(const unsigned char *up2, const unsigned char *up,
+                           const unsigned char *row, const unsigned char *dn,
+                           const unsigned char *dn2, unsigned char *g, int n, int phase);
+void bayer_rb_row_ssse3(const unsigned char *up, const unsigned char *row,
+                        const unsigned char *dn, const unsigned char *gu,
+                        const unsigned char *g, const unsigned char *gd,
+                        unsigned char *own, unsigned char *other, int n, int phase);
+void gray_planes_row_ssse3(const unsigned char *r, const unsigned char *g,
+                           const unsigned char *b, unsigned char *dst, int n);
+void bayer_bilinear_row_avx2(const unsigned char *up, const unsigned char *row,
+                             const unsigned char *dn, unsigned char *own, unsigned char *g,
+                             unsigned char *other, int n, int phase);
+void bayer_green_row_avx2(const unsigned char *up2, const unsigned char *up,
+                          const unsigned char *row, const unsigned char *dn,
+                          const unsigned char *dn2, unsigned char *g, int n, int phase);
+void bayer_rb_row_avx2(const unsigned char *up, const unsigned char *row,
+                       const unsigned char *dn, const unsigned char *gu,
+                       const unsigned char *g, const unsigned char *gd,
+                       unsigned char *own, unsigned char *other, int n, int phase);
+void gray_planes_row_avx2(const unsigned char *r, const unsigned char *g,
+                          const unsigned char *b, unsigned char *dst, int n);
+#endif
+
+// ============================================================
+// GOLDEN (diferença contra imagem de referência)
+// ============================================================
+
+// dst[i] = 255 se (|src[i] − ref[i]| −sat tol[i]) > thresh, senão 0 (tol
+// NULL = tolerância 0). Retorna o número de pixels marcados
+typedef int (*golden_row_fn)(const unsigned char *src, const unsigned char *ref,
+                             const unsigned char *tol, unsigned char *dst, int n, int thresh);
+
+int golden_row_scalar(const unsigned char *src, const unsigned char *ref,
+                      const unsigned char *tol, unsigned char *dst, int n, int thresh);
+
+#if FAVIS_X86
+int golden_row_ssse3(const unsigned char *src, const unsigned char *ref,
+                     const unsigned char *tol, unsigned char *dst, int n, int thresh);
+int golden_row_avx2(const unsigned char *src, const unsigned char *ref,
+                    const unsigned char *tol, unsigned char *dst, int n, int thresh);
+#endif
+
+// ============================================================
+// MEDIANA (histogramas de coluna, Perreault/Hébert)
+// ============================================================
+
+// Mediana de uma linha a partir dos histogramas de coluna de 'rows' linhas:
+// coarse com 16 contagens por coluna (nível >> 4) e fine com as 16 de cada
+// segmento, segmento a segmento (fine[(b·width + x)·16 + (v & 15)]). O
+// histograma da janela horizontal (raio radius, truncada nas bordas) desliza
+// somando a coluna que entra e subtraindo a que sai, 16 contagens por
+// operação: o grosso a cada pixel, cada segmento fino só quando consultado.
+// dst[x] = menor v com mais de ⌊área/2⌋ amostras <= v
+typedef void (*median_row_fn)(const uint16_t *fine, const uint16_t *coarse,
+                              unsigned char *dst, int width, int radius, int rows);
+
+void median_row_scalar(const uint16_t *fine, const uint16_t *coarse,
+                       unsigned char *dst, int width, int radius, int rows);
+
+#if FAVIS_X86
+void median_row_ssse3(const uint16_t *fine, const uint16_t *coarse,
+                      unsigned char *dst, int width, int radius, int rows);
+void median_row_avx2(const uint16_t *fine, const uint16_t *coarse,
+                     unsigned char *dst, int width, int radius, int rows);
+#endif
+
+// ============================================================
+// CONVERSÃO DE COR (planos R, G, B → 3 planos)
+// ============================================================
+
+// Matriz 3x3 em Q15 (coef[3·k + canal], canais R, G, B), arredondada. A
+// saída 0 é sem sinal, saturada em 0..255 (luminância); as saídas 1 e 2 são
+// diferenças de cor com sinal, saturadas em −128..127 e deslocadas de +128
+typedef void (*color_matrix_fn)(const unsigned char *r, const unsigned char *g,
+                                const unsigned char *b, const int16_t *coef,
+                                unsigned char *dst0, unsigned char *dst1,
+                                unsigned char *dst2, int n);
+
+// HSV em 8 bits: V = máx, S = 255·(máx − mín)/máx e matiz em 256 passos
+// por volta (0 vermelho, 85 verde, 171 azul), ambos arredondados
+typedef void (*hsv_row_fn)(const unsigned char *r, const unsigned char *g,
+                           const unsigned char *b, unsigned char *h, unsigned char *s,
+                           unsigned char *v, int n);
+
+void color_matrix_row_scalar(const unsigned char *r, const unsigned char *g,
+                             const unsigned char *b, const int16_t *coef,
+                             unsigned char *dst0, unsigned char *dst1,
+                             unsigned char *dst2, int n);
+void hsv_row_scalar(const unsigned char *r, const unsigned char *g, const unsigned char *b,
+                    unsigned char *h, unsigned char *s, unsigned char *v, int n);
+
+#if FAVIS_X86
+void color_matrix_row_ssse3(const unsigned char *r, const unsigned char *g,
+                            const unsigned char *b, const int16_t *coef,
+                            unsigned char *dst0, unsigned char *dst1,
+                            unsigned char *dst2, int n);
+void hsv_row_ssse3(const unsigned char *r, const unsigned char *g, const unsigned char *b,
+                   unsigned char *h, unsigned char *s, unsigned char *v, int n);
+void color_matrix_row_avx2(const unsigned char *r, const unsigned char *g,
+                           const unsigned char *b, const int16_t *coef,
+                           unsigned char *dst0, unsigned char *dst1,
+                           unsigned char *dst2, int n);
+void hsv_row_avx2(const unsigned char *r, const unsigned char *g, const unsigned char *b,
+                  unsigned char *h, unsigned char *s, unsigned char *v, int n);
+#endif
+
+// ============================================================
+// CLASSIFICAÇÃO DE COR (LUT 3D)
+// ============================================================
+
+// Classe de cada pixel pela LUT 3D de 64x64x64 células (6 bits por canal,
+// índice (r>>2)·4096 + (g>>2)·64 + (b>>2), ids 0..CLASS_MAX; a tabela tem
+// 4 bytes de folga após o fim). dst[i] = classe × CLASS_LABEL_STEP e
+// counts[c] += pixels da classe c, para c = 0..classes
+typedef void (*class_row_fn)(const unsigned char *r, const unsigned char *g,
+                             const unsigned char *b, const uint8_t *lut, unsigned char *dst,
+                             int n, int classes, uint32_t *counts);
+
+void class_row_scalar(const unsigned char *r, const unsigned char *g, const unsigned char *b,
+                      const uint8_t *lut, unsigned char *dst, int n, int classes,
+                      uint32_t *counts);
+
+#if FAVIS_X86
+void class_row_ssse3(const unsigned char *r, const unsigned char *g, const unsigned char *b,
+                     const uint8_t *lut, unsigned char *dst, int n, int classes,
+                     uint32_t *counts);
+void class_row_avx2(const unsigned char *r, const unsigned char *g, const unsigned char *b,
+                    const uint8_t *lut, unsigned char *dst, int n, int classes,
+                    uint32_t *counts);
+#endif
+
+// ============================================================
+// PLANAR (separação / intercalação de canais)
+// ============================================================
+
+// Pixels intercalados → planos: canal k do pixel i vai para dst[k·plane_stride + i]
+typedef void (*deinterleave_fn)(const unsigned char *src, unsigned char *dst,
+                                size_t plane_stride, int n);
+// Planos → pixels intercalados (inverso de deinterleave_fn)
+typedef void (*interleave_fn)(const unsigned char *src, size_t plane_stride,
+                              unsigned char *dst, int n);
+
+void deinterleave_ga_scalar(const unsigned char *src, unsigned char *dst,
+                            size_t plane_stride, int n);
+void deinterleave_rgb_scalar(const unsigned char *src, unsigned char *dst,
+                             size_t plane_stride, int n);
+void deinterleave_rgba_scalar(const unsigned char *src, unsigned char *dst,
+                              size_t plane_stride, int n);
+void interleave_ga_scalar(const unsigned char *src, size_t plane_stride,
+                          unsigned char *dst, int n);
+void interleave_rgb_scalar(const unsigned char *src, size_t plane_stride,
+                           unsigned char *dst, int n);
+void interleave_rgba_scalar(const unsigned char *src, size_t plane_stride,
+                            unsigned char *dst, int n);
+
+// Número qualquer de canais (referência genérica, sem versão SIMD)
+void deinterleave_scalar(const unsigned char *src, unsigned char *dst,
+                         size_t plane_stride, int n, int channels);
+void interleave_scalar(const unsigned char *src, size_t plane_stride,
+                       unsigned char *dst, int n, int channels);
+
+#if FAVIS_X86
+void deinterleave_ga_ssse3(const unsigned char *src, unsigned char *dst,
+                           size_t plane_stride, int n);
+void deinterleave_rgb_ssse3(const unsigned char *src, unsigned char *dst,
+                            size_t plane_stride, int n);
+void deinterleave_rgba_ssse3(const unsigned char *src, unsigned char *dst,
+                             size_t plane_stride, int n);
+void interleave_ga_ssse3(const unsigned char *src, size_t plane_stride,
+                         unsigned char *dst, int n);
+void interleave_rgb_ssse3(const unsigned char *src, size_t plane_stride,
+                          unsigned char *dst, int n);
+void interleave_rgba_ssse3(const unsigned char *src, size_t plane_stride,
+                           unsigned char *dst, int n);
+void deinterleave_ga_avx2(const unsigned char *src, unsigned char *dst,
+                          size_t plane_stride, int n);
+void deinterleave_rgb_avx2(const unsigned char *src, unsigned char *dst,
+                           size_t plane_stride, int n);
+void deinterleave_rgba_avx2(const unsigned char *src, unsigned char *dst,
+                            size_t plane_stride, int n);
+void interleave_ga_avx2(const unsigned char *src, size_t plane_stride,
+                        unsigned char *dst, int n);
+void interleave_rgb_avx2(const unsigned char *src, size_t plane_stride,
+                         unsigned char *dst, int n);
+void interleave_rgba_avx2(const unsigned char *src, size_t plane_stride,
+                          unsigned char *dst, int n);
+#endif
+
+// ============================================================
+// TABELA DE DESPACHO
+// ============================================================
+
+typedef struct {
+    gray_row_fn gray_row_rgb;
+    gray_row_fn gray_row_rgba;
+    gray_row_fn gray_plane_rgb;
+    gray_row_fn gray_plane_rgba;
+    blur_addsub_fn blur_addsub_row;
+    blur_scale_fn blur_scale_row;
+    blur_hsum_fn blur_hsum_row;
+    resize_vert_fn resize_vert_row;
+    sobel_row_fn sobel_row;
+    sobel_out_fn sobel_mag_l1;
+    sobel_out_fn sobel_mag_l2;
+    sobel_out_fn sobel_dir;
+    gauss5_vert_fn gauss5_vert_row;
+    gauss5_horiz_fn gauss5_horiz_row;
+    grad_mag16_fn grad_mag16_row;
+    canny_nms_fn canny_nms_row;
+    morph_row_fn morph_min_row;
+    morph_row_fn morph_max_row;
+    transpose_u8_fn transpose_u8;
+    integral_row_fn integral_row;
+    integral_sq_row_fn integral_sq_row;
+    box_sum_row_fn box_sum_row;
+    dot_u8_fn dot_u8;
+    pyr_down_fn pyr_down_row;
+    ncc_mac_fn ncc_mac_row;
+    threshold_row_fn threshold_row;
+    threshold_mean_fn threshold_mean_row;
+    lut_row_fn lut_row;
+    remap_row_fn remap_row;
+    calib_row_fn calib_row;
+    bayer_bilinear_fn bayer_bilinear_row;
+    bayer_green_fn bayer_green_row;
+    bayer_rb_fn bayer_rb_row;
+    gray_planes_fn gray_planes_row;
+    golden_row_fn golden_row;
+    median_row_fn median_row;
+    color_matrix_fn color_matrix_row;
+    hsv_row_fn hsv_row;
+    class_row_fn class_row;
+    deinterleave_fn deinterleave_ga;
+    deinterleave_fn deinterleave_rgb;
+    deinterleave_fn deinterleave_rgba;
+    interleave_fn interleave_ga;
+    interleave_fn interleave_rgb;
+    interleave_fn interleave_rgba;
+} simd_kernels_t;
+
+// Kernels em uso (versões escalares até simd_kernels_select())
+extern simd_kernels_t g_kernels;
+
+// Preenche g_kernels com a melhor versão disponível para o nível
+void simd_kernels_select(simd_level_t level);
+
+#endif // SIMD_KERNELS_H
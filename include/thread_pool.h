@@ -0,0 +1,45 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include "common.h"
+
+// Limite de threads por worker (linha de comando)
+#define POOL_MAX_THREADS    64
+
+// Tarefa: executada uma vez para cada índice em [0, num_tasks)
+typedef void (*pool_task_fn)(void *arg, int task);
+
+/**
+ * @brief Pool de threads persistente do worker
+ *
+ * Criado após o fork (threads não sobrevivem ao fork) e reutilizado
+ * por todas as imagens. A thread chamadora também executa tarefas,
+ * portanto num_threads inclui ela (num_threads - 1 threads auxiliares).
+ */
+typedef struct thread_pool_s {
+    int num_threads;
+    pthread_t threads[POOL_MAX_THREADS];
+    pthread_mutex_t mutex;
+    pthread_cond_t cond_work;       // Novo lote disponível (ou término)
+    pthread_cond_t cond_done;       // Lote concluído
+
+    // Lote atual (protegido pelo mutex, exceto next_task que é atômico)
+    pool_task_fn fn;
+    void *arg;
+    int num_tasks;
+    int next_task;
+    int tasks_done;
+    int active;                     // Auxiliares executando o lote atual
+    unsigned long generation;       // Incrementado a cada lote
+    int shutdown;
+} thread_pool_t;
+
+int thread_pool_init(thread_pool_t *pool, int num_threads);
+
+// Executa fn(arg, i) para i em [0, num_tasks) e aguarda o término.
+// pool NULL executa em série na thread chamadora
+void thread_pool_run(thread_pool_t *pool, pool_task_fn fn, void *arg, int num_tasks);
+
+void thread_pool_destroy(thread_pool_t *pool);
+
+#endif // THREAD_POOL_H
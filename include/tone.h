@@ -0,0 +1,34 @@
+#ifndef TONE_H
+#define TONE_H
+
+#include "common.h"
+
+/**
+ * @brief Operações pontuais compostas em uma única LUT
+ *
+ * Contraste, gama, curva de tons, inversão e limites são avaliados em
+ * sequência (nessa ordem) uma vez por valor de entrada, na carga dos
+ * recursos do worker. Qualquer combinação custa então uma consulta por
+ * amostra, feita na primeira passada sobre a origem: todos os filtros e
+ * as estatísticas veem a imagem corrigida. O alpha não é alterado.
+ */
+typedef struct {
+    int active;                 // 0 = identidade (estágio desligado)
+    unsigned char lut8[256];
+    uint16_t *lut16;            // 65536 entradas (imagens de 16 bits)
+} tone_lut_t;
+
+// 1 se alguma operação pontual está configurada
+int tone_enabled(const pipeline_config_t *cfg);
+
+// Compõe as operações configuradas. Retorna 0 ou -1
+int tone_lut_build(tone_lut_t *tl, const pipeline_config_t *cfg);
+void tone_lut_free(tone_lut_t *tl);
+
+// n pixels intercalados de 'channels' canais (src e dst podem coincidir)
+void tone_rows(const tone_lut_t *tl, const unsigned char *src, unsigned char *dst,
+               int n, int channels);
+void tone_rows_u16(const tone_lut_t *tl, const uint16_t *src, uint16_t *dst,
+                   int n, int channels);
+
+#endif // TONE_H
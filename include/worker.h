@@ -2,12 +2,16 @@
 #define WORKER_H
 
 #include "common.h"
+#include "calib.h"
+#include "classify.h"
 
-// Função principal do worker (chamada após fork)
-void worker_main(int worker_id, int pipe_fd);
+// Função principal do worker (chamada após fork; calib e LUT de classes
+// compartilhadas, só leitura)
+void worker_main(int worker_id, int pipe_fd, const pipeline_config_t *config,
+                 const calib_t *calib, const class_lut_t *class_lut);
 
 // Processa uma imagem (cria threads, aplica filtros)
-int process_image(worker_context_t *ctx, const char *filename);
+int process_image(worker_context_t *ctx, const char *filename, int task_id);
 
 // Atualiza estatísticas na memória compartilhada
 void update_stats(shared_stats_t *stats, int success, double elapsed_time);
@@ -0,0 +1,293 @@
+#include "bayer.h"
+#include "planar.h"
+#include "simd_kernels.h"
+
+// ============================================================
+// NOMES
+// ============================================================
+
+const char* bayer_pattern_name(int pattern) {
+    switch (pattern) {
+        case BAYER_RGGB: return "rggb";
+        case BAYER_BGGR: return "bggr";
+        case BAYER_GRBG: return "grbg";
+        case BAYER_GBRG: return "gbrg";
+        default:         return "none";
+    }
+}
+
+const char* demosaic_method_name(int method) {
+    return method == DEMOSAIC_EDGE ? "edge" : "bilinear";
+}
+
+int demosaic_channels(const pipeline_config_t *cfg) {
+    return cfg->bayer_gray ? 1 : 3;
+}
+
+// ============================================================
+// PREPARAÇÃO
+// ============================================================
+
+int demosaic_init(demosaic_t *d, const void *raw, int width, int height, int depth,
+                  const pipeline_config_t *cfg, const calib_t *calib) {
+    memset(d, 0, sizeof(*d));
+    if (width < BAYER_MIN_SIDE || height < BAYER_MIN_SIDE) {
+        LOG_ERROR("Imagem Bayer %dx%d menor que %dx%d", width, height,
+                  BAYER_MIN_SIDE, BAYER_MIN_SIDE);
+        return -1;
+    }
+    d->raw = raw;
+    d->width = width;
+    d->height = height;
+    d->depth = depth;
+    d->rx = cfg->bayer_pattern == BAYER_GRBG || cfg->bayer_pattern == BAYER_BGGR;
+    d->ry = cfg->bayer_pattern == BAYER_GBRG || cfg->bayer_pattern == BAYER_BGGR;
+    d->method = cfg->demosaic_method;
+    d->gray = cfg->bayer_gray;
+    d->calib = calib;
+
+    // Linhas com margem, arredondadas para manter o alinhamento de 64 bytes
+    const size_t sample = (size_t)depth / 8;
+    const size_t raw_bytes = planar_stride((int)(((size_t)width + 2 * BAYER_MARGIN) * sample));
+    const size_t green_bytes = planar_stride((int)(((size_t)width + 2) * sample));
+    const size_t plane_bytes = planar_stride((int)((size_t)width * sample));
+    d->block = (unsigned char*)planar_alloc(BAYER_RAW_SLOTS * raw_bytes +
+                                            BAYER_GREEN_SLOTS * green_bytes + 3 * plane_bytes);
+    if (!d->block) {
+        LOG_ERROR("Falha ao alocar demosaico (%dx%d)", width, height);
+        return -1;
+    }
+    unsigned char *next = d->block;
+    for (int i = 0; i < BAYER_RAW_SLOTS; i++, next += raw_bytes) {
+        d->raw_rows[i] = next + BAYER_MARGIN * sample;
+        d->raw_tag[i] = -1;
+    }
+    for (int i = 0; i < BAYER_GREEN_SLOTS; i++, next += green_bytes) {
+        d->green_rows[i] = next + sample;
+        d->green_tag[i] = -1;
+    }
+    d->planes = next;
+    return 0;
+}
+
+void demosaic_free(demosaic_t *d) {
+    free(d->block);
+    memset(d, 0, sizeof(*d));
+}
+
+// ============================================================
+// REFERÊNCIA DE 16 BITS (ESCALAR)
+// ============================================================
+// Mesmas fórmulas dos kernels de 8 bits (simd_kernels.h), em int32.
+
+static inline uint16_t bayer_sat16(int v) {
+    return (uint16_t)(v < 0 ? 0 : v > 65535 ? 65535 : v);
+}
+
+static void bayer_bilinear_row_u16(const uint16_t *up, const uint16_t *row, const uint16_t *dn,
+                                   uint16_t *own, uint16_t *g, uint16_t *other, int n,
+                                   int phase) {
+    for (int x = 0; x < n; x++) {
+        if ((x & 1) == phase) {
+            own[x] = row[x];
+            g[x] = (uint16_t)((row[x - 1] + row[x + 1] + up[x] + dn[x] + 2) >> 2);
+            other[x] = (uint16_t)((up[x - 1] + up[x + 1] + dn[x - 1] + dn[x + 1] + 2) >> 2);
+        } else {
+            own[x] = (uint16_t)((row[x - 1] + row[x + 1] + 1) >> 1);
+            g[x] = row[x];
+            other[x] = (uint16_t)((up[x] + dn[x] + 1) >> 1);
+        }
+    }
+}
+
+static void bayer_green_row_u16(const uint16_t *up2, const uint16_t *up, const uint16_t *row,
+                                const uint16_t *dn, const uint16_t *dn2, uint16_t *g, int n,
+                                int phase) {
+    for (int x = 0; x < n; x++) {
+        if ((x & 1) != phase) {
+            g[x] = row[x];
+            continue;
+        }
+        int lap_h = 2 * row[x] - row[x - 2] - row[x + 2];
+        int lap_v = 2 * row[x] - up2[x] - dn2[x];
+        int grad_h = abs(row[x - 1] - row[x + 1]) + abs(lap_h);
+        int grad_v = abs(up[x] - dn[x]) + abs(lap_v);
+        int gh = (2 * (row[x - 1] + row[x + 1]) + lap_h + 2) >> 2;
+        int gv = (2 * (up[x] + dn[x]) + lap_v + 2) >> 2;
+        g[x] = bayer_sat16(grad_h < grad_v ? gh : grad_v < grad_h ? gv : (gh + gv + 1) >> 1);
+    }
+}
+
+static void bayer_rb_row_u16(const uint16_t *up, const uint16_t *row, const uint16_t *dn,
+                             const uint16_t *gu, const uint16_t *g, const uint16_t *gd,
+                             uint16_t *own, uint16_t *other, int n, int phase) {
+    for (int x = 0; x < n; x++) {
+        if ((x & 1) == phase) {
+            int diag = up[x - 1] - gu[x - 1] + up[x + 1] - gu[x + 1] +
+                       dn[x - 1] - gd[x - 1] + dn[x + 1] - gd[x + 1];
+            own[x] = row[x];
+            other[x] = bayer_sat16(g[x] + ((diag + 2) >> 2));
+        } else {
+            int horiz = row[x - 1] - g[x - 1] + row[x + 1] - g[x + 1];
+            int vert = up[x] - gu[x] + dn[x] - gd[x];
+            own[x] = bayer_sat16(g[x] + ((horiz + 1) >> 1));
+            other[x] = bayer_sat16(g[x] + ((vert + 1) >> 1));
+        }
+    }
+}
+
+// ============================================================
+// JANELA DE LINHAS
+// ============================================================
+
+// Índice refletido sem repetir a borda: −1 → 1, n → n − 2 (mesma paridade)
+static inline int bayer_reflect(int i, int n) {
+    return i < 0 ? -i : i >= n ? 2 * (n - 1) - i : i;
+}
+
+// Cor da linha y: R nas linhas do R (coluna rx), B nas demais (coluna 1 − rx)
+static inline int bayer_row_is_red(const demosaic_t *d, int y) {
+    return (y & 1) == d->ry;
+}
+
+static inline int bayer_row_phase(const demosaic_t *d, int y) {
+    return bayer_row_is_red(d, y) ? d->rx : 1 - d->rx;
+}
+
+// Linha bruta y (refletida), calibrada ao entrar na janela
+static const unsigned char* demosaic_raw_row(demosaic_t *d, int y) {
+    y = bayer_reflect(y, d->height);
+    const int slot = y % BAYER_RAW_SLOTS;
+    unsigned char *row = d->raw_rows[slot];
+    if (d->raw_tag[slot] == y) return row;
+
+    const int w = d->width;
+    const size_t first = (size_t)y * w;
+    if (d->depth == 16) {
+        const uint16_t *src = (const uint16_t*)d->raw + first;
+        uint16_t *dst = (uint16_t*)row;
+        if (d->calib) {
+            calib_rows_u16(d->calib, src, dst, first, w);
+        } else {
+            memcpy(dst, src, (size_t)w * sizeof(uint16_t));
+        }
+        dst[-1] = dst[1];
+        dst[-2] = dst[2];
+        dst[w] = dst[w - 2];
+        dst[w + 1] = dst[w - 3];
+    } else {
+        const unsigned char *src = (const unsigned char*)d->raw + first;
+        if (d->calib) {
+            calib_rows(d->calib, src, row, first, w);
+        } else {
+            memcpy(row, src, (size_t)w);
+        }
+        row[-1] = row[1];
+        row[-2] = row[2];
+        row[w] = row[w - 2];
+        row[w + 1] = row[w - 3];
+    }
+    d->raw_tag[slot] = y;
+    return row;
+}
+
+// Verde completo da linha y (método edge), com margem refletida de 1
+static const unsigned char* demosaic_green_row(demosaic_t *d, int y) {
+    y = bayer_reflect(y, d->height);
+    const int slot = y % BAYER_GREEN_SLOTS;
+    unsigned char *g = d->green_rows[slot];
+    if (d->green_tag[slot] == y) return g;
+
+    const int w = d->width, phase = bayer_row_phase(d, y);
+    const unsigned char *up2 = demosaic_raw_row(d, y - 2), *up = demosaic_raw_row(d, y - 1);
+    const unsigned char *row = demosaic_raw_row(d, y);
+    const unsigned char *dn = demosaic_raw_row(d, y + 1), *dn2 = demosaic_raw_row(d, y + 2);
+    if (d->depth == 16) {
+        uint16_t *g16 = (uint16_t*)g;
+        bayer_green_row_u16((const uint16_t*)up2, (const uint16_t*)up, (const uint16_t*)row,
+                            (const uint16_t*)dn, (const uint16_t*)dn2, g16, w, phase);
+        g16[-1] = g16[1];
+        g16[w] = g16[w - 2];
+    } else {
+        g_kernels.bayer_green_row(up2, up, row, dn, dn2, g, w, phase);
+        g[-1] = g[1];
+        g[w] = g[w - 2];
+    }
+    d->green_tag[slot] = y;
+    return g;
+}
+
+// ============================================================
+// LINHA DE SAÍDA
+// ============================================================
+
+static void demosaic_row_u16(demosaic_t *d, int y, uint16_t *dst) {
+    const int w = d->width, phase = bayer_row_phase(d, y);
+    const size_t stride = planar_stride((int)(w * sizeof(uint16_t))) / sizeof(uint16_t);
+    uint16_t *r = (uint16_t*)d->planes, *g = r + stride, *b = g + stride;
+    uint16_t *own = bayer_row_is_red(d, y) ? r : b;
+    uint16_t *other = own == r ? b : r;
+
+    const uint16_t *up = (const uint16_t*)demosaic_raw_row(d, y - 1);
+    const uint16_t *row = (const uint16_t*)demosaic_raw_row(d, y);
+    const uint16_t *dn = (const uint16_t*)demosaic_raw_row(d, y + 1);
+    if (d->method == DEMOSAIC_EDGE) {
+        const uint16_t *gu = (const uint16_t*)demosaic_green_row(d, y - 1);
+        const uint16_t *gd = (const uint16_t*)demosaic_green_row(d, y + 1);
+        g = (uint16_t*)demosaic_green_row(d, y);
+        bayer_rb_row_u16(up, row, dn, gu, g, gd, own, other, w, phase);
+    } else {
+        bayer_bilinear_row_u16(up, row, dn, own, g, other, w, phase);
+    }
+
+    if (d->gray) {
+        for (int x = 0; x < w; x++) {
+            dst[x] = (uint16_t)((GRAY_WEIGHT_R * (uint32_t)r[x] + GRAY_WEIGHT_G * (uint32_t)g[x] +
+                                 GRAY_WEIGHT_B * (uint32_t)b[x] + (1u << (GRAY_SHIFT - 1))) >>
+                                GRAY_SHIFT);
+        }
+    } else {
+        for (int x = 0; x < w; x++, dst += 3) {
+            dst[0] = r[x];
+            dst[1] = g[x];
+            dst[2] = b[x];
+        }
+    }
+}
+
+void demosaic_row(demosaic_t *d, int y, void *dst, unsigned char *planes) {
+    if (d->depth == 16) {
+        demosaic_row_u16(d, y, (uint16_t*)dst);
+        return;
+    }
+
+    const int w = d->width, phase = bayer_row_phase(d, y);
+    const size_t stride = planar_stride(w);
+    unsigned char *r = planes ? planes : d->planes, *g = r + stride, *b = g + stride;
+    unsigned char *own = bayer_row_is_red(d, y) ? r : b;
+    unsigned char *other = own == r ? b : r;
+
+    const unsigned char *up = demosaic_raw_row(d, y - 1);
+    const unsigned char *row = demosaic_raw_row(d, y);
+    const unsigned char *dn = demosaic_raw_row(d, y + 1);
+    if (d->method == DEMOSAIC_EDGE) {
+        const unsigned char *gu = demosaic_green_row(d, y - 1);
+        const unsigned char *gd = demosaic_green_row(d, y + 1);
+        const unsigned char *gc = demosaic_green_row(d, y);
+        g_kernels.bayer_rb_row(up, row, dn, gu, gc, gd, own, other, w, phase);
+        if (d->gray && !planes) {
+            // Luminância direto do verde da janela
+            g_kernels.gray_planes_row(r, gc, b, (unsigned char*)dst, w);
+            return;
+        }
+        memcpy(g, gc, (size_t)w);
+    } else {
+        g_kernels.bayer_bilinear_row(up, row, dn, own, g, other, w, phase);
+    }
+
+    if (d->gray) {
+        g_kernels.gray_planes_row(r, g, b, (unsigned char*)dst, w);
+    } else {
+        planar_merge_row(r, (unsigned char*)dst, w, 3);
+    }
+}
@@ -0,0 +1,389 @@
+#include "blobs.h"
+#include <limits.h>
+#include <math.h>
+
+// ============================================================
+// UNION-FIND E MOMENTOS
+// ============================================================
+// Rótulos sempre apontam para um rótulo menor ou igual (a união liga a
+// raiz maior à menor); a raiz de um componente é seu primeiro rótulo.
+
+typedef struct {
+    uint64_t n, sx, sy, sxx, syy, sxy;
+    int x0, y0, x1, y1;
+} blob_acc_t;
+
+static inline uint32_t blob_find(uint32_t *parent, uint32_t i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+static inline uint32_t blob_union(uint32_t *parent, uint32_t a, uint32_t b) {
+    a = blob_find(parent, a);
+    b = blob_find(parent, b);
+    if (a < b) {
+        parent[b] = a;
+        return a;
+    }
+    parent[a] = b;
+    return b;
+}
+
+// Soma de k² para k em [0, n]
+static inline uint64_t blob_sum_sq(int64_t n) {
+    return n < 0 ? 0 : (uint64_t)(n * (n + 1) * (2 * n + 1) / 6);
+}
+
+// Corrida [a, b] da linha y: somas em forma fechada (sem laço por pixel)
+static inline void blob_acc_run(blob_acc_t *acc, int a, int b, int y) {
+    uint64_t n = (uint64_t)(b - a + 1);
+    uint64_t sx = (uint64_t)(a + b) * n / 2;
+    acc->n += n;
+    acc->sx += sx;
+    acc->sy += n * (uint64_t)y;
+    acc->sxx += blob_sum_sq(b) - blob_sum_sq(a - 1);
+    acc->syy += n * (uint64_t)y * (uint64_t)y;
+    acc->sxy += sx * (uint64_t)y;
+    acc->x0 = MIN(acc->x0, a);
+    acc->x1 = MAX(acc->x1, b);
+    acc->y0 = MIN(acc->y0, y);
+    acc->y1 = MAX(acc->y1, y);
+}
+
+static inline void blob_acc_merge(blob_acc_t *dst, const blob_acc_t *src) {
+    dst->n += src->n;
+    dst->sx += src->sx;
+    dst->sy += src->sy;
+    dst->sxx += src->sxx;
+    dst->syy += src->syy;
+    dst->sxy += src->sxy;
+    dst->x0 = MIN(dst->x0, src->x0);
+    dst->x1 = MAX(dst->x1, src->x1);
+    dst->y0 = MIN(dst->y0, src->y0);
+    dst->y1 = MAX(dst->y1, src->y1);
+}
+
+// Próximo pixel não nulo em [x, end) (o fundo é pulado de 8 em 8 bytes)
+static inline int blob_next_fg(const unsigned char *row, int x, int end) {
+    for (; x + 8 <= end; x += 8) {
+        uint64_t v;
+        memcpy(&v, row + x, sizeof(v));
+        if (v) break;
+    }
+    while (x < end && !row[x]) x++;
+    return x;
+}
+
+// Fim da corrida que começa em x (primeiro zero em [x, end), ou end)
+static inline int blob_run_end(const unsigned char *row, int x, int end) {
+    const unsigned char *z = (const unsigned char*)memchr(row + x, 0, end - x);
+    return z ? (int)(z - row) : end;
+}
+
+// ============================================================
+// FAIXAS
+// ============================================================
+
+typedef struct {
+    int y0, y1;
+    uint32_t *parent;           // Rótulos provisórios locais (0 sem uso)
+    blob_acc_t *acc;
+    uint32_t count, cap;        // count inclui o rótulo 0
+    uint32_t offset;            // Rótulo global = offset + local
+} blob_tile_t;
+
+typedef struct {
+    blob_set_t *bs;
+    const unsigned char *mask;
+    unsigned char *rgb;
+    int num_tiles;
+    blob_tile_t tiles[POOL_MAX_THREADS];
+    uint32_t *parent;           // Rótulos globais (1..total)
+    blob_acc_t *acc;
+    int failed;
+} blob_job_t;
+
+// Novo rótulo provisório da faixa. Retorna 0 ou -1
+static int blob_tile_new(blob_tile_t *t, uint32_t *label) {
+    if (t->count == t->cap) {
+        uint32_t cap = t->cap ? 2 * t->cap : 1024;
+        uint32_t *parent = (uint32_t*)realloc(t->parent, (size_t)cap * sizeof(uint32_t));
+        if (!parent) return -1;
+        t->parent = parent;
+        blob_acc_t *acc = (blob_acc_t*)realloc(t->acc, (size_t)cap * sizeof(blob_acc_t));
+        if (!acc) return -1;
+        t->acc = acc;
+        t->cap = cap;
+    }
+    uint32_t l = t->count++;
+    t->parent[l] = l;
+    t->acc[l] = (blob_acc_t){ .x0 = INT_MAX, .y0 = INT_MAX, .x1 = -1, .y1 = -1 };
+    *label = l;
+    return 0;
+}
+
+// Primeira passagem: corridas da faixa ligadas às corridas 8-vizinhas da
+// linha de cima (a primeira linha da faixa não olha para cima)
+static void blob_scan_task(void *arg, int tile) {
+    blob_job_t *job = (blob_job_t*)arg;
+    blob_tile_t *t = &job->tiles[tile];
+    const int w = job->bs->width;
+
+    uint32_t cur;
+    if (blob_tile_new(t, &cur) != 0) {  // Rótulo 0 reservado
+        __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    for (int y = t->y0; y < t->y1; y++) {
+        const unsigned char *row = job->mask + (size_t)y * w;
+        const unsigned char *up = y > t->y0 ? row - w : NULL;
+        uint32_t *lab = job->bs->labels + (size_t)y * w;
+        const uint32_t *lab_up = lab - w;
+
+        for (int x = 0; (x = blob_next_fg(row, x, w)) < w; ) {
+            int end = blob_run_end(row, x, w);
+            cur = 0;
+            if (up) {
+                int lo = MAX(0, x - 1), hi = MIN(w, end + 1);
+                for (int i = lo; (i = blob_next_fg(up, i, hi)) < hi; i = blob_run_end(up, i, hi)) {
+                    cur = cur ? blob_union(t->parent, cur, lab_up[i]) : lab_up[i];
+                }
+            }
+            if (!cur && blob_tile_new(t, &cur) != 0) {
+                __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+                return;
+            }
+            for (int i = x; i < end; i++) lab[i] = cur;
+            blob_acc_run(&t->acc[cur], x, end - 1, y);
+            x = end;
+        }
+    }
+}
+
+// Copia os rótulos locais da faixa para a tabela global
+static void blob_gather_task(void *arg, int tile) {
+    blob_job_t *job = (blob_job_t*)arg;
+    const blob_tile_t *t = &job->tiles[tile];
+    for (uint32_t l = 1; l < t->count; l++) {
+        job->parent[t->offset + l] = t->offset + t->parent[l];
+    }
+    if (t->count > 1) {
+        memcpy(job->acc + t->offset + 1, t->acc + 1, (t->count - 1) * sizeof(blob_acc_t));
+    }
+}
+
+// Une as corridas da primeira linha da faixa às da última linha da anterior
+static void blob_seam(blob_job_t *job, const blob_tile_t *upper, const blob_tile_t *lower) {
+    const int w = job->bs->width;
+    const int y = lower->y0;
+    const unsigned char *row = job->mask + (size_t)y * w;
+    const unsigned char *up = row - w;
+    const uint32_t *lab = job->bs->labels + (size_t)y * w;
+    const uint32_t *lab_up = lab - w;
+
+    for (int x = 0; (x = blob_next_fg(row, x, w)) < w; ) {
+        int end = blob_run_end(row, x, w);
+        int lo = MAX(0, x - 1), hi = MIN(w, end + 1);
+        for (int i = lo; (i = blob_next_fg(up, i, hi)) < hi; i = blob_run_end(up, i, hi)) {
+            blob_union(job->parent, lower->offset + lab[x], upper->offset + lab_up[i]);
+        }
+        x = end;
+    }
+}
+
+static inline void blob_color(uint32_t label, unsigned char *px) {
+    if (!label) {
+        px[0] = px[1] = px[2] = 0;
+        return;
+    }
+    // Cores distintas e claras o bastante para contrastar com o fundo
+    uint32_t h = label * 2654435761u;
+    px[0] = (unsigned char)(64 + (h >> 24) % 192);
+    px[1] = (unsigned char)(64 + ((h >> 16) & 0xff) % 192);
+    px[2] = (unsigned char)(64 + ((h >> 8) & 0xff) % 192);
+}
+
+// Segunda passagem: rótulos provisórios → finais (e cor de cada blob)
+static void blob_relabel_task(void *arg, int tile) {
+    blob_job_t *job = (blob_job_t*)arg;
+    const blob_tile_t *t = &job->tiles[tile];
+    const int w = job->bs->width;
+    const uint32_t *final = job->parent + t->offset;
+
+    for (int y = t->y0; y < t->y1; y++) {
+        const unsigned char *row = job->mask + (size_t)y * w;
+        uint32_t *lab = job->bs->labels + (size_t)y * w;
+        // Cada corrida tem um único rótulo provisório
+        for (int x = 0; x < w; ) {
+            int fg = blob_next_fg(row, x, w);
+            memset(lab + x, 0, (size_t)(fg - x) * sizeof(uint32_t));
+            if (fg == w) break;
+            int end = blob_run_end(row, fg, w);
+            uint32_t l = final[lab[fg]];
+            for (int i = fg; i < end; i++) lab[i] = l;
+            x = end;
+        }
+        if (job->rgb) {
+            unsigned char *px = job->rgb + (size_t)y * w * 3;
+            for (int x = 0; x < w; x++, px += 3) blob_color(lab[x], px);
+        }
+    }
+}
+
+// ============================================================
+// ROTULAÇÃO
+// ============================================================
+
+int blob_set_init(blob_set_t *bs, int width, int height) {
+    memset(bs, 0, sizeof(*bs));
+    bs->width = width;
+    bs->height = height;
+    bs->labels = (uint32_t*)malloc((size_t)width * height * sizeof(uint32_t));
+    if (!bs->labels) {
+        LOG_ERROR("Falha ao alocar plano de rótulos (%dx%d)", width, height);
+        return -1;
+    }
+    return 0;
+}
+
+void blob_set_free(blob_set_t *bs) {
+    free(bs->labels);
+    free(bs->blobs);
+    bs->labels = NULL;
+    bs->blobs = NULL;
+    bs->num_blobs = 0;
+}
+
+static void blob_fill(blob_t *b, uint32_t label, const blob_acc_t *acc) {
+    double n = (double)acc->n;
+    b->label = label;
+    b->area = (long)acc->n;
+    b->x0 = acc->x0;
+    b->y0 = acc->y0;
+    b->x1 = acc->x1;
+    b->y1 = acc->y1;
+    b->cx = (double)acc->sx / n;
+    b->cy = (double)acc->sy / n;
+    b->mu20 = (double)acc->sxx / n - b->cx * b->cx;
+    b->mu02 = (double)acc->syy / n - b->cy * b->cy;
+    b->mu11 = (double)acc->sxy / n - b->cx * b->cy;
+    b->angle = 0.5 * atan2(2.0 * b->mu11, b->mu20 - b->mu02);
+}
+
+// Achata a tabela global (cada rótulo → raiz, momentos somados na raiz)
+// e numera as raízes que passam do filtro de área. Ao final parent[i] é
+// o rótulo final do provisório i (0 = descartado)
+static int blob_resolve(blob_job_t *job, uint32_t total, long min_area) {
+    uint32_t *parent = job->parent;
+    blob_acc_t *acc = job->acc;
+    blob_set_t *bs = job->bs;
+
+    uint32_t roots = 0;
+    for (uint32_t i = 1; i <= total; i++) {
+        uint32_t p = parent[i];
+        if (p == i) {
+            roots++;
+            continue;
+        }
+        parent[i] = parent[p];          // p < i já aponta para a raiz
+        blob_acc_merge(&acc[parent[i]], &acc[i]);
+    }
+
+    free(bs->blobs);
+    bs->num_blobs = 0;
+    bs->blobs = roots ? (blob_t*)malloc((size_t)roots * sizeof(blob_t)) : NULL;
+    if (roots && !bs->blobs) return -1;
+
+    for (uint32_t i = 1; i <= total; i++) {
+        if (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+        } else if ((long)acc[i].n >= min_area) {
+            parent[i] = (uint32_t)++bs->num_blobs;
+            blob_fill(&bs->blobs[bs->num_blobs - 1], parent[i], &acc[i]);
+        } else {
+            parent[i] = 0;
+        }
+    }
+    return 0;
+}
+
+int blob_label(blob_set_t *bs, const unsigned char *mask, int min_area, unsigned char *rgb,
+               int num_tiles, thread_pool_t *pool) {
+    blob_job_t *job = (blob_job_t*)calloc(1, sizeof(blob_job_t));
+    if (!job) return -1;
+    job->bs = bs;
+    job->mask = mask;
+    job->rgb = rgb;
+    job->num_tiles = MAX(1, MIN(MIN(num_tiles, POOL_MAX_THREADS), bs->height));
+    for (int i = 0; i < job->num_tiles; i++) {
+        job->tiles[i].y0 = (int)((long)bs->height * i / job->num_tiles);
+        job->tiles[i].y1 = (int)((long)bs->height * (i + 1) / job->num_tiles);
+    }
+
+    thread_pool_run(pool, blob_scan_task, job, job->num_tiles);
+
+    // Faixas numeradas em sequência: rótulos globais únicos
+    uint32_t total = 0;
+    for (int i = 0; i < job->num_tiles; i++) {
+        job->tiles[i].offset = total;
+        total += job->tiles[i].count - 1;
+    }
+
+    int ok = !job->failed;
+    if (ok) {
+        job->parent = (uint32_t*)malloc(((size_t)total + 1) * sizeof(uint32_t));
+        job->acc = (blob_acc_t*)malloc(((size_t)total + 1) * sizeof(blob_acc_t));
+        ok = job->parent && job->acc;
+    }
+    if (ok) {
+        job->parent[0] = 0;
+        thread_pool_run(pool, blob_gather_task, job, job->num_tiles);
+        for (int i = 1; i < job->num_tiles; i++) {
+            blob_seam(job, &job->tiles[i - 1], &job->tiles[i]);
+        }
+        ok = blob_resolve(job, total, MAX(1, min_area)) == 0;
+    }
+    if (ok) {
+        thread_pool_run(pool, blob_relabel_task, job, job->num_tiles);
+    } else {
+        LOG_ERROR("Falha ao alocar rótulos dos blobs (%dx%d)", bs->width, bs->height);
+    }
+
+    for (int i = 0; i < job->num_tiles; i++) {
+        free(job->tiles[i].parent);
+        free(job->tiles[i].acc);
+    }
+    free(job->parent);
+    free(job->acc);
+    free(job);
+    return ok ? 0 : -1;
+}
+
+// ============================================================
+// RELATÓRIO
+// ============================================================
+
+int blob_write_csv(const blob_set_t *bs, const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        LOG_ERROR("Falha ao criar %s", path);
+        return -1;
+    }
+
+    fprintf(f, "label,area,x0,y0,x1,y1,cx,cy,mu20,mu02,mu11,angle\n");
+    for (int i = 0; i < bs->num_blobs; i++) {
+        const blob_t *b = &bs->blobs[i];
+        fprintf(f, "%u,%ld,%d,%d,%d,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.4f\n",
+                b->label, b->area, b->x0, b->y0, b->x1, b->y1,
+                b->cx, b->cy, b->mu20, b->mu02, b->mu11, b->angle);
+    }
+
+    int ok = !ferror(f);
+    if (fclose(f) != 0) ok = 0;
+    if (!ok) LOG_ERROR("Falha ao escrever %s", path);
+    return ok ? 0 : -1;
+}
@@ -0,0 +1,138 @@
+#include "calib.h"
+#include "filters.h"
+#include "simd_kernels.h"
+#include <math.h>
+
+// ============================================================
+// CARGA
+// ============================================================
+
+int calib_enabled(const pipeline_config_t *cfg) {
+    return cfg->calib_dark[0] != '\0' || cfg->calib_flat[0] != '\0';
+}
+
+// Quadro em 16 bits (quadros de 8 bits são expandidos × 257 pelo decodificador)
+static uint16_t* calib_frame_load(const char *path, int *w, int *h, int *c) {
+    uint16_t *frame = load_image_16(path, w, h, c);
+    if (frame && *c > MAX_CHANNELS) {
+        LOG_ERROR("Quadro de calibração com %d canais: %s", *c, path);
+        free_image((unsigned char*)frame);
+        return NULL;
+    }
+    return frame;
+}
+
+int calib_load(calib_t *cal, const pipeline_config_t *cfg) {
+    memset(cal, 0, sizeof(*cal));
+    if (!calib_enabled(cfg)) return 0;
+
+    uint16_t *dark = NULL, *flat = NULL;
+    int w = 0, h = 0, c = 0;
+    if (cfg->calib_dark[0] && !(dark = calib_frame_load(cfg->calib_dark, &w, &h, &c))) {
+        return -1;
+    }
+    if (cfg->calib_flat[0]) {
+        int fw, fh, fc;
+        if (!(flat = calib_frame_load(cfg->calib_flat, &fw, &fh, &fc))) {
+            free_image((unsigned char*)dark);
+            return -1;
+        }
+        if (dark && (fw != w || fh != h || fc != c)) {
+            LOG_ERROR("Dark frame (%dx%d, %d canais) e flat-field (%dx%d, %d canais) diferem",
+                      w, h, c, fw, fh, fc);
+            free_image((unsigned char*)dark);
+            free_image((unsigned char*)flat);
+            return -1;
+        }
+        w = fw;
+        h = fh;
+        c = fc;
+    }
+
+    // Um bloco compartilhado: ganhos, dark de 16 bits e dark de 8 bits
+    size_t n = (size_t)w * h * c;
+    cal->block_bytes = n * (2 * sizeof(uint16_t) + 1);
+    cal->block = mmap(NULL, cal->block_bytes, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (cal->block == MAP_FAILED) {
+        LOG_ERROR("Falha ao mapear calibração (%dx%d, %d canais)", w, h, c);
+        cal->block = NULL;
+        free_image((unsigned char*)dark);
+        free_image((unsigned char*)flat);
+        return -1;
+    }
+    int16_t *gain = (int16_t*)cal->block;
+    uint16_t *dark16 = (uint16_t*)(gain + n);
+    unsigned char *dark8 = (unsigned char*)(dark16 + n);
+
+    // Alpha (2 ou 4 canais) passa sem correção
+    const int color = (c == 2 || c == 4) ? c - 1 : c;
+    for (size_t i = 0; i < n; i++) {
+        dark16[i] = dark && (int)(i % c) < color ? dark[i] : 0;
+        gain[i] = 1 << CALIB_GAIN_BITS;
+    }
+    reduce_u16(dark16, dark8, n);
+
+    // Ganho normaliza cada amostra pela média do canal no flat sem dark
+    for (int k = 0; flat && k < color; k++) {
+        double sum = 0.0;
+        size_t count = 0;
+        for (size_t i = k; i < n; i += c) {
+            if (flat[i] > dark16[i]) {
+                sum += flat[i] - dark16[i];
+                count++;
+            }
+        }
+        if (count == 0) continue;
+        double mean = sum / count;
+        for (size_t i = k; i < n; i += c) {
+            if (flat[i] <= dark16[i]) continue;
+            double g = mean / (flat[i] - dark16[i]) * (1 << CALIB_GAIN_BITS);
+            gain[i] = (int16_t)MIN(CALIB_GAIN_MAX, lround(g));
+        }
+    }
+    free_image((unsigned char*)dark);
+    free_image((unsigned char*)flat);
+
+    // Somente leitura a partir daqui (herdado pelos workers no fork)
+    if (mprotect(cal->block, cal->block_bytes, PROT_READ) != 0) {
+        LOG_ERROR("Falha ao proteger calibração: %s", strerror(errno));
+    }
+    cal->width = w;
+    cal->height = h;
+    cal->channels = c;
+    cal->gain = gain;
+    cal->dark16 = dark16;
+    cal->dark8 = dark8;
+    cal->active = 1;
+    return 0;
+}
+
+void calib_free(calib_t *cal) {
+    if (cal->block) munmap(cal->block, cal->block_bytes);
+    memset(cal, 0, sizeof(*cal));
+}
+
+int calib_matches(const calib_t *cal, int width, int height, int channels) {
+    return cal->width == width && cal->height == height && cal->channels == channels;
+}
+
+// ============================================================
+// APLICAÇÃO
+// ============================================================
+
+void calib_rows(const calib_t *cal, const unsigned char *src, unsigned char *dst,
+                size_t first, int n) {
+    g_kernels.calib_row(src, cal->dark8 + first, cal->gain + first, dst, n);
+}
+
+void calib_rows_u16(const calib_t *cal, const uint16_t *src, uint16_t *dst,
+                    size_t first, int n) {
+    const uint16_t *dark = cal->dark16 + first;
+    const int16_t *gain = cal->gain + first;
+    for (int i = 0; i < n; i++) {
+        uint32_t v = src[i] > dark[i] ? (uint32_t)(src[i] - dark[i]) : 0;
+        v = (v * (uint32_t)gain[i] + (1u << (CALIB_GAIN_BITS - 1))) >> CALIB_GAIN_BITS;
+        dst[i] = (uint16_t)MIN(v, 65535u);
+    }
+}
@@ -0,0 +1,317 @@
+#include "canny.h"
+
+// ============================================================
+// STREAM (gaussiano → gradiente → supressão de não-máximos)
+// ============================================================
+
+// Offsets dentro do bloco único alinhados à linha de cache
+#define CANNY_ALIGN(n)  (((n) + 63) & ~(size_t)63)
+
+static inline unsigned char* canny_luma_row(const canny_stream_t *cs, int y) {
+    return cs->luma + (size_t)(y % 5) * cs->width;
+}
+
+static inline unsigned char* canny_smooth_row(const canny_stream_t *cs, int y) {
+    return cs->smooth + (size_t)(y % 3) * (cs->width + 2);
+}
+
+static inline int16_t* canny_mag_row(const canny_stream_t *cs, int y) {
+    if (y < 0 || y >= cs->height) return cs->mag_zero;
+    return cs->mag + (size_t)(y % 3) * (cs->width + 2);
+}
+
+static inline unsigned char* canny_dir_row(const canny_stream_t *cs, int y) {
+    return cs->dir + (size_t)(y % 3) * cs->width;
+}
+
+int canny_stream_init(canny_stream_t *cs, int width, int height, int low, int high,
+                      int out_begin, int out_end) {
+    memset(cs, 0, sizeof(*cs));
+    cs->width = width;
+    cs->height = height;
+    cs->low = low;
+    cs->high = high;
+    cs->out_begin = out_begin;
+    cs->out_end = out_end;
+    cs->next_out = out_begin;
+
+    // Halo de cada estágio: supressão 1, Sobel 1, gaussiano 2
+    cs->next_grad = MAX(0, out_begin - 1);
+    cs->grad_end = MIN(height, out_end + 1);
+    cs->next_smooth = MAX(0, out_begin - 2);
+    cs->smooth_end = MIN(height, out_end + 2);
+    cs->in_begin = MAX(0, out_begin - 4);
+    cs->in_end = MIN(height, out_end + 4);
+
+    const size_t w = (size_t)width;
+    size_t off_mag = 0;
+    size_t off_zero = off_mag + CANNY_ALIGN(3 * (w + 2) * sizeof(int16_t));
+    size_t off_gx = off_zero + CANNY_ALIGN((w + 2) * sizeof(int16_t));
+    size_t off_gy = off_gx + CANNY_ALIGN(w * sizeof(int16_t));
+    size_t off_vert = off_gy + CANNY_ALIGN(w * sizeof(int16_t));
+    size_t off_luma = off_vert + CANNY_ALIGN((w + 4) * sizeof(uint16_t));
+    size_t off_smooth = off_luma + CANNY_ALIGN(5 * w);
+    size_t off_dir = off_smooth + CANNY_ALIGN(3 * (w + 2));
+    size_t total = off_dir + CANNY_ALIGN(3 * w);
+
+    // Zerado: bordas da magnitude e a linha fora da imagem ficam em 0
+    unsigned char *block = (unsigned char*)calloc(1, total);
+    if (!block) {
+        LOG_ERROR("Falha ao alocar memória para canny");
+        return -1;
+    }
+    cs->block = block;
+    cs->mag = (int16_t*)(block + off_mag);
+    cs->mag_zero = (int16_t*)(block + off_zero);
+    cs->gx = (int16_t*)(block + off_gx);
+    cs->gy = (int16_t*)(block + off_gy);
+    cs->vert = (uint16_t*)(block + off_vert);
+    cs->luma = block + off_luma;
+    cs->smooth = block + off_smooth;
+    cs->dir = block + off_dir;
+    return 0;
+}
+
+// Supressão das linhas cuja magnitude vizinha (acima e abaixo) já existe
+static void canny_emit_nms(canny_stream_t *cs, unsigned char *map) {
+    while (cs->next_out < cs->out_end && MIN(cs->height - 1, cs->next_out + 1) < cs->next_grad) {
+        int yo = cs->next_out;
+        g_kernels.canny_nms_row(canny_mag_row(cs, yo - 1), canny_mag_row(cs, yo),
+                                canny_mag_row(cs, yo + 1), canny_dir_row(cs, yo),
+                                map + (size_t)yo * cs->width, cs->width, cs->low, cs->high);
+        cs->next_out++;
+    }
+}
+
+// Gradiente das linhas cuja vizinhança suavizada 3x3 está completa
+static void canny_emit_grad(canny_stream_t *cs, unsigned char *map) {
+    const int w = cs->width, h = cs->height;
+    while (cs->next_grad < cs->grad_end && MIN(h - 1, cs->next_grad + 1) < cs->next_smooth) {
+        int yg = cs->next_grad;
+        g_kernels.sobel_row(canny_smooth_row(cs, MAX(0, yg - 1)), canny_smooth_row(cs, yg),
+                            canny_smooth_row(cs, MIN(h - 1, yg + 1)), cs->gx, cs->gy, w);
+        g_kernels.grad_mag16_row(cs->gx, cs->gy, canny_mag_row(cs, yg) + 1, w);
+        g_kernels.sobel_dir(cs->gx, cs->gy, canny_dir_row(cs, yg), w);
+        cs->next_grad++;
+        canny_emit_nms(cs, map);
+    }
+}
+
+void canny_stream_push(canny_stream_t *cs, const unsigned char *luma, int y,
+                       unsigned char *map) {
+    if (y < cs->in_begin || y >= cs->in_end) return;
+
+    const int w = cs->width, h = cs->height;
+    memcpy(canny_luma_row(cs, y), luma, w);
+
+    // Gaussiano das linhas cuja janela vertical de 5 está completa
+    // (borda replicada nos dois eixos)
+    while (cs->next_smooth < cs->smooth_end && MIN(h - 1, cs->next_smooth + 2) <= y) {
+        int ys = cs->next_smooth;
+        uint16_t *vert = cs->vert + 2;
+        g_kernels.gauss5_vert_row(canny_luma_row(cs, MAX(0, ys - 2)),
+                                  canny_luma_row(cs, MAX(0, ys - 1)),
+                                  canny_luma_row(cs, ys),
+                                  canny_luma_row(cs, MIN(h - 1, ys + 1)),
+                                  canny_luma_row(cs, MIN(h - 1, ys + 2)), vert, w);
+        vert[-2] = vert[-1] = vert[0];
+        vert[w] = vert[w + 1] = vert[w - 1];
+
+        unsigned char *row = canny_smooth_row(cs, ys);
+        g_kernels.gauss5_horiz_row(cs->vert, row + 1, w);
+        row[0] = row[1];
+        row[w + 1] = row[w];
+        cs->next_smooth++;
+
+        canny_emit_grad(cs, map);
+    }
+}
+
+void canny_stream_free(canny_stream_t *cs) {
+    free(cs->block);
+    memset(cs, 0, sizeof(*cs));
+}
+
+// ============================================================
+// HISTERESE
+// ============================================================
+// Cada faixa propaga as bordas fortes pelos fracos das próprias linhas
+// (pilha explícita, sem recursão). Depois as costuras entre faixas
+// adjacentes são comparadas em série: um fraco vizinho de um forte do
+// outro lado vira semente da sua faixa, que propaga de novo em paralelo.
+// Repete até nenhuma costura mudar (uma borda que serpenteia entre faixas
+// pode exigir algumas rodadas; em geral uma basta).
+
+typedef struct {
+    int y0, y1;
+    int *stack;                 // Índices de pixels fortes a propagar
+    int top, cap;
+} canny_tile_t;
+
+typedef struct {
+    unsigned char *map;
+    int width, height;
+    int num_tiles;
+    canny_tile_t tiles[POOL_MAX_THREADS];
+    int failed;
+} canny_hysteresis_t;
+
+static int canny_tile_push(canny_tile_t *t, int idx) {
+    if (t->top == t->cap) {
+        int cap = t->cap ? 2 * t->cap : 4096;
+        int *stack = (int*)realloc(t->stack, (size_t)cap * sizeof(int));
+        if (!stack) return -1;
+        t->stack = stack;
+        t->cap = cap;
+    }
+    t->stack[t->top++] = idx;
+    return 0;
+}
+
+// Esvazia a pilha promovendo fracos 8-conectados dentro da faixa
+static int canny_tile_flood(canny_hysteresis_t *hy, canny_tile_t *t) {
+    unsigned char *map = hy->map;
+    const int w = hy->width;
+
+    while (t->top > 0) {
+        int idx = t->stack[--t->top];
+        int y = idx / w, x = idx - y * w;
+        int ya = MAX(t->y0, y - 1), yb = MIN(t->y1 - 1, y + 1);
+        int xa = MAX(0, x - 1), xb = MIN(w - 1, x + 1);
+        for (int ny = ya; ny <= yb; ny++) {
+            for (int nx = xa; nx <= xb; nx++) {
+                int n = ny * w + nx;
+                if (map[n] != CANNY_WEAK) continue;
+                map[n] = CANNY_STRONG;
+                if (canny_tile_push(t, n) != 0) return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+static void canny_fail(canny_hysteresis_t *hy) {
+    __atomic_store_n(&hy->failed, 1, __ATOMIC_RELAXED);
+}
+
+// Primeira rodada: toda borda forte da faixa é semente
+static void canny_seed_task(void *arg, int tile) {
+    canny_hysteresis_t *hy = (canny_hysteresis_t*)arg;
+    canny_tile_t *t = &hy->tiles[tile];
+    const int w = hy->width;
+
+    for (int y = t->y0; y < t->y1; y++) {
+        unsigned char *row = hy->map + (size_t)y * w;
+        unsigned char *p = row;
+        // Mapa quase todo zero: memchr pula os trechos vazios
+        while ((p = (unsigned char*)memchr(p, CANNY_STRONG, w - (p - row))) != NULL) {
+            if (canny_tile_push(t, y * w + (int)(p - row)) != 0 || canny_tile_flood(hy, t) != 0) {
+                canny_fail(hy);
+                return;
+            }
+            p++;
+        }
+    }
+}
+
+static void canny_flood_task(void *arg, int tile) {
+    canny_hysteresis_t *hy = (canny_hysteresis_t*)arg;
+    if (canny_tile_flood(hy, &hy->tiles[tile]) != 0) {
+        canny_fail(hy);
+    }
+}
+
+// Fracos não alcançados viram 0; fortes ficam 255
+static void canny_finish_task(void *arg, int tile) {
+    canny_hysteresis_t *hy = (canny_hysteresis_t*)arg;
+    const canny_tile_t *t = &hy->tiles[tile];
+    unsigned char *rows = hy->map + (size_t)t->y0 * hy->width;
+    g_kernels.threshold_row(rows, rows, (t->y1 - t->y0) * hy->width, CANNY_STRONG - 1);
+}
+
+// Promove fracos da linha 'to' vizinhos de fortes da linha 'from'
+static int canny_seam_row(canny_hysteresis_t *hy, int from, int to, canny_tile_t *t) {
+    const int w = hy->width;
+    const unsigned char *src = hy->map + (size_t)from * w;
+    unsigned char *dst = hy->map + (size_t)to * w;
+    int seeds = 0;
+
+    for (int x = 0; x < w; x++) {
+        if (src[x] != CANNY_STRONG) continue;
+        for (int nx = MAX(0, x - 1); nx <= MIN(w - 1, x + 1); nx++) {
+            if (dst[nx] != CANNY_WEAK) continue;
+            dst[nx] = CANNY_STRONG;
+            if (canny_tile_push(t, to * w + nx) != 0) return -1;
+            seeds++;
+        }
+    }
+    return seeds;
+}
+
+// Retorna quantas sementes novas as costuras geraram (-1 em falha)
+static int canny_seams(canny_hysteresis_t *hy) {
+    int seeds = 0;
+    for (int k = 0; k + 1 < hy->num_tiles; k++) {
+        canny_tile_t *upper = &hy->tiles[k], *lower = &hy->tiles[k + 1];
+        int a = canny_seam_row(hy, upper->y1 - 1, lower->y0, lower);
+        int b = canny_seam_row(hy, lower->y0, upper->y1 - 1, upper);
+        if (a < 0 || b < 0) return -1;
+        seeds += a + b;
+    }
+    return seeds;
+}
+
+int canny_hysteresis(unsigned char *map, int width, int height, int num_tiles,
+                     thread_pool_t *pool) {
+    canny_hysteresis_t hy;
+    memset(&hy, 0, sizeof(hy));
+    hy.map = map;
+    hy.width = width;
+    hy.height = height;
+    hy.num_tiles = MAX(1, MIN(MIN(num_tiles, POOL_MAX_THREADS), height));
+    for (int i = 0; i < hy.num_tiles; i++) {
+        hy.tiles[i].y0 = (int)((long)height * i / hy.num_tiles);
+        hy.tiles[i].y1 = (int)((long)height * (i + 1) / hy.num_tiles);
+    }
+
+    thread_pool_run(pool, canny_seed_task, &hy, hy.num_tiles);
+
+    int seeds;
+    while (!hy.failed && (seeds = canny_seams(&hy)) != 0) {
+        if (seeds < 0) {
+            hy.failed = 1;
+            break;
+        }
+        thread_pool_run(pool, canny_flood_task, &hy, hy.num_tiles);
+    }
+
+    if (!hy.failed) {
+        thread_pool_run(pool, canny_finish_task, &hy, hy.num_tiles);
+    } else {
+        LOG_ERROR("Falha ao alocar pilha da histerese (%dx%d)", width, height);
+    }
+
+    for (int i = 0; i < hy.num_tiles; i++) {
+        free(hy.tiles[i].stack);
+    }
+    return hy.failed ? -1 : 0;
+}
+
+// ============================================================
+// IMAGEM INTEIRA
+// ============================================================
+
+int apply_canny(const unsigned char *luma, unsigned char *dst, int width, int height,
+                int low, int high) {
+    canny_stream_t cs;
+    if (canny_stream_init(&cs, width, height, low, high, 0, height) != 0) {
+        return -1;
+    }
+
+    for (int y = 0; y < height; y++) {
+        canny_stream_push(&cs, luma + (size_t)y * width, y, dst);
+    }
+
+    canny_stream_free(&cs);
+    return canny_hysteresis(dst, width, height, 1, NULL);
+}
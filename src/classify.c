@@ -0,0 +1,139 @@
+#include "classify.h"
+#include "simd_kernels.h"
+
+const char* class_space_name(int space) {
+    return space == CLASS_SPACE_RGB ? "rgb" : color_space_name(space);
+}
+
+// ============================================================
+// MONTAGEM (COORDENADOR)
+// ============================================================
+
+// Lado de uma célula da LUT (cores por canal)
+#define CLASS_CELL  (256 >> CLASS_LUT_BITS)
+
+// Bits das classes cujo intervalo de um componente aceita cada valor,
+// por espaço: a classe de uma cor é o primeiro bit comum aos três
+typedef struct {
+    unsigned int used;                          // Espaços com alguma classe (bit por espaço)
+    uint16_t accept[CLASS_SPACE_RGB + 1][3][256];
+} class_masks_t;
+
+static void class_masks_init(class_masks_t *m, const pipeline_config_t *cfg) {
+    memset(m, 0, sizeof(*m));
+    for (int c = 0; c < cfg->num_classes; c++) {
+        const color_class_t *cls = &cfg->classes[c];
+        m->used |= 1u << cls->space;
+        for (int k = 0; k < 3; k++) {
+            for (int v = 0; v < 256; v++) {
+                int in = cls->lo[k] <= cls->hi[k] ? v >= cls->lo[k] && v <= cls->hi[k]
+                                                  : v >= cls->lo[k] || v <= cls->hi[k];
+                if (in) m->accept[cls->space][k][v] |= (uint16_t)(1u << c);
+            }
+        }
+    }
+}
+
+// Linhas de 256 cores (B de 0 a 255) com R e G fixos, convertidas para
+// cada espaço usado; ids[i] = primeira classe que aceita a cor (0 = nenhuma)
+static void class_row_ids(const class_masks_t *m, int r, int g, const unsigned char *ramp,
+                          unsigned char *ids) {
+    unsigned char rr[256], gg[256], conv[COLOR_PLANES][256];
+    memset(rr, r, sizeof(rr));
+    memset(gg, g, sizeof(gg));
+    uint16_t match[256] = {0};
+
+    for (int space = 0; space <= CLASS_SPACE_RGB; space++) {
+        if (!(m->used & (1u << space))) continue;
+        const unsigned char *comp[COLOR_PLANES] = { rr, gg, ramp };
+        if (space != CLASS_SPACE_RGB) {
+            unsigned char *const dst[COLOR_PLANES] = { conv[0], conv[1], conv[2] };
+            color_convert_row(space, rr, gg, ramp, dst, 256);
+            for (int k = 0; k < COLOR_PLANES; k++) comp[k] = conv[k];
+        }
+        const uint16_t (*acc)[256] = m->accept[space];
+        for (int i = 0; i < 256; i++) {
+            match[i] |= acc[0][comp[0][i]] & acc[1][comp[1][i]] & acc[2][comp[2][i]];
+        }
+    }
+    for (int i = 0; i < 256; i++) {
+        ids[i] = match[i] ? (unsigned char)(__builtin_ctz(match[i]) + 1) : 0;
+    }
+}
+
+// Células de um par (R, G) quantizado: voto das 4x4x4 cores de cada uma
+// (empate fica com o menor id)
+static void class_lut_cells(const class_masks_t *m, int rq, int gq, const unsigned char *ramp,
+                            uint8_t *cells) {
+    unsigned char ids[CLASS_CELL * CLASS_CELL][256];
+    for (int j = 0; j < CLASS_CELL * CLASS_CELL; j++) {
+        class_row_ids(m, rq * CLASS_CELL + j / CLASS_CELL, gq * CLASS_CELL + j % CLASS_CELL,
+                      ramp, ids[j]);
+    }
+    for (int bq = 0; bq < (1 << CLASS_LUT_BITS); bq++) {
+        int votes[CLASS_MAX + 1] = {0};
+        for (int j = 0; j < CLASS_CELL * CLASS_CELL; j++) {
+            for (int k = 0; k < CLASS_CELL; k++) votes[ids[j][bq * CLASS_CELL + k]]++;
+        }
+        int best = 0;
+        for (int c = 1; c <= CLASS_MAX; c++) {
+            if (votes[c] > votes[best]) best = c;
+        }
+        cells[bq] = (uint8_t)best;
+    }
+}
+
+int class_lut_build(class_lut_t *cl, const pipeline_config_t *cfg) {
+    memset(cl, 0, sizeof(*cl));
+    if (!(cfg->filters & FILTER_BIT(FILTER_CLASSIFY))) return 0;
+
+    class_masks_t *m = (class_masks_t*)malloc(sizeof(class_masks_t));
+    if (!m) {
+        LOG_ERROR("Falha ao alocar memória para a LUT de classes");
+        return -1;
+    }
+    cl->block_bytes = CLASS_LUT_SIZE + CLASS_LUT_PAD;
+    cl->block = mmap(NULL, cl->block_bytes, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (cl->block == MAP_FAILED) {
+        LOG_ERROR("Falha ao mapear LUT de classes: %s", strerror(errno));
+        cl->block = NULL;
+        free(m);
+        return -1;
+    }
+
+    class_masks_init(m, cfg);
+    unsigned char ramp[256];
+    for (int v = 0; v < 256; v++) ramp[v] = (unsigned char)v;
+    uint8_t *lut = (uint8_t*)cl->block;
+    const int side = 1 << CLASS_LUT_BITS;
+    for (int rq = 0; rq < side; rq++) {
+        for (int gq = 0; gq < side; gq++) {
+            class_lut_cells(m, rq, gq, ramp, lut + ((rq * side + gq) << CLASS_LUT_BITS));
+        }
+    }
+    free(m);
+
+    // Somente leitura a partir daqui (herdado pelos workers no fork)
+    if (mprotect(cl->block, cl->block_bytes, PROT_READ) != 0) {
+        LOG_ERROR("Falha ao proteger LUT de classes: %s", strerror(errno));
+    }
+    cl->active = 1;
+    cl->classes = cfg->num_classes;
+    cl->lut = lut;
+    return 0;
+}
+
+void class_lut_free(class_lut_t *cl) {
+    if (cl->block) munmap(cl->block, cl->block_bytes);
+    memset(cl, 0, sizeof(*cl));
+}
+
+// ============================================================
+// APLICAÇÃO
+// ============================================================
+
+void class_rows(const class_lut_t *cl, const unsigned char *r, const unsigned char *g,
+                const unsigned char *b, unsigned char *dst, int n, uint32_t *counts) {
+    g_kernels.class_row(r, g, b, cl->lut, dst, n, cl->classes, counts);
+}
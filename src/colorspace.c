@@ -0,0 +1,59 @@
+#include "colorspace.h"
+#include "simd_kernels.h"
+
+// ============================================================
+// COEFICIENTES (Q15, linha por componente, colunas R, G, B)
+// ============================================================
+
+// JFIF: Y com os pesos do grayscale (saída idêntica à luminância),
+// Cb = 0,5·(B − Y)/(1 − 0,114) e Cr = 0,5·(R − Y)/(1 − 0,299)
+static const int16_t ycbcr_coef[9] = {
+    GRAY_WEIGHT_R, GRAY_WEIGHT_G, GRAY_WEIGHT_B,
+    -5529, -10855, 16384,
+    16384, -13720, -2664
+};
+
+// Lab aproximado: a raiz cúbica do CIELAB é trocada pela codificação sRGB
+// já presente nos valores de 8 bits (as duas comprimem a luminância de modo
+// parecido), o que deixa L, a e b lineares em R', G', B'. Com X, Y, Z da
+// matriz sRGB (D65) sobre R', G', B' em [0, 1]: L = 255·Y (L* × 2,55),
+// a = 500·(X/Xn − Y) e b = 200·(Y − Z/Zn), como o Lab de 8 bits do
+// OpenCV. Serve para distâncias de cor e limiares, não para colorimetria
+static const int16_t lab_coef[9] = {
+    6969, 23434, 2365,
+    14217, -21777, 7560,
+    5009, 15567, -20576
+};
+
+static const char *plane_names[COLOR_SPACE_COUNT][COLOR_PLANES] = {
+    { "ycbcr_y", "ycbcr_cb", "ycbcr_cr" },
+    { "hsv_h", "hsv_s", "hsv_v" },
+    { "lab_l", "lab_a", "lab_b" }
+};
+
+const char* color_space_name(int space) {
+    switch (space) {
+        case COLOR_YCBCR: return "ycbcr";
+        case COLOR_HSV:   return "hsv";
+        case COLOR_LAB:   return "lab";
+        default:          return "unknown";
+    }
+}
+
+const char* color_plane_name(int space, int plane) {
+    return plane_names[space][plane];
+}
+
+// ============================================================
+// CONVERSÃO
+// ============================================================
+
+void color_convert_row(int space, const unsigned char *r, const unsigned char *g,
+                       const unsigned char *b, unsigned char *const dst[COLOR_PLANES], int n) {
+    if (space == COLOR_HSV) {
+        g_kernels.hsv_row(r, g, b, dst[0], dst[1], dst[2], n);
+    } else {
+        g_kernels.color_matrix_row(r, g, b, space == COLOR_YCBCR ? ycbcr_coef : lab_coef,
+                                   dst[0], dst[1], dst[2], n);
+    }
+}
@@ -0,0 +1,945 @@
+#include "config.h"
+#include "bayer.h"
+#include "canny.h"
+#include "classify.h"
+#include "colorspace.h"
+#include "filters.h"
+#include "remap.h"
+#include "resize.h"
+#include "thread_pool.h"
+#include "tone.h"
+#include <limits.h>
+#include <math.h>
+
+// ============================================================
+// OPÇÕES DE LINHA DE COMANDO
+// ============================================================
+
+typedef struct {
+    const char *short_name;     // Ex: "-b" (NULL = só a forma longa)
+    const char *long_name;      // Ex: "--blur-radius"
+    const char *key;            // Parâmetro em config_set()
+    const char *arg;            // Descrição do argumento
+    const char *help;           // Texto de ajuda
+} cli_option_t;
+
+static const cli_option_t cli_options[] = {
+    {"-b", "--blur-radius", "blur_radius", "<r>",       "Raio do box blur (kernel 2r+1)"},
+    {NULL, "--median-radius", "median_radius", "<1-15>", "Raio da mediana (janela 2r+1, custo independe do raio)"},
+    {"-r", "--resize",      "resize",      "<LxA|f>",   "Saída do resize: tamanho (640x640, 640x0) ou fator (0.25)"},
+    {"-m", "--resize-mode", "resize_mode", "<modo>",    "Interpolação do resize: area, bilinear, nearest"},
+    {"-t", "--threads",     "threads",     "<n>",       "Threads por worker (faixas da imagem em paralelo)"},
+    {"-f", "--filters",     "filters",     "<lista>",   "Filtros a executar, ex: grayscale,blur,resize,sobel,threshold,canny,morph,blobs,match,pyramid,remap,golden,median,color,classify"},
+    {NULL, "--sobel-norm",  "sobel_norm",  "<l1|l2>",   "Magnitude do Sobel: |gx|+|gy| ou sqrt(gx²+gy²)"},
+    {NULL, "--sobel-dir",   "sobel_direction", "<on|off>", "Salva também a direção quantizada do Sobel"},
+    {NULL, "--threshold-mode", "threshold_mode", "<modo>", "Binarização: fixed, mean (média local), otsu"},
+    {NULL, "--threshold",   "threshold_value", "<0-255>", "Limiar do modo fixed"},
+    {NULL, "--threshold-radius", "threshold_radius", "<r>", "Raio da janela do modo mean"},
+    {NULL, "--threshold-c", "threshold_c", "<c>",       "Margem abaixo da média no modo mean"},
+    {NULL, "--canny-low",   "canny_low",   "<0-2040>",  "Limiar fraco do Canny (magnitude |gx|+|gy|)"},
+    {NULL, "--canny-high",  "canny_high",  "<0-2040>",  "Limiar forte do Canny"},
+    {NULL, "--morph",       "morph_op",    "<op>",      "Morfologia: erode, dilate, open, close"},
+    {NULL, "--morph-size",  "morph_size",  "<n|LxA>",   "Elemento estruturante retangular (lados ímpares)"},
+    {NULL, "--morph-input", "morph_input", "<modo>",    "Entrada da morfologia: gray ou binary (saída do threshold)"},
+    {NULL, "--blob-min-area", "blob_min_area", "<n>",   "Área mínima (pixels) de um blob na rotulação"},
+    {NULL, "--templates",   "templates",   "<lista>",   "Imagens dos templates do match, ex: peca.png,furo.png"},
+    {NULL, "--match-threshold", "match_threshold", "<0-1>", "Score NCC mínimo de uma ocorrência do template"},
+    {NULL, "--stats",       "image_stats", "<on|off>",  "Média, desvio, mín/máx e histograma por canal no relatório"},
+    {NULL, "--dark",        "calib_dark",  "<arquivo>", "Dark frame subtraído de cada imagem (mesma geometria)"},
+    {NULL, "--flat",        "calib_flat",  "<arquivo>", "Flat-field: ganho por amostra contra vinheta e padrão fixo"},
+    {NULL, "--bayer",       "bayer_pattern", "<padrão>", "Entrada bruta de sensor (1 canal): rggb, bggr, grbg, gbrg"},
+    {NULL, "--demosaic",    "demosaic_method", "<modo>", "Demosaico Bayer: bilinear ou edge (direcional)"},
+    {NULL, "--bayer-gray",  "bayer_gray",  "<on|off>",  "Converte o mosaico direto para luminância (1 canal)"},
+    {NULL, "--contrast",    "tone_contrast", "<lo:hi>", "Estica a faixa [lo, hi] para 0-255 (antes dos filtros)"},
+    {NULL, "--gamma",       "tone_gamma",  "<g>",       "Correção gama: saída = entrada^g (< 1 clareia)"},
+    {NULL, "--curve",       "tone_curve",  "<x:y,...>", "Curva de tons linear por partes, ex: 0:0,64:32,255:255"},
+    {NULL, "--invert",      "tone_invert", "<on|off>",  "Negativo da imagem"},
+    {NULL, "--clamp",       "tone_clamp",  "<lo:hi>",   "Limita a saída das operações pontuais a [lo, hi]"},
+    {NULL, "--remap",       "remap",       "<modo:p,...>", "Geometria do remap: lens:k1,k2[,cx,cy], perspective:x0,y0,...,x3,y3, polar:cx,cy,r0,r1"},
+    {NULL, "--remap-size",  "remap_size",  "<LxA>",     "Tamanho da saída do remap (padrão: origem; polar: 2πr1 x (r1-r0))"},
+    {NULL, "--golden",      "golden",      "<lista>",   "Referências do golden (uma por geometria), ex: placa.png,tampa.png"},
+    {NULL, "--golden-mask", "golden_mask", "<lista>",   "Tolerância por pixel de cada referência (cinza; 255 ignora a região)"},
+    {NULL, "--golden-threshold", "golden_threshold", "<0-255>", "Diferença de luminância além da tolerância que marca defeito"},
+    {NULL, "--color",       "color_spaces", "<lista>",  "Espaços do filtro color (planos de 1 canal): ycbcr,hsv,lab"},
+    {NULL, "--class",       "class",       "<classe>",  "Classe de cor nome:espaço:lo-hi,lo-hi,lo-hi (repetível, em ordem de prioridade), ex: vermelho:hsv:240-10,80-255,50-255"},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+// ============================================================
+// VALORES PADRÃO
+// ============================================================
+
+void config_init(pipeline_config_t *cfg) {
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->blur_radius = BLUR_KERNEL_SIZE / 2;
+    cfg->median_radius = MEDIAN_RADIUS;
+    cfg->resize_scale = RESIZE_SCALE;
+    cfg->resize_width = 0;
+    cfg->resize_height = 0;
+    cfg->resize_mode = RESIZE_MODE;
+    cfg->num_threads = NUM_THREADS;
+    cfg->filters = FILTERS_DEFAULT;
+    cfg->sobel_norm = SOBEL_NORM;
+    cfg->sobel_direction = 0;
+    cfg->threshold_mode = THRESHOLD_MODE;
+    cfg->threshold_value = THRESHOLD_VALUE;
+    cfg->threshold_radius = THRESHOLD_RADIUS;
+    cfg->threshold_c = THRESHOLD_C;
+    cfg->canny_low = CANNY_LOW;
+    cfg->canny_high = CANNY_HIGH;
+    cfg->morph_op = MORPH_OP;
+    cfg->morph_width = MORPH_SIZE;
+    cfg->morph_height = MORPH_SIZE;
+    cfg->morph_input = MORPH_INPUT_GRAY;
+    cfg->blob_min_area = BLOB_MIN_AREA;
+    cfg->num_templates = 0;
+    cfg->match_threshold = MATCH_THRESHOLD;
+    cfg->image_stats = IMAGE_STATS;
+    cfg->tone_gamma = 1.0;
+    cfg->tone_contrast_low = 0;
+    cfg->tone_contrast_high = 255;
+    cfg->tone_curve_points = 0;
+    cfg->tone_invert = 0;
+    cfg->tone_clamp_low = 0;
+    cfg->tone_clamp_high = 255;
+    cfg->bayer_pattern = BAYER_NONE;
+    cfg->demosaic_method = DEMOSAIC_BILINEAR;
+    cfg->bayer_gray = 0;
+    cfg->remap_mode = REMAP_NONE;
+    cfg->remap_num_params = 0;
+    cfg->remap_width = 0;
+    cfg->remap_height = 0;
+    cfg->num_golden_refs = 0;
+    cfg->num_golden_masks = 0;
+    cfg->golden_threshold = GOLDEN_THRESHOLD;
+    cfg->color_spaces = COLOR_SPACES_DEFAULT;
+}
+
+// ============================================================
+// PARÂMETROS POR NOME
+// ============================================================
+
+// Converte inteiro validando faixa [min, max]
+static int parse_int(const char *value, int min, int max, int *out) {
+    char *end;
+    errno = 0;
+    long v = strtol(value, &end, 10);
+    if (errno != 0 || end == value || *end != '\0' || v < min || v > max) {
+        return -1;
+    }
+    *out = (int)v;
+    return 0;
+}
+
+// Converte real validando faixa (min, max]
+static int parse_double(const char *value, double min, double max, double *out) {
+    char *end;
+    errno = 0;
+    double v = strtod(value, &end);
+    if (errno != 0 || end == value || *end != '\0' || v <= min || v > max) {
+        return -1;
+    }
+    *out = v;
+    return 0;
+}
+
+// "LxA" define tamanho fixo (0 em um eixo mantém a proporção); "f" define o fator
+static int parse_resize(pipeline_config_t *cfg, const char *value) {
+    const char *x = strchr(value, 'x');
+    if (!x) {
+        double scale;
+        if (parse_double(value, 0.0, 16.0, &scale) != 0) return -1;
+        cfg->resize_scale = scale;
+        cfg->resize_width = 0;
+        cfg->resize_height = 0;
+        return 0;
+    }
+
+    char w_str[16];
+    size_t len = (size_t)(x - value);
+    if (len == 0 || len >= sizeof(w_str)) return -1;
+    memcpy(w_str, value, len);
+    w_str[len] = '\0';
+
+    int w, h;
+    if (parse_int(w_str, 0, 65535, &w) != 0 || parse_int(x + 1, 0, 65535, &h) != 0) return -1;
+    if (w == 0 && h == 0) return -1;
+    cfg->resize_width = w;
+    cfg->resize_height = h;
+    return 0;
+}
+
+// "N" (quadrado) ou "LxA", lados ímpares em [1, MORPH_MAX_SIZE]
+static int parse_morph_size(pipeline_config_t *cfg, const char *value) {
+    int w, h;
+    const char *x = strchr(value, 'x');
+    if (!x) {
+        if (parse_int(value, 1, MORPH_MAX_SIZE, &w) != 0) return -1;
+        h = w;
+    } else {
+        char w_str[16];
+        size_t len = (size_t)(x - value);
+        if (len == 0 || len >= sizeof(w_str)) return -1;
+        memcpy(w_str, value, len);
+        w_str[len] = '\0';
+        if (parse_int(w_str, 1, MORPH_MAX_SIZE, &w) != 0 ||
+            parse_int(x + 1, 1, MORPH_MAX_SIZE, &h) != 0) return -1;
+    }
+    if (w % 2 == 0 || h % 2 == 0) return -1;
+    cfg->morph_width = w;
+    cfg->morph_height = h;
+    return 0;
+}
+
+// Lista de nomes separados por vírgula → máscara FILTER_BIT
+static int parse_filters(const char *value, unsigned int *mask) {
+    char buf[256];
+    if (strlen(value) >= sizeof(buf)) return -1;
+    strcpy(buf, value);
+
+    unsigned int m = 0;
+    char *saveptr;
+    for (char *tok = strtok_r(buf, ",", &saveptr); tok; tok = strtok_r(NULL, ",", &saveptr)) {
+        int type = 0;
+        while (type < FILTER_COUNT && strcmp(tok, get_filter_name(type)) != 0) type++;
+        if (type == FILTER_COUNT) return -1;
+        m |= FILTER_BIT(type);
+    }
+    if (m == 0) return -1;
+    *mask = m;
+    return 0;
+}
+
+// Nomes aceitos por parse_filters, separados por vírgula (mensagens de erro)
+static void filter_name_list(char *buf, size_t size) {
+    buf[0] = '\0';
+    for (int type = 0; type < FILTER_COUNT; type++) {
+        if (type > 0) strncat(buf, ",", size - strlen(buf) - 1);
+        strncat(buf, get_filter_name(type), size - strlen(buf) - 1);
+    }
+}
+
+// Espaços de cor separados por vírgula (ex: "hsv,lab")
+static int parse_color_spaces(const char *value, unsigned int *mask) {
+    char buf[64];
+    if (strlen(value) >= sizeof(buf)) return -1;
+    strcpy(buf, value);
+
+    unsigned int m = 0;
+    char *saveptr;
+    for (char *tok = strtok_r(buf, ",", &saveptr); tok; tok = strtok_r(NULL, ",", &saveptr)) {
+        int space = 0;
+        while (space < COLOR_SPACE_COUNT && strcmp(tok, color_space_name(space)) != 0) space++;
+        if (space == COLOR_SPACE_COUNT) return -1;
+        m |= COLOR_SPACE_BIT(space);
+    }
+    if (m == 0) return -1;
+    *mask = m;
+    return 0;
+}
+
+// Classe de cor "nome:espaço:lo-hi,lo-hi,lo-hi" (espaço rgb, ycbcr, hsv ou lab)
+static int parse_class(color_class_t *cls, const char *value) {
+    memset(cls, 0, sizeof(*cls));
+    const char *sep = strchr(value, ':');
+    if (!sep || sep == value || sep - value >= CLASS_NAME_LEN) return -1;
+    memcpy(cls->name, value, sep - value);
+
+    const char *ranges = strchr(sep + 1, ':');
+    if (!ranges) return -1;
+    size_t len = (size_t)(ranges - sep - 1);
+    cls->space = 0;
+    while (cls->space <= CLASS_SPACE_RGB &&
+           (strlen(class_space_name(cls->space)) != len ||
+            strncmp(sep + 1, class_space_name(cls->space), len) != 0)) {
+        cls->space++;
+    }
+    if (cls->space > CLASS_SPACE_RGB) return -1;
+
+    int lo[3], hi[3], end = 0;
+    if (sscanf(ranges + 1, "%d-%d,%d-%d,%d-%d%n", &lo[0], &hi[0], &lo[1], &hi[1],
+               &lo[2], &hi[2], &end) != 6 || ranges[1 + end] != '\0') {
+        return -1;
+    }
+    for (int k = 0; k < 3; k++) {
+        if (lo[k] < 0 || lo[k] > 255 || hi[k] < 0 || hi[k] > 255) return -1;
+        cls->lo[k] = (unsigned char)lo[k];
+        cls->hi[k] = (unsigned char)hi[k];
+    }
+    return 0;
+}
+
+// Caminhos separados por vírgula (até max)
+static int parse_paths(const char *value, char paths[][MAX_PATH], int max, int *count) {
+    int n = 0;
+    for (const char *p = value; *p; ) {
+        const char *end = strchr(p, ',');
+        size_t len = end ? (size_t)(end - p) : strlen(p);
+        if (len == 0 || len >= MAX_PATH || n == max) return -1;
+        memcpy(paths[n], p, len);
+        paths[n][len] = '\0';
+        n++;
+        p += len + (end ? 1 : 0);
+        if (end && *p == '\0') return -1;
+    }
+    if (n == 0) return -1;
+    *count = n;
+    return 0;
+}
+
+// "a:b" com a e b em [0, 255]
+static int parse_pair(const char *value, int *a, int *b) {
+    const char *colon = strchr(value, ':');
+    char a_str[16];
+    size_t len = colon ? (size_t)(colon - value) : 0;
+    if (!colon || len == 0 || len >= sizeof(a_str)) return -1;
+    memcpy(a_str, value, len);
+    a_str[len] = '\0';
+    return parse_int(a_str, 0, 255, a) == 0 && parse_int(colon + 1, 0, 255, b) == 0 ? 0 : -1;
+}
+
+// "x:y,x:y,..." (2 a TONE_MAX_CURVE pontos, x estritamente crescente)
+static int parse_curve(pipeline_config_t *cfg, const char *value) {
+    char buf[256];
+    if (strlen(value) >= sizeof(buf)) return -1;
+    strcpy(buf, value);
+
+    int n = 0;
+    char *saveptr;
+    for (char *tok = strtok_r(buf, ",", &saveptr); tok; tok = strtok_r(NULL, ",", &saveptr)) {
+        int x, y;
+        if (n == TONE_MAX_CURVE || parse_pair(tok, &x, &y) != 0) return -1;
+        if (n > 0 && x <= cfg->tone_curve[n - 1][0]) return -1;
+        cfg->tone_curve[n][0] = (unsigned char)x;
+        cfg->tone_curve[n][1] = (unsigned char)y;
+        n++;
+    }
+    if (n < 2) return -1;
+    cfg->tone_curve_points = n;
+    return 0;
+}
+
+// "modo:p1,p2,..." com a quantidade de parâmetros do modo (remap.h)
+static int parse_remap(pipeline_config_t *cfg, const char *value) {
+    const char *colon = strchr(value, ':');
+    if (!colon) return -1;
+
+    int mode = REMAP_LENS;
+    size_t len = (size_t)(colon - value);
+    while (mode <= REMAP_POLAR && (strlen(remap_mode_name(mode)) != len ||
+                                   strncmp(value, remap_mode_name(mode), len) != 0)) {
+        mode++;
+    }
+    if (mode > REMAP_POLAR) return -1;
+
+    double params[REMAP_MAX_PARAMS];
+    int n = 0;
+    const char *p = colon + 1;
+    while (1) {
+        char *end;
+        errno = 0;
+        double v = strtod(p, &end);
+        if (errno != 0 || end == p || !isfinite(v) || n == REMAP_MAX_PARAMS) return -1;
+        params[n++] = v;
+        if (*end == '\0') break;
+        if (*end != ',') return -1;
+        p = end + 1;
+    }
+
+    if (mode == REMAP_LENS) {
+        if (n != 2 && n != 4) return -1;
+        if (n == 2) {
+            // Centro óptico no centro da imagem
+            params[2] = -1.0;
+            params[3] = -1.0;
+        } else if (params[2] < 0.0 || params[3] < 0.0) {
+            return -1;
+        }
+    } else if (mode == REMAP_PERSPECTIVE) {
+        if (n != 8) return -1;
+    } else if (n != 4 || params[2] < 0.0 || params[3] <= params[2] || params[3] > REMAP_MAX_SIDE) {
+        return -1;
+    }
+
+    memset(cfg->remap_params, 0, sizeof(cfg->remap_params));
+    memcpy(cfg->remap_params, params, (size_t)(mode == REMAP_LENS ? 4 : n) * sizeof(double));
+    cfg->remap_mode = mode;
+    cfg->remap_num_params = n;
+    return 0;
+}
+
+static int parse_on_off(const char *value, int *out) {
+    if (strcmp(value, "on") == 0 || strcmp(value, "1") == 0) {
+        *out = 1;
+    } else if (strcmp(value, "off") == 0 || strcmp(value, "0") == 0) {
+        *out = 0;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+int config_set(pipeline_config_t *cfg, const char *key, const char *value) {
+    if (strcmp(key, "blur_radius") == 0) {
+        if (parse_int(value, 0, BLUR_MAX_RADIUS, &cfg->blur_radius) != 0) {
+            LOG_ERROR("blur_radius inválido: %s (0 a %d)", value, BLUR_MAX_RADIUS);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "median_radius") == 0) {
+        if (parse_int(value, 1, MEDIAN_MAX_RADIUS, &cfg->median_radius) != 0) {
+            LOG_ERROR("median_radius inválido: %s (1 a %d)", value, MEDIAN_MAX_RADIUS);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "resize") == 0) {
+        if (parse_resize(cfg, value) != 0) {
+            LOG_ERROR("resize inválido: %s (use LxA, ex: 640x640, ou um fator, ex: 0.5)", value);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "resize_mode") == 0) {
+        for (int m = RESIZE_NEAREST; m <= RESIZE_AREA; m++) {
+            if (strcmp(value, resize_mode_name((resize_mode_t)m)) == 0) {
+                cfg->resize_mode = m;
+                return 0;
+            }
+        }
+        LOG_ERROR("resize_mode inválido: %s (area, bilinear, nearest)", value);
+        return -1;
+    }
+
+    if (strcmp(key, "threads") == 0) {
+        if (parse_int(value, 1, POOL_MAX_THREADS, &cfg->num_threads) != 0) {
+            LOG_ERROR("threads inválido: %s (1 a %d)", value, POOL_MAX_THREADS);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "filters") == 0) {
+        if (parse_filters(value, &cfg->filters) != 0) {
+            char names[160];
+            filter_name_list(names, sizeof(names));
+            LOG_ERROR("filters inválido: %s (disponíveis: %s)", value, names);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "sobel_norm") == 0) {
+        if (strcmp(value, "l1") == 0) {
+            cfg->sobel_norm = SOBEL_L1;
+        } else if (strcmp(value, "l2") == 0) {
+            cfg->sobel_norm = SOBEL_L2;
+        } else {
+            LOG_ERROR("sobel_norm inválido: %s (l1, l2)", value);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "sobel_direction") == 0) {
+        if (parse_on_off(value, &cfg->sobel_direction) != 0) {
+            LOG_ERROR("sobel_direction inválido: %s (on, off)", value);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "threshold_mode") == 0) {
+        for (int m = THRESH_FIXED; m <= THRESH_OTSU; m++) {
+            if (strcmp(value, threshold_mode_name(m)) == 0) {
+                cfg->threshold_mode = m;
+                return 0;
+            }
+        }
+        LOG_ERROR("threshold_mode inválido: %s (fixed, mean, otsu)", value);
+        return -1;
+    }
+
+    if (strcmp(key, "threshold_value") == 0) {
+        if (parse_int(value, 0, 255, &cfg->threshold_value) != 0) {
+            LOG_ERROR("threshold inválido: %s (0 a 255)", value);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "threshold_radius") == 0) {
+        if (parse_int(value, 1, BLUR_MAX_RADIUS, &cfg->threshold_radius) != 0) {
+            LOG_ERROR("threshold_radius inválido: %s (1 a %d)", value, BLUR_MAX_RADIUS);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "threshold_c") == 0) {
+        if (parse_int(value, -255, 255, &cfg->threshold_c) != 0) {
+            LOG_ERROR("threshold_c inválido: %s (-255 a 255)", value);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "canny_low") == 0) {
+        if (parse_int(value, 0, CANNY_MAX_THRESHOLD, &cfg->canny_low) != 0) {
+            LOG_ERROR("canny_low inválido: %s (0 a %d)", value, CANNY_MAX_THRESHOLD);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "canny_high") == 0) {
+        if (parse_int(value, 0, CANNY_MAX_THRESHOLD, &cfg->canny_high) != 0) {
+            LOG_ERROR("canny_high inválido: %s (0 a %d)", value, CANNY_MAX_THRESHOLD);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "morph_op") == 0) {
+        for (int op = MORPH_ERODE; op <= MORPH_CLOSE; op++) {
+            if (strcmp(value, morph_op_name(op)) == 0) {
+                cfg->morph_op = op;
+                return 0;
+            }
+        }
+        LOG_ERROR("morph inválido: %s (erode, dilate, open, close)", value);
+        return -1;
+    }
+
+    if (strcmp(key, "morph_size") == 0) {
+        if (parse_morph_size(cfg, value) != 0) {
+            LOG_ERROR("morph_size inválido: %s (ímpar até %d, ex: 25 ou 25x9)", value, MORPH_MAX_SIZE);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "morph_input") == 0) {
+        if (strcmp(value, "gray") == 0) {
+            cfg->morph_input = MORPH_INPUT_GRAY;
+        } else if (strcmp(value, "binary") == 0) {
+            cfg->morph_input = MORPH_INPUT_BINARY;
+        } else {
+            LOG_ERROR("morph_input inválido: %s (gray, binary)", value);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "blob_min_area") == 0) {
+        if (parse_int(value, 1, INT_MAX, &cfg->blob_min_area) != 0) {
+            LOG_ERROR("blob_min_area inválido: %s (inteiro >= 1)", value);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "image_stats") == 0) {
+        if (parse_on_off(value, &cfg->image_stats) != 0) {
+            LOG_ERROR("image_stats inválido: %s (on, off)", value);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "calib_dark") == 0 || strcmp(key, "calib_flat") == 0) {
+        char *path = strcmp(key, "calib_dark") == 0 ? cfg->calib_dark : cfg->calib_flat;
+        if (value[0] == '\0' || strlen(value) >= MAX_PATH) {
+            LOG_ERROR("%s inválido: caminho vazio ou maior que %d", key, MAX_PATH - 1);
+            return -1;
+        }
+        strcpy(path, value);
+        return 0;
+    }
+
+    if (strcmp(key, "bayer_pattern") == 0) {
+        for (int pattern = BAYER_RGGB; pattern <= BAYER_GBRG; pattern++) {
+            if (strcmp(value, bayer_pattern_name(pattern)) == 0) {
+                cfg->bayer_pattern = pattern;
+                return 0;
+            }
+        }
+        LOG_ERROR("bayer inválido: %s (rggb, bggr, grbg, gbrg)", value);
+        return -1;
+    }
+
+    if (strcmp(key, "demosaic_method") == 0) {
+        if (strcmp(value, "bilinear") == 0) {
+            cfg->demosaic_method = DEMOSAIC_BILINEAR;
+        } else if (strcmp(value, "edge") == 0) {
+            cfg->demosaic_method = DEMOSAIC_EDGE;
+        } else {
+            LOG_ERROR("demosaic inválido: %s (bilinear, edge)", value);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "bayer_gray") == 0) {
+        if (parse_on_off(value, &cfg->bayer_gray) != 0) {
+            LOG_ERROR("bayer_gray inválido: %s (on, off)", value);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "tone_contrast") == 0) {
+        int lo, hi;
+        if (parse_pair(value, &lo, &hi) != 0 || lo >= hi) {
+            LOG_ERROR("contrast inválido: %s (lo:hi, 0 <= lo < hi <= 255)", value);
+            return -1;
+        }
+        cfg->tone_contrast_low = lo;
+        cfg->tone_contrast_high = hi;
+        return 0;
+    }
+
+    if (strcmp(key, "tone_gamma") == 0) {
+        if (parse_double(value, 0.0, 10.0, &cfg->tone_gamma) != 0) {
+            LOG_ERROR("gamma inválido: %s (0 < g <= 10)", value);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "tone_curve") == 0) {
+        if (parse_curve(cfg, value) != 0) {
+            LOG_ERROR("curve inválido: %s (2 a %d pontos x:y, x crescente)", value, TONE_MAX_CURVE);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "tone_invert") == 0) {
+        if (parse_on_off(value, &cfg->tone_invert) != 0) {
+            LOG_ERROR("invert inválido: %s (on, off)", value);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "tone_clamp") == 0) {
+        int lo, hi;
+        if (parse_pair(value, &lo, &hi) != 0 || lo > hi) {
+            LOG_ERROR("clamp inválido: %s (lo:hi, 0 <= lo <= hi <= 255)", value);
+            return -1;
+        }
+        cfg->tone_clamp_low = lo;
+        cfg->tone_clamp_high = hi;
+        return 0;
+    }
+
+    if (strcmp(key, "remap") == 0) {
+        if (parse_remap(cfg, value) != 0) {
+            LOG_ERROR("remap inválido: %s (lens:k1,k2[,cx,cy], perspective:8 coordenadas, "
+                      "polar:cx,cy,r0,r1 com 0 <= r0 < r1)", value);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "remap_size") == 0) {
+        const char *x = strchr(value, 'x');
+        char w_str[16];
+        size_t len = x ? (size_t)(x - value) : 0;
+        int w, h;
+        if (!x || len == 0 || len >= sizeof(w_str)) {
+            LOG_ERROR("remap_size inválido: %s (LxA, ex: 1280x720)", value);
+            return -1;
+        }
+        memcpy(w_str, value, len);
+        w_str[len] = '\0';
+        if (parse_int(w_str, 1, 65535, &w) != 0 || parse_int(x + 1, 1, 65535, &h) != 0) {
+            LOG_ERROR("remap_size inválido: %s (LxA, lados de 1 a 65535)", value);
+            return -1;
+        }
+        cfg->remap_width = w;
+        cfg->remap_height = h;
+        return 0;
+    }
+
+    if (strcmp(key, "templates") == 0) {
+        if (parse_paths(value, cfg->match_templates, MATCH_MAX_TEMPLATES,
+                        &cfg->num_templates) != 0) {
+            LOG_ERROR("templates inválido: %s (até %d caminhos separados por vírgula)",
+                      value, MATCH_MAX_TEMPLATES);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "match_threshold") == 0) {
+        if (parse_double(value, 0.0, 1.0, &cfg->match_threshold) != 0) {
+            LOG_ERROR("match_threshold inválido: %s (0 < t <= 1)", value);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "golden") == 0) {
+        if (parse_paths(value, cfg->golden_refs, GOLDEN_MAX_REFS, &cfg->num_golden_refs) != 0) {
+            LOG_ERROR("golden inválido: %s (até %d caminhos separados por vírgula)",
+                      value, GOLDEN_MAX_REFS);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "golden_mask") == 0) {
+        if (parse_paths(value, cfg->golden_masks, GOLDEN_MAX_REFS,
+                        &cfg->num_golden_masks) != 0) {
+            LOG_ERROR("golden_mask inválido: %s (até %d caminhos separados por vírgula)",
+                      value, GOLDEN_MAX_REFS);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "golden_threshold") == 0) {
+        if (parse_int(value, 0, 255, &cfg->golden_threshold) != 0) {
+            LOG_ERROR("golden_threshold inválido: %s (0 a 255)", value);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "class") == 0) {
+        if (cfg->num_classes == CLASS_MAX) {
+            LOG_ERROR("class: máximo de %d classes", CLASS_MAX);
+            return -1;
+        }
+        if (parse_class(&cfg->classes[cfg->num_classes], value) != 0) {
+            LOG_ERROR("class inválido: %s (nome:espaço:lo-hi,lo-hi,lo-hi; espaço rgb, ycbcr, "
+                      "hsv ou lab; 0 a 255)", value);
+            return -1;
+        }
+        cfg->num_classes++;
+        return 0;
+    }
+
+    if (strcmp(key, "color_spaces") == 0) {
+        if (parse_color_spaces(value, &cfg->color_spaces) != 0) {
+            LOG_ERROR("color_spaces inválido: %s (lista de ycbcr, hsv, lab)", value);
+            return -1;
+        }
+        return 0;
+    }
+
+    LOG_ERROR("Parâmetro desconhecido: %s", key);
+    return -1;
+}
+
+// ============================================================
+// LINHA DE COMANDO
+// ============================================================
+
+void config_print_usage(const char *prog) {
+    favis_print_version();
+    printf("\nUso: %s [opções]\n\n", prog);
+    printf("Opções:\n");
+    printf("  -v, --version              Mostra versão\n");
+    printf("  -h, --help                 Mostra esta ajuda\n");
+    for (const cli_option_t *opt = cli_options; opt->key; opt++) {
+        char names[48];
+        if (opt->short_name) {
+            snprintf(names, sizeof(names), "%s, %s %s", opt->short_name, opt->long_name, opt->arg);
+        } else {
+            snprintf(names, sizeof(names), "    %s %s", opt->long_name, opt->arg);
+        }
+        printf("  %-26s %s\n", names, opt->help);
+    }
+    printf("\nColoque imagens em '%s/' e execute sem argumentos.\n", INPUT_DIR);
+}
+
+int config_parse_args(pipeline_config_t *cfg, int argc, char *argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--version") == 0 || strcmp(argv[i], "-v") == 0) {
+            favis_print_version();
+            return 1;
+        }
+        if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+            config_print_usage(argv[0]);
+            return 1;
+        }
+
+        const cli_option_t *opt = cli_options;
+        while (opt->key && (!opt->short_name || strcmp(argv[i], opt->short_name) != 0) &&
+               strcmp(argv[i], opt->long_name) != 0) {
+            opt++;
+        }
+        if (!opt->key) {
+            LOG_ERROR("Opção desconhecida: %s (use --help)", argv[i]);
+            return -1;
+        }
+        if (i + 1 >= argc) {
+            LOG_ERROR("Opção %s requer argumento %s", argv[i], opt->arg);
+            return -1;
+        }
+        if (config_set(cfg, opt->key, argv[++i]) != 0) {
+            return -1;
+        }
+    }
+
+    if ((cfg->filters & FILTER_BIT(FILTER_MATCH)) && cfg->num_templates == 0) {
+        LOG_ERROR("Filtro match requer --templates");
+        return -1;
+    }
+    if ((cfg->filters & FILTER_BIT(FILTER_REMAP)) && cfg->remap_mode == REMAP_NONE) {
+        LOG_ERROR("Filtro remap requer --remap");
+        return -1;
+    }
+    if ((cfg->filters & FILTER_BIT(FILTER_GOLDEN)) && cfg->num_golden_refs == 0) {
+        LOG_ERROR("Filtro golden requer --golden");
+        return -1;
+    }
+    if (cfg->num_golden_masks > cfg->num_golden_refs) {
+        LOG_ERROR("--golden-mask com %d máscaras para %d referências",
+                  cfg->num_golden_masks, cfg->num_golden_refs);
+        return -1;
+    }
+    if ((cfg->filters & FILTER_BIT(FILTER_CLASSIFY)) && cfg->num_classes == 0) {
+        LOG_ERROR("Filtro classify requer --class");
+        return -1;
+    }
+    if (cfg->canny_low > cfg->canny_high) {
+        LOG_ERROR("--canny-low (%d) maior que --canny-high (%d)", cfg->canny_low, cfg->canny_high);
+        return -1;
+    }
+    return 0;
+}
+
+void config_print(const pipeline_config_t *cfg) {
+    char names[160] = "";
+    for (int type = 0; type < FILTER_COUNT; type++) {
+        if (!(cfg->filters & FILTER_BIT(type))) continue;
+        if (names[0]) strcat(names, ", ");
+        strcat(names, get_filter_name(type));
+    }
+    printf("  ├─ Filtros:     %s\n", names);
+    if (cfg->filters & FILTER_BIT(FILTER_BLUR)) {
+        printf("  ├─ Blur:        raio %d (kernel %dx%d)\n",
+               cfg->blur_radius, 2 * cfg->blur_radius + 1, 2 * cfg->blur_radius + 1);
+    }
+    if (cfg->filters & FILTER_BIT(FILTER_MEDIAN)) {
+        printf("  ├─ Mediana:     raio %d (janela %dx%d)\n",
+               cfg->median_radius, 2 * cfg->median_radius + 1, 2 * cfg->median_radius + 1);
+    }
+    if (cfg->filters & FILTER_BIT(FILTER_COLOR)) {
+        char spaces[32] = "";
+        for (int space = 0; space < COLOR_SPACE_COUNT; space++) {
+            if (!(cfg->color_spaces & COLOR_SPACE_BIT(space))) continue;
+            if (spaces[0]) strcat(spaces, ", ");
+            strcat(spaces, color_space_name(space));
+        }
+        printf("  ├─ Cor:         %s (um plano por componente)\n", spaces);
+    }
+    if (cfg->filters & FILTER_BIT(FILTER_CLASSIFY)) {
+        printf("  ├─ Classes:     %d, LUT %dx%dx%d:", cfg->num_classes, 1 << CLASS_LUT_BITS,
+               1 << CLASS_LUT_BITS, 1 << CLASS_LUT_BITS);
+        for (int c = 0; c < cfg->num_classes; c++) {
+            printf(" %s (%s)%s", cfg->classes[c].name, class_space_name(cfg->classes[c].space),
+                   c + 1 < cfg->num_classes ? "," : "\n");
+        }
+    }
+    if (cfg->filters & FILTER_BIT(FILTER_RESIZE)) {
+        if (cfg->resize_width > 0 || cfg->resize_height > 0) {
+            printf("  ├─ Resize:      %dx%d (%s)\n", cfg->resize_width, cfg->resize_height,
+                   resize_mode_name((resize_mode_t)cfg->resize_mode));
+        } else {
+            printf("  ├─ Resize:      fator %.3g (%s)\n", cfg->resize_scale,
+                   resize_mode_name((resize_mode_t)cfg->resize_mode));
+        }
+    }
+    if (cfg->filters & FILTER_BIT(FILTER_SOBEL)) {
+        printf("  ├─ Sobel:       %s%s\n", cfg->sobel_norm == SOBEL_L2 ? "L2" : "L1",
+               cfg->sobel_direction ? " + direção" : "");
+    }
+    if (cfg->filters & FILTER_BIT(FILTER_THRESHOLD)) {
+        if (cfg->threshold_mode == THRESH_FIXED) {
+            printf("  ├─ Threshold:   fixo %d\n", cfg->threshold_value);
+        } else if (cfg->threshold_mode == THRESH_MEAN) {
+            printf("  ├─ Threshold:   média local %dx%d - %d\n", 2 * cfg->threshold_radius + 1,
+                   2 * cfg->threshold_radius + 1, cfg->threshold_c);
+        } else {
+            printf("  ├─ Threshold:   Otsu\n");
+        }
+    }
+    if (cfg->filters & FILTER_BIT(FILTER_CANNY)) {
+        printf("  ├─ Canny:       histerese %d/%d\n", cfg->canny_low, cfg->canny_high);
+    }
+    if (cfg->filters & FILTER_BIT(FILTER_MORPH)) {
+        printf("  ├─ Morfologia:  %s %dx%d (%s)\n", morph_op_name(cfg->morph_op),
+               cfg->morph_width, cfg->morph_height,
+               cfg->morph_input == MORPH_INPUT_BINARY ? "binária" : "cinza");
+    }
+    if (cfg->filters & FILTER_BIT(FILTER_BLOBS)) {
+        printf("  ├─ Blobs:       8-vizinhança, área >= %d (máscara do %s)\n", cfg->blob_min_area,
+               (cfg->filters & FILTER_BIT(FILTER_MORPH)) && cfg->morph_input == MORPH_INPUT_BINARY ?
+               "morph" : "threshold");
+    }
+    if (cfg->calib_dark[0]) {
+        printf("  ├─ Dark frame:  %s\n", cfg->calib_dark);
+    }
+    if (cfg->calib_flat[0]) {
+        printf("  ├─ Flat-field:  %s\n", cfg->calib_flat);
+    }
+    if (cfg->bayer_pattern != BAYER_NONE) {
+        printf("  ├─ Bayer:       %s, demosaico %s%s\n", bayer_pattern_name(cfg->bayer_pattern),
+               demosaic_method_name(cfg->demosaic_method), cfg->bayer_gray ? " (luminância)" : "");
+    }
+    if (tone_enabled(cfg)) {
+        char ops[128] = "";
+        if (cfg->tone_contrast_low != 0 || cfg->tone_contrast_high != 255) {
+            snprintf(ops + strlen(ops), sizeof(ops) - strlen(ops), "contraste %d-%d, ",
+                     cfg->tone_contrast_low, cfg->tone_contrast_high);
+        }
+        if (cfg->tone_gamma != 1.0) {
+            snprintf(ops + strlen(ops), sizeof(ops) - strlen(ops), "gama %.3g, ", cfg->tone_gamma);
+        }
+        if (cfg->tone_curve_points > 0) {
+            snprintf(ops + strlen(ops), sizeof(ops) - strlen(ops), "curva de %d pontos, ",
+                     cfg->tone_curve_points);
+        }
+        if (cfg->tone_invert) {
+            snprintf(ops + strlen(ops), sizeof(ops) - strlen(ops), "negativo, ");
+        }
+        if (cfg->tone_clamp_low != 0 || cfg->tone_clamp_high != 255) {
+            snprintf(ops + strlen(ops), sizeof(ops) - strlen(ops), "limites %d-%d, ",
+                     cfg->tone_clamp_low, cfg->tone_clamp_high);
+        }
+        ops[strlen(ops) - 2] = '\0';
+        printf("  ├─ Tons (LUT):  %s\n", ops);
+    }
+    if (cfg->filters & FILTER_BIT(FILTER_REMAP)) {
+        char size[32] = "tamanho padrão";
+        if (cfg->remap_width > 0) {
+            snprintf(size, sizeof(size), "%dx%d", cfg->remap_width, cfg->remap_height);
+        }
+        char params[160] = "";
+        for (int i = 0; i < cfg->remap_num_params; i++) {
+            snprintf(params + strlen(params), sizeof(params) - strlen(params), "%s%g",
+                     i ? "," : "", cfg->remap_params[i]);
+        }
+        printf("  ├─ Remap:       %s %s (%s)\n", remap_mode_name(cfg->remap_mode), params, size);
+    }
+    if (cfg->image_stats) {
+        printf("  ├─ Estatísticas: por canal (média, desvio, mín/máx, histograma)\n");
+    }
+    if (cfg->filters & FILTER_BIT(FILTER_MATCH)) {
+        printf("  ├─ Match:       NCC >= %.2f, %d template(s)\n", cfg->match_threshold,
+               cfg->num_templates);
+    }
+    if (cfg->filters & FILTER_BIT(FILTER_GOLDEN)) {
+        printf("  ├─ Golden:      %d referência(s), %d máscara(s), diferença > %d\n",
+               cfg->num_golden_refs, cfg->num_golden_masks, cfg->golden_threshold);
+    }
+}
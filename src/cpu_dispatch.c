@@ -0,0 +1,89 @@
+#include "cpu_dispatch.h"
+
+#if FAVIS_X86
+#include <cpuid.h>
+#endif
+
+static simd_level_t detected_level = SIMD_SCALAR;
+static simd_level_t active_level = SIMD_SCALAR;
+static int initialized = 0;
+
+// ============================================================
+// DETECÇÃO DE CPU
+// ============================================================
+
+#if FAVIS_X86
+// Lê XCR0 para confirmar que o SO salva os registradores YMM
+static unsigned long long read_xcr0(void) {
+    unsigned int eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((unsigned long long)edx << 32) | eax;
+}
+
+static simd_level_t detect_x86(void) {
+    unsigned int eax, ebx, ecx, edx;
+
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return SIMD_SCALAR;
+    }
+
+    int has_sse2 = (edx >> 26) & 1;
+    int has_ssse3 = (ecx >> 9) & 1;
+    int has_osxsave = (ecx >> 27) & 1;
+    int has_avx = (ecx >> 28) & 1;
+
+    if (!has_sse2 || !has_ssse3) {
+        return SIMD_SCALAR;
+    }
+
+    // AVX2 exige suporte do SO (XMM + YMM habilitados em XCR0)
+    if (has_osxsave && has_avx && (read_xcr0() & 0x6) == 0x6) {
+        if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && ((ebx >> 5) & 1)) {
+            return SIMD_AVX2;
+        }
+    }
+
+    return SIMD_SSSE3;
+}
+#endif
+
+void cpu_dispatch_init(void) {
+    if (initialized) return;
+
+#if FAVIS_X86
+    detected_level = detect_x86();
+#else
+    detected_level = SIMD_SCALAR;
+#endif
+    active_level = detected_level;
+    initialized = 1;
+}
+
+// ============================================================
+// CONSULTA E CONFIGURAÇÃO
+// ============================================================
+
+simd_level_t cpu_detected_level(void) {
+    cpu_dispatch_init();
+    return detected_level;
+}
+
+simd_level_t cpu_simd_level(void) {
+    cpu_dispatch_init();
+    return active_level;
+}
+
+simd_level_t cpu_set_simd_level(simd_level_t level) {
+    cpu_dispatch_init();
+    active_level = (level > detected_level) ? detected_level : level;
+    return active_level;
+}
+
+const char* cpu_simd_name(simd_level_t level) {
+    switch (level) {
+        case SIMD_SCALAR: return "scalar";
+        case SIMD_SSSE3:  return "ssse3";
+        case SIMD_AVX2:   return "avx2";
+        default:          return "unknown";
+    }
+}
@@ -3,8 +3,21 @@
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 
 #include "filters.h"
+#include "simd_kernels.h"
+#include "planar.h"
+#include "resize.h"
 #include "stb_image.h"
 #include "stb_image_write.h"
+#include <math.h>
+
+// ============================================================
+// DESPACHO DE KERNELS SIMD
+// ============================================================
+
+void filters_init(void) {
+    cpu_dispatch_init();
+    simd_kernels_select(cpu_simd_level());
+}
 
 // ============================================================
 // CARREGAMENTO E SALVAMENTO DE IMAGENS
@@ -45,11 +58,124 @@ void free_image(unsigned char *data) {
     }
 }
 
+int image_is_16_bit(const char *filename) {
+    return stbi_is_16_bit(filename);
+}
+
+uint16_t* load_image_16(const char *filename, int *width, int *height, int *channels) {
+    uint16_t *data = stbi_load_16(filename, width, height, channels, 0);
+    if (!data) {
+        LOG_ERROR("Falha ao carregar: %s - %s", filename, stbi_failure_reason());
+    }
+    return data;
+}
+
+// Chunk PNG: comprimento, tipo, dados e CRC (tipo + dados), big-endian
+static void png_put_u32(unsigned char *p, uint32_t v) {
+    p[0] = (unsigned char)(v >> 24);
+    p[1] = (unsigned char)(v >> 16);
+    p[2] = (unsigned char)(v >> 8);
+    p[3] = (unsigned char)v;
+}
+
+static int png_write_chunk(FILE *f, const char *type, const unsigned char *data, int len) {
+    unsigned char *buf = (unsigned char*)malloc((size_t)len + 12);
+    if (!buf) return -1;
+    png_put_u32(buf, (uint32_t)len);
+    memcpy(buf + 4, type, 4);
+    if (len) memcpy(buf + 8, data, (size_t)len);
+    png_put_u32(buf + 8 + len, stbiw__crc32(buf + 4, len + 4));
+    int ok = fwrite(buf, 1, (size_t)len + 12, f) == (size_t)len + 12;
+    free(buf);
+    return ok ? 0 : -1;
+}
+
+int save_image_16(const char *filename, const uint16_t *data, int width, int height,
+                  int channels) {
+    // stb_image_write só gera PNG de 8 bits: linhas montadas aqui (amostras
+    // big-endian, filtro Sub) e comprimidas pelo zlib do próprio stb
+    static const unsigned char color_type[MAX_CHANNELS + 1] = { 0, 0, 4, 2, 6 };
+    if (channels < 1 || channels > MAX_CHANNELS) {
+        LOG_ERROR("Falha ao salvar: %s (%d canais)", filename, channels);
+        return -1;
+    }
+
+    const int bpp = 2 * channels;
+    const size_t row_bytes = (size_t)width * bpp;
+    unsigned char *filt = (unsigned char*)malloc((row_bytes + 1) * height);
+    unsigned char *raw = (unsigned char*)malloc(row_bytes);
+    if (!filt || !raw) {
+        free(filt);
+        free(raw);
+        LOG_ERROR("Falha ao alocar memória para PNG de 16 bits");
+        return -1;
+    }
+
+    for (int y = 0; y < height; y++) {
+        const uint16_t *src = data + (size_t)y * width * channels;
+        for (size_t i = 0; i < (size_t)width * channels; i++) {
+            raw[2 * i] = (unsigned char)(src[i] >> 8);
+            raw[2 * i + 1] = (unsigned char)src[i];
+        }
+        // Sub: diferença para o mesmo byte do pixel à esquerda
+        unsigned char *out = filt + (size_t)y * (row_bytes + 1);
+        out[0] = 1;
+        memcpy(out + 1, raw, (size_t)bpp);
+        for (size_t i = bpp; i < row_bytes; i++) {
+            out[1 + i] = (unsigned char)(raw[i] - raw[i - bpp]);
+        }
+    }
+    free(raw);
+
+    int zlen = 0;
+    unsigned char *zlib = stbi_zlib_compress(filt, (int)((row_bytes + 1) * height), &zlen,
+                                             stbi_write_png_compression_level);
+    free(filt);
+    if (!zlib) {
+        LOG_ERROR("Falha ao comprimir: %s", filename);
+        return -1;
+    }
+
+    unsigned char ihdr[13];
+    png_put_u32(ihdr, (uint32_t)width);
+    png_put_u32(ihdr + 4, (uint32_t)height);
+    ihdr[8] = 16;
+    ihdr[9] = color_type[channels];
+    ihdr[10] = ihdr[11] = ihdr[12] = 0;
+
+    static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    FILE *f = fopen(filename, "wb");
+    int ok = f && fwrite(signature, 1, sizeof(signature), f) == sizeof(signature) &&
+             png_write_chunk(f, "IHDR", ihdr, sizeof(ihdr)) == 0 &&
+             png_write_chunk(f, "IDAT", zlib, zlen) == 0 &&
+             png_write_chunk(f, "IEND", NULL, 0) == 0;
+    if (f && fclose(f) != 0) ok = 0;
+    STBIW_FREE(zlib);
+
+    if (!ok) {
+        LOG_ERROR("Falha ao salvar: %s", filename);
+        return -1;
+    }
+    return 0;
+}
+
 const char* get_filter_name(int filter_type) {
     switch (filter_type) {
         case FILTER_GRAYSCALE: return "grayscale";
         case FILTER_BLUR:      return "blur";
         case FILTER_RESIZE:    return "resize";
+        case FILTER_SOBEL:     return "sobel";
+        case FILTER_THRESHOLD: return "threshold";
+        case FILTER_CANNY:     return "canny";
+        case FILTER_MORPH:     return "morph";
+        case FILTER_BLOBS:     return "blobs";
+        case FILTER_MATCH:     return "match";
+        case FILTER_PYRAMID:   return "pyramid";
+        case FILTER_REMAP:     return "remap";
+        case FILTER_GOLDEN:    return "golden";
+        case FILTER_MEDIAN:    return "median";
+        case FILTER_COLOR:     return "color";
+        case FILTER_CLASSIFY:  return "classify";
         default:               return "unknown";
     }
 }
@@ -58,170 +184,790 @@ const char* get_filter_name(int filter_type) {
 // IMPLEMENTAÇÃO DOS FILTROS
 // ============================================================
 
+void grayscale_rows(const unsigned char *src, unsigned char *dst, int n, int channels) {
+    // Só faz sentido se tiver RGB ou RGBA; demais formatos são copiados
+    if (channels < 3) {
+        if (src != dst) memcpy(dst, src, (size_t)n * channels);
+        return;
+    }
+    
+    // Luminância em ponto fixo: (9798R + 19235G + 3735B) >> 15
+    if (channels == 3) {
+        g_kernels.gray_row_rgb(src, dst, n);
+    } else {
+        // Alpha (se existir) permanece inalterado
+        g_kernels.gray_row_rgba(src, dst, n);
+    }
+}
+
+void luma_rows(const unsigned char *src, unsigned char *dst, int n, int channels) {
+    switch (channels) {
+        case 1: memcpy(dst, src, n); break;
+        case 3: g_kernels.gray_plane_rgb(src, dst, n); break;
+        case 4: g_kernels.gray_plane_rgba(src, dst, n); break;
+        default:
+            // Cinza + alpha: luminância é o primeiro canal
+            for (int i = 0; i < n; i++) dst[i] = src[i * channels];
+            break;
+    }
+}
+
 void apply_grayscale(unsigned char *image, int width, int height, int channels) {
-    // Só faz sentido se tiver RGB ou RGBA
-    if (channels < 3) return;
+    // Imagem contígua: converte todos os pixels em uma única chamada
+    grayscale_rows(image, image, width * height, channels);
+}
+
+// ------------------------------------------------------------
+// Box blur separável
+// ------------------------------------------------------------
+// Passo horizontal: soma deslizante por linha (uint16, kernel <= 257).
+// Passo vertical: soma por coluna atualizada com +linha nova -linha antiga.
+// Bordas usam a média dos pixels válidos (janela truncada); são tratadas
+// em prólogo/epílogo para que o laço interno não tenha desvios.
+// Cada canal é um plano contíguo: o passo horizontal é uma única soma
+// deslizante por plano e o vertical cobre os planos da linha de uma vez.
+
+// Soma horizontal de um plano: janela [x-r, x+r] ∩ [0, width-1]
+static inline void blur_hsum_plane(const unsigned char *src, uint16_t *dst, int width, int radius) {
+    int sum = 0;
+    
+    int first = MIN(radius, width - 1);
+    for (int x = 0; x <= first; x++) sum += src[x];
+    dst[0] = (uint16_t)sum;
     
+    // Para x em [1, width): src[x+r] entra se x < add_end, src[x-r-1] sai se x >= sub_begin
+    const int add_end = width - radius;
+    const int sub_begin = radius + 1;
+    int x = 1;
+    
+    // Prólogo: janela crescendo
+    for (; x < MIN(add_end, sub_begin) && x < width; x++) {
+        sum += src[x + radius];
+        dst[x] = (uint16_t)sum;
+    }
+    
+    // Interior: janela completa, sem desvios (plano contíguo: kernel SIMD)
+    if (x < add_end) {
+        sum = g_kernels.blur_hsum_row(src + x - radius - 1, 2 * radius + 1, dst + x,
+                                      add_end - x, (uint16_t)sum);
+        x = add_end;
+    }
+    
+    // Janela maior que a linha: cobre tudo
+    for (; x < sub_begin && x < width; x++) dst[x] = (uint16_t)sum;
+    
+    // Epílogo: janela encolhendo
+    for (; x < width; x++) {
+        sum -= src[x - radius - 1];
+        dst[x] = (uint16_t)sum;
+    }
+}
+
+static inline uint16_t* blur_ring_row(const blur_stream_t *bs, int y) {
+    return bs->ring + (size_t)(y % bs->ring_rows) * bs->stride * bs->channels;
+}
+
+// Média arredondada de uma coluna da borda (janela horizontal truncada)
+static inline unsigned char blur_border_mean(const blur_stream_t *bs, uint32_t sum,
+                                             int x, uint32_t cy) {
+    uint32_t area = (uint32_t)(MIN(x + bs->radius, bs->width - 1) -
+                               MAX(0, x - bs->radius) + 1) * cy;
+    return (unsigned char)((sum + area / 2) / area);
+}
+
+// Normaliza um plano de colsum pela área da janela: (soma + área/2) / área
+static inline void blur_emit_plane(const blur_stream_t *bs, const uint32_t *sum,
+                                   unsigned char *dst, uint32_t cy) {
+    // Colunas da borda esquerda
+    for (int x = 0; x < bs->col_begin; x++) {
+        dst[x] = blur_border_mean(bs, sum[x], x, cy);
+    }
+    
+    // Interior: área constante (2r+1) × altura da janela
+    int n = bs->col_end - bs->col_begin;
+    if (n > 0) {
+        g_kernels.blur_scale_row(sum + bs->col_begin, dst + bs->col_begin, n,
+                                 (uint32_t)(2 * bs->radius + 1) * cy);
+    }
+    
+    // Colunas da borda direita
+    for (int x = bs->col_end; x < bs->width; x++) {
+        dst[x] = blur_border_mean(bs, sum[x], x, cy);
+    }
+}
+
+// Variantes por número de canais: laço de planos desenrolado e kernel de
+// reintercalação resolvido em compilação. Escolhidas uma vez por stream.
+#define BLUR_ROW_TEMPLATE(C)                                                    \
+static void blur_hsum_c##C(const blur_stream_t *bs, const unsigned char *row,   \
+                           uint16_t *h) {                                       \
+    for (int ch = 0; ch < (C); ch++) {                                          \
+        blur_hsum_plane(row + ch * bs->stride, h + ch * bs->stride,             \
+                        bs->width, bs->radius);                                 \
+    }                                                                           \
+}                                                                               \
+static void blur_emit_c##C(const blur_stream_t *bs, unsigned char *out) {       \
+    const uint32_t cy = (uint32_t)(bs->win_hi - bs->win_lo + 1);                \
+    for (int ch = 0; ch < (C); ch++) {                                          \
+        blur_emit_plane(bs, bs->colsum + ch * bs->stride,                       \
+                        (C) == 1 ? out : bs->out_planes + ch * bs->stride, cy); \
+    }                                                                           \
+    if ((C) > 1) planar_merge_row(bs->out_planes, out, bs->width, (C));         \
+}
+
+BLUR_ROW_TEMPLATE(1)
+BLUR_ROW_TEMPLATE(2)
+BLUR_ROW_TEMPLATE(3)
+BLUR_ROW_TEMPLATE(4)
+
+struct blur_row_ops_s {
+    void (*hsum)(const blur_stream_t *bs, const unsigned char *row, uint16_t *h);
+    void (*emit)(const blur_stream_t *bs, unsigned char *out);
+};
+
+static const blur_row_ops_t blur_row_ops[MAX_CHANNELS + 1] = {
+    { NULL, NULL },
+    { blur_hsum_c1, blur_emit_c1 },
+    { blur_hsum_c2, blur_emit_c2 },
+    { blur_hsum_c3, blur_emit_c3 },
+    { blur_hsum_c4, blur_emit_c4 },
+};
+
+int blur_stream_init(blur_stream_t *bs, int width, int height, int channels,
+                     int radius, int out_begin, int out_end) {
+    memset(bs, 0, sizeof(*bs));
+    if (radius < 0) radius = 0;
+    if (radius > BLUR_MAX_RADIUS) radius = BLUR_MAX_RADIUS;
+    
+    bs->width = width;
+    bs->height = height;
+    bs->channels = channels;
+    bs->radius = radius;
+    bs->out_begin = out_begin;
+    bs->out_end = out_end;
+    bs->in_begin = MAX(0, out_begin - radius);
+    bs->in_end = MIN(height, out_end + radius);
+    bs->next_out = out_begin;
+    bs->win_lo = bs->in_begin;
+    bs->win_hi = bs->in_begin - 1;
+    bs->ring_rows = 2 * radius + 2;
+    bs->col_begin = MIN(radius, width);
+    bs->col_end = MAX(bs->col_begin, width - radius);
+    bs->stride = planar_stride(width);
+    bs->ops = &blur_row_ops[channels];
+    
+    // Preenchimento zerado: somas verticais cobrem a linha inteira de planos
+    size_t row_elems = bs->stride * channels;
+    bs->ring = (uint16_t*)planar_alloc(bs->ring_rows * row_elems * sizeof(uint16_t));
+    bs->colsum = (uint32_t*)planar_alloc(row_elems * sizeof(uint32_t));
+    if (channels > 1) bs->out_planes = (unsigned char*)planar_alloc(row_elems);
+    if (!bs->ring || !bs->colsum || (channels > 1 && !bs->out_planes)) {
+        LOG_ERROR("Falha ao alocar memória para blur");
+        blur_stream_free(bs);
+        return -1;
+    }
+    return 0;
+}
+
+void blur_stream_push(blur_stream_t *bs, const unsigned char *row, int y, unsigned char *dst) {
+    if (y < bs->in_begin || y >= bs->in_end) return;
+    
+    const int n = (int)(bs->stride * bs->channels);
+    uint16_t *h = blur_ring_row(bs, y);
+    bs->ops->hsum(bs, row, h);
+    
+    // Regime permanente: a linha que entra e a que sai são aplicadas juntas
+    int lo = MAX(0, bs->next_out - bs->radius);
+    int ready = bs->next_out < bs->out_end && MIN(bs->height - 1, bs->next_out + bs->radius) <= y;
+    if (ready && bs->win_lo < lo && bs->win_lo <= bs->win_hi) {
+        g_kernels.blur_addsub_row(bs->colsum, h, blur_ring_row(bs, bs->win_lo), n);
+        bs->win_lo++;
+    } else {
+        for (int i = 0; i < n; i++) bs->colsum[i] += h[i];
+    }
+    bs->win_hi = y;
+    
+    // Emite todas as linhas cuja janela vertical está completa
+    const size_t out_bytes = (size_t)bs->width * bs->channels;
+    while (bs->next_out < bs->out_end &&
+           MIN(bs->height - 1, bs->next_out + bs->radius) <= bs->win_hi) {
+        lo = MAX(0, bs->next_out - bs->radius);
+        while (bs->win_lo < lo) {
+            const uint16_t *old = blur_ring_row(bs, bs->win_lo);
+            for (int i = 0; i < n; i++) bs->colsum[i] -= old[i];
+            bs->win_lo++;
+        }
+        bs->ops->emit(bs, dst + (size_t)bs->next_out * out_bytes);
+        bs->next_out++;
+    }
+}
+
+void blur_stream_free(blur_stream_t *bs) {
+    free(bs->ring);
+    free(bs->colsum);
+    free(bs->out_planes);
+    bs->ring = NULL;
+    bs->colsum = NULL;
+    bs->out_planes = NULL;
+}
+
+int apply_blur(const unsigned char *src, unsigned char *dst, int width, int height,
+               int channels, int radius) {
+    blur_stream_t bs;
+    if (blur_stream_init(&bs, width, height, channels, radius, 0, height) != 0) {
+        return -1;
+    }
+    unsigned char *planes = NULL;
+    if (channels > 1 && !(planes = (unsigned char*)planar_alloc(bs.stride * channels))) {
+        LOG_ERROR("Falha ao alocar memória para blur");
+        blur_stream_free(&bs);
+        return -1;
+    }
+    
+    size_t stride = (size_t)width * channels;
     for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            int idx = (y * width + x) * channels;
-            
-            // Luminância: 0.299R + 0.587G + 0.114B
-            unsigned char r = image[idx];
-            unsigned char g = image[idx + 1];
-            unsigned char b = image[idx + 2];
-            unsigned char gray = (unsigned char)(0.299 * r + 0.587 * g + 0.114 * b);
-            
-            image[idx] = gray;
-            image[idx + 1] = gray;
-            image[idx + 2] = gray;
-            // Alpha (se existir) permanece inalterado
+        const unsigned char *row = src + y * stride;
+        if (planes) {
+            planar_split_row(row, planes, width, channels);
+            row = planes;
+        }
+        blur_stream_push(&bs, row, y, dst);
+    }
+    
+    free(planes);
+    blur_stream_free(&bs);
+    return 0;
+}
+
+// ------------------------------------------------------------
+// Mediana
+// ------------------------------------------------------------
+// Histogramas de coluna (Perreault/Hébert): grosso de 16 faixas e fino de
+// 256 níveis, por canal. O fino é guardado segmento a segmento (16 níveis
+// de todas as colunas, depois os 16 seguintes): cada segmento de coluna é
+// uma soma vetorial e o kernel, ao deslizar a janela dentro de um
+// segmento, percorre colunas vizinhas em memória contígua. Atualizar uma
+// coluna custa duas contagens por pixel.
+
+static inline unsigned char* median_ring_row(const median_stream_t *ms, int y) {
+    return ms->ring + (size_t)(y % ms->ring_rows) * ms->stride * ms->channels;
+}
+
+// Soma (delta = 1) ou retira (delta = -1) uma linha dos histogramas de coluna
+static void median_hist_row(median_stream_t *ms, const unsigned char *row, int delta) {
+    for (int ch = 0; ch < ms->channels; ch++) {
+        const unsigned char *src = row + ch * ms->stride;
+        uint16_t *fine = ms->fine + (size_t)ch * ms->width * 256;
+        uint16_t *coarse = ms->coarse + (size_t)ch * ms->width * 16;
+        for (int x = 0; x < ms->width; x++) {
+            fine[((src[x] >> 4) * ms->width + x) * 16 + (src[x] & 15)] += delta;
+            coarse[x * 16 + (src[x] >> 4)] += delta;
         }
     }
 }
 
-void apply_blur(unsigned char *src, unsigned char *dst, int width, int height, int channels) {
-    // Box blur 3x3
+int median_stream_init(median_stream_t *ms, int width, int height, int channels,
+                       int radius, int out_begin, int out_end) {
+    memset(ms, 0, sizeof(*ms));
+    if (radius < 0) radius = 0;
+    if (radius > MEDIAN_MAX_RADIUS) radius = MEDIAN_MAX_RADIUS;
+
+    ms->width = width;
+    ms->height = height;
+    ms->channels = channels;
+    ms->radius = radius;
+    ms->out_begin = out_begin;
+    ms->out_end = out_end;
+    ms->in_begin = MAX(0, out_begin - radius);
+    ms->in_end = MIN(height, out_end + radius);
+    ms->next_out = out_begin;
+    ms->win_lo = ms->in_begin;
+    ms->win_hi = ms->in_begin - 1;
+    ms->ring_rows = 2 * radius + 2;
+    ms->stride = planar_stride(width);
+
+    // Histogramas zerados: nenhuma linha na janela
+    size_t cols = (size_t)width * channels;
+    ms->ring = (unsigned char*)planar_alloc(ms->ring_rows * ms->stride * channels);
+    ms->fine = (uint16_t*)planar_alloc(cols * 256 * sizeof(uint16_t));
+    ms->coarse = (uint16_t*)planar_alloc(cols * 16 * sizeof(uint16_t));
+    if (channels > 1) ms->out_planes = (unsigned char*)planar_alloc(ms->stride * channels);
+    if (!ms->ring || !ms->fine || !ms->coarse || (channels > 1 && !ms->out_planes)) {
+        LOG_ERROR("Falha ao alocar memória para mediana");
+        median_stream_free(ms);
+        return -1;
+    }
+    return 0;
+}
+
+void median_stream_push(median_stream_t *ms, const unsigned char *row, int y,
+                        unsigned char *dst) {
+    if (y < ms->in_begin || y >= ms->in_end) return;
+
+    // Com 1 canal a linha pode ser a própria origem: copia só 'width' bytes
+    unsigned char *kept = median_ring_row(ms, y);
+    for (int ch = 0; ch < ms->channels; ch++) {
+        memcpy(kept + ch * ms->stride, row + ch * ms->stride, ms->width);
+    }
+    median_hist_row(ms, row, 1);
+    ms->win_hi = y;
+
+    // Emite todas as linhas cuja janela vertical está completa
+    const size_t out_bytes = (size_t)ms->width * ms->channels;
+    while (ms->next_out < ms->out_end &&
+           MIN(ms->height - 1, ms->next_out + ms->radius) <= ms->win_hi) {
+        int lo = MAX(0, ms->next_out - ms->radius);
+        while (ms->win_lo < lo) {
+            median_hist_row(ms, median_ring_row(ms, ms->win_lo), -1);
+            ms->win_lo++;
+        }
+
+        unsigned char *out = dst + (size_t)ms->next_out * out_bytes;
+        const int rows = ms->win_hi - ms->win_lo + 1;
+        for (int ch = 0; ch < ms->channels; ch++) {
+            g_kernels.median_row(ms->fine + (size_t)ch * ms->width * 256,
+                                 ms->coarse + (size_t)ch * ms->width * 16,
+                                 ms->channels == 1 ? out : ms->out_planes + ch * ms->stride,
+                                 ms->width, ms->radius, rows);
+        }
+        if (ms->channels > 1) planar_merge_row(ms->out_planes, out, ms->width, ms->channels);
+        ms->next_out++;
+    }
+}
+
+void median_stream_free(median_stream_t *ms) {
+    free(ms->ring);
+    free(ms->fine);
+    free(ms->coarse);
+    free(ms->out_planes);
+    ms->ring = NULL;
+    ms->fine = NULL;
+    ms->coarse = NULL;
+    ms->out_planes = NULL;
+}
+
+int apply_median(const unsigned char *src, unsigned char *dst, int width, int height,
+                 int channels, int radius) {
+    median_stream_t ms;
+    if (median_stream_init(&ms, width, height, channels, radius, 0, height) != 0) {
+        return -1;
+    }
+    unsigned char *planes = NULL;
+    if (channels > 1 && !(planes = (unsigned char*)planar_alloc(ms.stride * channels))) {
+        LOG_ERROR("Falha ao alocar memória para mediana");
+        median_stream_free(&ms);
+        return -1;
+    }
+
+    size_t stride = (size_t)width * channels;
     for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            for (int c = 0; c < channels; c++) {
-                int sum = 0;
-                int count = 0;
-                
-                // Kernel 3x3
-                for (int ky = -1; ky <= 1; ky++) {
-                    for (int kx = -1; kx <= 1; kx++) {
-                        int ny = y + ky;
-                        int nx = x + kx;
-                        
-                        // Verifica limites
-                        if (ny >= 0 && ny < height && nx >= 0 && nx < width) {
-                            int idx = (ny * width + nx) * channels + c;
-                            sum += src[idx];
-                            count++;
-                        }
-                    }
-                }
-                
-                int dst_idx = (y * width + x) * channels + c;
-                dst[dst_idx] = (unsigned char)(sum / count);
+        const unsigned char *row = src + y * stride;
+        if (planes) {
+            planar_split_row(row, planes, width, channels);
+            row = planes;
+        }
+        median_stream_push(&ms, row, y, dst);
+    }
+
+    free(planes);
+    median_stream_free(&ms);
+    return 0;
+}
+
+// ------------------------------------------------------------
+// Morfologia
+// ------------------------------------------------------------
+// van Herk/Gil-Werman: a sequência de linhas é dividida em blocos de
+// k = 2r+1. Toda janela de k linhas cobre o sufixo de um bloco e o
+// prefixo do seguinte, então cada saída é op(sufixo, prefixo): cerca de
+// 3 operações por pixel para qualquer k. As linhas são combinadas
+// inteiras com os kernels de min/max; o passo horizontal transpõe
+// blocos de MORPH_CHUNK_ROWS linhas e reaplica o mesmo passo.
+
+#define MORPH_CHUNK_ROWS    32      // Bloco transposto e saída cabem no L2
+
+// Sequência de linhas de entrada; fora de [lo, hi) vale a linha neutra
+typedef struct {
+    const unsigned char *base;  // Linha 'lo'
+    size_t stride;
+    int lo, hi;
+    const unsigned char *ident; // 255 na erosão, 0 na dilatação
+} morph_lines_t;
+
+typedef struct {
+    int width, rx, ry;
+    unsigned char *suffix;      // k linhas (sufixos do bloco atual)
+    unsigned char *prefix;      // Prefixo acumulado do bloco seguinte
+    unsigned char *ident;
+    unsigned char *cols;        // Bloco transposto (width × MORPH_CHUNK_ROWS)
+    unsigned char *cols_out;
+} morph_scratch_t;
+
+static inline const unsigned char* morph_line(const morph_lines_t *in, int v) {
+    if (v < in->lo || v >= in->hi) return in->ident;
+    return in->base + (size_t)(v - in->lo) * in->stride;
+}
+
+// Linhas [out_begin, out_end) de min/max na janela vertical de raio r.
+// dst aponta para a linha out_begin
+static void morph_vhgw(const morph_lines_t *in, unsigned char *dst, size_t dst_stride,
+                       int n, int r, morph_row_fn op, int out_begin, int out_end,
+                       morph_scratch_t *s) {
+    const int k = 2 * r + 1;
+    const int count = out_end - out_begin;
+
+    for (int base = 0; base < count; base += k) {
+        int b0 = out_begin - r + base;      // Bloco [b0, b0 + k)
+
+        // suffix[t] = op das linhas b0+t .. b0+k-1
+        memcpy(s->suffix + (size_t)(k - 1) * n, morph_line(in, b0 + k - 1), n);
+        for (int t = k - 2; t >= 0; t--) {
+            op(morph_line(in, b0 + t), s->suffix + (size_t)(t + 1) * n,
+               s->suffix + (size_t)t * n, n);
+        }
+        memcpy(dst + (size_t)base * dst_stride, s->suffix, n);
+
+        // Janela deslocada de t: sufixo a partir de t + prefixo de t linhas
+        const unsigned char *prefix = NULL;
+        for (int t = 1; t < k && base + t < count; t++) {
+            const unsigned char *line = morph_line(in, b0 + k + t - 1);
+            if (t == 1) {
+                prefix = line;
+            } else {
+                op(prefix, line, s->prefix, n);
+                prefix = s->prefix;
             }
+            op(s->suffix + (size_t)t * n, prefix, dst + (size_t)(base + t) * dst_stride, n);
         }
     }
 }
 
-void apply_resize(unsigned char *src, int src_w, int src_h, int channels,
-                  unsigned char **dst, int *dst_w, int *dst_h) {
-    // Reduz para 50%
-    *dst_w = src_w / 2;
-    *dst_h = src_h / 2;
-    
-    if (*dst_w < 1) *dst_w = 1;
-    if (*dst_h < 1) *dst_h = 1;
-    
-    *dst = (unsigned char*)malloc((*dst_w) * (*dst_h) * channels);
+// Passo horizontal no lugar sobre 'rows' linhas de buf
+static void morph_horizontal(unsigned char *buf, int rows, morph_row_fn op, morph_scratch_t *s) {
+    const int w = s->width;
+    for (int c0 = 0; c0 < rows; c0 += MORPH_CHUNK_ROWS) {
+        int n = MIN(MORPH_CHUNK_ROWS, rows - c0);
+        unsigned char *chunk = buf + (size_t)c0 * w;
+        g_kernels.transpose_u8(chunk, w, s->cols, MORPH_CHUNK_ROWS, n, w);
+
+        morph_lines_t in = { s->cols, MORPH_CHUNK_ROWS, 0, w, s->ident };
+        morph_vhgw(&in, s->cols_out, MORPH_CHUNK_ROWS, n, s->rx, op, 0, w, s);
+
+        g_kernels.transpose_u8(s->cols_out, MORPH_CHUNK_ROWS, chunk, w, w, n);
+    }
+}
+
+// Erosão/dilatação das linhas [out_begin, out_end) de 'in' para dst
+static void morph_pass(const morph_lines_t *in, unsigned char *dst, int erode,
+                       int out_begin, int out_end, morph_scratch_t *s) {
+    morph_row_fn op = erode ? g_kernels.morph_min_row : g_kernels.morph_max_row;
+    memset(s->ident, erode ? 255 : 0, MAX(s->width, MORPH_CHUNK_ROWS));
+    morph_vhgw(in, dst, s->width, s->width, s->ry, op, out_begin, out_end, s);
+    morph_horizontal(dst, out_end - out_begin, op, s);
+}
+
+int morph_rows(const unsigned char *src, unsigned char *dst, int width, int height,
+               int op, int kw, int kh, int out_begin, int out_end) {
+    morph_scratch_t s;
+    s.width = width;
+    s.rx = kw / 2;
+    s.ry = kh / 2;
+
+    // Abertura/fechamento: a primeira operação cobre também o halo da segunda
+    int compound = op == MORPH_OPEN || op == MORPH_CLOSE;
+    int a = compound ? MAX(0, out_begin - s.ry) : out_begin;
+    int b = compound ? MIN(height, out_end + s.ry) : out_end;
+
+    size_t line = (size_t)MAX(width, MORPH_CHUNK_ROWS);
+    size_t k = 2 * (size_t)MAX(s.rx, s.ry) + 1;
+    size_t cols = (size_t)width * MORPH_CHUNK_ROWS;
+    size_t inter = compound ? (size_t)(b - a) * width : 0;
+    unsigned char *block = (unsigned char*)malloc((k + 2) * line + 2 * cols + inter);
+    if (!block) {
+        LOG_ERROR("Falha ao alocar memória para morfologia");
+        return -1;
+    }
+    s.suffix = block;
+    s.prefix = s.suffix + k * line;
+    s.ident = s.prefix + line;
+    s.cols = s.ident + line;
+    s.cols_out = s.cols + cols;
+
+    morph_lines_t in = { src, (size_t)width, 0, height, s.ident };
+    unsigned char *out = dst + (size_t)out_begin * width;
+    if (!compound) {
+        morph_pass(&in, out, op == MORPH_ERODE, out_begin, out_end, &s);
+    } else {
+        unsigned char *tmp = s.cols_out + cols;
+        morph_pass(&in, tmp, op == MORPH_OPEN, a, b, &s);
+        morph_lines_t mid = { tmp, (size_t)width, a, b, s.ident };
+        morph_pass(&mid, out, op == MORPH_CLOSE, out_begin, out_end, &s);
+    }
+
+    free(block);
+    return 0;
+}
+
+int apply_morphology(const unsigned char *src, unsigned char *dst, int width, int height,
+                     int op, int kw, int kh) {
+    return morph_rows(src, dst, width, height, op, kw, kh, 0, height);
+}
+
+const char* morph_op_name(int op) {
+    switch (op) {
+        case MORPH_ERODE:  return "erode";
+        case MORPH_DILATE: return "dilate";
+        case MORPH_OPEN:   return "open";
+        case MORPH_CLOSE:  return "close";
+        default:           return "unknown";
+    }
+}
+
+int apply_resize(const unsigned char *src, int src_w, int src_h, int channels,
+                 unsigned char **dst, int dst_w, int dst_h, int mode) {
+    *dst = (unsigned char*)malloc((size_t)dst_w * dst_h * channels);
     if (!*dst) {
         LOG_ERROR("Falha ao alocar memória para resize");
-        return;
+        return -1;
     }
     
-    // Interpolação simples (nearest neighbor)
-    for (int y = 0; y < *dst_h; y++) {
-        for (int x = 0; x < *dst_w; x++) {
-            int src_x = x * 2;
-            int src_y = y * 2;
-            
-            if (src_x >= src_w) src_x = src_w - 1;
-            if (src_y >= src_h) src_y = src_h - 1;
-            
-            for (int c = 0; c < channels; c++) {
-                int src_idx = (src_y * src_w + src_x) * channels + c;
-                int dst_idx = (y * (*dst_w) + x) * channels + c;
-                (*dst)[dst_idx] = src[src_idx];
-            }
-        }
+    // Coeficientes vêm do cache de planos (calculados uma vez por geometria)
+    if (resize_image(src, src_w, src_h, channels, *dst, dst_w, dst_h, (resize_mode_t)mode) != 0) {
+        free(*dst);
+        *dst = NULL;
+        return -1;
     }
+    return 0;
 }
 
-// ============================================================
-// FUNÇÕES DE THREAD PARA FILTROS
-// ============================================================
+// ------------------------------------------------------------
+// Sobel
+// ------------------------------------------------------------
+// Entrada: plano de luminância (1 canal). Cada linha recebida é copiada
+// para um anel de 3 linhas com 1 pixel de borda replicada em cada lado,
+// de modo que o kernel não precisa testar bordas. Bordas verticais
+// também replicam a primeira/última linha.
 
-void* thread_grayscale(void *args) {
-    thread_args_t *targs = (thread_args_t*)args;
+static inline unsigned char* sobel_ring_row(const sobel_stream_t *ss, int y) {
+    return ss->ring + (size_t)(y % 3) * (ss->width + 2);
+}
+
+int sobel_stream_init(sobel_stream_t *ss, int width, int height, int norm,
+                      int out_begin, int out_end) {
+    memset(ss, 0, sizeof(*ss));
+    ss->width = width;
+    ss->height = height;
+    ss->norm = norm;
+    ss->out_begin = out_begin;
+    ss->out_end = out_end;
+    ss->in_begin = MAX(0, out_begin - 1);
+    ss->in_end = MIN(height, out_end + 1);
+    ss->next_out = out_begin;
     
-    // Copia dados da imagem para não interferir com outras threads
-    size_t size = targs->width * targs->height * targs->channels;
-    unsigned char *img_copy = (unsigned char*)malloc(size);
-    if (!img_copy) {
-        LOG_ERROR("Worker %d: Falha ao alocar memória (grayscale)", targs->worker_id);
-        targs->success = 0;
-        return NULL;
+    ss->ring = (unsigned char*)malloc(3 * (size_t)(width + 2));
+    ss->gx = (int16_t*)malloc(width * sizeof(int16_t));
+    ss->gy = (int16_t*)malloc(width * sizeof(int16_t));
+    if (!ss->ring || !ss->gx || !ss->gy) {
+        LOG_ERROR("Falha ao alocar memória para sobel");
+        sobel_stream_free(ss);
+        return -1;
     }
+    return 0;
+}
+
+void sobel_stream_push(sobel_stream_t *ss, const unsigned char *luma, int y,
+                       unsigned char *mag, unsigned char *dir) {
+    if (y < ss->in_begin || y >= ss->in_end) return;
     
-    memcpy(img_copy, targs->image_data, size);
+    const int w = ss->width;
+    unsigned char *row = sobel_ring_row(ss, y);
+    memcpy(row + 1, luma, w);
+    row[0] = luma[0];
+    row[w + 1] = luma[w - 1];
     
-    // Aplica filtro
-    apply_grayscale(img_copy, targs->width, targs->height, targs->channels);
+    // Emite as linhas cuja vizinhança 3x3 está completa
+    while (ss->next_out < ss->out_end && MIN(ss->height - 1, ss->next_out + 1) <= y) {
+        int yo = ss->next_out;
+        const unsigned char *r0 = sobel_ring_row(ss, MAX(0, yo - 1));
+        const unsigned char *r1 = sobel_ring_row(ss, yo);
+        const unsigned char *r2 = sobel_ring_row(ss, MIN(ss->height - 1, yo + 1));
+        
+        g_kernels.sobel_row(r0, r1, r2, ss->gx, ss->gy, w);
+        if (ss->norm == SOBEL_L2) {
+            g_kernels.sobel_mag_l2(ss->gx, ss->gy, mag + (size_t)yo * w, w);
+        } else {
+            g_kernels.sobel_mag_l1(ss->gx, ss->gy, mag + (size_t)yo * w, w);
+        }
+        if (dir) {
+            g_kernels.sobel_dir(ss->gx, ss->gy, dir + (size_t)yo * w, w);
+        }
+        ss->next_out++;
+    }
+}
+
+void sobel_stream_free(sobel_stream_t *ss) {
+    free(ss->ring);
+    free(ss->gx);
+    free(ss->gy);
+    ss->ring = NULL;
+    ss->gx = NULL;
+    ss->gy = NULL;
+}
+
+int apply_sobel(const unsigned char *luma, unsigned char *mag, unsigned char *dir,
+                int width, int height, int norm) {
+    sobel_stream_t ss;
+    if (sobel_stream_init(&ss, width, height, norm, 0, height) != 0) {
+        return -1;
+    }
     
-    // Salva resultado
-    if (save_image(targs->output_file, img_copy, targs->width, targs->height, targs->channels) == 0) {
-        targs->success = 1;
-    } else {
-        targs->success = 0;
+    for (int y = 0; y < height; y++) {
+        sobel_stream_push(&ss, luma + (size_t)y * width, y, mag, dir);
     }
     
-    free(img_copy);
-    return NULL;
+    sobel_stream_free(&ss);
+    return 0;
 }
 
-void* thread_blur(void *args) {
-    thread_args_t *targs = (thread_args_t*)args;
-    
-    size_t size = targs->width * targs->height * targs->channels;
-    unsigned char *img_blur = (unsigned char*)malloc(size);
-    if (!img_blur) {
-        LOG_ERROR("Worker %d: Falha ao alocar memória (blur)", targs->worker_id);
-        targs->success = 0;
-        return NULL;
+// ------------------------------------------------------------
+// Threshold
+// ------------------------------------------------------------
+// Binariza o plano de luminância (255 = acima do limiar). O limiar
+// fixo e o de Otsu são comparações vetorizadas linha a linha; o
+// adaptativo compara cada pixel com a média da janela (2r+1)² ao redor,
+// lida da imagem integral (4 acessos por pixel, qualquer raio).
+
+int otsu_threshold(const uint32_t *hist) {
+    return otsu_threshold_bins(hist, 256);
+}
+
+int otsu_threshold_bins(const uint32_t *hist, int bins) {
+    uint64_t total = 0;
+    double sum = 0.0;
+    for (int i = 0; i < bins; i++) {
+        total += hist[i];
+        sum += (double)i * hist[i];
     }
     
-    // Aplica blur
-    apply_blur(targs->image_data, img_blur, targs->width, targs->height, targs->channels);
+    // Maximiza a variância entre classes: w_b × w_f × (m_b - m_f)²
+    uint64_t w_b = 0;
+    double sum_b = 0.0, best = -1.0;
+    int thresh = 0;
+    for (int i = 0; i < bins; i++) {
+        w_b += hist[i];
+        if (w_b == 0) continue;
+        uint64_t w_f = total - w_b;
+        if (w_f == 0) break;
+        
+        sum_b += (double)i * hist[i];
+        double m_b = sum_b / (double)w_b;
+        double m_f = (sum - sum_b) / (double)w_f;
+        double var = (double)w_b * (double)w_f * (m_b - m_f) * (m_b - m_f);
+        if (var > best) {
+            best = var;
+            thresh = i;
+        }
+    }
+    return thresh;
+}
+
+void channel_stats_from_hist(const uint32_t *hist, channel_stats_t *out) {
+    memset(out, 0, sizeof(*out));
+    memcpy(out->hist, hist, sizeof(out->hist));
+
+    uint64_t total = 0, sum = 0;
+    out->min = -1;
+    for (int i = 0; i < 256; i++) {
+        if (!hist[i]) continue;
+        if (out->min < 0) out->min = i;
+        out->max = i;
+        total += hist[i];
+        sum += (uint64_t)i * hist[i];
+    }
+    if (total == 0) {
+        out->min = 0;
+        return;
+    }
+
+    // Variância centrada na média (256 termos, sem cancelamento)
+    out->mean = (double)sum / (double)total;
+    double var = 0.0;
+    for (int i = out->min; i <= out->max; i++) {
+        double d = (double)i - out->mean;
+        var += d * d * (double)hist[i];
+    }
+    out->stddev = sqrt(var / (double)total);
+}
+
+int threshold_mean_rows(const integral_t *ii, const unsigned char *luma, unsigned char *dst,
+                        int radius, int c, int out_begin, int out_end) {
+    const int w = ii->width;
+    uint32_t *tmp = (uint32_t*)malloc((size_t)w * sizeof(uint32_t));
+    if (!tmp) {
+        LOG_ERROR("Falha ao alocar memória para threshold");
+        return -1;
+    }
     
-    // Salva resultado
-    if (save_image(targs->output_file, img_blur, targs->width, targs->height, targs->channels) == 0) {
-        targs->success = 1;
-    } else {
-        targs->success = 0;
+    // Cada linha de média escrita em dst é comparada no próprio lugar
+    for (int y = out_begin; y < out_end; y++) {
+        unsigned char *row = dst + (size_t)y * w;
+        integral_box_mean_row(ii, y, radius, tmp, row);
+        g_kernels.threshold_mean_row(luma + (size_t)y * w, row, row, w, c);
     }
     
-    free(img_blur);
-    return NULL;
+    free(tmp);
+    return 0;
 }
 
-void* thread_resize(void *args) {
-    thread_args_t *targs = (thread_args_t*)args;
-    
-    unsigned char *resized = NULL;
-    int new_w, new_h;
+int apply_threshold(const unsigned char *luma, unsigned char *dst, int width, int height,
+                    int mode, int value, int radius, int c) {
+    size_t n = (size_t)width * height;
     
-    // Aplica resize
-    apply_resize(targs->image_data, targs->width, targs->height, targs->channels,
-                 &resized, &new_w, &new_h);
+    if (mode == THRESH_MEAN) {
+        integral_t ii;
+        if (integral_init(&ii, width, height, 0) != 0) return -1;
+        integral_build(&ii, luma);
+        int ret = threshold_mean_rows(&ii, luma, dst, radius, c, 0, height);
+        integral_free(&ii);
+        return ret;
+    }
     
-    if (!resized) {
-        targs->success = 0;
-        return NULL;
+    int thresh = value;
+    if (mode == THRESH_OTSU) {
+        uint32_t hist[256] = {0};
+        histogram_u8(luma, (int)n, hist);
+        thresh = otsu_threshold(hist);
+    }
+    g_kernels.threshold_row(luma, dst, (int)n, thresh);
+    return 0;
+}
+
+const char* threshold_mode_name(int mode) {
+    switch (mode) {
+        case THRESH_FIXED: return "fixed";
+        case THRESH_MEAN:  return "mean";
+        case THRESH_OTSU:  return "otsu";
+        default:           return "unknown";
     }
+}
+
+// ============================================================
+// FUNÇÕES DE THREAD
+// ============================================================
+
+void* thread_save_output(void *args) {
+    thread_args_t *targs = (thread_args_t*)args;
     
-    // Salva resultado
-    if (save_image(targs->output_file, resized, new_w, new_h, targs->channels) == 0) {
+    // Codificação JPEG domina o custo; uma thread por saída
+    int ret = targs->depth == 16 ?
+              save_image_16(targs->output_file, (const uint16_t*)targs->image_data,
+                            targs->width, targs->height, targs->channels) :
+              save_image(targs->output_file, targs->image_data, targs->width, targs->height,
+                         targs->channels);
+    if (ret == 0) {
         targs->success = 1;
     } else {
         targs->success = 0;
     }
-    
-    free(resized);
     return NULL;
 }
@@ -0,0 +1,168 @@
+#include "filters.h"
+#include "simd_kernels.h"
+
+// ============================================================
+// CONVERSÕES (16 BITS)
+// ============================================================
+// Mesmos pesos Q15 da luminância de 8 bits; o produto cabe em 32 bits
+// (65535 × 32768 < 2^31 por termo, soma dos pesos = 2^15).
+
+static inline uint16_t gray_pixel_u16(uint32_t r, uint32_t g, uint32_t b) {
+    return (uint16_t)((GRAY_WEIGHT_R * r + GRAY_WEIGHT_G * g + GRAY_WEIGHT_B * b +
+                       (1u << (GRAY_SHIFT - 1))) >> GRAY_SHIFT);
+}
+
+void grayscale_rows_u16(const uint16_t *src, uint16_t *dst, int n, int channels) {
+    // Só faz sentido se tiver RGB ou RGBA; demais formatos são copiados
+    if (channels < 3) {
+        if (src != dst) memcpy(dst, src, (size_t)n * channels * sizeof(uint16_t));
+        return;
+    }
+
+    for (int i = 0; i < n; i++, src += channels, dst += channels) {
+        uint16_t gray = gray_pixel_u16(src[0], src[1], src[2]);
+        dst[0] = gray;
+        dst[1] = gray;
+        dst[2] = gray;
+        // Alpha (se existir) permanece inalterado
+        if (channels == 4) dst[3] = src[3];
+    }
+}
+
+void luma_rows_u16(const uint16_t *src, uint16_t *dst, int n, int channels) {
+    switch (channels) {
+        case 1: memcpy(dst, src, (size_t)n * sizeof(uint16_t)); break;
+        case 3:
+        case 4:
+            for (int i = 0; i < n; i++, src += channels) {
+                dst[i] = gray_pixel_u16(src[0], src[1], src[2]);
+            }
+            break;
+        default:
+            // Cinza + alpha: luminância é o primeiro canal
+            for (int i = 0; i < n; i++) dst[i] = src[i * channels];
+            break;
+    }
+}
+
+void reduce_u16(const uint16_t *src, unsigned char *dst, size_t n) {
+    for (size_t i = 0; i < n; i++) dst[i] = (unsigned char)(src[i] >> 8);
+}
+
+// ============================================================
+// BOX BLUR (16 BITS)
+// ============================================================
+// Mesmo esquema do blur de 8 bits (somas deslizantes horizontal e
+// vertical, janela truncada nas bordas), com somas em 32 bits: a maior
+// janela (129 × 129 × 65535) ainda cabe em uint32. A origem está inteira
+// na memória, então cada faixa lê as linhas de halo diretamente.
+
+// Soma horizontal de uma linha intercalada: janela [x-r, x+r] ∩ [0, width-1]
+static void blur_hsum_row_u16(const uint16_t *src, uint32_t *dst, int width,
+                              int channels, int radius) {
+    uint32_t acc[MAX_CHANNELS] = {0};
+    for (int x = 0; x < MIN(radius, width); x++) {
+        for (int ch = 0; ch < channels; ch++) acc[ch] += src[x * channels + ch];
+    }
+    for (int x = 0; x < width; x++) {
+        int add = x + radius, sub = x - radius - 1;
+        for (int ch = 0; ch < channels; ch++) {
+            if (add < width) acc[ch] += src[add * channels + ch];
+            if (sub >= 0) acc[ch] -= src[sub * channels + ch];
+            dst[x * channels + ch] = acc[ch];
+        }
+    }
+}
+
+int blur_rows_u16(const uint16_t *src, uint16_t *dst, int width, int height, int channels,
+                  int radius, int out_begin, int out_end) {
+    if (radius < 0) radius = 0;
+    if (radius > BLUR_MAX_RADIUS) radius = BLUR_MAX_RADIUS;
+    if (channels < 1 || channels > MAX_CHANNELS) return -1;
+
+    const size_t n = (size_t)width * channels;
+    const int ring_rows = 2 * radius + 2;
+    uint32_t *ring = (uint32_t*)malloc(ring_rows * n * sizeof(uint32_t));
+    uint32_t *colsum = (uint32_t*)calloc(n, sizeof(uint32_t));
+    if (!ring || !colsum) {
+        free(ring);
+        free(colsum);
+        LOG_ERROR("Falha ao alocar memória para blur de 16 bits");
+        return -1;
+    }
+
+    int win_lo = MAX(0, out_begin - radius), win_hi = win_lo - 1;
+    for (int y = out_begin; y < out_end; y++) {
+        int lo = MAX(0, y - radius), hi = MIN(height - 1, y + radius);
+        while (win_hi < hi) {
+            win_hi++;
+            uint32_t *h = ring + (size_t)(win_hi % ring_rows) * n;
+            blur_hsum_row_u16(src + (size_t)win_hi * n, h, width, channels, radius);
+            for (size_t i = 0; i < n; i++) colsum[i] += h[i];
+        }
+        while (win_lo < lo) {
+            const uint32_t *old = ring + (size_t)(win_lo % ring_rows) * n;
+            for (size_t i = 0; i < n; i++) colsum[i] -= old[i];
+            win_lo++;
+        }
+
+        // Normaliza pela área da janela (mesmo arredondamento do 8 bits;
+        // soma <= 129² × 65535 cabe em 32 bits)
+        const uint32_t cy = (uint32_t)(hi - lo + 1);
+        uint16_t *out = dst + (size_t)(y - out_begin) * n;
+        for (int x = 0; x < width; x++) {
+            const uint32_t area = (uint32_t)(MIN(x + radius, width - 1) -
+                                             MAX(0, x - radius) + 1) * cy;
+            for (int ch = 0; ch < channels; ch++) {
+                size_t i = (size_t)x * channels + ch;
+                out[i] = (uint16_t)((colsum[i] + area / 2) / area);
+            }
+        }
+    }
+
+    free(ring);
+    free(colsum);
+    return 0;
+}
+
+// ============================================================
+// THRESHOLD (16 BITS)
+// ============================================================
+
+void threshold_row_u16(const uint16_t *src, unsigned char *dst, int n, int thresh) {
+    for (int i = 0; i < n; i++) {
+        dst[i] = src[i] > thresh ? 255 : 0;
+    }
+}
+
+void histogram_u16(const uint16_t *src, int n, uint32_t *hist) {
+    for (int i = 0; i < n; i++) hist[src[i]]++;
+}
+
+// Média local pelo próprio box blur (janela truncada, como a integral)
+int threshold_mean_rows_u16(const uint16_t *luma, unsigned char *dst, int width, int height,
+                            int radius, int c, int out_begin, int out_end) {
+    if (out_begin >= out_end) return 0;
+    uint16_t *mean = (uint16_t*)malloc((size_t)width * (out_end - out_begin) * sizeof(uint16_t));
+    if (!mean) {
+        LOG_ERROR("Falha ao alocar memória para threshold de 16 bits");
+        return -1;
+    }
+    if (blur_rows_u16(luma, mean, width, height, 1, radius, out_begin, out_end) != 0) {
+        free(mean);
+        return -1;
+    }
+
+    const int margin = c * DEPTH16_SCALE;
+    for (int y = out_begin; y < out_end; y++) {
+        const uint16_t *src = luma + (size_t)y * width;
+        const uint16_t *m = mean + (size_t)(y - out_begin) * width;
+        unsigned char *out = dst + (size_t)y * width;
+        for (int x = 0; x < width; x++) {
+            out[x] = src[x] + margin > m[x] ? 255 : 0;
+        }
+    }
+
+    free(mean);
+    return 0;
+}
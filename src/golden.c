@@ -0,0 +1,167 @@
+#include "golden.h"
+#include "filters.h"
+#include "planar.h"
+
+// ============================================================
+// CRIAÇÃO (COORDENADOR)
+// ============================================================
+
+// Imagem decodificada e convertida para luminância (liberar com free)
+static unsigned char* golden_plane_load(const char *path, int *width, int *height) {
+    int c;
+    unsigned char *img = load_image(path, width, height, &c);
+    if (!img) return NULL;
+    size_t n = (size_t)*width * *height;
+    unsigned char *plane = (unsigned char*)malloc(n);
+    if (plane) luma_rows(img, plane, (int)n, c);
+    free_image(img);
+    return plane;
+}
+
+// Planos decodificados antes de conhecer o tamanho do objeto
+typedef struct {
+    unsigned char *luma[GOLDEN_MAX_REFS];
+    unsigned char *tol[GOLDEN_MAX_REFS];
+} golden_planes_t;
+
+static void golden_planes_free(golden_planes_t *pl) {
+    for (int i = 0; i < GOLDEN_MAX_REFS; i++) {
+        free(pl->luma[i]);
+        free(pl->tol[i]);
+    }
+}
+
+static int golden_planes_load(golden_planes_t *pl, golden_header_t *header, size_t *bytes,
+                              const pipeline_config_t *cfg) {
+    memset(pl, 0, sizeof(*pl));
+    memset(header, 0, sizeof(*header));
+    *bytes = planar_stride(sizeof(*header));
+
+    for (int i = 0; i < cfg->num_golden_refs; i++) {
+        golden_ref_t *ref = &header->refs[i];
+        if (!(pl->luma[i] = golden_plane_load(cfg->golden_refs[i], &ref->width, &ref->height))) {
+            LOG_ERROR("Falha ao carregar referência golden: %s", cfg->golden_refs[i]);
+            return -1;
+        }
+        for (int j = 0; j < i; j++) {
+            if (header->refs[j].width == ref->width && header->refs[j].height == ref->height) {
+                LOG_ERROR("Referências golden %s e %s com a mesma geometria (%dx%d)",
+                          cfg->golden_refs[j], cfg->golden_refs[i], ref->width, ref->height);
+                return -1;
+            }
+        }
+        size_t plane = (size_t)ref->width * ref->height;
+        ref->luma_offset = *bytes;
+        *bytes += planar_stride((int)plane);
+
+        if (i >= cfg->num_golden_masks) continue;
+        int mw, mh;
+        if (!(pl->tol[i] = golden_plane_load(cfg->golden_masks[i], &mw, &mh))) {
+            LOG_ERROR("Falha ao carregar máscara golden: %s", cfg->golden_masks[i]);
+            return -1;
+        }
+        if (mw != ref->width || mh != ref->height) {
+            LOG_ERROR("Máscara golden %s (%dx%d) difere da referência %s (%dx%d)",
+                      cfg->golden_masks[i], mw, mh, cfg->golden_refs[i],
+                      ref->width, ref->height);
+            return -1;
+        }
+        ref->tol_offset = *bytes;
+        *bytes += planar_stride((int)plane);
+    }
+    header->count = cfg->num_golden_refs;
+    return 0;
+}
+
+int golden_create(golden_set_t *set, const pipeline_config_t *cfg) {
+    memset(set, 0, sizeof(*set));
+    set->fd = -1;
+    if (!(cfg->filters & FILTER_BIT(FILTER_GOLDEN))) return 0;
+
+    golden_planes_t pl;
+    golden_header_t header;
+    size_t bytes;
+    if (golden_planes_load(&pl, &header, &bytes, cfg) != 0) {
+        golden_planes_free(&pl);
+        return -1;
+    }
+
+    // Remove objeto antigo se existir
+    shm_unlink(GOLDEN_SHM_NAME);
+    set->fd = shm_open(GOLDEN_SHM_NAME, O_CREAT | O_RDWR, 0644);
+    if (set->fd == -1 || ftruncate(set->fd, (off_t)bytes) == -1) {
+        LOG_ERROR("Falha ao criar %s: %s", GOLDEN_SHM_NAME, strerror(errno));
+        golden_planes_free(&pl);
+        golden_close(set);
+        shm_unlink(GOLDEN_SHM_NAME);
+        return -1;
+    }
+    unsigned char *map = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, set->fd, 0);
+    if (map == MAP_FAILED) {
+        LOG_ERROR("Falha ao mapear %s: %s", GOLDEN_SHM_NAME, strerror(errno));
+        golden_planes_free(&pl);
+        golden_close(set);
+        shm_unlink(GOLDEN_SHM_NAME);
+        return -1;
+    }
+
+    memcpy(map, &header, sizeof(header));
+    for (int i = 0; i < header.count; i++) {
+        const golden_ref_t *ref = &header.refs[i];
+        size_t plane = (size_t)ref->width * ref->height;
+        memcpy(map + ref->luma_offset, pl.luma[i], plane);
+        if (ref->tol_offset) memcpy(map + ref->tol_offset, pl.tol[i], plane);
+    }
+    golden_planes_free(&pl);
+
+    // Somente leitura também no coordenador
+    if (mprotect(map, bytes, PROT_READ) != 0) {
+        LOG_ERROR("Falha ao proteger %s: %s", GOLDEN_SHM_NAME, strerror(errno));
+    }
+    set->map = map;
+    set->map_bytes = bytes;
+    set->header = (const golden_header_t*)map;
+    return 0;
+}
+
+// ============================================================
+// ACESSO (WORKERS)
+// ============================================================
+
+int golden_open(golden_set_t *set) {
+    memset(set, 0, sizeof(*set));
+    set->fd = shm_open(GOLDEN_SHM_NAME, O_RDONLY, 0644);
+    struct stat st;
+    if (set->fd == -1 || fstat(set->fd, &st) != 0 ||
+        (size_t)st.st_size < sizeof(golden_header_t)) {
+        LOG_ERROR("Falha ao abrir %s", GOLDEN_SHM_NAME);
+        golden_close(set);
+        return -1;
+    }
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, set->fd, 0);
+    if (map == MAP_FAILED) {
+        LOG_ERROR("Falha ao mapear %s: %s", GOLDEN_SHM_NAME, strerror(errno));
+        golden_close(set);
+        return -1;
+    }
+    set->map = map;
+    set->map_bytes = (size_t)st.st_size;
+    set->header = (const golden_header_t*)map;
+    return 0;
+}
+
+void golden_close(golden_set_t *set) {
+    if (set->map) munmap(set->map, set->map_bytes);
+    if (set->fd != -1) close(set->fd);
+    memset(set, 0, sizeof(*set));
+    set->fd = -1;
+}
+
+const golden_ref_t* golden_find(const golden_set_t *set, int width, int height) {
+    if (!set || !set->header) return NULL;
+    for (int i = 0; i < set->header->count; i++) {
+        const golden_ref_t *ref = &set->header->refs[i];
+        if (ref->width == width && ref->height == height) return ref;
+    }
+    return NULL;
+}
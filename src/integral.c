@@ -0,0 +1,218 @@
+#include "integral.h"
+
+// ============================================================
+// CONSTRUÇÃO
+// ============================================================
+
+int integral_init(integral_t *ii, int width, int height, int with_sq) {
+    memset(ii, 0, sizeof(*ii));
+    ii->width = width;
+    ii->height = height;
+    ii->stride = (size_t)width + 1;
+
+    size_t cells = ii->stride * ((size_t)height + 1);
+    ii->sum = (uint32_t*)malloc(cells * sizeof(uint32_t));
+    if (with_sq) {
+        ii->sqsum = (uint64_t*)malloc(cells * sizeof(uint64_t));
+    }
+    if (!ii->sum || (with_sq && !ii->sqsum)) {
+        LOG_ERROR("Falha ao alocar imagem integral (%dx%d)", width, height);
+        integral_free(ii);
+        return -1;
+    }
+
+    // Linha 0 fica zero; a coluna 0 é escrita junto com cada linha
+    memset(ii->sum, 0, ii->stride * sizeof(uint32_t));
+    if (ii->sqsum) memset(ii->sqsum, 0, ii->stride * sizeof(uint64_t));
+    return 0;
+}
+
+void integral_free(integral_t *ii) {
+    free(ii->sum);
+    free(ii->sqsum);
+    ii->sum = NULL;
+    ii->sqsum = NULL;
+}
+
+void integral_rows(integral_t *ii, const unsigned char *src, int y, int n, int top) {
+    const int w = ii->width;
+    for (int i = 0; i < n; i++) {
+        int yy = y + i;
+        // Linha yy da origem → linha yy + 1 da tabela
+        size_t prev = yy == top ? 0 : (size_t)yy * ii->stride;
+        size_t cur = (size_t)(yy + 1) * ii->stride;
+        const unsigned char *row = src + (size_t)i * w;
+
+        ii->sum[cur] = 0;
+        g_kernels.integral_row(row, ii->sum + prev + 1, ii->sum + cur + 1, w);
+        if (ii->sqsum) {
+            ii->sqsum[cur] = 0;
+            g_kernels.integral_sq_row(row, ii->sqsum + prev + 1, ii->sqsum + cur + 1, w);
+        }
+    }
+}
+
+void integral_build(integral_t *ii, const unsigned char *src) {
+    integral_rows(ii, src, 0, ii->height, 0);
+}
+
+// ------------------------------------------------------------
+// Junção das faixas
+// ------------------------------------------------------------
+// Cada faixa foi montada a partir de zero. O acumulado que falta à faixa
+// k é a linha inicial dela na tabela global, obtida em série somando as
+// últimas linhas (locais) das faixas anteriores; depois cada faixa soma
+// esse acumulado às próprias linhas, em paralelo.
+
+typedef struct {
+    integral_t *ii;
+    int num_bands;
+    uint32_t *carry;            // num_bands × stride (faixa 0 sem uso)
+    uint64_t *carry_sq;
+} integral_merge_t;
+
+static inline int integral_band_start(const integral_t *ii, int band, int num_bands) {
+    return (int)((long)ii->height * band / num_bands);
+}
+
+static void integral_fixup_task(void *arg, int band) {
+    integral_merge_t *m = (integral_merge_t*)arg;
+    integral_t *ii = m->ii;
+    if (band == 0) return;
+
+    const size_t stride = ii->stride;
+    int y0 = integral_band_start(ii, band, m->num_bands);
+    int y1 = integral_band_start(ii, band + 1, m->num_bands);
+    const uint32_t *carry = m->carry + band * stride;
+    const uint64_t *carry_sq = m->carry_sq ? m->carry_sq + band * stride : NULL;
+
+    // Módulo 2^32 na soma: a correção pode "passar do limite" sem erro
+    for (int y = y0 + 1; y <= y1; y++) {
+        uint32_t *row = ii->sum + (size_t)y * stride;
+        for (size_t x = 0; x < stride; x++) row[x] += carry[x];
+        if (carry_sq) {
+            uint64_t *sq = ii->sqsum + (size_t)y * stride;
+            for (size_t x = 0; x < stride; x++) sq[x] += carry_sq[x];
+        }
+    }
+}
+
+int integral_merge_bands(integral_t *ii, int num_bands, thread_pool_t *pool) {
+    if (num_bands <= 1) return 0;
+
+    const size_t stride = ii->stride;
+    integral_merge_t m = { .ii = ii, .num_bands = num_bands };
+    m.carry = (uint32_t*)calloc((size_t)num_bands * stride, sizeof(uint32_t));
+    if (ii->sqsum) {
+        m.carry_sq = (uint64_t*)calloc((size_t)num_bands * stride, sizeof(uint64_t));
+    }
+    if (!m.carry || (ii->sqsum && !m.carry_sq)) {
+        LOG_ERROR("Falha ao alocar junção da imagem integral");
+        free(m.carry);
+        free(m.carry_sq);
+        return -1;
+    }
+
+    for (int k = 1; k < num_bands; k++) {
+        size_t y0 = (size_t)integral_band_start(ii, k, num_bands);
+        // Faixa anterior vazia (altura < num_bands): nada a acumular
+        int empty = integral_band_start(ii, k - 1, num_bands) == (int)y0;
+        const uint32_t *row = ii->sum + y0 * stride;
+        uint32_t *c = m.carry + k * stride;
+        const uint32_t *c_prev = m.carry + (k - 1) * stride;
+        for (size_t x = 0; x < stride; x++) c[x] = c_prev[x] + (empty ? 0 : row[x]);
+        if (m.carry_sq) {
+            const uint64_t *sq = ii->sqsum + y0 * stride;
+            uint64_t *cs = m.carry_sq + k * stride;
+            const uint64_t *cs_prev = m.carry_sq + (k - 1) * stride;
+            for (size_t x = 0; x < stride; x++) cs[x] = cs_prev[x] + (empty ? 0 : sq[x]);
+        }
+    }
+
+    thread_pool_run(pool, integral_fixup_task, &m, num_bands);
+
+    free(m.carry);
+    free(m.carry_sq);
+    return 0;
+}
+
+// ============================================================
+// CONSULTAS
+// ============================================================
+
+uint64_t integral_sum(const integral_t *ii, int x0, int y0, int x1, int y1) {
+    if (x1 <= x0 || y1 <= y0) return 0;
+
+    // Retângulos acima de INTEGRAL_MAX_AREA são somados em faixas exatas
+    int rows = (int)MAX(1, INTEGRAL_MAX_AREA / (x1 - x0));
+    uint64_t total = 0;
+    for (int ya = y0; ya < y1; ya += rows) {
+        int yb = MIN(y1, ya + rows);
+        const uint32_t *top = ii->sum + (size_t)ya * ii->stride;
+        const uint32_t *bot = ii->sum + (size_t)yb * ii->stride;
+        total += (uint32_t)(bot[x1] - bot[x0] - top[x1] + top[x0]);
+    }
+    return total;
+}
+
+uint64_t integral_sq_sum(const integral_t *ii, int x0, int y0, int x1, int y1) {
+    if (x1 <= x0 || y1 <= y0 || !ii->sqsum) return 0;
+    const uint64_t *top = ii->sqsum + (size_t)y0 * ii->stride;
+    const uint64_t *bot = ii->sqsum + (size_t)y1 * ii->stride;
+    return bot[x1] - bot[x0] - top[x1] + top[x0];
+}
+
+double integral_mean(const integral_t *ii, int x0, int y0, int x1, int y1) {
+    double area = (double)(x1 - x0) * (double)(y1 - y0);
+    if (area <= 0.0) return 0.0;
+    return (double)integral_sum(ii, x0, y0, x1, y1) / area;
+}
+
+double integral_variance(const integral_t *ii, int x0, int y0, int x1, int y1) {
+    double area = (double)(x1 - x0) * (double)(y1 - y0);
+    if (area <= 0.0 || !ii->sqsum) return 0.0;
+
+    double sq = (double)integral_sq_sum(ii, x0, y0, x1, y1);
+    double mean = (double)integral_sum(ii, x0, y0, x1, y1) / area;
+    double var = sq / area - mean * mean;
+    return var > 0.0 ? var : 0.0;
+}
+
+// Média arredondada de uma coluna da borda (janela horizontal truncada)
+static inline unsigned char integral_border_mean(const uint32_t *top, const uint32_t *bot,
+                                                 int x, int w, int r, uint32_t cy) {
+    int xa = MAX(0, x - r), xb = MIN(w - 1, x + r);
+    uint32_t s = bot[xb + 1] - bot[xa] - top[xb + 1] + top[xa];
+    uint32_t area = (uint32_t)(xb - xa + 1) * cy;
+    return (unsigned char)((s + area / 2) / area);
+}
+
+void integral_box_mean_row(const integral_t *ii, int y, int radius, uint32_t *tmp,
+                           unsigned char *dst) {
+    const int w = ii->width, r = radius;
+    int ya = MAX(0, y - r), yb = MIN(ii->height - 1, y + r);
+    const uint32_t *top = ii->sum + (size_t)ya * ii->stride;
+    const uint32_t *bot = ii->sum + (size_t)(yb + 1) * ii->stride;
+
+    // Mesmo arredondamento do box blur (saída idêntica)
+    const uint32_t cy = (uint32_t)(yb - ya + 1);
+    int col_begin = MIN(r, w);
+    int col_end = MAX(col_begin, w - r);
+
+    for (int x = 0; x < col_begin; x++) {
+        dst[x] = integral_border_mean(top, bot, x, w, r, cy);
+    }
+
+    // Interior: janela horizontal completa
+    int n = col_end - col_begin;
+    if (n > 0) {
+        g_kernels.box_sum_row(top + col_begin - r, bot + col_begin - r, tmp + col_begin,
+                              n, 2 * r + 1);
+        g_kernels.blur_scale_row(tmp + col_begin, dst + col_begin, n,
+                                 (uint32_t)(2 * r + 1) * cy);
+    }
+
+    for (int x = col_end; x < w; x++) {
+        dst[x] = integral_border_mean(top, bot, x, w, r, cy);
+    }
+}
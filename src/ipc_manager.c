@@ -173,6 +173,7 @@ void cleanup_ipc_coordinator(mqd_t mq, shared_stats_t *stats, int shm_fd) {
     unlink_message_queue(QUEUE_NAME);
     close_shared_memory(stats, shm_fd);
     unlink_shared_memory(SHM_NAME);
+    unlink_shared_memory(GOLDEN_SHM_NAME);
 }
 
 void cleanup_ipc_worker(mqd_t mq, shared_stats_t *stats, int shm_fd) {
@@ -13,11 +13,29 @@
 #include "ipc_manager.h"
 #include "sync_manager.h"
 #include "worker.h"
+#include "filters.h"
+#include "cpu_dispatch.h"
+#include "config.h"
+#include "calib.h"
+#include "golden.h"
+#include "classify.h"
 
 // Lista de imagens encontradas
 static char image_files[MAX_IMAGES][MAX_FILENAME];
 static int num_images = 0;
 
+// Parâmetros dos filtros (herdados pelos workers no fork)
+static pipeline_config_t g_config;
+
+// Dark frame / flat-field (mapeamento somente leitura herdado pelos workers)
+static calib_t g_calib;
+
+// Referências golden (objeto GOLDEN_SHM_NAME, mapeado pelos workers)
+static golden_set_t g_golden;
+
+// LUT 3D de classes de cor (mapeamento somente leitura herdado pelos workers)
+static class_lut_t g_classes;
+
 // PIDs dos workers
 static pid_t worker_pids[NUM_WORKERS];
 
@@ -123,6 +141,45 @@ void print_header(void) {
     printf("\n");
 }
 
+// Nome do canal k de uma imagem com 'channels' canais
+static const char* channel_name(int channels, int k) {
+    static const char *rgba[MAX_CHANNELS] = { "R", "G", "B", "A" };
+    return channels == 1 ? "L" : rgba[k];
+}
+
+/**
+ * @brief Exporta as estatísticas por canal de cada imagem em CSV
+ *
+ * Uma linha por canal: média, desvio, mínimo, máximo e os 256 bins do
+ * histograma (monitoramento de iluminação sem reler as imagens).
+ */
+static int write_image_stats_csv(const shared_stats_t *stats, const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        LOG_ERROR("Falha ao criar %s", path);
+        return -1;
+    }
+
+    fprintf(f, "image,channel,mean,stddev,min,max");
+    for (int b = 0; b < 256; b++) fprintf(f, ",h%d", b);
+    fprintf(f, "\n");
+    for (int i = 0; i < num_images; i++) {
+        const image_report_t *r = &stats->reports[i];
+        for (int k = 0; k < r->channels; k++) {
+            const channel_stats_t *cs = &r->channel[k];
+            fprintf(f, "%s,%s,%.3f,%.3f,%d,%d", image_files[i], channel_name(r->channels, k),
+                    cs->mean, cs->stddev, cs->min, cs->max);
+            for (int b = 0; b < 256; b++) fprintf(f, ",%u", cs->hist[b]);
+            fprintf(f, "\n");
+        }
+    }
+
+    int ok = !ferror(f);
+    if (fclose(f) != 0) ok = 0;
+    if (!ok) LOG_ERROR("Falha ao escrever %s", path);
+    return ok ? 0 : -1;
+}
+
 /**
  * @brief Imprime estatísticas finais
  */
@@ -150,11 +207,105 @@ void print_statistics(shared_stats_t *stats) {
     }
     printf("  ║                                                               ║\n");
     printf("  ║   Workers utilizados:     %d                                   ║\n", NUM_WORKERS);
-    printf("  ║   Threads por worker:     %d                                   ║\n", NUM_THREADS);
+    printf("  ║   Threads por worker:     %-2d                                  ║\n", g_config.num_threads);
     printf("  ║                                                               ║\n");
     printf("  ╠═══════════════════════════════════════════════════════════════╣\n");
     printf("  ║   Resultados salvos em: %-37s  ║\n", OUTPUT_DIR "/");
     printf("  ╚═══════════════════════════════════════════════════════════════╝\n\n");
+    
+    // Resumo dos blobs por imagem (medidas completas em *_blobs.csv)
+    if (g_config.filters & FILTER_BIT(FILTER_BLOBS)) {
+        printf("  Blobs por imagem:\n");
+        for (int i = 0; i < num_images; i++) {
+            const image_report_t *r = &stats->reports[i];
+            const char *branch = i + 1 < num_images ? "├─" : "└─";
+            if (r->num_blobs < 0) {
+                printf("  %s %s: sem resultado\n", branch, image_files[i]);
+            } else {
+                printf("  %s %s: %d blobs (área total %ld px, maior %ld px)\n", branch,
+                       image_files[i], r->num_blobs, r->blob_area, r->largest_blob);
+            }
+        }
+        printf("\n");
+    }
+
+    // Estatísticas por canal (histogramas completos em stats.csv)
+    if (g_config.image_stats) {
+        printf("  Estatísticas por imagem (média ± desvio, faixa):\n");
+        for (int i = 0; i < num_images; i++) {
+            const image_report_t *r = &stats->reports[i];
+            const char *branch = i + 1 < num_images ? "├─" : "└─";
+            if (r->channels == 0) {
+                printf("  %s %s: sem resultado\n", branch, image_files[i]);
+                continue;
+            }
+            printf("  %s %s:", branch, image_files[i]);
+            for (int k = 0; k < r->channels; k++) {
+                const channel_stats_t *cs = &r->channel[k];
+                printf("%s %s %.1f ± %.1f [%d-%d]", k ? "," : "", channel_name(r->channels, k),
+                       cs->mean, cs->stddev, cs->min, cs->max);
+            }
+            printf("\n");
+        }
+        printf("\n");
+        write_image_stats_csv(stats, OUTPUT_DIR "/stats.csv");
+    }
+
+    // Ocorrências de templates por imagem (posições em *_match.csv)
+    if (g_config.filters & FILTER_BIT(FILTER_MATCH)) {
+        printf("  Templates por imagem:\n");
+        for (int i = 0; i < num_images; i++) {
+            const image_report_t *r = &stats->reports[i];
+            const char *branch = i + 1 < num_images ? "├─" : "└─";
+            if (r->num_matches < 0) {
+                printf("  %s %s: sem resultado\n", branch, image_files[i]);
+            } else if (r->num_matches == 0) {
+                printf("  %s %s: nenhuma ocorrência\n", branch, image_files[i]);
+            } else {
+                printf("  %s %s: %d ocorrência(s) (melhor NCC %.3f)\n", branch,
+                       image_files[i], r->num_matches, r->best_match);
+            }
+        }
+        printf("\n");
+    }
+
+    // Defeitos contra a referência golden (máscaras em *_golden.png)
+    if (g_config.filters & FILTER_BIT(FILTER_GOLDEN)) {
+        printf("  Defeitos (golden) por imagem:\n");
+        for (int i = 0; i < num_images; i++) {
+            const image_report_t *r = &stats->reports[i];
+            const char *branch = i + 1 < num_images ? "├─" : "└─";
+            if (r->golden_defects < 0) {
+                printf("  %s %s: sem resultado\n", branch, image_files[i]);
+            } else {
+                printf("  %s %s: %ld px (%.3f%%)\n", branch, image_files[i], r->golden_defects,
+                       r->golden_pixels > 0 ? 100.0 * r->golden_defects / r->golden_pixels : 0);
+            }
+        }
+        printf("\n");
+    }
+
+    // Pixels por classe de cor (rótulos em *_classify.jpg)
+    if (g_config.filters & FILTER_BIT(FILTER_CLASSIFY)) {
+        printf("  Classes de cor por imagem:\n");
+        for (int i = 0; i < num_images; i++) {
+            const image_report_t *r = &stats->reports[i];
+            const char *branch = i + 1 < num_images ? "├─" : "└─";
+            if (r->num_classes < 0) {
+                printf("  %s %s: sem resultado\n", branch, image_files[i]);
+                continue;
+            }
+            long total = 0;
+            for (int c = 0; c <= r->num_classes; c++) total += r->class_counts[c];
+            printf("  %s %s:", branch, image_files[i]);
+            for (int c = 1; c <= r->num_classes; c++) {
+                printf(" %s %.1f%%,", g_config.classes[c - 1].name,
+                       total > 0 ? 100.0 * r->class_counts[c] / total : 0);
+            }
+            printf(" sem classe %.1f%%\n", total > 0 ? 100.0 * r->class_counts[0] / total : 0);
+        }
+        printf("\n");
+    }
 }
 
 /**
@@ -163,7 +314,9 @@ void print_statistics(shared_stats_t *stats) {
 void print_config(void) {
     printf("  Configuração:\n");
     printf("  ├─ Workers:     %d processos\n", NUM_WORKERS);
-    printf("  ├─ Threads:     %d por worker\n", NUM_THREADS);
+    printf("  ├─ Threads:     %d por worker\n", g_config.num_threads);
+    printf("  ├─ SIMD:        %s\n", cpu_simd_name(cpu_simd_level()));
+    config_print(&g_config);
     printf("  ├─ Entrada:     %s/\n", INPUT_DIR);
     printf("  └─ Saída:       %s/\n", OUTPUT_DIR);
     printf("\n");
@@ -190,29 +343,35 @@ void* log_reader_thread(void *arg) {
  * @brief Ponto de entrada principal
  */
 int main(int argc, char *argv[]) {
+    config_init(&g_config);
+    
     // Verifica argumentos
-    if (argc > 1) {
-        if (strcmp(argv[1], "--version") == 0 || strcmp(argv[1], "-v") == 0) {
-            favis_print_version();
-            return 0;
-        }
-        if (strcmp(argv[1], "--help") == 0 || strcmp(argv[1], "-h") == 0) {
-            favis_print_version();
-            printf("\nUso: %s [opções]\n\n", argv[0]);
-            printf("Opções:\n");
-            printf("  -v, --version    Mostra versão\n");
-            printf("  -h, --help       Mostra esta ajuda\n");
-            printf("\nColoque imagens em '%s/' e execute sem argumentos.\n", INPUT_DIR);
-            return 0;
-        }
+    int args_status = config_parse_args(&g_config, argc, argv);
+    if (args_status != 0) {
+        return args_status > 0 ? 0 : 1;
     }
     
     struct timespec start_time, end_time;
     clock_gettime(CLOCK_MONOTONIC, &start_time);
     
+    // Seleciona kernels SIMD uma única vez (herdado pelos workers no fork)
+    filters_init();
+    
     print_header();
     print_config();
     
+    // Quadros de calibração decodificados uma única vez, antes do fork
+    if (calib_load(&g_calib, &g_config) != 0) {
+        LOG_ERROR("Falha ao carregar quadros de calibração");
+        return 1;
+    }
+    // LUT de classes montada uma única vez, também antes do fork
+    if (class_lut_build(&g_classes, &g_config) != 0) {
+        LOG_ERROR("Falha ao montar LUT de classes");
+        calib_free(&g_calib);
+        return 1;
+    }
+    
     // Configura handler de sinais
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
@@ -242,6 +401,16 @@ int main(int argc, char *argv[]) {
         return 1;
     }
     printf("  ├─ Memória compartilhada: %s ✓\n", SHM_NAME);
+
+    // Referências golden decodificadas uma única vez, ao lado das estatísticas
+    if (golden_create(&g_golden, &g_config) != 0) {
+        LOG_ERROR("Falha ao carregar referências golden");
+        cleanup_ipc_coordinator(g_mq, g_stats, g_shm_fd);
+        return 1;
+    }
+    if (g_golden.header) printf("  ├─ Referências golden: %s ✓\n", GOLDEN_SHM_NAME);
+    if (g_classes.active) printf("  ├─ LUT de classes: %d classes, %d KiB ✓\n",
+                                 g_classes.classes, (int)(g_classes.block_bytes >> 10));
     
     // Inicializa mutex e cond na memória compartilhada
     if (init_shared_mutex(&g_stats->mutex, &g_stats->mutex_attr) != 0) {
@@ -297,6 +466,12 @@ int main(int argc, char *argv[]) {
     g_stats->total_processing_time = 0;
     g_stats->workers_active = 0;
     g_stats->workers_done = 0;
+    for (int i = 0; i < MAX_IMAGES; i++) {
+        g_stats->reports[i].num_blobs = -1;
+        g_stats->reports[i].num_matches = -1;
+        g_stats->reports[i].golden_defects = -1;
+        g_stats->reports[i].num_classes = -1;
+    }
     
     // ========================================================================
     // CRIAÇÃO DOS WORKERS (FORK)
@@ -322,7 +497,7 @@ int main(int argc, char *argv[]) {
         if (pid == 0) {
             // Processo filho (worker)
             close(log_pipe[0]);  // Fecha leitura
-            worker_main(i, log_pipe[1]);
+            worker_main(i, log_pipe[1], &g_config, &g_calib, &g_classes);
             // worker_main chama exit()
         }
         
@@ -427,6 +602,9 @@ int main(int argc, char *argv[]) {
     destroy_cond(&g_stats->cond_finished, &g_stats->cond_attr);
     cleanup_sync(g_io_sem);
     cleanup_ipc_coordinator(g_mq, g_stats, g_shm_fd);
+    calib_free(&g_calib);
+    class_lut_free(&g_classes);
+    golden_close(&g_golden);
     
     return 0;
 }
@@ -0,0 +1,491 @@
+#include "match.h"
+#include "filters.h"
+#include <math.h>
+
+// ============================================================
+// TEMPLATES
+// ============================================================
+
+static void match_level_stats(match_level_t *lv) {
+    int64_t n = (int64_t)lv->width * lv->height;
+    uint64_t sum = 0, sq = 0;
+    for (int y = 0; y < lv->height; y++) {
+        const unsigned char *row = lv->data + (size_t)y * lv->width;
+        for (int x = 0; x < lv->width; x++) sum += row[x];
+        sq += g_kernels.dot_u8(row, row, lv->width);
+    }
+    lv->sum = (int64_t)sum;
+    lv->var = n * (int64_t)sq - lv->sum * lv->sum;
+}
+
+// Próximo nível (média 2x2); retorna 0 se ainda tem textura, -1 se não
+static int match_level_down(const match_level_t *src, match_level_t *dst) {
+    dst->width = src->width / 2;
+    dst->height = src->height / 2;
+    dst->data = (unsigned char*)malloc((size_t)dst->width * dst->height);
+    if (!dst->data) return -1;
+
+    for (int y = 0; y < dst->height; y++) {
+        const unsigned char *r0 = src->data + (size_t)(2 * y) * src->width;
+        g_kernels.pyr_down_row(r0, r0 + src->width, dst->data + (size_t)y * dst->width,
+                               dst->width);
+    }
+    match_level_stats(dst);
+    return dst->var > 0 ? 0 : -1;
+}
+
+static int match_template_load(match_template_t *t, const char *path) {
+    int w, h, c;
+    unsigned char *img = load_image(path, &w, &h, &c);
+    if (!img) return -1;
+
+    get_basename(path, t->name);
+    if (w < 2 || h < 2 || w > MATCH_MAX_SIDE || (long)w * h > MATCH_MAX_AREA) {
+        LOG_ERROR("Tamanho de template inválido: %s (%dx%d; lados 2 a %d, até %ld pixels)",
+                  path, w, h, MATCH_MAX_SIDE, (long)MATCH_MAX_AREA);
+        free_image(img);
+        return -1;
+    }
+
+    match_level_t *base = &t->level[0];
+    base->width = w;
+    base->height = h;
+    base->data = (unsigned char*)malloc((size_t)w * h);
+    if (!base->data) {
+        LOG_ERROR("Falha ao alocar template: %s", path);
+        free_image(img);
+        return -1;
+    }
+    luma_rows(img, base->data, w * h, c);
+    free_image(img);
+
+    match_level_stats(base);
+    if (base->var <= 0) {
+        LOG_ERROR("Template uniforme (NCC indefinido): %s", path);
+        return -1;
+    }
+
+    // Reduz enquanto o menor lado comporta MATCH_COARSE_SIDE e há textura
+    t->levels = 1;
+    while (t->levels < MATCH_MAX_LEVELS) {
+        const match_level_t *prev = &t->level[t->levels - 1];
+        match_level_t *next = &t->level[t->levels];
+        if (MIN(prev->width, prev->height) / 2 < MATCH_COARSE_SIDE) break;
+        if (match_level_down(prev, next) != 0) {
+            free(next->data);
+            next->data = NULL;
+            break;
+        }
+        t->levels++;
+    }
+    return 0;
+}
+
+int match_templates_load(match_template_set_t *set, const char paths[][MAX_PATH], int count) {
+    memset(set, 0, sizeof(*set));
+    for (int i = 0; i < count && i < MATCH_MAX_TEMPLATES; i++) {
+        set->count++;
+        if (match_template_load(&set->templates[i], paths[i]) != 0) {
+            match_templates_free(set);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void match_templates_free(match_template_set_t *set) {
+    for (int i = 0; i < set->count; i++) {
+        for (int l = 0; l < MATCH_MAX_LEVELS; l++) {
+            free(set->templates[i].level[l].data);
+            set->templates[i].level[l].data = NULL;
+        }
+    }
+    set->count = 0;
+}
+
+// ============================================================
+// NCC
+// ============================================================
+
+typedef struct {
+    int width, height;
+    const unsigned char *data;
+    const integral_t *ii;
+} match_image_t;
+
+// NCC = (n·Σ(I·T) − ΣI·ΣT) / sqrt((n·ΣI² − (ΣI)²) · var_T), somas exatas em
+// int64; ΣI e ΣI² da janela saem da imagem integral em O(1)
+static double match_ncc(const match_image_t *img, const match_level_t *t, int x, int y,
+                        uint64_t dot) {
+    int64_t n = (int64_t)t->width * t->height;
+    int64_t si = (int64_t)integral_sum(img->ii, x, y, x + t->width, y + t->height);
+    int64_t sq = (int64_t)integral_sq_sum(img->ii, x, y, x + t->width, y + t->height);
+    int64_t var = n * sq - si * si;
+    if (var <= 0) return 0.0;
+
+    int64_t num = n * (int64_t)dot - si * t->sum;
+    return (double)num / sqrt((double)var * (double)t->var);
+}
+
+// Score de uma posição isolada (refinamento)
+static double match_score(const match_image_t *img, const match_level_t *t, int x, int y) {
+    uint64_t dot = 0;
+    const unsigned char *src = img->data + (size_t)y * img->width + x;
+    for (int r = 0; r < t->height; r++) {
+        dot += g_kernels.dot_u8(src + (size_t)r * img->width, t->data + (size_t)r * t->width,
+                                t->width);
+    }
+    return match_ncc(img, t, x, y, dot);
+}
+
+// ============================================================
+// BUSCA
+// ============================================================
+
+typedef struct {
+    const match_template_set_t *set;
+    double threshold;
+    int num_tiles;
+
+    // Pirâmide da imagem (nível 0 = luma e integral recebidos)
+    int levels;
+    match_image_t img[MATCH_MAX_LEVELS];
+    unsigned char *pyr[MATCH_MAX_LEVELS];
+    integral_t pyr_ii[MATCH_MAX_LEVELS];
+    int build, build_tiles;             // Nível em construção
+
+    // Template atual
+    const match_template_t *tpl;
+    int coarse;                         // Nível da busca exaustiva
+    float *scores;                      // sw × sh posições do nível grosso
+    int sw, sh;
+    match_t *cands;
+    int num_cands, cap_cands;
+    int failed;
+} match_job_t;
+
+static inline int match_tile_begin(int n, int tile, int num_tiles) {
+    return (int)((long)n * tile / num_tiles);
+}
+
+// Um nível da pirâmide a partir do anterior, já com sua integral (faixa local)
+static void match_pyr_task(void *arg, int tile) {
+    match_job_t *job = (match_job_t*)arg;
+    const match_image_t *src = &job->img[job->build - 1];
+    const match_image_t *dst = &job->img[job->build];
+    unsigned char *out = job->pyr[job->build];
+    int y0 = match_tile_begin(dst->height, tile, job->build_tiles);
+    int y1 = match_tile_begin(dst->height, tile + 1, job->build_tiles);
+
+    for (int y = y0; y < y1; y++) {
+        const unsigned char *r0 = src->data + (size_t)(2 * y) * src->width;
+        g_kernels.pyr_down_row(r0, r0 + src->width, out + (size_t)y * dst->width, dst->width);
+    }
+    integral_rows(&job->pyr_ii[job->build], out + (size_t)y0 * dst->width, y0, y1 - y0, y0);
+}
+
+static int match_build_pyramid(match_job_t *job, int levels, thread_pool_t *pool) {
+    for (int l = 1; l < levels; l++) {
+        int w = job->img[l - 1].width / 2, h = job->img[l - 1].height / 2;
+        if (w < 1 || h < 1) break;
+        if ((job->pyr[l] = (unsigned char*)malloc((size_t)w * h)) == NULL ||
+            integral_init(&job->pyr_ii[l], w, h, 1) != 0) {
+            return -1;
+        }
+        job->img[l] = (match_image_t){ w, h, job->pyr[l], &job->pyr_ii[l] };
+        job->build = l;
+        job->build_tiles = MIN(job->num_tiles, h);
+        thread_pool_run(pool, match_pyr_task, job, job->build_tiles);
+        if (integral_merge_bands(&job->pyr_ii[l], job->build_tiles, pool) != 0) return -1;
+        job->levels = l + 1;
+    }
+    return 0;
+}
+
+// Busca exaustiva do nível grosso, em faixas de linhas do mapa de scores.
+// Σ(I·T) de uma linha inteira de posições de uma vez: cada par de
+// coeficientes do template multiplica a linha da imagem deslocada
+// (vetoriza ao longo de x, qualquer que seja a largura do template)
+static void match_coarse_task(void *arg, int tile) {
+    match_job_t *job = (match_job_t*)arg;
+    const match_image_t *img = &job->img[job->coarse];
+    const match_level_t *t = &job->tpl->level[job->coarse];
+    const int sw = job->sw, tw = t->width;
+    int tiles = MIN(job->num_tiles, job->sh);
+    int y0 = match_tile_begin(job->sh, tile, tiles);
+    int y1 = match_tile_begin(job->sh, tile + 1, tiles);
+
+    // Acumuladores de 32 bits descarregados a cada flush_rows linhas
+    int flush_rows = MAX(1, MATCH_ACC_PIXELS / tw);
+    int chunks = t->height > flush_rows;
+    uint32_t *acc = (uint32_t*)malloc((size_t)sw * sizeof(uint32_t));
+    uint64_t *acc64 = chunks ? (uint64_t*)malloc((size_t)sw * sizeof(uint64_t)) : NULL;
+    if (!acc || (chunks && !acc64)) {
+        free(acc);
+        __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    for (int y = y0; y < y1; y++) {
+        if (acc64) memset(acc64, 0, (size_t)sw * sizeof(uint64_t));
+        for (int r0 = 0; r0 < t->height; r0 += flush_rows) {
+            memset(acc, 0, (size_t)sw * sizeof(uint32_t));
+            for (int r = r0; r < MIN(t->height, r0 + flush_rows); r++) {
+                const unsigned char *src = img->data + (size_t)(y + r) * img->width;
+                const unsigned char *trow = t->data + (size_t)r * tw;
+                int c = 0;
+                for (; c + 1 < tw; c += 2) {
+                    g_kernels.ncc_mac_row(src + c, trow[c], trow[c + 1], acc, sw);
+                }
+                // Coluna ímpar final: par com a anterior (coeficiente 0), sem
+                // ler além da linha
+                if (c < tw) g_kernels.ncc_mac_row(src + c - 1, 0, trow[c], acc, sw);
+            }
+            if (acc64) {
+                for (int x = 0; x < sw; x++) acc64[x] += acc[x];
+            }
+        }
+
+        float *row = job->scores + (size_t)y * sw;
+        for (int x = 0; x < sw; x++) {
+            row[x] = (float)match_ncc(img, t, x, y, acc64 ? acc64[x] : acc[x]);
+        }
+    }
+
+    free(acc);
+    free(acc64);
+}
+
+// Desce um candidato até o nível 0; score < 0 marca descarte
+static void match_refine(match_job_t *job, match_t *c) {
+    const double keep = job->threshold - MATCH_COARSE_SLACK;
+    for (int l = job->coarse - 1; l >= 0; l--) {
+        const match_image_t *img = &job->img[l];
+        const match_level_t *t = &job->tpl->level[l];
+        int xa = MAX(0, 2 * c->x - MATCH_REFINE_RADIUS);
+        int xb = MIN(img->width - t->width, 2 * c->x + MATCH_REFINE_RADIUS);
+        int ya = MAX(0, 2 * c->y - MATCH_REFINE_RADIUS);
+        int yb = MIN(img->height - t->height, 2 * c->y + MATCH_REFINE_RADIUS);
+
+        double best = -2.0;
+        for (int y = ya; y <= yb; y++) {
+            for (int x = xa; x <= xb; x++) {
+                double s = match_score(img, t, x, y);
+                if (s > best) {
+                    best = s;
+                    c->x = x;
+                    c->y = y;
+                }
+            }
+        }
+        c->score = best;
+        if (best < keep) {
+            c->score = -2.0;
+            return;
+        }
+    }
+}
+
+static void match_refine_task(void *arg, int tile) {
+    match_job_t *job = (match_job_t*)arg;
+    int tiles = MIN(job->num_tiles, job->num_cands);
+    int i0 = match_tile_begin(job->num_cands, tile, tiles);
+    int i1 = match_tile_begin(job->num_cands, tile + 1, tiles);
+    for (int i = i0; i < i1; i++) {
+        match_refine(job, &job->cands[i]);
+    }
+}
+
+static int match_push(match_t **items, int *count, int *cap, const match_t *m) {
+    if (*count == *cap) {
+        int n = *cap ? 2 * *cap : 64;
+        match_t *p = (match_t*)realloc(*items, (size_t)n * sizeof(match_t));
+        if (!p) return -1;
+        *items = p;
+        *cap = n;
+    }
+    (*items)[(*count)++] = *m;
+    return 0;
+}
+
+// Score decrescente; empates pela posição (resultado independe das threads)
+static int match_cmp(const void *a, const void *b) {
+    const match_t *ma = (const match_t*)a, *mb = (const match_t*)b;
+    if (ma->score != mb->score) return ma->score > mb->score ? -1 : 1;
+    if (ma->y != mb->y) return ma->y - mb->y;
+    return ma->x - mb->x;
+}
+
+// Máximos locais (3x3) do mapa de scores acima do limiar do nível grosso
+static int match_collect(match_job_t *job, int id) {
+    const double keep = job->coarse > 0 ? job->threshold - MATCH_COARSE_SLACK : job->threshold;
+    const int sw = job->sw, sh = job->sh;
+    job->num_cands = 0;
+
+    for (int y = 0; y < sh; y++) {
+        for (int x = 0; x < sw; x++) {
+            float s = job->scores[(size_t)y * sw + x];
+            if (s < keep) continue;
+            int is_max = 1;
+            for (int ny = MAX(0, y - 1); ny <= MIN(sh - 1, y + 1) && is_max; ny++) {
+                for (int nx = MAX(0, x - 1); nx <= MIN(sw - 1, x + 1); nx++) {
+                    float v = job->scores[(size_t)ny * sw + nx];
+                    // Platô: fica o primeiro na ordem de varredura
+                    if (v > s || (v == s && (ny < y || (ny == y && nx < x)))) {
+                        is_max = 0;
+                        break;
+                    }
+                }
+            }
+            if (!is_max) continue;
+            match_t m = { .template_id = id, .x = x, .y = y, .score = s };
+            if (match_push(&job->cands, &job->num_cands, &job->cap_cands, &m) != 0) return -1;
+        }
+    }
+
+    if (job->num_cands > 0) {
+        qsort(job->cands, job->num_cands, sizeof(match_t), match_cmp);
+    }
+    job->num_cands = MIN(job->num_cands, MATCH_MAX_CANDIDATES);
+    return 0;
+}
+
+// Ocorrências finais do template: score >= limiar, sem sobreposição
+static int match_select(match_job_t *job, match_list_t *out) {
+    const match_level_t *t = &job->tpl->level[0];
+    if (job->num_cands > 0) {
+        qsort(job->cands, job->num_cands, sizeof(match_t), match_cmp);
+    }
+
+    int first = out->count;
+    for (int i = 0; i < job->num_cands; i++) {
+        match_t m = job->cands[i];
+        if (m.score < job->threshold) break;
+
+        int overlap = 0;
+        for (int k = first; k < out->count && !overlap; k++) {
+            overlap = abs(out->items[k].x - m.x) < t->width / 2 + 1 &&
+                      abs(out->items[k].y - m.y) < t->height / 2 + 1;
+        }
+        if (overlap) continue;
+
+        m.width = t->width;
+        m.height = t->height;
+        if (match_push(&out->items, &out->count, &out->cap, &m) != 0) return -1;
+    }
+    return 0;
+}
+
+static int match_template(match_job_t *job, int id, thread_pool_t *pool, match_list_t *out) {
+    const match_template_t *tpl = &job->set->templates[id];
+    job->tpl = tpl;
+
+    // Nível grosso: o mais alto comum à imagem e ao template onde ele cabe
+    job->coarse = MIN(tpl->levels, job->levels) - 1;
+    while (job->coarse >= 0 &&
+           (tpl->level[job->coarse].width > job->img[job->coarse].width ||
+            tpl->level[job->coarse].height > job->img[job->coarse].height)) {
+        job->coarse--;
+    }
+    if (job->coarse < 0) return 0;
+
+    job->sw = job->img[job->coarse].width - tpl->level[job->coarse].width + 1;
+    job->sh = job->img[job->coarse].height - tpl->level[job->coarse].height + 1;
+    free(job->scores);
+    job->scores = (float*)malloc((size_t)job->sw * job->sh * sizeof(float));
+    if (!job->scores) return -1;
+
+    thread_pool_run(pool, match_coarse_task, job, MIN(job->num_tiles, job->sh));
+    if (job->failed || match_collect(job, id) != 0) return -1;
+    if (job->coarse > 0 && job->num_cands > 0) {
+        thread_pool_run(pool, match_refine_task, job, MIN(job->num_tiles, job->num_cands));
+    }
+    return match_select(job, out);
+}
+
+int match_find(const match_template_set_t *set, const unsigned char *luma, const integral_t *ii,
+               double threshold, int num_tiles, thread_pool_t *pool, match_list_t *out) {
+    out->count = 0;
+    if (!ii->sqsum) {
+        LOG_ERROR("Template matching requer a integral dos quadrados");
+        return -1;
+    }
+
+    match_job_t *job = (match_job_t*)calloc(1, sizeof(match_job_t));
+    if (!job) return -1;
+    job->set = set;
+    job->threshold = threshold;
+    job->num_tiles = MAX(1, MIN(num_tiles, POOL_MAX_THREADS));
+    job->levels = 1;
+    job->img[0] = (match_image_t){ ii->width, ii->height, luma, ii };
+
+    int levels = 1;
+    for (int i = 0; i < set->count; i++) {
+        levels = MAX(levels, set->templates[i].levels);
+    }
+
+    int ok = match_build_pyramid(job, levels, pool) == 0;
+    for (int i = 0; ok && i < set->count; i++) {
+        ok = match_template(job, i, pool, out) == 0;
+    }
+    if (!ok) {
+        LOG_ERROR("Falha no template matching (%dx%d)", ii->width, ii->height);
+    }
+
+    for (int l = 1; l < MATCH_MAX_LEVELS; l++) {
+        free(job->pyr[l]);
+        integral_free(&job->pyr_ii[l]);
+    }
+    free(job->scores);
+    free(job->cands);
+    free(job);
+    return ok ? 0 : -1;
+}
+
+void match_list_free(match_list_t *list) {
+    free(list->items);
+    list->items = NULL;
+    list->count = list->cap = 0;
+}
+
+// ============================================================
+// SAÍDAS
+// ============================================================
+
+void match_draw(const match_list_t *list, unsigned char *dst, int width, int height) {
+    const int thick = 2;
+    for (int i = 0; i < list->count; i++) {
+        const match_t *m = &list->items[i];
+        int x0 = MAX(0, m->x), x1 = MIN(width, m->x + m->width);
+        int y0 = MAX(0, m->y), y1 = MIN(height, m->y + m->height);
+        for (int y = y0; y < y1; y++) {
+            unsigned char *row = dst + (size_t)y * width;
+            if (y < y0 + thick || y >= y1 - thick) {
+                memset(row + x0, 255, x1 - x0);
+                continue;
+            }
+            for (int x = x0; x < MIN(x1, x0 + thick); x++) row[x] = 255;
+            for (int x = MAX(x0, x1 - thick); x < x1; x++) row[x] = 255;
+        }
+    }
+}
+
+int match_write_csv(const match_list_t *list, const match_template_set_t *set, const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        LOG_ERROR("Falha ao criar %s", path);
+        return -1;
+    }
+
+    fprintf(f, "template,x,y,width,height,score\n");
+    for (int i = 0; i < list->count; i++) {
+        const match_t *m = &list->items[i];
+        fprintf(f, "%s,%d,%d,%d,%d,%.4f\n", set->templates[m->template_id].name,
+                m->x, m->y, m->width, m->height, m->score);
+    }
+
+    int ok = !ferror(f);
+    if (fclose(f) != 0) ok = 0;
+    if (!ok) LOG_ERROR("Falha ao escrever %s", path);
+    return ok ? 0 : -1;
+}
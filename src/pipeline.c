@@ -0,0 +1,751 @@
+#include "pipeline.h"
+
+// ============================================================
+// SAÍDAS
+// ============================================================
+
+static pipeline_output_t* pipeline_add_output(pipeline_t *p, int filter_type, const char *name,
+                                              int width, int height, int channels) {
+    pipeline_output_t *out = &p->outputs[p->num_outputs];
+    out->filter_type = filter_type;
+    out->name = name;
+    out->width = width;
+    out->height = height;
+    out->channels = channels;
+    out->depth = 8;
+    out->data = (unsigned char*)malloc((size_t)width * height * channels);
+    if (!out->data) {
+        LOG_ERROR("Falha ao alocar saída (%s)", name);
+        return NULL;
+    }
+    p->num_outputs++;
+    return out;
+}
+
+static int pipeline_enabled(const pipeline_t *p, int filter_type) {
+    return (p->config->filters & FILTER_BIT(filter_type)) != 0;
+}
+
+// Demosaico, calibração ou LUT: a faixa de cache é corrigida antes dos estágios
+static int pipeline_corrects(const pipeline_t *p) {
+    return p->bayer || p->calib || p->tone;
+}
+
+// ============================================================
+// RECURSOS DO WORKER
+// ============================================================
+
+int pipeline_resources_load(pipeline_resources_t *res, const pipeline_config_t *config) {
+    memset(res, 0, sizeof(*res));
+    if (tone_lut_build(&res->tone, config) != 0) return -1;
+    if ((config->filters & FILTER_BIT(FILTER_MATCH)) &&
+        match_templates_load(&res->templates, config->match_templates,
+                             config->num_templates) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+void pipeline_resources_free(pipeline_resources_t *res) {
+    match_templates_free(&res->templates);
+    tone_lut_free(&res->tone);
+}
+
+// ============================================================
+// PREPARAÇÃO
+// ============================================================
+
+int pipeline_init(pipeline_t *p, const unsigned char *src, int width, int height,
+                  int channels, const pipeline_config_t *config,
+                  const pipeline_resources_t *resources) {
+    memset(p, 0, sizeof(*p));
+    p->src = src;
+    p->width = width;
+    p->height = height;
+    p->channels = channels;
+    p->config = config;
+    p->resources = resources;
+    p->calib = resources ? resources->calib : NULL;
+    p->tone = resources && resources->tone.active ? &resources->tone : NULL;
+    p->has_stats = config->image_stats && channels <= MAX_CHANNELS;
+
+    int w = width, h = height, c = channels;
+    int ok = 1;
+
+    if (p->calib && !calib_matches(p->calib, w, h, c)) {
+        LOG_ERROR("Imagem %dx%d (%d canais) difere dos quadros de calibração (%dx%d, %d canais)",
+                  w, h, c, p->calib->width, p->calib->height, p->calib->channels);
+        ok = 0;
+    }
+    // Quadro Bayer: estágios veem a imagem demosaicada (RGB ou luminância)
+    if (ok && config->bayer_pattern != BAYER_NONE) {
+        if (c != 1) {
+            LOG_ERROR("Imagem com %d canais não é um quadro Bayer (--bayer)", c);
+            ok = 0;
+        } else if (w < BAYER_MIN_SIDE || h < BAYER_MIN_SIDE) {
+            LOG_ERROR("Imagem Bayer %dx%d menor que %dx%d", w, h, BAYER_MIN_SIDE, BAYER_MIN_SIDE);
+            ok = 0;
+        } else {
+            p->bayer = 1;
+            p->channels = c = demosaic_channels(config);
+        }
+    }
+
+    if (ok && pipeline_enabled(p, FILTER_GRAYSCALE)) {
+        ok = (p->gray = pipeline_add_output(p, FILTER_GRAYSCALE, "grayscale", w, h, c)) != NULL;
+    }
+    if (ok && pipeline_enabled(p, FILTER_BLUR)) {
+        ok = (p->blur = pipeline_add_output(p, FILTER_BLUR, "blur", w, h, c)) != NULL;
+    }
+    if (ok && pipeline_enabled(p, FILTER_MEDIAN)) {
+        ok = (p->median = pipeline_add_output(p, FILTER_MEDIAN, "median", w, h, c)) != NULL;
+    }
+    if (ok && pipeline_enabled(p, FILTER_RESIZE)) {
+        int rw, rh;
+        resize_target_size(config, w, h, &rw, &rh);
+        ok = (p->resize = pipeline_add_output(p, FILTER_RESIZE, "resize", rw, rh, c)) != NULL &&
+             (p->resize_plan = resize_plan_get(w, h, rw, rh,
+                                               (resize_mode_t)config->resize_mode)) != NULL;
+    }
+    if (ok && pipeline_enabled(p, FILTER_SOBEL)) {
+        // Sobel opera no plano de luminância: saídas de 1 canal
+        ok = (p->sobel = pipeline_add_output(p, FILTER_SOBEL, "sobel", w, h, 1)) != NULL;
+        if (ok && config->sobel_direction) {
+            ok = (p->sobel_dir = pipeline_add_output(p, FILTER_SOBEL, "sobel_dir", w, h, 1)) != NULL;
+        }
+    }
+
+    // Morfologia binária opera sobre a saída do threshold
+    int morph_binary = pipeline_enabled(p, FILTER_MORPH) &&
+                       config->morph_input == MORPH_INPUT_BINARY;
+    if (ok && (pipeline_enabled(p, FILTER_THRESHOLD) || morph_binary ||
+               pipeline_enabled(p, FILTER_BLOBS))) {
+        ok = (p->threshold = pipeline_add_output(p, FILTER_THRESHOLD, "threshold", w, h, 1)) != NULL;
+        p->has_luma_hist = config->threshold_mode == THRESH_OTSU;
+    }
+    if (ok && pipeline_enabled(p, FILTER_CANNY)) {
+        // Mapa de classes da primeira fase vira a saída após a histerese
+        ok = (p->canny = pipeline_add_output(p, FILTER_CANNY, "canny", w, h, 1)) != NULL;
+    }
+    if (ok && pipeline_enabled(p, FILTER_MORPH)) {
+        ok = (p->morph = pipeline_add_output(p, FILTER_MORPH, "morph", w, h, 1)) != NULL;
+    }
+    if (ok && pipeline_enabled(p, FILTER_BLOBS)) {
+        // Uma cor por blob; rótulos e medidas ficam em blob_set
+        ok = (p->blobs = pipeline_add_output(p, FILTER_BLOBS, "blobs", w, h, 3)) != NULL &&
+             blob_set_init(&p->blob_set, w, h) == 0;
+    }
+    if (ok && pipeline_enabled(p, FILTER_PYRAMID)) {
+        // Saídas apontam para o bloco da pirâmide (não são liberadas uma a uma)
+        static const char *names[PYRAMID_LEVELS + 1] = { NULL, "pyr2", "pyr4", "pyr8" };
+        ok = pyramid_init(&p->pyramid, w, h, c) == 0;
+        for (int l = 1; ok && l <= p->pyramid.levels; l++) {
+            pipeline_output_t *out = &p->outputs[p->num_outputs++];
+            *out = (pipeline_output_t){ .filter_type = FILTER_PYRAMID, .name = names[l],
+                                        .data = p->pyramid.level[l],
+                                        .width = p->pyramid.width[l],
+                                        .height = p->pyramid.height[l],
+                                        .channels = c, .depth = 8 };
+        }
+    }
+    if (ok && pipeline_enabled(p, FILTER_REMAP)) {
+        if (config->remap_mode == REMAP_NONE) {
+            LOG_ERROR("Filtro remap sem geometria (--remap)");
+            ok = 0;
+        } else {
+            int dw, dh;
+            remap_target_size(config, w, h, &dw, &dh);
+            ok = (p->remap_map = remap_map_get(config, w, h)) != NULL &&
+                 (p->remap = pipeline_add_output(p, FILTER_REMAP, "remap", dw, dh, c)) != NULL &&
+                 planar_init(&p->remap_src, w, h + 1, c) == 0;
+        }
+    }
+    if (ok && pipeline_enabled(p, FILTER_GOLDEN)) {
+        // Referência escolhida pela geometria (após o demosaico)
+        const golden_set_t *set = resources ? resources->golden : NULL;
+        const golden_ref_t *ref = golden_find(set, w, h);
+        if (!ref) {
+            LOG_ERROR("Sem referência golden %dx%d", w, h);
+            ok = 0;
+        } else {
+            p->golden_luma = golden_luma(set, ref);
+            p->golden_tol = golden_tolerance(set, ref);
+            ok = (p->golden = pipeline_add_output(p, FILTER_GOLDEN, "golden", w, h, 1)) != NULL;
+        }
+    }
+    if (ok && pipeline_enabled(p, FILTER_COLOR)) {
+        // Um plano de 1 canal por componente de cada espaço pedido
+        for (int space = 0; ok && space < COLOR_SPACE_COUNT; space++) {
+            if (!(config->color_spaces & COLOR_SPACE_BIT(space))) continue;
+            for (int k = 0; ok && k < COLOR_PLANES; k++) {
+                ok = (p->color[space][k] = pipeline_add_output(p, FILTER_COLOR,
+                                                               color_plane_name(space, k),
+                                                               w, h, 1)) != NULL;
+            }
+        }
+    }
+    if (ok && pipeline_enabled(p, FILTER_CLASSIFY)) {
+        if (!resources || !resources->class_lut) {
+            LOG_ERROR("Filtro classify sem LUT de classes");
+            ok = 0;
+        } else {
+            // Rótulo da classe por pixel (id × CLASS_LABEL_STEP)
+            p->class_lut = resources->class_lut;
+            ok = (p->classify = pipeline_add_output(p, FILTER_CLASSIFY, "classify", w, h, 1)) != NULL;
+        }
+    }
+    if (ok && pipeline_enabled(p, FILTER_MATCH)) {
+        if (!resources || resources->templates.count == 0) {
+            LOG_ERROR("Filtro match sem templates carregados");
+            ok = 0;
+        } else {
+            // Luminância com o contorno de cada ocorrência
+            ok = (p->match = pipeline_add_output(p, FILTER_MATCH, "match", w, h, 1)) != NULL;
+        }
+    }
+
+    // Otsu, média local e morfologia em cinza dependem da imagem inteira:
+    // segunda fase, sobre o plano de luminância completo
+    int needs_plane = (p->threshold && config->threshold_mode != THRESH_FIXED) ||
+                      (p->morph && !morph_binary) || p->match;
+    if (ok && needs_plane) {
+        // Com correções o plano guarda a origem corrigida
+        if (c == 1 && !pipeline_corrects(p)) {
+            p->luma = src;
+        } else {
+            ok = (p->luma = p->luma_buf = (unsigned char*)malloc((size_t)w * h)) != NULL;
+        }
+    }
+    // Média local consulta somas; o NCC também as somas dos quadrados
+    if (ok && ((p->threshold && config->threshold_mode == THRESH_MEAN) || p->match)) {
+        ok = integral_init(&p->integral, w, h, p->match != NULL) == 0;
+    }
+
+    if (!ok) {
+        LOG_ERROR("Falha ao preparar pipeline (%dx%d)", w, h);
+        pipeline_free(p);
+        return -1;
+    }
+    return 0;
+}
+
+void pipeline_free(pipeline_t *p) {
+    for (int i = 0; i < p->num_outputs; i++) {
+        if (p->outputs[i].filter_type != FILTER_PYRAMID) free(p->outputs[i].data);
+        p->outputs[i].data = NULL;
+    }
+    p->num_outputs = 0;
+    pyramid_free(&p->pyramid);
+
+    if (p->remap_map) {
+        remap_map_release(p->remap_map);
+        p->remap_map = NULL;
+    }
+    planar_free(&p->remap_src);
+
+    if (p->resize_plan) {
+        resize_plan_release(p->resize_plan);
+        p->resize_plan = NULL;
+    }
+
+    free(p->luma_buf);
+    p->luma_buf = NULL;
+    p->luma = NULL;
+    integral_free(&p->integral);
+    blob_set_free(&p->blob_set);
+    match_list_free(&p->matches);
+}
+
+// ============================================================
+// PASSO FUNDIDO
+// ============================================================
+
+typedef struct {
+    pipeline_t *p;
+    int num_tiles;
+    int failed;
+} pipeline_job_t;
+
+// Estágios que consomem o plano de luminância na primeira fase. A imagem
+// integral (média local, NCC) é montada aqui mesmo quando o plano é a
+// própria origem (cinza sem correções, luma_buf NULL)
+static int pipeline_needs_luma(const pipeline_t *p) {
+    return p->sobel || p->threshold || p->canny || p->golden || p->luma_buf ||
+           p->integral.sum;
+}
+
+// Blur, mediana, resize, pirâmide, cor e classes trabalham em planos: com
+// mais de um canal a faixa é separada
+static int pipeline_needs_planes(const pipeline_t *p) {
+    return (p->blur || p->median || p->resize || p->pyramid.levels ||
+            pipeline_enabled(p, FILTER_COLOR) || p->classify) && p->channels != 1;
+}
+
+// Planos de cor e classes das linhas [g0, g1) a partir das linhas da faixa
+// [b0, ...) em planos; em cinza (com ou sem alpha) o primeiro plano entra
+// como R, G e B
+static void pipeline_color_rows(pipeline_t *p, const unsigned char *planes,
+                                size_t planes_stride, size_t plane_stride,
+                                int b0, int g0, int g1, uint32_t *class_counts) {
+    size_t step = p->channels >= 3 ? plane_stride : 0;
+    for (int y = g0; y < g1; y++) {
+        const unsigned char *r = planes + (y - b0) * planes_stride;
+        size_t o = (size_t)y * p->width;
+        for (int space = 0; space < COLOR_SPACE_COUNT; space++) {
+            if (!p->color[space][0]) continue;
+            unsigned char *const dst[COLOR_PLANES] = {
+                p->color[space][0]->data + o, p->color[space][1]->data + o,
+                p->color[space][2]->data + o
+            };
+            color_convert_row(space, r, r + step, r + 2 * step, dst, p->width);
+        }
+        if (p->classify) {
+            class_rows(p->class_lut, r, r + step, r + 2 * step, p->classify->data + o,
+                       p->width, class_counts);
+        }
+    }
+}
+
+// Imagem de 1 canal com histograma de luminância: o canal já está contado
+static int pipeline_stats_from_luma(const pipeline_t *p) {
+    return p->channels == 1 && p->has_luma_hist;
+}
+
+// Estado de uma faixa: um stream por estágio habilitado
+typedef struct {
+    int y0, y1;                 // Linhas de saída (imagem de mesma geometria)
+    int in_begin, in_end;       // Linhas de origem lidas (faixa + halos)
+    blur_stream_t blur;
+    median_stream_t median;
+    resize_stream_t resize;
+    pyramid_stream_t pyramid;
+    sobel_stream_t sobel;
+    canny_stream_t canny;
+    demosaic_t demosaic;        // Janela de linhas brutas (quadro Bayer)
+    unsigned char *luma;        // Plano de luminância da faixa de cache
+    unsigned char *corrected;   // Faixa de cache após demosaico, calibração e LUT
+    planar_t planes;            // Faixa de cache separada por canal (blur/resize)
+    uint32_t hist[256];         // Histograma de luminância das linhas [y0, y1)
+    uint32_t chan_hist[MAX_CHANNELS][256];  // Histogramas por canal das mesmas linhas
+    uint32_t class_counts[CLASS_MAX + 1];   // Pixels por classe das mesmas linhas
+} pipeline_tile_t;
+
+static void pipeline_tile_free(const pipeline_t *p, pipeline_tile_t *t) {
+    if (p->blur) blur_stream_free(&t->blur);
+    if (p->median) median_stream_free(&t->median);
+    if (p->resize) resize_stream_free(&t->resize);
+    if (p->sobel) sobel_stream_free(&t->sobel);
+    if (p->canny) canny_stream_free(&t->canny);
+    if (p->pyramid.levels) pyramid_stream_free(&t->pyramid);
+    if (p->bayer) demosaic_free(&t->demosaic);
+    free(t->luma);
+    free(t->corrected);
+    planar_free(&t->planes);
+}
+
+// Amplia a faixa de origem para incluir o halo de um estágio
+static void pipeline_tile_need(pipeline_tile_t *t, int in_begin, int in_end) {
+    if (in_begin >= in_end) return;
+    t->in_begin = MIN(t->in_begin, in_begin);
+    t->in_end = MAX(t->in_end, in_end);
+}
+
+static int pipeline_tile_init(const pipeline_t *p, pipeline_tile_t *t, int y0, int y1,
+                              int r0, int r1, int band_rows) {
+    memset(t, 0, sizeof(*t));
+    t->y0 = y0;
+    t->y1 = y1;
+    t->in_begin = y0;
+    t->in_end = y1;
+
+    int ok = 1;
+    if (p->blur) {
+        ok = ok && blur_stream_init(&t->blur, p->width, p->height, p->channels,
+                                    p->config->blur_radius, y0, y1) == 0;
+        if (ok) pipeline_tile_need(t, t->blur.in_begin, t->blur.in_end);
+    }
+    if (p->median) {
+        ok = ok && median_stream_init(&t->median, p->width, p->height, p->channels,
+                                      p->config->median_radius, y0, y1) == 0;
+        if (ok) pipeline_tile_need(t, t->median.in_begin, t->median.in_end);
+    }
+    if (p->resize) {
+        ok = ok && resize_stream_init(&t->resize, p->resize_plan, p->channels, r0, r1) == 0;
+        if (ok) pipeline_tile_need(t, t->resize.in_begin, t->resize.in_end);
+    }
+    if (p->pyramid.levels) {
+        ok = ok && pyramid_stream_init(&t->pyramid, &p->pyramid, y0, y1) == 0;
+        if (ok) pipeline_tile_need(t, t->pyramid.in_begin, t->pyramid.in_end);
+    }
+    if (p->sobel) {
+        ok = ok && sobel_stream_init(&t->sobel, p->width, p->height, p->config->sobel_norm,
+                                     y0, y1) == 0;
+        if (ok) pipeline_tile_need(t, t->sobel.in_begin, t->sobel.in_end);
+    }
+    if (p->canny) {
+        ok = ok && canny_stream_init(&t->canny, p->width, p->height, p->config->canny_low,
+                                     p->config->canny_high, y0, y1) == 0;
+        if (ok) pipeline_tile_need(t, t->canny.in_begin, t->canny.in_end);
+    }
+
+    if (ok && p->bayer) {
+        ok = demosaic_init(&t->demosaic, p->src, p->width, p->height, 8, p->config,
+                           p->calib) == 0;
+    }
+
+    // Imagem de 1 canal já é o plano de luminância
+    if (ok && pipeline_needs_luma(p) && p->channels != 1) {
+        t->luma = (unsigned char*)malloc((size_t)band_rows * p->width);
+        ok = t->luma != NULL;
+    }
+    if (ok && pipeline_corrects(p)) {
+        t->corrected = (unsigned char*)malloc((size_t)band_rows * p->width * p->channels);
+        ok = t->corrected != NULL;
+    }
+    // Faixa separada por canal uma vez para blur, mediana, resize, pirâmide,
+    // cor e classes
+    if (ok && pipeline_needs_planes(p)) {
+        ok = planar_init(&t->planes, p->width, band_rows, p->channels) == 0;
+    }
+
+    if (!ok) {
+        LOG_ERROR("Falha ao preparar faixa %d-%d", y0, y1);
+        pipeline_tile_free(p, t);
+        return -1;
+    }
+    return 0;
+}
+
+// Processa uma faixa horizontal [y0, y1) de todas as saídas. As faixas de
+// entrada dos estágios incluem o halo (linhas vizinhas lidas também pelas
+// faixas adjacentes); cada faixa escreve apenas as próprias linhas.
+static int pipeline_run_tile(pipeline_t *p, int y0, int y1, int r0, int r1) {
+    const size_t stride = (size_t)p->width * p->channels;
+
+    // Linhas por faixa de cache: a origem deve caber no L2 junto com
+    // os buffers circulares dos estágios (e com as cópias corrigida e
+    // planar, se houver; a calibração lê também dark e ganho da faixa)
+    size_t band_bytes = stride * (1 + pipeline_corrects(p) + pipeline_needs_planes(p) +
+                                  (p->calib ? 1 + sizeof(int16_t) : 0));
+    int band_rows = MAX(1, (int)(BAND_CACHE_BYTES / band_bytes));
+
+    pipeline_tile_t t;
+    if (pipeline_tile_init(p, &t, y0, y1, r0, r1, band_rows) != 0) {
+        return -1;
+    }
+    long defects = 0;
+
+    for (int b0 = t.in_begin; b0 < t.in_end; b0 += band_rows) {
+        int b1 = MIN(t.in_end, b0 + band_rows);
+        const unsigned char *band = p->bayer ? NULL : p->src + b0 * stride;
+        int planes_ready = 0;
+
+        // Dark frame e ganho do flat (multiplicação-soma vetorial) seguidos
+        // das operações pontuais (uma consulta à LUT por amostra), no cache
+        if (t.corrected) {
+            const unsigned char *raw = band;
+            if (p->bayer) {
+                // Demosaico (calibra as linhas brutas); sem LUT, os planos
+                // de blur/resize saem do próprio demosaico
+                planes_ready = t.planes.data && !p->tone;
+                for (int y = b0; y < b1; y++) {
+                    demosaic_row(&t.demosaic, y, t.corrected + (y - b0) * stride,
+                                 planes_ready ? planar_row(&t.planes, y - b0) : NULL);
+                }
+                raw = t.corrected;
+            } else if (p->calib) {
+                calib_rows(p->calib, raw, t.corrected, b0 * stride, (int)((b1 - b0) * stride));
+                raw = t.corrected;
+            }
+            if (p->tone) tone_rows(p->tone, raw, t.corrected, (b1 - b0) * p->width, p->channels);
+            band = t.corrected;
+        }
+
+        // Grayscale: direto da faixa para a saída (sem cópia intermediária)
+        int g0 = MAX(b0, y0), g1 = MIN(b1, y1);
+        if (p->has_stats && g0 < g1 && !pipeline_stats_from_luma(p)) {
+            histogram_channels_u8(band + (g0 - b0) * stride, (g1 - g0) * p->width, p->channels,
+                                  t.chan_hist);
+        }
+        if (p->gray && g0 < g1) {
+            grayscale_rows(band + (g0 - b0) * stride, p->gray->data + g0 * stride,
+                           (g1 - g0) * p->width, p->channels);
+        }
+
+        // Demais estágios consomem as mesmas linhas enquanto estão no cache
+        const unsigned char *planes = band;
+        size_t planes_stride = stride;
+        if (t.planes.data) {
+            if (!planes_ready) planar_load_rows(&t.planes, band, 0, b1 - b0);
+            planes = t.planes.data;
+            planes_stride = t.planes.stride * p->channels;
+        }
+        if ((pipeline_enabled(p, FILTER_COLOR) || p->classify) && g0 < g1) {
+            pipeline_color_rows(p, planes, planes_stride, t.planes.stride, b0, g0, g1,
+                                t.class_counts);
+        }
+        if (p->blur) {
+            for (int y = b0; y < b1; y++) {
+                blur_stream_push(&t.blur, planes + (y - b0) * planes_stride, y, p->blur->data);
+            }
+        }
+        if (p->median) {
+            for (int y = b0; y < b1; y++) {
+                median_stream_push(&t.median, planes + (y - b0) * planes_stride, y,
+                                   p->median->data);
+            }
+        }
+        if (p->resize) {
+            for (int y = b0; y < b1; y++) {
+                resize_stream_push(&t.resize, planes + (y - b0) * planes_stride, y,
+                                   p->resize->data);
+            }
+        }
+        if (p->pyramid.levels) {
+            for (int y = b0; y < b1; y++) {
+                pyramid_stream_push(&t.pyramid, planes + (y - b0) * planes_stride, y);
+            }
+        }
+        if (p->remap && g0 < g1) {
+            if (t.planes.data) {
+                memcpy(planar_row(&p->remap_src, g0), planes + (g0 - b0) * planes_stride,
+                       (g1 - g0) * planes_stride);
+            } else {
+                planar_load_rows(&p->remap_src, band + (g0 - b0) * stride, g0, g1 - g0);
+            }
+        }
+
+        // Estágios em cinza: luminância convertida uma vez por faixa
+        if (!pipeline_needs_luma(p)) continue;
+        const unsigned char *luma = band;
+        if (t.luma) {
+            luma_rows(band, t.luma, (b1 - b0) * p->width, p->channels);
+            luma = t.luma;
+        }
+        if (p->sobel) {
+            for (int y = b0; y < b1; y++) {
+                sobel_stream_push(&t.sobel, luma + (size_t)(y - b0) * p->width, y,
+                                  p->sobel->data, p->sobel_dir ? p->sobel_dir->data : NULL);
+            }
+        }
+        if (p->canny) {
+            for (int y = b0; y < b1; y++) {
+                canny_stream_push(&t.canny, luma + (size_t)(y - b0) * p->width, y,
+                                  p->canny->data);
+            }
+        }
+        if (g0 < g1) {
+            const unsigned char *own = luma + (size_t)(g0 - b0) * p->width;
+            size_t own_pixels = (size_t)(g1 - g0) * p->width;
+            if (p->luma_buf) memcpy(p->luma_buf + (size_t)g0 * p->width, own, own_pixels);
+            if (p->has_luma_hist) histogram_u8(own, (int)own_pixels, t.hist);
+            if (p->integral.sum) integral_rows(&p->integral, own, g0, g1 - g0, y0);
+            if (p->threshold && p->config->threshold_mode == THRESH_FIXED) {
+                g_kernels.threshold_row(own, p->threshold->data + (size_t)g0 * p->width,
+                                        (int)own_pixels, p->config->threshold_value);
+            }
+            if (p->golden) {
+                size_t o = (size_t)g0 * p->width;
+                defects += g_kernels.golden_row(own, p->golden_luma + o,
+                                                p->golden_tol ? p->golden_tol + o : NULL,
+                                                p->golden->data + o, (int)own_pixels,
+                                                p->config->golden_threshold);
+            }
+        }
+    }
+
+    if (defects) __atomic_fetch_add(&p->golden_defects, defects, __ATOMIC_RELAXED);
+    if (p->classify) {
+        for (int c = 0; c <= p->class_lut->classes; c++) {
+            __atomic_fetch_add(&p->class_counts[c], (long)t.class_counts[c], __ATOMIC_RELAXED);
+        }
+    }
+
+    // Histogramas da faixa somados aos da imagem
+    if (p->has_luma_hist) {
+        for (int i = 0; i < 256; i++) {
+            if (t.hist[i]) __atomic_fetch_add(&p->luma_hist[i], t.hist[i], __ATOMIC_RELAXED);
+        }
+    }
+    if (p->has_stats && !pipeline_stats_from_luma(p)) {
+        for (int k = 0; k < p->channels; k++) {
+            for (int i = 0; i < 256; i++) {
+                if (t.chan_hist[k][i]) {
+                    __atomic_fetch_add(&p->channel_hist[k][i], t.chan_hist[k][i],
+                                       __ATOMIC_RELAXED);
+                }
+            }
+        }
+    }
+
+    pipeline_tile_free(p, &t);
+    return 0;
+}
+
+static void pipeline_tile_task(void *arg, int tile) {
+    pipeline_job_t *job = (pipeline_job_t*)arg;
+    pipeline_t *p = job->p;
+    int rh = p->resize ? p->resize->height : 0;
+
+    // Faixas de origem e de destino do resize proporcionais (mesma região)
+    int y0 = (int)((long)p->height * tile / job->num_tiles);
+    int y1 = (int)((long)p->height * (tile + 1) / job->num_tiles);
+    int r0 = (int)((long)rh * tile / job->num_tiles);
+    int r1 = (int)((long)rh * (tile + 1) / job->num_tiles);
+
+    if (pipeline_run_tile(p, y0, y1, r0, r1) != 0) {
+        __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+    }
+}
+
+// ============================================================
+// SEGUNDA FASE (dependências da imagem inteira)
+// ============================================================
+
+typedef struct {
+    pipeline_t *p;
+    int num_tiles;
+    int failed;
+    int threshold;              // Limiar global (Otsu) já calculado
+} pipeline_post_job_t;
+
+static void pipeline_post_task(void *arg, int tile) {
+    pipeline_post_job_t *job = (pipeline_post_job_t*)arg;
+    pipeline_t *p = job->p;
+    const pipeline_config_t *cfg = p->config;
+    int w = p->width;
+
+    int y0 = (int)((long)p->height * tile / job->num_tiles);
+    int y1 = (int)((long)p->height * (tile + 1) / job->num_tiles);
+
+    if (p->threshold && cfg->threshold_mode == THRESH_OTSU) {
+        g_kernels.threshold_row(p->luma + (size_t)y0 * w, p->threshold->data + (size_t)y0 * w,
+                                (y1 - y0) * w, job->threshold);
+    } else if (p->threshold && cfg->threshold_mode == THRESH_MEAN) {
+        if (threshold_mean_rows(&p->integral, p->luma, p->threshold->data,
+                                cfg->threshold_radius, cfg->threshold_c, y0, y1) != 0) {
+            __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static void pipeline_morph_task(void *arg, int tile) {
+    pipeline_post_job_t *job = (pipeline_post_job_t*)arg;
+    pipeline_t *p = job->p;
+    const pipeline_config_t *cfg = p->config;
+
+    int y0 = (int)((long)p->height * tile / job->num_tiles);
+    int y1 = (int)((long)p->height * (tile + 1) / job->num_tiles);
+
+    const unsigned char *src = cfg->morph_input == MORPH_INPUT_BINARY ? p->threshold->data : p->luma;
+    if (morph_rows(src, p->morph->data, p->width, p->height, cfg->morph_op,
+                   cfg->morph_width, cfg->morph_height, y0, y1) != 0) {
+        __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+    }
+}
+
+static void pipeline_remap_task(void *arg, int tile) {
+    pipeline_post_job_t *job = (pipeline_post_job_t*)arg;
+    pipeline_t *p = job->p;
+    const remap_map_t *map = p->remap_map;
+    const int c = p->channels, dw = p->remap->width;
+    const size_t src_stride = p->remap_src.stride;
+
+    int y0 = (int)((long)p->remap->height * tile / job->num_tiles);
+    int y1 = (int)((long)p->remap->height * (tile + 1) / job->num_tiles);
+
+    // 1 canal: plano de origem contíguo, destino direto na saída
+    if (c == 1) {
+        remap_plane_rows(map, p->remap_src.data, src_stride, p->remap->data + (size_t)y0 * dw,
+                         dw, y0, y1);
+        return;
+    }
+
+    unsigned char *row = (unsigned char*)planar_alloc(planar_stride(dw) * c);
+    if (!row) {
+        LOG_ERROR("Falha ao alocar memória para remap");
+        __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    for (int y = y0; y < y1; y++) {
+        for (int k = 0; k < c; k++) {
+            remap_plane_rows(map, p->remap_src.data + k * src_stride, src_stride * c,
+                             row + k * planar_stride(dw), 0, y, y + 1);
+        }
+        planar_merge_row(row, p->remap->data + (size_t)y * dw * c, dw, c);
+    }
+    free(row);
+}
+
+int pipeline_run(pipeline_t *p, thread_pool_t *pool) {
+    // Uma faixa por thread; faixas muito baixas só somariam halo
+    int num_tiles = pool ? pool->num_threads : 1;
+    num_tiles = MIN(num_tiles, MAX(1, p->height / PIPELINE_MIN_TILE_ROWS));
+
+    memset(p->luma_hist, 0, sizeof(p->luma_hist));
+    memset(p->channel_hist, 0, sizeof(p->channel_hist));
+
+    pipeline_job_t job = { .p = p, .num_tiles = num_tiles, .failed = 0 };
+    thread_pool_run(pool, pipeline_tile_task, &job, num_tiles);
+    if (job.failed) return -1;
+    if (p->has_stats && pipeline_stats_from_luma(p)) {
+        memcpy(p->channel_hist[0], p->luma_hist, sizeof(p->luma_hist));
+    }
+
+    // Histerese sobre o mapa de classes completo (mesmas faixas)
+    if (p->canny && canny_hysteresis(p->canny->data, p->width, p->height,
+                                     num_tiles, pool) != 0) {
+        return -1;
+    }
+
+    // Acumulado das faixas anteriores somado à integral de cada faixa
+    if (p->integral.sum && integral_merge_bands(&p->integral, num_tiles, pool) != 0) {
+        return -1;
+    }
+
+    pipeline_post_job_t post = { .p = p, .num_tiles = num_tiles, .failed = 0 };
+
+    // Remap: origem inteira já em planos, faixas de linhas de destino
+    if (p->remap) {
+        post.num_tiles = MIN(num_tiles, MAX(1, p->remap->height / PIPELINE_MIN_TILE_ROWS));
+        thread_pool_run(pool, pipeline_remap_task, &post, post.num_tiles);
+        if (post.failed) return -1;
+        post.num_tiles = num_tiles;
+    }
+
+    if (p->threshold && p->config->threshold_mode != THRESH_FIXED) {
+        if (p->config->threshold_mode == THRESH_OTSU) {
+            post.threshold = otsu_threshold(p->luma_hist);
+        }
+        thread_pool_run(pool, pipeline_post_task, &post, num_tiles);
+    }
+
+    // Morfologia binária lê o halo do threshold das faixas vizinhas:
+    // só depois que todas terminaram
+    if (p->morph && !post.failed) {
+        thread_pool_run(pool, pipeline_morph_task, &post, num_tiles);
+    }
+    if (post.failed) return -1;
+
+    // Blobs da máscara final: morfologia binária (limpa) ou threshold
+    if (p->blobs) {
+        const unsigned char *mask = p->morph && p->config->morph_input == MORPH_INPUT_BINARY ?
+                                    p->morph->data : p->threshold->data;
+        if (blob_label(&p->blob_set, mask, p->config->blob_min_area, p->blobs->data,
+                       num_tiles, pool) != 0) {
+            return -1;
+        }
+    }
+
+    // Template matching sobre a luminância, normalizado pela integral
+    if (p->match) {
+        if (match_find(&p->resources->templates, p->luma, &p->integral,
+                       p->config->match_threshold, pool ? pool->num_threads : 1, pool,
+                       &p->matches) != 0) {
+            return -1;
+        }
+        memcpy(p->match->data, p->luma, (size_t)p->width * p->height);
+        match_draw(&p->matches, p->match->data, p->width, p->height);
+    }
+    return 0;
+}
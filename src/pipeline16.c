@@ -0,0 +1,292 @@
+#include "pipeline16.h"
+
+#define HIST16_BINS     65536
+
+// ============================================================
+// PREPARAÇÃO
+// ============================================================
+
+static pipeline_output_t* pipeline16_add_output(pipeline16_t *p, int filter_type,
+                                                const char *name, int width, int height,
+                                                int channels, int depth) {
+    pipeline_output_t *out = &p->outputs[p->num_outputs];
+    out->filter_type = filter_type;
+    out->name = name;
+    out->width = width;
+    out->height = height;
+    out->channels = channels;
+    out->depth = depth;
+    out->data = (unsigned char*)malloc((size_t)width * height * channels * (depth / 8));
+    if (!out->data) {
+        LOG_ERROR("Falha ao alocar saída de 16 bits (%s)", name);
+        return NULL;
+    }
+    p->num_outputs++;
+    return out;
+}
+
+static int pipeline16_enabled(const pipeline16_t *p, int filter_type) {
+    return (p->config->filters & FILTER_BIT(filter_type)) != 0;
+}
+
+int pipeline16_init(pipeline16_t *p, const uint16_t *src, int width, int height,
+                    int channels, const pipeline_config_t *config,
+                    const pipeline_resources_t *resources) {
+    memset(p, 0, sizeof(*p));
+    p->src = p->orig = src;
+    p->width = width;
+    p->height = height;
+    p->channels = channels;
+    p->config = config;
+    p->calib = resources ? resources->calib : NULL;
+    p->tone = resources && resources->tone.active ? &resources->tone : NULL;
+
+    int w = width, h = height, c = channels;
+    int ok = 1;
+
+    if (p->calib && !calib_matches(p->calib, w, h, c)) {
+        LOG_ERROR("Imagem %dx%d (%d canais) difere dos quadros de calibração (%dx%d, %d canais)",
+                  w, h, c, p->calib->width, p->calib->height, p->calib->channels);
+        ok = 0;
+    }
+    if (ok && config->bayer_pattern != BAYER_NONE) {
+        if (c != 1) {
+            LOG_ERROR("Imagem com %d canais não é um quadro Bayer (--bayer)", c);
+            ok = 0;
+        } else if (w < BAYER_MIN_SIDE || h < BAYER_MIN_SIDE) {
+            LOG_ERROR("Imagem Bayer %dx%d menor que %dx%d", w, h, BAYER_MIN_SIDE, BAYER_MIN_SIDE);
+            ok = 0;
+        } else {
+            p->bayer = 1;
+            p->channels = c = demosaic_channels(config);
+        }
+    }
+    if (ok && (p->bayer || p->calib || p->tone)) {
+        ok = (p->corrected = (uint16_t*)malloc((size_t)w * h * c * sizeof(uint16_t))) != NULL;
+        if (ok) p->src = p->corrected;
+    }
+
+    if (ok && pipeline16_enabled(p, FILTER_GRAYSCALE)) {
+        ok = (p->gray = pipeline16_add_output(p, FILTER_GRAYSCALE, "grayscale",
+                                              w, h, c, 16)) != NULL;
+    }
+    if (ok && pipeline16_enabled(p, FILTER_BLUR)) {
+        ok = (p->blur = pipeline16_add_output(p, FILTER_BLUR, "blur", w, h, c, 16)) != NULL;
+    }
+    if (ok && pipeline16_enabled(p, FILTER_RESIZE)) {
+        int rw, rh;
+        resize_target_size(config, w, h, &rw, &rh);
+        ok = (p->resize = pipeline16_add_output(p, FILTER_RESIZE, "resize",
+                                                rw, rh, c, 16)) != NULL &&
+             (p->resize_plan = resize_plan_get(w, h, rw, rh,
+                                               (resize_mode_t)config->resize_mode)) != NULL;
+    }
+    if (ok && pipeline16_enabled(p, FILTER_THRESHOLD)) {
+        // Máscara binária: 8 bits como no pipeline comum
+        ok = (p->threshold = pipeline16_add_output(p, FILTER_THRESHOLD, "threshold",
+                                                   w, h, 1, 8)) != NULL;
+    }
+
+    // Otsu e média local dependem da imagem inteira: plano de luminância
+    if (ok && p->threshold && config->threshold_mode != THRESH_FIXED) {
+        if (c == 1) {
+            p->luma = p->src;
+        } else {
+            ok = (p->luma = p->luma_buf =
+                  (uint16_t*)malloc((size_t)w * h * sizeof(uint16_t))) != NULL;
+        }
+    }
+    if (ok && p->threshold && config->threshold_mode == THRESH_OTSU) {
+        ok = (p->luma_hist = (uint32_t*)malloc(HIST16_BINS * sizeof(uint32_t))) != NULL;
+    }
+
+    if (!ok) {
+        LOG_ERROR("Falha ao preparar pipeline de 16 bits (%dx%d)", w, h);
+        pipeline16_free(p);
+        return -1;
+    }
+    return 0;
+}
+
+void pipeline16_free(pipeline16_t *p) {
+    for (int i = 0; i < p->num_outputs; i++) {
+        free(p->outputs[i].data);
+        p->outputs[i].data = NULL;
+    }
+    p->num_outputs = 0;
+
+    if (p->resize_plan) {
+        resize_plan_release(p->resize_plan);
+        p->resize_plan = NULL;
+    }
+
+    free(p->corrected);
+    free(p->luma_buf);
+    free(p->luma_hist);
+    p->corrected = NULL;
+    p->luma_buf = NULL;
+    p->luma_hist = NULL;
+    p->luma = NULL;
+}
+
+// ============================================================
+// EXECUÇÃO
+// ============================================================
+
+typedef struct {
+    pipeline16_t *p;
+    int num_tiles;
+    int failed;
+    int threshold;              // Limiar global (Otsu) já calculado
+} pipeline16_job_t;
+
+// Demosaico, calibração e operações pontuais da faixa [y0, y1) sobre a origem
+static void pipeline16_correct_task(void *arg, int tile) {
+    pipeline16_job_t *job = (pipeline16_job_t*)arg;
+    pipeline16_t *p = job->p;
+    const size_t stride = (size_t)p->width * p->channels;
+
+    int y0 = (int)((long)p->height * tile / job->num_tiles);
+    int y1 = (int)((long)p->height * (tile + 1) / job->num_tiles);
+    const uint16_t *raw = p->orig + y0 * stride;
+    if (p->bayer) {
+        // Linhas de halo lidas do quadro bruto (calibradas na janela)
+        demosaic_t d;
+        if (demosaic_init(&d, p->orig, p->width, p->height, 16, p->config, p->calib) != 0) {
+            __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+            return;
+        }
+        for (int y = y0; y < y1; y++) {
+            demosaic_row(&d, y, p->corrected + y * stride, NULL);
+        }
+        demosaic_free(&d);
+        raw = p->corrected + y0 * stride;
+    } else if (p->calib) {
+        calib_rows_u16(p->calib, raw, p->corrected + y0 * stride, y0 * stride,
+                       (int)((y1 - y0) * stride));
+        raw = p->corrected + y0 * stride;
+    }
+    if (p->tone) {
+        tone_rows_u16(p->tone, raw, p->corrected + y0 * stride, (y1 - y0) * p->width,
+                      p->channels);
+    }
+}
+
+// Luminância e limiar fixo da faixa, linha a linha (uma linha no L1)
+static int pipeline16_luma_tile(pipeline16_t *p, int y0, int y1) {
+    const pipeline_config_t *cfg = p->config;
+    const int w = p->width, c = p->channels;
+
+    uint16_t *row = NULL;
+    uint32_t *hist = NULL;
+    if ((!p->luma_buf && c != 1 && !(row = (uint16_t*)malloc(w * sizeof(uint16_t)))) ||
+        (p->luma_hist && !(hist = (uint32_t*)calloc(HIST16_BINS, sizeof(uint32_t))))) {
+        free(row);
+        LOG_ERROR("Falha ao alocar memória para luminância de 16 bits");
+        return -1;
+    }
+
+    for (int y = y0; y < y1; y++) {
+        const uint16_t *src = p->src + (size_t)y * w * c;
+        const uint16_t *luma = src;
+        if (p->luma_buf) {
+            luma = p->luma_buf + (size_t)y * w;
+            luma_rows_u16(src, (uint16_t*)luma, w, c);
+        } else if (row) {
+            luma_rows_u16(src, row, w, c);
+            luma = row;
+        }
+        if (hist) histogram_u16(luma, w, hist);
+        if (cfg->threshold_mode == THRESH_FIXED) {
+            threshold_row_u16(luma, p->threshold->data + (size_t)y * w, w,
+                              cfg->threshold_value * DEPTH16_SCALE);
+        }
+    }
+
+    // Histograma da faixa somado ao da imagem
+    if (hist) {
+        for (int i = 0; i < HIST16_BINS; i++) {
+            if (hist[i]) __atomic_fetch_add(&p->luma_hist[i], hist[i], __ATOMIC_RELAXED);
+        }
+    }
+    free(row);
+    free(hist);
+    return 0;
+}
+
+// Primeira fase: faixa [y0, y1) de cada saída (halos lidos da origem)
+static void pipeline16_tile_task(void *arg, int tile) {
+    pipeline16_job_t *job = (pipeline16_job_t*)arg;
+    pipeline16_t *p = job->p;
+    const size_t stride = (size_t)p->width * p->channels;
+    int rh = p->resize ? p->resize->height : 0;
+
+    int y0 = (int)((long)p->height * tile / job->num_tiles);
+    int y1 = (int)((long)p->height * (tile + 1) / job->num_tiles);
+    int r0 = (int)((long)rh * tile / job->num_tiles);
+    int r1 = (int)((long)rh * (tile + 1) / job->num_tiles);
+
+    int ok = 1;
+    if (p->gray) {
+        grayscale_rows_u16(p->src + y0 * stride, (uint16_t*)p->gray->data + y0 * stride,
+                           (y1 - y0) * p->width, p->channels);
+    }
+    if (p->blur) {
+        ok = ok && blur_rows_u16(p->src, (uint16_t*)p->blur->data + y0 * stride, p->width,
+                                 p->height, p->channels, p->config->blur_radius,
+                                 y0, y1) == 0;
+    }
+    if (p->resize) {
+        ok = ok && resize_rows_u16(p->resize_plan, p->src, p->channels,
+                                   (uint16_t*)p->resize->data +
+                                   (size_t)r0 * p->resize->width * p->channels,
+                                   r0, r1) == 0;
+    }
+    if (p->threshold) {
+        ok = ok && pipeline16_luma_tile(p, y0, y1) == 0;
+    }
+    if (!ok) __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+}
+
+// Segunda fase: Otsu (limiar global) ou média local sobre a luminância
+static void pipeline16_post_task(void *arg, int tile) {
+    pipeline16_job_t *job = (pipeline16_job_t*)arg;
+    pipeline16_t *p = job->p;
+    const pipeline_config_t *cfg = p->config;
+    const int w = p->width;
+
+    int y0 = (int)((long)p->height * tile / job->num_tiles);
+    int y1 = (int)((long)p->height * (tile + 1) / job->num_tiles);
+
+    if (cfg->threshold_mode == THRESH_OTSU) {
+        threshold_row_u16(p->luma + (size_t)y0 * w, p->threshold->data + (size_t)y0 * w,
+                          (y1 - y0) * w, job->threshold);
+    } else if (threshold_mean_rows_u16(p->luma, p->threshold->data, w, p->height,
+                                       cfg->threshold_radius, cfg->threshold_c,
+                                       y0, y1) != 0) {
+        __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+    }
+}
+
+int pipeline16_run(pipeline16_t *p, thread_pool_t *pool) {
+    // Uma faixa por thread; faixas muito baixas só somariam halo
+    int num_tiles = pool ? pool->num_threads : 1;
+    num_tiles = MIN(num_tiles, MAX(1, p->height / PIPELINE_MIN_TILE_ROWS));
+
+    if (p->luma_hist) memset(p->luma_hist, 0, HIST16_BINS * sizeof(uint32_t));
+
+    pipeline16_job_t job = { .p = p, .num_tiles = num_tiles, .failed = 0 };
+    if (p->corrected) {
+        thread_pool_run(pool, pipeline16_correct_task, &job, num_tiles);
+        if (job.failed) return -1;
+    }
+    thread_pool_run(pool, pipeline16_tile_task, &job, num_tiles);
+    if (job.failed) return -1;
+
+    if (p->threshold && p->config->threshold_mode != THRESH_FIXED) {
+        if (p->luma_hist) job.threshold = otsu_threshold_bins(p->luma_hist, HIST16_BINS);
+        thread_pool_run(pool, pipeline16_post_task, &job, num_tiles);
+        if (job.failed) return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,45 @@
+#include "planar.h"
+
+// ============================================================
+// ALOCAÇÃO
+// ============================================================
+
+void* planar_alloc(size_t bytes) {
+    // aligned_alloc exige tamanho múltiplo do alinhamento
+    size_t size = (bytes + PLANAR_ALIGN - 1) & ~(size_t)(PLANAR_ALIGN - 1);
+    void *p = aligned_alloc(PLANAR_ALIGN, size ? size : PLANAR_ALIGN);
+    if (p) memset(p, 0, size);
+    return p;
+}
+
+int planar_init(planar_t *pl, int width, int rows, int channels) {
+    memset(pl, 0, sizeof(*pl));
+    pl->width = width;
+    pl->rows = rows;
+    pl->channels = channels;
+    pl->stride = planar_stride(width);
+
+    pl->data = (unsigned char*)planar_alloc((size_t)rows * channels * pl->stride);
+    if (!pl->data) {
+        LOG_ERROR("Falha ao alocar imagem planar (%dx%d, %d canais)", width, rows, channels);
+        return -1;
+    }
+    return 0;
+}
+
+void planar_free(planar_t *pl) {
+    free(pl->data);
+    pl->data = NULL;
+}
+
+// ============================================================
+// CONVERSÃO
+// ============================================================
+
+void planar_load_rows(planar_t *pl, const unsigned char *src, int y, int n) {
+    const size_t row_bytes = (size_t)pl->width * pl->channels;
+    for (int i = 0; i < n; i++) {
+        planar_split_row(src + (size_t)i * row_bytes, planar_row(pl, y + i),
+                         pl->width, pl->channels);
+    }
+}
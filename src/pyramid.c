@@ -0,0 +1,164 @@
+#include "pyramid.h"
+
+// ============================================================
+// NÍVEIS
+// ============================================================
+
+static inline size_t pyramid_align(size_t bytes) {
+    return (bytes + PLANAR_ALIGN - 1) & ~(size_t)(PLANAR_ALIGN - 1);
+}
+
+int pyramid_init(pyramid_t *pyr, int width, int height, int channels) {
+    memset(pyr, 0, sizeof(*pyr));
+    pyr->channels = channels;
+    pyr->width[0] = width;
+    pyr->height[0] = height;
+
+    // Mesma regra da pirâmide dos templates: lados truncados a cada nível
+    size_t offset[PYRAMID_LEVELS + 1] = {0}, total = 0;
+    for (int l = 1; l <= PYRAMID_LEVELS; l++) {
+        int w = width >> l, h = height >> l;
+        if (w < 1 || h < 1) break;
+        pyr->width[l] = w;
+        pyr->height[l] = h;
+        pyr->levels = l;
+        offset[l] = total;
+        total += pyramid_align((size_t)w * h * channels);
+    }
+    if (pyr->levels == 0) return 0;
+
+    pyr->data = (unsigned char*)aligned_alloc(PLANAR_ALIGN, total);
+    if (!pyr->data) {
+        LOG_ERROR("Falha ao alocar pirâmide (%dx%d, %d níveis)", width, height, pyr->levels);
+        return -1;
+    }
+    for (int l = 1; l <= pyr->levels; l++) pyr->level[l] = pyr->data + offset[l];
+    return 0;
+}
+
+void pyramid_free(pyramid_t *pyr) {
+    free(pyr->data);
+    memset(pyr, 0, sizeof(*pyr));
+}
+
+// ============================================================
+// STREAMING
+// ============================================================
+
+int pyramid_stream_init(pyramid_stream_t *ps, const pyramid_t *pyr, int out_begin, int out_end) {
+    memset(ps, 0, sizeof(*ps));
+    ps->pyr = pyr;
+    ps->out_begin = out_begin;
+    ps->out_end = out_end;
+
+    // Origem de 1 canal chega intercalada (a própria linha)
+    const int c = pyr->channels;
+    ps->stride[0] = c > 1 ? planar_stride(pyr->width[0]) : (size_t)pyr->width[0];
+    for (int l = 1; l <= pyr->levels; l++) ps->stride[l] = planar_stride(pyr->width[l]);
+
+    // Linhas de origem das linhas próprias de cada nível (primeira origem
+    // em [out_begin, out_end)); as do nível 1 começam sempre em linha par
+    ps->in_begin = ps->in_end = 0;
+    for (int l = 1; l <= pyr->levels; l++) {
+        int first = (out_begin + (1 << l) - 1) >> l;
+        int last = MIN((out_end + (1 << l) - 1) >> l, pyr->height[l]);
+        if (first >= last) continue;
+        if (ps->in_begin == ps->in_end) ps->in_begin = first << l;
+        ps->in_begin = MIN(ps->in_begin, first << l);
+        ps->in_end = MAX(ps->in_end, last << l);
+    }
+    for (int l = 0; l <= PYRAMID_LEVELS; l++) ps->even_row[l] = -1;
+
+    size_t pend_bytes = pyramid_align(ps->stride[0] * c), total = pend_bytes;
+    for (int l = 1; l <= pyr->levels; l++) total += 2 * ps->stride[l] * c;
+    ps->buf = (unsigned char*)planar_alloc(total);
+    if (!ps->buf) {
+        LOG_ERROR("Falha ao alocar memória para pirâmide");
+        return -1;
+    }
+    ps->pend = ps->buf;
+    unsigned char *next = ps->buf + pend_bytes;
+    for (int l = 1; l <= pyr->levels; l++) {
+        ps->rows[l][0] = next;
+        ps->rows[l][1] = next + ps->stride[l] * c;
+        next += 2 * ps->stride[l] * c;
+    }
+    return 0;
+}
+
+void pyramid_stream_push(pyramid_stream_t *ps, const unsigned char *row, int y) {
+    if (y < ps->in_begin || y >= ps->in_end) return;
+
+    const pyramid_t *pyr = ps->pyr;
+    const int c = pyr->channels;
+
+    // A linha j do nível l - 1 entra no nível l; cada par par/ímpar gera
+    // uma linha, que segue para o nível seguinte ainda no cache
+    int j = y;
+    for (int l = 1; l <= pyr->levels; l++) {
+        const size_t in_stride = ps->stride[l - 1], out_stride = ps->stride[l];
+        const int w = pyr->width[l];
+        if (j >= 2 * pyr->height[l]) return;       // Linha ímpar final: truncada
+
+        if (!(j & 1)) {
+            // A faixa de origem pode ser trocada antes da linha ímpar chegar
+            if (l == 1) {
+                memcpy(ps->pend, row, in_stride * c);
+                row = ps->pend;
+            }
+            ps->even[l] = row;
+            ps->even_row[l] = j;
+            return;
+        }
+        // Par incompleto no início da faixa (linha par de outra instância)
+        if (ps->even_row[l] != j - 1) return;
+
+        j >>= 1;
+        unsigned char *out = ps->rows[l][j & 1];
+        for (int k = 0; k < c; k++) {
+            g_kernels.pyr_down_row(ps->even[l] + k * in_stride, row + k * in_stride,
+                                   out + k * out_stride, w);
+        }
+        if ((j << l) >= ps->out_begin && (j << l) < ps->out_end) {
+            planar_merge_row(out, pyr->level[l] + (size_t)j * w * c, w, c);
+        }
+        row = out;
+    }
+}
+
+void pyramid_stream_free(pyramid_stream_t *ps) {
+    free(ps->buf);
+    ps->buf = NULL;
+}
+
+// ============================================================
+// IMAGEM INTEIRA
+// ============================================================
+
+int pyramid_build(pyramid_t *pyr, const unsigned char *src) {
+    if (pyr->levels == 0) return 0;
+
+    const int w = pyr->width[0], c = pyr->channels;
+    pyramid_stream_t ps;
+    if (pyramid_stream_init(&ps, pyr, 0, pyr->height[0]) != 0) return -1;
+    unsigned char *planes = NULL;
+    if (c > 1 && !(planes = (unsigned char*)planar_alloc(ps.stride[0] * c))) {
+        LOG_ERROR("Falha ao alocar memória para pirâmide");
+        pyramid_stream_free(&ps);
+        return -1;
+    }
+
+    size_t stride = (size_t)w * c;
+    for (int y = ps.in_begin; y < ps.in_end; y++) {
+        const unsigned char *row = src + y * stride;
+        if (planes) {
+            planar_split_row(row, planes, w, c);
+            row = planes;
+        }
+        pyramid_stream_push(&ps, row, y);
+    }
+
+    free(planes);
+    pyramid_stream_free(&ps);
+    return 0;
+}
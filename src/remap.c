@@ -0,0 +1,278 @@
+#include "remap.h"
+#include <math.h>
+
+// ============================================================
+// GEOMETRIAS
+// ============================================================
+
+void remap_target_size(const pipeline_config_t *cfg, int src_w, int src_h,
+                       int *dst_w, int *dst_h) {
+    if (cfg->remap_width > 0 && cfg->remap_height > 0) {
+        *dst_w = cfg->remap_width;
+        *dst_h = cfg->remap_height;
+    } else if (cfg->remap_mode == REMAP_POLAR) {
+        // Circunferência externa na horizontal, espessura do anel na vertical
+        const double r0 = cfg->remap_params[2], r1 = cfg->remap_params[3];
+        *dst_w = MAX(1, (int)lround(2.0 * M_PI * r1));
+        *dst_h = MAX(1, (int)lround(r1 - r0));
+    } else {
+        *dst_w = src_w;
+        *dst_h = src_h;
+    }
+}
+
+// Homografia do quadrado unitário para o quadrilátero (cantos em
+// sentido horário a partir do superior esquerdo): x = (a·s + b·t + c) /
+// (g·s + h·t + 1), y = (d·s + e·t + f) / (g·s + h·t + 1)
+typedef struct {
+    double a, b, c, d, e, f, g, h;
+} remap_homography_t;
+
+static int remap_homography(const double *q, remap_homography_t *H) {
+    const double x0 = q[0], y0 = q[1], x1 = q[2], y1 = q[3];
+    const double x2 = q[4], y2 = q[5], x3 = q[6], y3 = q[7];
+    const double sx = x0 - x1 + x2 - x3, sy = y0 - y1 + y2 - y3;
+
+    if (sx == 0.0 && sy == 0.0) {
+        // Paralelogramo: transformação afim
+        *H = (remap_homography_t){ x1 - x0, x2 - x1, x0, y1 - y0, y2 - y1, y0, 0.0, 0.0 };
+        return 0;
+    }
+    const double dx1 = x1 - x2, dx2 = x3 - x2, dy1 = y1 - y2, dy2 = y3 - y2;
+    const double den = dx1 * dy2 - dx2 * dy1;
+    if (fabs(den) < 1e-12) return -1;
+    H->g = (sx * dy2 - dx2 * sy) / den;
+    H->h = (dx1 * sy - sx * dy1) / den;
+    H->a = x1 - x0 + H->g * x1;
+    H->b = x3 - x0 + H->h * x3;
+    H->c = x0;
+    H->d = y1 - y0 + H->g * y1;
+    H->e = y3 - y0 + H->h * y3;
+    H->f = y0;
+    return 0;
+}
+
+// Canto superior esquerdo e frações Q7 de uma posição de origem
+static void remap_store(remap_map_t *map, size_t i, double sx, double sy) {
+    if (!(sx >= 0.0 && sx <= map->src_w - 1 && sy >= 0.0 && sy <= map->src_h - 1)) {
+        map->xy[2 * i] = 0;
+        map->xy[2 * i + 1] = 0;
+        map->frac[i] = REMAP_OUTSIDE << 8;
+        return;
+    }
+    // Última coluna/linha: canto em src - 2 com fração inteira (128)
+    int x = MIN((int)sx, map->src_w - 2), y = MIN((int)sy, map->src_h - 2);
+    int fx = (int)((sx - x) * (1 << REMAP_FRAC_BITS) + 0.5);
+    int fy = (int)((sy - y) * (1 << REMAP_FRAC_BITS) + 0.5);
+    map->xy[2 * i] = (int16_t)x;
+    map->xy[2 * i + 1] = (int16_t)y;
+    map->frac[i] = (uint16_t)(fx | fy << 8);
+}
+
+static int remap_map_build(remap_map_t *map) {
+    const int dw = map->dst_w, dh = map->dst_h;
+    const double *p = map->params;
+    remap_homography_t H = {0};
+
+    if (map->mode == REMAP_PERSPECTIVE && remap_homography(p, &H) != 0) {
+        LOG_ERROR("Quadrilátero degenerado no remap perspective");
+        return -1;
+    }
+
+    // Lente: raio normalizado pela meia diagonal (k1, k2 independem da resolução)
+    const double focal = 0.5 * hypot(map->src_w, map->src_h);
+    const double cx = map->mode == REMAP_LENS && p[2] >= 0.0 ? p[2] : (map->src_w - 1) / 2.0;
+    const double cy = map->mode == REMAP_LENS && p[3] >= 0.0 ? p[3] : (map->src_h - 1) / 2.0;
+    const double ox = cx + (dw - map->src_w) / 2.0, oy = cy + (dh - map->src_h) / 2.0;
+
+    // Polar: o ângulo depende só da coluna
+    double *dir = NULL;
+    if (map->mode == REMAP_POLAR) {
+        dir = (double*)malloc(2 * (size_t)dw * sizeof(double));
+        if (!dir) {
+            LOG_ERROR("Falha ao alocar memória para mapa de remap");
+            return -1;
+        }
+        for (int u = 0; u < dw; u++) {
+            double theta = 2.0 * M_PI * (u + 0.5) / dw;
+            dir[2 * u] = cos(theta);
+            dir[2 * u + 1] = sin(theta);
+        }
+    }
+
+    for (int v = 0; v < dh; v++) {
+        for (int u = 0; u < dw; u++) {
+            size_t i = (size_t)v * dw + u;
+            double sx, sy;
+            switch (map->mode) {
+                case REMAP_LENS: {
+                    // Inverso do modelo radial: o pixel corrigido lê a posição distorcida
+                    double xn = (u - ox) / focal, yn = (v - oy) / focal;
+                    double r2 = xn * xn + yn * yn;
+                    double k = 1.0 + p[0] * r2 + p[1] * r2 * r2;
+                    sx = cx + xn * k * focal;
+                    sy = cy + yn * k * focal;
+                    break;
+                }
+                case REMAP_PERSPECTIVE: {
+                    double s = dw > 1 ? (double)u / (dw - 1) : 0.0;
+                    double t = dh > 1 ? (double)v / (dh - 1) : 0.0;
+                    double z = H.g * s + H.h * t + 1.0;
+                    sx = (H.a * s + H.b * t + H.c) / z;
+                    sy = (H.d * s + H.e * t + H.f) / z;
+                    break;
+                }
+                default: {
+                    // Polar: colunas percorrem o ângulo, linhas o raio (r0 no topo)
+                    double r = p[2] + (v + 0.5) * (p[3] - p[2]) / dh;
+                    sx = p[0] + r * dir[2 * u];
+                    sy = p[1] + r * dir[2 * u + 1];
+                    break;
+                }
+            }
+            remap_store(map, i, sx, sy);
+        }
+    }
+    free(dir);
+    return 0;
+}
+
+// ============================================================
+// CACHE DE MAPAS
+// ============================================================
+// Mesmo esquema dos planos de resize: a câmera (e a receita) fixam a
+// geometria, então o mapa é calculado na primeira imagem.
+
+static remap_map_t *map_cache[REMAP_MAP_CACHE];
+static pthread_mutex_t cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static unsigned long use_clock = 0;
+
+static void map_free(remap_map_t *map) {
+    if (!map) return;
+    free(map->xy);
+    free(map->frac);
+    free(map);
+}
+
+static remap_map_t* map_create(const pipeline_config_t *cfg, int src_w, int src_h,
+                               int dst_w, int dst_h) {
+    remap_map_t *map = (remap_map_t*)calloc(1, sizeof(remap_map_t));
+    if (!map) return NULL;
+
+    map->src_w = src_w;
+    map->src_h = src_h;
+    map->dst_w = dst_w;
+    map->dst_h = dst_h;
+    map->mode = cfg->remap_mode;
+    memcpy(map->params, cfg->remap_params, sizeof(map->params));
+
+    size_t n = (size_t)dst_w * dst_h;
+    map->xy = (int16_t*)malloc(2 * n * sizeof(int16_t));
+    map->frac = (uint16_t*)malloc(n * sizeof(uint16_t));
+    if (!map->xy || !map->frac || remap_map_build(map) != 0) {
+        map_free(map);
+        return NULL;
+    }
+    return map;
+}
+
+static remap_map_t* cache_lookup(const pipeline_config_t *cfg, int src_w, int src_h,
+                                 int dst_w, int dst_h) {
+    for (int i = 0; i < REMAP_MAP_CACHE; i++) {
+        remap_map_t *m = map_cache[i];
+        if (m && m->src_w == src_w && m->src_h == src_h && m->dst_w == dst_w &&
+            m->dst_h == dst_h && m->mode == cfg->remap_mode &&
+            memcmp(m->params, cfg->remap_params, sizeof(m->params)) == 0) {
+            m->refs++;
+            m->last_use = ++use_clock;
+            return m;
+        }
+    }
+    return NULL;
+}
+
+remap_map_t* remap_map_get(const pipeline_config_t *cfg, int src_w, int src_h) {
+    if (cfg->remap_mode == REMAP_NONE || src_w < 2 || src_h < 2 ||
+        src_w > REMAP_MAX_SIDE || src_h > REMAP_MAX_SIDE) {
+        LOG_ERROR("Remap indisponível para %dx%d (lados 2 a %d)", src_w, src_h, REMAP_MAX_SIDE);
+        return NULL;
+    }
+    int dst_w, dst_h;
+    remap_target_size(cfg, src_w, src_h, &dst_w, &dst_h);
+
+    pthread_mutex_lock(&cache_mutex);
+    remap_map_t *map = cache_lookup(cfg, src_w, src_h, dst_w, dst_h);
+    pthread_mutex_unlock(&cache_mutex);
+    if (map) return map;
+
+    // Cálculo fora da seção crítica
+    remap_map_t *created = map_create(cfg, src_w, src_h, dst_w, dst_h);
+    if (!created) {
+        LOG_ERROR("Falha ao criar mapa de remap %dx%d -> %dx%d", src_w, src_h, dst_w, dst_h);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&cache_mutex);
+
+    // Outra thread pode ter criado o mesmo mapa nesse intervalo
+    map = cache_lookup(cfg, src_w, src_h, dst_w, dst_h);
+    if (map) {
+        pthread_mutex_unlock(&cache_mutex);
+        map_free(created);
+        return map;
+    }
+
+    // Entrada livre ou a menos usada recentemente sem usuários ativos
+    int slot = -1;
+    for (int i = 0; i < REMAP_MAP_CACHE; i++) {
+        if (!map_cache[i]) { slot = i; break; }
+        if (map_cache[i]->refs == 0 &&
+            (slot < 0 || map_cache[i]->last_use < map_cache[slot]->last_use)) {
+            slot = i;
+        }
+    }
+
+    created->refs = 1;
+    created->last_use = ++use_clock;
+    if (slot >= 0) {
+        map_free(map_cache[slot]);
+        map_cache[slot] = created;
+        created->cached = 1;
+    }
+
+    pthread_mutex_unlock(&cache_mutex);
+    return created;
+}
+
+void remap_map_release(remap_map_t *map) {
+    if (!map) return;
+
+    pthread_mutex_lock(&cache_mutex);
+    map->refs--;
+    int discard = !map->cached && map->refs == 0;
+    pthread_mutex_unlock(&cache_mutex);
+
+    if (discard) map_free(map);
+}
+
+// ============================================================
+// APLICAÇÃO
+// ============================================================
+
+void remap_plane_rows(const remap_map_t *map, const unsigned char *src, size_t src_stride,
+                      unsigned char *dst, size_t dst_stride, int out_begin, int out_end) {
+    const int dw = map->dst_w;
+    for (int y = out_begin; y < out_end; y++) {
+        g_kernels.remap_row(src, src_stride, map->xy + 2 * (size_t)y * dw,
+                            map->frac + (size_t)y * dw, dst + (y - out_begin) * dst_stride, dw);
+    }
+}
+
+const char* remap_mode_name(int mode) {
+    switch (mode) {
+        case REMAP_LENS:        return "lens";
+        case REMAP_PERSPECTIVE: return "perspective";
+        case REMAP_POLAR:       return "polar";
+        default:                return "none";
+    }
+}
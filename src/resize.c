@@ -0,0 +1,461 @@
+#include "resize.h"
+#include "planar.h"
+#include <math.h>
+
+// ============================================================
+// COEFICIENTES POR EIXO
+// ============================================================
+
+// Quantiza pesos em Q14 garantindo soma exata (resto vai para o maior peso)
+static void quantize_weights(const double *w, int16_t *out, int taps) {
+    const int one = 1 << RESIZE_COEF_BITS;
+    int sum = 0, max_k = 0;
+    for (int k = 0; k < taps; k++) {
+        out[k] = (int16_t)lround(w[k] * one);
+        sum += out[k];
+        if (w[k] > w[max_k]) max_k = k;
+    }
+    out[max_k] = (int16_t)(out[max_k] + (one - sum));
+}
+
+static void axis_free(resize_axis_t *ax) {
+    free(ax->offset);
+    free(ax->weight);
+    ax->offset = NULL;
+    ax->weight = NULL;
+}
+
+static int axis_build(resize_axis_t *ax, int src_len, int dst_len, resize_mode_t mode) {
+    double scale = (double)src_len / dst_len;
+
+    // Média por área só se aplica à redução
+    if (mode == RESIZE_AREA && scale <= 1.0) mode = RESIZE_BILINEAR;
+
+    int taps;
+    switch (mode) {
+        case RESIZE_NEAREST:  taps = 1; break;
+        case RESIZE_BILINEAR: taps = 2; break;
+        default:              taps = (int)ceil(scale) + 1; break;
+    }
+    if (taps > src_len) taps = src_len;
+
+    ax->src_len = src_len;
+    ax->dst_len = dst_len;
+    ax->taps = taps;
+    ax->offset = (int*)malloc(dst_len * sizeof(int));
+    ax->weight = (int16_t*)malloc((size_t)dst_len * taps * sizeof(int16_t));
+    double *w = (double*)malloc(taps * sizeof(double));
+    if (!ax->offset || !ax->weight || !w) {
+        free(w);
+        axis_free(ax);
+        return -1;
+    }
+
+    for (int i = 0; i < dst_len; i++) {
+        memset(w, 0, taps * sizeof(double));
+        int first;
+
+        if (mode == RESIZE_NEAREST) {
+            first = MIN((int)((i + 0.5) * scale), src_len - 1);
+            w[0] = 1.0;
+        } else if (mode == RESIZE_BILINEAR) {
+            // Centros de pixel alinhados: x_src = (x_dst + 0.5) * escala - 0.5
+            double fx = (i + 0.5) * scale - 0.5;
+            int x0 = (int)floor(fx);
+            double t = fx - x0;
+            if (x0 < 0) { x0 = 0; t = 0.0; }
+            if (x0 >= src_len - 1) { x0 = src_len - 1; t = 0.0; }
+
+            first = MIN(x0, src_len - taps);
+            w[x0 - first] += 1.0 - t;
+            if (t > 0.0) w[x0 + 1 - first] += t;
+        } else {
+            // Cobertura do pixel de destino: [i*escala, (i+1)*escala)
+            double begin = i * scale;
+            double end = MIN((i + 1) * scale, (double)src_len);
+            int x_lo = (int)floor(begin);
+            int x_hi = MIN((int)ceil(end), src_len);
+
+            first = MIN(x_lo, src_len - taps);
+            for (int x = x_lo; x < x_hi; x++) {
+                double overlap = MIN(end, (double)(x + 1)) - MAX(begin, (double)x);
+                if (overlap > 0.0) w[x - first] += overlap / scale;
+            }
+        }
+
+        ax->offset[i] = first;
+        quantize_weights(w, ax->weight + (size_t)i * taps, taps);
+    }
+
+    free(w);
+    return 0;
+}
+
+// ============================================================
+// CACHE DE PLANOS
+// ============================================================
+// Imagens de uma mesma câmera têm geometria fixa: o plano é calculado
+// na primeira imagem e reaproveitado nas seguintes.
+
+static resize_plan_t *plan_cache[RESIZE_PLAN_CACHE];
+static pthread_mutex_t cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static unsigned long use_clock = 0;
+
+static void plan_free(resize_plan_t *plan) {
+    if (!plan) return;
+    axis_free(&plan->x);
+    axis_free(&plan->y);
+    free(plan);
+}
+
+static resize_plan_t* plan_create(int src_w, int src_h, int dst_w, int dst_h, resize_mode_t mode) {
+    resize_plan_t *plan = (resize_plan_t*)calloc(1, sizeof(resize_plan_t));
+    if (!plan) return NULL;
+
+    plan->src_w = src_w;
+    plan->src_h = src_h;
+    plan->dst_w = dst_w;
+    plan->dst_h = dst_h;
+    plan->mode = mode;
+
+    if (axis_build(&plan->x, src_w, dst_w, mode) != 0 ||
+        axis_build(&plan->y, src_h, dst_h, mode) != 0) {
+        plan_free(plan);
+        return NULL;
+    }
+    return plan;
+}
+
+static resize_plan_t* cache_lookup(int src_w, int src_h, int dst_w, int dst_h, resize_mode_t mode) {
+    for (int i = 0; i < RESIZE_PLAN_CACHE; i++) {
+        resize_plan_t *p = plan_cache[i];
+        if (p && p->src_w == src_w && p->src_h == src_h &&
+            p->dst_w == dst_w && p->dst_h == dst_h && p->mode == mode) {
+            p->refs++;
+            p->last_use = ++use_clock;
+            return p;
+        }
+    }
+    return NULL;
+}
+
+resize_plan_t* resize_plan_get(int src_w, int src_h, int dst_w, int dst_h, resize_mode_t mode) {
+    if (src_w < 1 || src_h < 1 || dst_w < 1 || dst_h < 1) return NULL;
+
+    pthread_mutex_lock(&cache_mutex);
+    resize_plan_t *plan = cache_lookup(src_w, src_h, dst_w, dst_h, mode);
+    pthread_mutex_unlock(&cache_mutex);
+    if (plan) return plan;
+
+    // Cálculo fora da seção crítica
+    resize_plan_t *created = plan_create(src_w, src_h, dst_w, dst_h, mode);
+    if (!created) {
+        LOG_ERROR("Falha ao criar plano de resize %dx%d -> %dx%d", src_w, src_h, dst_w, dst_h);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&cache_mutex);
+
+    // Outra thread pode ter criado o mesmo plano nesse intervalo
+    plan = cache_lookup(src_w, src_h, dst_w, dst_h, mode);
+    if (plan) {
+        pthread_mutex_unlock(&cache_mutex);
+        plan_free(created);
+        return plan;
+    }
+
+    // Entrada livre ou a menos usada recentemente sem usuários ativos
+    int slot = -1;
+    for (int i = 0; i < RESIZE_PLAN_CACHE; i++) {
+        if (!plan_cache[i]) { slot = i; break; }
+        if (plan_cache[i]->refs == 0 &&
+            (slot < 0 || plan_cache[i]->last_use < plan_cache[slot]->last_use)) {
+            slot = i;
+        }
+    }
+
+    created->refs = 1;
+    created->last_use = ++use_clock;
+    if (slot >= 0) {
+        plan_free(plan_cache[slot]);
+        plan_cache[slot] = created;
+        created->cached = 1;
+    }
+
+    pthread_mutex_unlock(&cache_mutex);
+    return created;
+}
+
+void resize_plan_release(resize_plan_t *plan) {
+    if (!plan) return;
+
+    pthread_mutex_lock(&cache_mutex);
+    plan->refs--;
+    int discard = !plan->cached && plan->refs == 0;
+    pthread_mutex_unlock(&cache_mutex);
+
+    if (discard) plan_free(plan);
+}
+
+// ============================================================
+// RESIZE EM STREAMING
+// ============================================================
+
+// ------------------------------------------------------------
+// Variantes especializadas
+// ------------------------------------------------------------
+// Instanciadas por macro para que o compilador desenrole os laços de taps
+// e de canais; a variante é escolhida uma vez por stream (por imagem).
+
+// Passo horizontal sobre um plano da linha intermediária (largura de origem)
+#define RESIZE_HORIZ_TEMPLATE(NAME, TAPS)                                       \
+static void NAME(const int16_t *src, unsigned char *dst, const resize_axis_t *ax) { \
+    const int taps = (TAPS);                                                    \
+    const int shift = RESIZE_COEF_BITS + RESIZE_INTER_BITS;                     \
+    for (int x = 0; x < ax->dst_len; x++) {                                     \
+        const int16_t *w = ax->weight + (size_t)x * taps;                       \
+        const int16_t *in = src + ax->offset[x];                                \
+        int acc = 0;                                                            \
+        for (int k = 0; k < taps; k++) acc += w[k] * in[k];                     \
+        int v = (acc + (1 << (shift - 1))) >> shift;                            \
+        dst[x] = (unsigned char)MIN(v, 255);                                    \
+    }                                                                           \
+}
+
+RESIZE_HORIZ_TEMPLATE(resize_horiz_plane, ax->taps)
+RESIZE_HORIZ_TEMPLATE(resize_horiz_t1, 1)
+RESIZE_HORIZ_TEMPLATE(resize_horiz_t2, 2)
+RESIZE_HORIZ_TEMPLATE(resize_horiz_t3, 3)
+RESIZE_HORIZ_TEMPLATE(resize_horiz_t4, 4)
+
+// Vizinho, bilinear e área até 3:1; reduções maiores usam a versão genérica
+static const resize_horiz_fn resize_horiz_taps[] = {
+    NULL, resize_horiz_t1, resize_horiz_t2, resize_horiz_t3, resize_horiz_t4
+};
+#define RESIZE_HORIZ_MAX_TAPS   4
+
+// Linha com C canais: cópia dos planos para o anel e emissão de uma saída
+#define RESIZE_ROW_TEMPLATE(C)                                                  \
+static void resize_store_c##C(const resize_stream_t *rs, const unsigned char *row, \
+                              unsigned char *slot) {                            \
+    for (int ch = 0; ch < (C); ch++) {                                          \
+        memcpy(slot + ch * rs->stride, row + ch * rs->stride,                   \
+               (size_t)rs->plan->src_w);                                        \
+    }                                                                           \
+}                                                                               \
+static void resize_emit_c##C(const resize_stream_t *rs, unsigned char *out) {   \
+    const resize_plan_t *plan = rs->plan;                                       \
+    for (int ch = 0; ch < (C); ch++) {                                          \
+        rs->horiz(rs->vrow + ch * rs->stride,                                   \
+                  (C) == 1 ? out : rs->out_planes + ch * rs->out_stride, &plan->x); \
+    }                                                                           \
+    if ((C) > 1) planar_merge_row(rs->out_planes, out, plan->dst_w, (C));       \
+}
+
+RESIZE_ROW_TEMPLATE(1)
+RESIZE_ROW_TEMPLATE(2)
+RESIZE_ROW_TEMPLATE(3)
+RESIZE_ROW_TEMPLATE(4)
+
+struct resize_row_ops_s {
+    void (*store)(const resize_stream_t *rs, const unsigned char *row, unsigned char *slot);
+    void (*emit)(const resize_stream_t *rs, unsigned char *out);
+};
+
+static const resize_row_ops_t resize_row_ops[MAX_CHANNELS + 1] = {
+    { NULL, NULL },
+    { resize_store_c1, resize_emit_c1 },
+    { resize_store_c2, resize_emit_c2 },
+    { resize_store_c3, resize_emit_c3 },
+    { resize_store_c4, resize_emit_c4 },
+};
+
+int resize_stream_init(resize_stream_t *rs, const resize_plan_t *plan, int channels,
+                       int out_begin, int out_end) {
+    memset(rs, 0, sizeof(*rs));
+    rs->plan = plan;
+    rs->channels = channels;
+    rs->out_begin = out_begin;
+    rs->out_end = out_end;
+    rs->next_out = out_begin;
+    rs->stride = planar_stride(plan->src_w);
+    rs->out_stride = planar_stride(plan->dst_w);
+    rs->ops = &resize_row_ops[channels];
+    rs->horiz = plan->x.taps <= RESIZE_HORIZ_MAX_TAPS ? resize_horiz_taps[plan->x.taps]
+                                                      : resize_horiz_plane;
+
+    const resize_axis_t *ay = &plan->y;
+    if (out_begin < out_end) {
+        rs->in_begin = ay->offset[out_begin];
+        rs->in_end = ay->offset[out_end - 1] + ay->taps;
+    }
+
+    size_t row_elems = rs->stride * channels;
+    rs->ring = (unsigned char*)planar_alloc(ay->taps * row_elems);
+    rs->rows = (const unsigned char**)malloc(ay->taps * sizeof(*rs->rows));
+    rs->vrow = (int16_t*)planar_alloc(row_elems * sizeof(int16_t));
+    if (channels > 1) rs->out_planes = (unsigned char*)planar_alloc(rs->out_stride * channels);
+    if (!rs->ring || !rs->rows || !rs->vrow || (channels > 1 && !rs->out_planes)) {
+        LOG_ERROR("Falha ao alocar memória para resize");
+        resize_stream_free(rs);
+        return -1;
+    }
+    return 0;
+}
+
+void resize_stream_push(resize_stream_t *rs, const unsigned char *row, int y, unsigned char *dst) {
+    if (y < rs->in_begin || y >= rs->in_end) return;
+
+    const resize_plan_t *plan = rs->plan;
+    const int c = rs->channels;
+    const int taps = plan->y.taps;
+    const size_t row_elems = rs->stride * c;
+    const size_t out_bytes = (size_t)plan->dst_w * c;
+
+    // Linhas entre os taps de saídas consecutivas (redução) não são usadas
+    if (rs->next_out >= rs->out_end || y < plan->y.offset[rs->next_out]) return;
+
+    // Só a largura útil de cada plano: o preenchimento do anel fica zerado
+    rs->ops->store(rs, row, rs->ring + (size_t)(y % taps) * row_elems);
+
+    // Emite as linhas de destino cujos taps verticais já chegaram
+    while (rs->next_out < rs->out_end && plan->y.offset[rs->next_out] + taps - 1 <= y) {
+        int first = plan->y.offset[rs->next_out];
+        for (int k = 0; k < taps; k++) {
+            rs->rows[k] = rs->ring + (size_t)((first + k) % taps) * row_elems;
+        }
+        // Passo vertical de todos os planos da linha em uma chamada
+        g_kernels.resize_vert_row(rs->rows, plan->y.weight + (size_t)rs->next_out * taps,
+                                  taps, rs->vrow, (int)row_elems);
+        rs->ops->emit(rs, dst + rs->next_out * out_bytes);
+        rs->next_out++;
+    }
+}
+
+void resize_stream_free(resize_stream_t *rs) {
+    free(rs->ring);
+    free(rs->rows);
+    free(rs->vrow);
+    free(rs->out_planes);
+    rs->ring = NULL;
+    rs->rows = NULL;
+    rs->vrow = NULL;
+    rs->out_planes = NULL;
+}
+
+int resize_image(const unsigned char *src, int src_w, int src_h, int channels,
+                 unsigned char *dst, int dst_w, int dst_h, resize_mode_t mode) {
+    resize_plan_t *plan = resize_plan_get(src_w, src_h, dst_w, dst_h, mode);
+    if (!plan) return -1;
+
+    resize_stream_t rs;
+    if (resize_stream_init(&rs, plan, channels, 0, dst_h) != 0) {
+        resize_plan_release(plan);
+        return -1;
+    }
+    unsigned char *planes = NULL;
+    if (channels > 1 && !(planes = (unsigned char*)planar_alloc(rs.stride * channels))) {
+        LOG_ERROR("Falha ao alocar memória para resize");
+        resize_stream_free(&rs);
+        resize_plan_release(plan);
+        return -1;
+    }
+
+    size_t stride = (size_t)src_w * channels;
+    for (int y = rs.in_begin; y < rs.in_end; y++) {
+        const unsigned char *row = src + y * stride;
+        if (planes) {
+            planar_split_row(row, planes, src_w, channels);
+            row = planes;
+        }
+        resize_stream_push(&rs, row, y, dst);
+    }
+
+    free(planes);
+    resize_stream_free(&rs);
+    resize_plan_release(plan);
+    return 0;
+}
+
+// ------------------------------------------------------------
+// 16 bits por amostra
+// ------------------------------------------------------------
+// Mesmos coeficientes Q14 do plano. A origem está inteira na memória:
+// cada linha de saída combina as linhas de origem dos taps diretamente.
+// Pesos não negativos com soma 2^14: acumuladores em 32 bits sem estouro.
+
+int resize_rows_u16(const resize_plan_t *plan, const uint16_t *src, int channels,
+                    uint16_t *dst, int out_begin, int out_end) {
+    const resize_axis_t *ax = &plan->x, *ay = &plan->y;
+    const size_t src_n = (size_t)plan->src_w * channels;
+    const size_t dst_n = (size_t)plan->dst_w * channels;
+    const uint32_t half = 1u << (RESIZE_COEF_BITS - 1);
+
+    uint32_t *vrow = (uint32_t*)malloc(src_n * sizeof(uint32_t));
+    if (!vrow) {
+        LOG_ERROR("Falha ao alocar memória para resize de 16 bits");
+        return -1;
+    }
+
+    for (int y = out_begin; y < out_end; y++) {
+        // Passo vertical: linha intermediária já arredondada para 16 bits
+        const int16_t *wy = ay->weight + (size_t)y * ay->taps;
+        const uint16_t *s = src + (size_t)ay->offset[y] * src_n;
+        for (size_t i = 0; i < src_n; i++) vrow[i] = (uint32_t)wy[0] * s[i];
+        for (int k = 1; k < ay->taps; k++) {
+            const uint16_t *sk = s + (size_t)k * src_n;
+            const uint32_t w = (uint32_t)wy[k];
+            for (size_t i = 0; i < src_n; i++) vrow[i] += w * sk[i];
+        }
+        for (size_t i = 0; i < src_n; i++) vrow[i] = (vrow[i] + half) >> RESIZE_COEF_BITS;
+
+        // Passo horizontal
+        uint16_t *out = dst + (size_t)(y - out_begin) * dst_n;
+        for (int x = 0; x < plan->dst_w; x++) {
+            const int16_t *wx = ax->weight + (size_t)x * ax->taps;
+            const uint32_t *v = vrow + (size_t)ax->offset[x] * channels;
+            for (int ch = 0; ch < channels; ch++) {
+                uint32_t acc = half;
+                for (int k = 0; k < ax->taps; k++) acc += (uint32_t)wx[k] * v[k * channels + ch];
+                out[x * channels + ch] = (uint16_t)MIN(acc >> RESIZE_COEF_BITS, 65535u);
+            }
+        }
+    }
+
+    free(vrow);
+    return 0;
+}
+
+// ============================================================
+// CONFIGURAÇÃO
+// ============================================================
+
+void resize_target_size(const pipeline_config_t *cfg, int src_w, int src_h,
+                        int *dst_w, int *dst_h) {
+    if (cfg->resize_width > 0 && cfg->resize_height > 0) {
+        *dst_w = cfg->resize_width;
+        *dst_h = cfg->resize_height;
+    } else if (cfg->resize_width > 0) {
+        // Só largura: mantém proporção
+        *dst_w = cfg->resize_width;
+        *dst_h = (int)lround((double)src_h * cfg->resize_width / src_w);
+    } else if (cfg->resize_height > 0) {
+        *dst_h = cfg->resize_height;
+        *dst_w = (int)lround((double)src_w * cfg->resize_height / src_h);
+    } else {
+        *dst_w = (int)lround(src_w * cfg->resize_scale);
+        *dst_h = (int)lround(src_h * cfg->resize_scale);
+    }
+
+    if (*dst_w < 1) *dst_w = 1;
+    if (*dst_h < 1) *dst_h = 1;
+}
+
+const char* resize_mode_name(resize_mode_t mode) {
+    switch (mode) {
+        case RESIZE_NEAREST:  return "nearest";
+        case RESIZE_BILINEAR: return "bilinear";
+        case RESIZE_AREA:     return "area";
+        default:              return "unknown";
+    }
+}
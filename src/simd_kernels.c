@@ -0,0 +1,3487 @@
+#include "simd_kernels.h"
+#include <math.h>
+
+#if FAVIS_X86
+#include <immintrin.h>
+
+#define TARGET_SSSE3 __attribute__((target("ssse3")))
+#define TARGET_AVX2  __attribute__((target("avx2")))
+#endif
+
+// ============================================================
+// TABELA DE DESPACHO
+// ============================================================
+
+simd_kernels_t g_kernels = {
+    .gray_row_rgb = gray_row_rgb_scalar,
+    .gray_row_rgba = gray_row_rgba_scalar,
+    .gray_plane_rgb = gray_plane_rgb_scalar,
+    .gray_plane_rgba = gray_plane_rgba_scalar,
+    .blur_addsub_row = blur_addsub_row_scalar,
+    .blur_scale_row = blur_scale_row_scalar,
+    .blur_hsum_row = blur_hsum_row_scalar,
+    .resize_vert_row = resize_vert_row_scalar,
+    .sobel_row = sobel_row_scalar,
+    .sobel_mag_l1 = sobel_mag_l1_scalar,
+    .sobel_mag_l2 = sobel_mag_l2_scalar,
+    .sobel_dir = sobel_dir_scalar,
+    .gauss5_vert_row = gauss5_vert_row_scalar,
+    .gauss5_horiz_row = gauss5_horiz_row_scalar,
+    .grad_mag16_row = grad_mag16_row_scalar,
+    .canny_nms_row = canny_nms_row_scalar,
+    .morph_min_row = morph_min_row_scalar,
+    .morph_max_row = morph_max_row_scalar,
+    .transpose_u8 = transpose_u8_scalar,
+    .integral_row = integral_row_scalar,
+    .integral_sq_row = integral_sq_row_scalar,
+    .box_sum_row = box_sum_row_scalar,
+    .dot_u8 = dot_u8_scalar,
+    .pyr_down_row = pyr_down_row_scalar,
+    .ncc_mac_row = ncc_mac_row_scalar,
+    .threshold_row = threshold_row_scalar,
+    .threshold_mean_row = threshold_mean_row_scalar,
+    .lut_row = lut_row_scalar,
+    .remap_row = remap_row_scalar,
+    .calib_row = calib_row_scalar,
+    .bayer_bilinear_row = bayer_bilinear_row_scalar,
+    .bayer_green_row = bayer_green_row_scalar,
+    .bayer_rb_row = bayer_rb_row_scalar,
+    .gray_planes_row = gray_planes_row_scalar,
+    .golden_row = golden_row_scalar,
+    .median_row = median_row_scalar,
+    .color_matrix_row = color_matrix_row_scalar,
+    .hsv_row = hsv_row_scalar,
+    .class_row = class_row_scalar,
+    .deinterleave_ga = deinterleave_ga_scalar,
+    .deinterleave_rgb = deinterleave_rgb_scalar,
+    .deinterleave_rgba = deinterleave_rgba_scalar,
+    .interleave_ga = interleave_ga_scalar,
+    .interleave_rgb = interleave_rgb_scalar,
+    .interleave_rgba = interleave_rgba_scalar,
+};
+
+void simd_kernels_select(simd_level_t level) {
+    g_kernels.gray_row_rgb = gray_row_rgb_scalar;
+    g_kernels.gray_row_rgba = gray_row_rgba_scalar;
+    g_kernels.gray_plane_rgb = gray_plane_rgb_scalar;
+    g_kernels.gray_plane_rgba = gray_plane_rgba_scalar;
+    g_kernels.blur_addsub_row = blur_addsub_row_scalar;
+    g_kernels.blur_scale_row = blur_scale_row_scalar;
+    g_kernels.blur_hsum_row = blur_hsum_row_scalar;
+    g_kernels.resize_vert_row = resize_vert_row_scalar;
+    g_kernels.sobel_row = sobel_row_scalar;
+    g_kernels.sobel_mag_l1 = sobel_mag_l1_scalar;
+    g_kernels.sobel_mag_l2 = sobel_mag_l2_scalar;
+    g_kernels.sobel_dir = sobel_dir_scalar;
+    g_kernels.gauss5_vert_row = gauss5_vert_row_scalar;
+    g_kernels.gauss5_horiz_row = gauss5_horiz_row_scalar;
+    g_kernels.grad_mag16_row = grad_mag16_row_scalar;
+    g_kernels.canny_nms_row = canny_nms_row_scalar;
+    g_kernels.morph_min_row = morph_min_row_scalar;
+    g_kernels.morph_max_row = morph_max_row_scalar;
+    g_kernels.transpose_u8 = transpose_u8_scalar;
+    g_kernels.integral_row = integral_row_scalar;
+    g_kernels.integral_sq_row = integral_sq_row_scalar;
+    g_kernels.box_sum_row = box_sum_row_scalar;
+    g_kernels.dot_u8 = dot_u8_scalar;
+    g_kernels.pyr_down_row = pyr_down_row_scalar;
+    g_kernels.ncc_mac_row = ncc_mac_row_scalar;
+    g_kernels.threshold_row = threshold_row_scalar;
+    g_kernels.threshold_mean_row = threshold_mean_row_scalar;
+    g_kernels.lut_row = lut_row_scalar;
+    g_kernels.remap_row = remap_row_scalar;
+    g_kernels.calib_row = calib_row_scalar;
+    g_kernels.bayer_bilinear_row = bayer_bilinear_row_scalar;
+    g_kernels.bayer_green_row = bayer_green_row_scalar;
+    g_kernels.bayer_rb_row = bayer_rb_row_scalar;
+    g_kernels.gray_planes_row = gray_planes_row_scalar;
+    g_kernels.golden_row = golden_row_scalar;
+    g_kernels.median_row = median_row_scalar;
+    g_kernels.color_matrix_row = color_matrix_row_scalar;
+    g_kernels.hsv_row = hsv_row_scalar;
+    g_kernels.class_row = class_row_scalar;
+    g_kernels.deinterleave_ga = deinterleave_ga_scalar;
+    g_kernels.deinterleave_rgb = deinterleave_rgb_scalar;
+    g_kernels.deinterleave_rgba = deinterleave_rgba_scalar;
+    g_kernels.interleave_ga = interleave_ga_scalar;
+    g_kernels.interleave_rgb = interleave_rgb_scalar;
+    g_kernels.interleave_rgba = interleave_rgba_scalar;
+
+#if FAVIS_X86
+    if (level >= SIMD_SSSE3) {
+        g_kernels.gray_row_rgb = gray_row_rgb_ssse3;
+        g_kernels.gray_row_rgba = gray_row_rgba_ssse3;
+        g_kernels.gray_plane_rgb = gray_plane_rgb_ssse3;
+        g_kernels.gray_plane_rgba = gray_plane_rgba_ssse3;
+        g_kernels.blur_addsub_row = blur_addsub_row_ssse3;
+        g_kernels.blur_scale_row = blur_scale_row_ssse3;
+        g_kernels.blur_hsum_row = blur_hsum_row_ssse3;
+        g_kernels.resize_vert_row = resize_vert_row_ssse3;
+        g_kernels.sobel_row = sobel_row_ssse3;
+        g_kernels.sobel_mag_l1 = sobel_mag_l1_ssse3;
+        g_kernels.sobel_mag_l2 = sobel_mag_l2_ssse3;
+        g_kernels.sobel_dir = sobel_dir_ssse3;
+        g_kernels.gauss5_vert_row = gauss5_vert_row_ssse3;
+        g_kernels.gauss5_horiz_row = gauss5_horiz_row_ssse3;
+        g_kernels.grad_mag16_row = grad_mag16_row_ssse3;
+        g_kernels.canny_nms_row = canny_nms_row_ssse3;
+        g_kernels.morph_min_row = morph_min_row_ssse3;
+        g_kernels.morph_max_row = morph_max_row_ssse3;
+        g_kernels.transpose_u8 = transpose_u8_ssse3;
+        g_kernels.integral_row = integral_row_ssse3;
+        g_kernels.integral_sq_row = integral_sq_row_ssse3;
+        g_kernels.box_sum_row = box_sum_row_ssse3;
+        g_kernels.dot_u8 = dot_u8_ssse3;
+        g_kernels.pyr_down_row = pyr_down_row_ssse3;
+        g_kernels.ncc_mac_row = ncc_mac_row_ssse3;
+        g_kernels.threshold_row = threshold_row_ssse3;
+        g_kernels.threshold_mean_row = threshold_mean_row_ssse3;
+        g_kernels.lut_row = lut_row_ssse3;
+        g_kernels.remap_row = remap_row_ssse3;
+        g_kernels.calib_row = calib_row_ssse3;
+        g_kernels.bayer_bilinear_row = bayer_bilinear_row_ssse3;
+        g_kernels.bayer_green_row = bayer_green_row_ssse3;
+        g_kernels.bayer_rb_row = bayer_rb_row_ssse3;
+        g_kernels.gray_planes_row = gray_planes_row_ssse3;
+        g_kernels.golden_row = golden_row_ssse3;
+        g_kernels.median_row = median_row_ssse3;
+        g_kernels.color_matrix_row = color_matrix_row_ssse3;
+        g_kernels.hsv_row = hsv_row_ssse3;
+        g_kernels.class_row = class_row_ssse3;
+        g_kernels.deinterleave_ga = deinterleave_ga_ssse3;
+        g_kernels.deinterleave_rgb = deinterleave_rgb_ssse3;
+        g_kernels.deinterleave_rgba = deinterleave_rgba_ssse3;
+        g_kernels.interleave_ga = interleave_ga_ssse3;
+        g_kernels.interleave_rgb = interleave_rgb_ssse3;
+        g_kernels.interleave_rgba = interleave_rgba_ssse3;
+    }
+    if (level >= SIMD_AVX2) {
+        g_kernels.gray_row_rgb = gray_row_rgb_avx2;
+        g_kernels.gray_row_rgba = gray_row_rgba_avx2;
+        g_kernels.gray_plane_rgb = gray_plane_rgb_avx2;
+        g_kernels.gray_plane_rgba = gray_plane_rgba_avx2;
+        g_kernels.blur_addsub_row = blur_addsub_row_avx2;
+        g_kernels.blur_scale_row = blur_scale_row_avx2;
+        g_kernels.blur_hsum_row = blur_hsum_row_avx2;
+        g_kernels.resize_vert_row = resize_vert_row_avx2;
+        g_kernels.sobel_row = sobel_row_avx2;
+        g_kernels.sobel_mag_l1 = sobel_mag_l1_avx2;
+        g_kernels.sobel_mag_l2 = sobel_mag_l2_avx2;
+        g_kernels.sobel_dir = sobel_dir_avx2;
+        g_kernels.gauss5_vert_row = gauss5_vert_row_avx2;
+        g_kernels.gauss5_horiz_row = gauss5_horiz_row_avx2;
+        g_kernels.grad_mag16_row = grad_mag16_row_avx2;
+        g_kernels.canny_nms_row = canny_nms_row_avx2;
+        g_kernels.morph_min_row = morph_min_row_avx2;
+        g_kernels.morph_max_row = morph_max_row_avx2;
+        g_kernels.integral_row = integral_row_avx2;
+        g_kernels.integral_sq_row = integral_sq_row_avx2;
+        g_kernels.box_sum_row = box_sum_row_avx2;
+        g_kernels.dot_u8 = dot_u8_avx2;
+        g_kernels.pyr_down_row = pyr_down_row_avx2;
+        g_kernels.ncc_mac_row = ncc_mac_row_avx2;
+        g_kernels.threshold_row = threshold_row_avx2;
+        g_kernels.threshold_mean_row = threshold_mean_row_avx2;
+        g_kernels.lut_row = lut_row_avx2;
+        g_kernels.remap_row = remap_row_avx2;
+        g_kernels.calib_row = calib_row_avx2;
+        g_kernels.bayer_bilinear_row = bayer_bilinear_row_avx2;
+        g_kernels.bayer_green_row = bayer_green_row_avx2;
+        g_kernels.bayer_rb_row = bayer_rb_row_avx2;
+        g_kernels.gray_planes_row = gray_planes_row_avx2;
+        g_kernels.golden_row = golden_row_avx2;
+        g_kernels.median_row = median_row_avx2;
+        g_kernels.color_matrix_row = color_matrix_row_avx2;
+        g_kernels.hsv_row = hsv_row_avx2;
+        g_kernels.class_row = class_row_avx2;
+        g_kernels.deinterleave_ga = deinterleave_ga_avx2;
+        g_kernels.deinterleave_rgb = deinterleave_rgb_avx2;
+        g_kernels.deinterleave_rgba = deinterleave_rgba_avx2;
+        g_kernels.interleave_ga = interleave_ga_avx2;
+        g_kernels.interleave_rgb = interleave_rgb_avx2;
+        g_kernels.interleave_rgba = interleave_rgba_avx2;
+    }
+#else
+    (void)level;
+#endif
+}
+
+// ============================================================
+// GRAYSCALE - REFERÊNCIA ESCALAR
+// ============================================================
+
+void gray_row_rgb_scalar(const unsigned char *src, unsigned char *dst, int n) {
+    for (int i = 0; i < n; i++, src += 3, dst += 3) {
+        unsigned char gray = gray_pixel(src[0], src[1], src[2]);
+        dst[0] = gray;
+        dst[1] = gray;
+        dst[2] = gray;
+    }
+}
+
+void gray_row_rgba_scalar(const unsigned char *src, unsigned char *dst, int n) {
+    for (int i = 0; i < n; i++, src += 4, dst += 4) {
+        unsigned char gray = gray_pixel(src[0], src[1], src[2]);
+        unsigned char alpha = src[3];
+        dst[0] = gray;
+        dst[1] = gray;
+        dst[2] = gray;
+        dst[3] = alpha;
+    }
+}
+
+void gray_plane_rgb_scalar(const unsigned char *src, unsigned char *dst, int n) {
+    for (int i = 0; i < n; i++, src += 3) {
+        dst[i] = gray_pixel(src[0], src[1], src[2]);
+    }
+}
+
+void gray_plane_rgba_scalar(const unsigned char *src, unsigned char *dst, int n) {
+    for (int i = 0; i < n; i++, src += 4) {
+        dst[i] = gray_pixel(src[0], src[1], src[2]);
+    }
+}
+
+// ============================================================
+// BOX BLUR - REFERÊNCIA ESCALAR
+// ============================================================
+
+void blur_addsub_row_scalar(uint32_t *acc, const uint16_t *add, const uint16_t *sub, int n) {
+    // A diferença pode ser negativa; o resultado final é sempre >= 0
+    for (int i = 0; i < n; i++) {
+        acc[i] += (uint32_t)((int)add[i] - (int)sub[i]);
+    }
+}
+
+void blur_scale_row_scalar(const uint32_t *acc, unsigned char *dst, int n, uint32_t area) {
+    const uint32_t half = area / 2;
+    for (int i = 0; i < n; i++) {
+        dst[i] = (unsigned char)((acc[i] + half) / area);
+    }
+}
+
+uint16_t blur_hsum_row_scalar(const unsigned char *src, int span, uint16_t *dst,
+                              int n, uint16_t sum) {
+    for (int i = 0; i < n; i++) {
+        sum = (uint16_t)(sum + src[i + span] - src[i]);
+        dst[i] = sum;
+    }
+    return sum;
+}
+
+// ============================================================
+// RESIZE - REFERÊNCIA ESCALAR
+// ============================================================
+
+void resize_vert_row_scalar(const unsigned char *const *rows, const int16_t *weights,
+                            int taps, int16_t *dst, int n) {
+    for (int i = 0; i < n; i++) {
+        int acc = 1 << (RESIZE_VERT_SHIFT - 1);
+        for (int k = 0; k < taps; k++) {
+            acc += weights[k] * rows[k][i];
+        }
+        dst[i] = (int16_t)(acc >> RESIZE_VERT_SHIFT);
+    }
+}
+
+// ============================================================
+// SOBEL - REFERÊNCIA ESCALAR
+// ============================================================
+
+void sobel_row_scalar(const unsigned char *r0, const unsigned char *r1,
+                      const unsigned char *r2, int16_t *gx, int16_t *gy, int n) {
+    for (int i = 0; i < n; i++) {
+        // Colunas i-1, i, i+1 estão em i, i+1, i+2 (linhas com borda)
+        gx[i] = (int16_t)((r0[i + 2] - r0[i]) + 2 * (r1[i + 2] - r1[i]) + (r2[i + 2] - r2[i]));
+        gy[i] = (int16_t)((r2[i] + 2 * r2[i + 1] + r2[i + 2]) - (r0[i] + 2 * r0[i + 1] + r0[i + 2]));
+    }
+}
+
+void sobel_mag_l1_scalar(const int16_t *gx, const int16_t *gy, unsigned char *dst, int n) {
+    for (int i = 0; i < n; i++) {
+        int m = abs(gx[i]) + abs(gy[i]);
+        dst[i] = (unsigned char)(m > 255 ? 255 : m);
+    }
+}
+
+void sobel_mag_l2_scalar(const int16_t *gx, const int16_t *gy, unsigned char *dst, int n) {
+    for (int i = 0; i < n; i++) {
+        // gx² + gy² <= 2 × 1020²: exato em float; sqrtf tem arredondamento IEEE como sqrtps
+        int s = gx[i] * gx[i] + gy[i] * gy[i];
+        int m = (int)(sqrtf((float)s) + 0.5f);
+        dst[i] = (unsigned char)(m > 255 ? 255 : m);
+    }
+}
+
+// Arredondamento igual ao de pmulhrsw: (a × b + 2^14) >> 15
+static inline int mul_q15_round(int a, int b) {
+    return (a * b + (1 << 14)) >> 15;
+}
+
+void sobel_dir_scalar(const int16_t *gx, const int16_t *gy, unsigned char *dst, int n) {
+    for (int i = 0; i < n; i++) {
+        int ax = abs(gx[i]), ay = abs(gy[i]);
+        if (ay <= mul_q15_round(ax, SOBEL_TAN_22_5)) {
+            dst[i] = SOBEL_DIR_0;
+        } else if (ax <= mul_q15_round(ay, SOBEL_TAN_22_5)) {
+            dst[i] = SOBEL_DIR_90;
+        } else {
+            dst[i] = ((gx[i] ^ gy[i]) < 0) ? SOBEL_DIR_135 : SOBEL_DIR_45;
+        }
+    }
+}
+
+// ============================================================
+// CANNY - REFERÊNCIA ESCALAR
+// ============================================================
+
+void gauss5_vert_row_scalar(const unsigned char *r0, const unsigned char *r1,
+                            const unsigned char *r2, const unsigned char *r3,
+                            const unsigned char *r4, uint16_t *dst, int n) {
+    for (int i = 0; i < n; i++) {
+        dst[i] = (uint16_t)(r0[i] + 4 * r1[i] + 6 * r2[i] + 4 * r3[i] + r4[i]);
+    }
+}
+
+void gauss5_horiz_row_scalar(const uint16_t *src, unsigned char *dst, int n) {
+    for (int i = 0; i < n; i++) {
+        int v = src[i] + 4 * src[i + 1] + 6 * src[i + 2] + 4 * src[i + 3] + src[i + 4];
+        dst[i] = (unsigned char)((v + (1 << (GAUSS5_SHIFT - 1))) >> GAUSS5_SHIFT);
+    }
+}
+
+void grad_mag16_row_scalar(const int16_t *gx, const int16_t *gy, int16_t *dst, int n) {
+    for (int i = 0; i < n; i++) {
+        dst[i] = (int16_t)(abs(gx[i]) + abs(gy[i]));
+    }
+}
+
+void canny_nms_row_scalar(const int16_t *m0, const int16_t *m1, const int16_t *m2,
+                          const unsigned char *dir, unsigned char *dst, int n,
+                          int low, int high) {
+    for (int i = 0; i < n; i++) {
+        int m = m1[i + 1];
+        int a, b;
+        // Vizinhos ao longo do gradiente (coluna i-1, i, i+1 = índices i, i+1, i+2)
+        switch (dir[i]) {
+            case SOBEL_DIR_0:  a = m1[i];     b = m1[i + 2]; break;
+            case SOBEL_DIR_45: a = m0[i];     b = m2[i + 2]; break;
+            case SOBEL_DIR_90: a = m0[i + 1]; b = m2[i + 1]; break;
+            default:           a = m0[i + 2]; b = m2[i];     break;
+        }
+        // Empate desfeito para um dos lados: a borda fica com 1 pixel
+        if (m > low && m > a && m >= b) {
+            dst[i] = m > high ? CANNY_STRONG : CANNY_WEAK;
+        } else {
+            dst[i] = 0;
+        }
+    }
+}
+
+// ============================================================
+// MORFOLOGIA - REFERÊNCIA ESCALAR
+// ============================================================
+
+void morph_min_row_scalar(const unsigned char *a, const unsigned char *b, unsigned char *dst, int n) {
+    for (int i = 0; i < n; i++) {
+        dst[i] = a[i] < b[i] ? a[i] : b[i];
+    }
+}
+
+void morph_max_row_scalar(const unsigned char *a, const unsigned char *b, unsigned char *dst, int n) {
+    for (int i = 0; i < n; i++) {
+        dst[i] = a[i] > b[i] ? a[i] : b[i];
+    }
+}
+
+void transpose_u8_scalar(const unsigned char *src, size_t src_stride,
+                         unsigned char *dst, size_t dst_stride, int rows, int cols) {
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            dst[c * dst_stride + r] = src[r * src_stride + c];
+        }
+    }
+}
+
+// ============================================================
+// IMAGEM INTEGRAL - REFERÊNCIA ESCALAR
+// ============================================================
+// O prefixo da linha é sequencial: as versões SIMD terminam a cauda
+// com o acumulado corrente em vez de chamar a versão escalar do zero.
+
+static inline void integral_row_tail(const unsigned char *src, const uint32_t *prev,
+                                     uint32_t *dst, int i, int n, uint32_t run) {
+    for (; i < n; i++) {
+        run += src[i];
+        dst[i] = prev[i] + run;
+    }
+}
+
+static inline void integral_sq_row_tail(const unsigned char *src, const uint64_t *prev,
+                                        uint64_t *dst, int i, int n, uint64_t run) {
+    for (; i < n; i++) {
+        run += (uint32_t)src[i] * src[i];
+        dst[i] = prev[i] + run;
+    }
+}
+
+void integral_row_scalar(const unsigned char *src, const uint32_t *prev, uint32_t *dst, int n) {
+    integral_row_tail(src, prev, dst, 0, n, 0);
+}
+
+void integral_sq_row_scalar(const unsigned char *src, const uint64_t *prev, uint64_t *dst, int n) {
+    integral_sq_row_tail(src, prev, dst, 0, n, 0);
+}
+
+void box_sum_row_scalar(const uint32_t *top, const uint32_t *bot, uint32_t *dst, int n, int span) {
+    for (int i = 0; i < n; i++) {
+        dst[i] = bot[i + span] - bot[i] - top[i + span] + top[i];
+    }
+}
+
+// ============================================================
+// TEMPLATE MATCHING - REFERÊNCIA ESCALAR
+// ============================================================
+
+uint64_t dot_u8_scalar(const unsigned char *a, const unsigned char *b, int n) {
+    uint64_t sum = 0;
+    for (int i = 0; i < n; i++) {
+        sum += (uint32_t)a[i] * b[i];
+    }
+    return sum;
+}
+
+void pyr_down_row_scalar(const unsigned char *r0, const unsigned char *r1,
+                         unsigned char *dst, int n) {
+    for (int i = 0; i < n; i++) {
+        dst[i] = (unsigned char)((r0[2 * i] + r0[2 * i + 1] + r1[2 * i] + r1[2 * i + 1] + 2) >> 2);
+    }
+}
+
+void ncc_mac_row_scalar(const unsigned char *src, int c0, int c1, uint32_t *acc, int n) {
+    for (int i = 0; i < n; i++) {
+        acc[i] += (uint32_t)(src[i] * c0 + src[i + 1] * c1);
+    }
+}
+
+// ============================================================
+// THRESHOLD / HISTOGRAMA - REFERÊNCIA ESCALAR
+// ============================================================
+
+void threshold_row_scalar(const unsigned char *src, unsigned char *dst, int n, int thresh) {
+    for (int i = 0; i < n; i++) {
+        dst[i] = src[i] > thresh ? 255 : 0;
+    }
+}
+
+void threshold_mean_row_scalar(const unsigned char *src, const unsigned char *mean,
+                               unsigned char *dst, int n, int c) {
+    for (int i = 0; i < n; i++) {
+        dst[i] = src[i] + c > mean[i] ? 255 : 0;
+    }
+}
+
+void histogram_u8(const unsigned char *src, int n, uint32_t *hist) {
+    uint32_t bank[HIST_BANKS][256];
+    memset(bank, 0, sizeof(bank));
+
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t v;
+        memcpy(&v, src + i, sizeof(v));
+        bank[0][v & 0xFF]++;
+        bank[1][(v >> 8) & 0xFF]++;
+        bank[2][(v >> 16) & 0xFF]++;
+        bank[3][(v >> 24) & 0xFF]++;
+        bank[0][(v >> 32) & 0xFF]++;
+        bank[1][(v >> 40) & 0xFF]++;
+        bank[2][(v >> 48) & 0xFF]++;
+        bank[3][v >> 56]++;
+    }
+    for (; i < n; i++) bank[0][src[i]]++;
+
+    for (int b = 0; b < 256; b++) {
+        hist[b] += bank[0][b] + bank[1][b] + bank[2][b] + bank[3][b];
+    }
+}
+
+// Dois bancos por canal (pixels alternados): com 3-4 canais as tabelas de
+// canais diferentes já intercalam os incrementos
+void histogram_channels_u8(const unsigned char *src, int n, int channels,
+                           uint32_t (*hist)[256]) {
+    if (channels == 1) {
+        histogram_u8(src, n, hist[0]);
+        return;
+    }
+
+    uint32_t bank[2][MAX_CHANNELS][256];
+    memset(bank, 0, sizeof(bank));
+
+    const int c = channels;
+    int i = 0;
+    for (; i + 2 <= n; i += 2, src += 2 * c) {
+        for (int k = 0; k < c; k++) {
+            bank[0][k][src[k]]++;
+            bank[1][k][src[c + k]]++;
+        }
+    }
+    if (i < n) {
+        for (int k = 0; k < c; k++) bank[0][k][src[k]]++;
+    }
+
+    for (int k = 0; k < c; k++) {
+        for (int b = 0; b < 256; b++) hist[k][b] += bank[0][k][b] + bank[1][k][b];
+    }
+}
+
+// ============================================================
+// LUT - REFERÊNCIA ESCALAR
+// ============================================================
+
+void lut_row_scalar(const unsigned char *src, unsigned char *dst, int n,
+                    const unsigned char *lut, int alpha_stride) {
+    if (!alpha_stride) {
+        for (int i = 0; i < n; i++) dst[i] = lut[src[i]];
+        return;
+    }
+    // Pixel a pixel: o alpha é copiado (src e dst podem coincidir)
+    for (int i = 0; i + alpha_stride <= n; i += alpha_stride) {
+        for (int k = 0; k < alpha_stride - 1; k++) dst[i + k] = lut[src[i + k]];
+        dst[i + alpha_stride - 1] = src[i + alpha_stride - 1];
+    }
+}
+
+// ============================================================
+// REMAP - REFERÊNCIA ESCALAR
+// ============================================================
+
+void remap_row_scalar(const unsigned char *src, size_t stride, const int16_t *xy,
+                      const uint16_t *frac, unsigned char *dst, int n) {
+    for (int i = 0; i < n; i++) {
+        int fx = frac[i] & 0xFF, fy = frac[i] >> 8;
+        if (fy == 0xFF) {
+            dst[i] = 0;
+            continue;
+        }
+        const unsigned char *p = src + (size_t)xy[2 * i + 1] * stride + xy[2 * i];
+        int top = p[0] * (128 - fx) + p[1] * fx;
+        int bot = p[stride] * (128 - fx) + p[stride + 1] * fx;
+        dst[i] = (unsigned char)((top * (128 - fy) + bot * fy + (1 << 13)) >> 14);
+    }
+}
+
+// ============================================================
+// CALIBRAÇÃO - REFERÊNCIA ESCALAR
+// ============================================================
+
+void calib_row_scalar(const unsigned char *src, const unsigned char *dark,
+                      const int16_t *gain, unsigned char *dst, int n) {
+    for (int i = 0; i < n; i++) {
+        int v = src[i] > dark[i] ? src[i] - dark[i] : 0;
+        v = (v * gain[i] + (1 << 9)) >> 10;
+        dst[i] = (unsigned char)(v > 255 ? 255 : v);
+    }
+}
+
+// ============================================================
+// DEMOSAICO - REFERÊNCIA ESCALAR
+// ============================================================
+
+static inline unsigned char bayer_sat8(int v) {
+    return (unsigned char)(v < 0 ? 0 : v > 255 ? 255 : v);
+}
+
+void bayer_bilinear_row_scalar(const unsigned char *up, const unsigned char *row,
+                               const unsigned char *dn, unsigned char *own, unsigned char *g,
+                               unsigned char *other, int n, int phase) {
+    for (int x = 0; x < n; x++) {
+        if ((x & 1) == phase) {
+            own[x] = row[x];
+            g[x] = (unsigned char)((row[x - 1] + row[x + 1] + up[x] + dn[x] + 2) >> 2);
+            other[x] = (unsigned char)((up[x - 1] + up[x + 1] + dn[x - 1] + dn[x + 1] + 2) >> 2);
+        } else {
+            own[x] = (unsigned char)((row[x - 1] + row[x + 1] + 1) >> 1);
+            g[x] = row[x];
+            other[x] = (unsigned char)((up[x] + dn[x] + 1) >> 1);
+        }
+    }
+}
+
+void bayer_green_row_scalar(const unsigned char *up2, const unsigned char *up,
+                            const unsigned char *row, const unsigned char *dn,
+                            const unsigned char *dn2, unsigned char *g, int n, int phase) {
+    for (int x = 0; x < n; x++) {
+        if ((x & 1) != phase) {
+            g[x] = row[x];
+            continue;
+        }
+        int lap_h = 2 * row[x] - row[x - 2] - row[x + 2];
+        int lap_v = 2 * row[x] - up2[x] - dn2[x];
+        int grad_h = abs(row[x - 1] - row[x + 1]) + abs(lap_h);
+        int grad_v = abs(up[x] - dn[x]) + abs(lap_v);
+        int gh = (2 * (row[x - 1] + row[x + 1]) + lap_h + 2) >> 2;
+        int gv = (2 * (up[x] + dn[x]) + lap_v + 2) >> 2;
+        int v = grad_h < grad_v ? gh : grad_v < grad_h ? gv : (gh + gv + 1) >> 1;
+        g[x] = bayer_sat8(v);
+    }
+}
+
+void bayer_rb_row_scalar(const unsigned char *up, const unsigned char *row,
+                         const unsigned char *dn, const unsigned char *gu,
+                         const unsigned char *g, const unsigned char *gd,
+                         unsigned char *own, unsigned char *other, int n, int phase) {
+    for (int x = 0; x < n; x++) {
+        if ((x & 1) == phase) {
+            int diag = up[x - 1] - gu[x - 1] + up[x + 1] - gu[x + 1] +
+                       dn[x - 1] - gd[x - 1] + dn[x + 1] - gd[x + 1];
+            own[x] = row[x];
+            other[x] = bayer_sat8(g[x] + ((diag + 2) >> 2));
+        } else {
+            int horiz = row[x - 1] - g[x - 1] + row[x + 1] - g[x + 1];
+            int vert = up[x] - gu[x] + dn[x] - gd[x];
+            own[x] = bayer_sat8(g[x] + ((horiz + 1) >> 1));
+            other[x] = bayer_sat8(g[x] + ((vert + 1) >> 1));
+        }
+    }
+}
+
+void gray_planes_row_scalar(const unsigned char *r, const unsigned char *g,
+                            const unsigned char *b, unsigned char *dst, int n) {
+    for (int i = 0; i < n; i++) {
+        dst[i] = gray_pixel(r[i], g[i], b[i]);
+    }
+}
+
+// ============================================================
+// GOLDEN - REFERÊNCIA ESCALAR
+// ============================================================
+
+int golden_row_scalar(const unsigned char *src, const unsigned char *ref,
+                      const unsigned char *tol, unsigned char *dst, int n, int thresh) {
+    int defects = 0;
+    for (int i = 0; i < n; i++) {
+        int diff = abs(src[i] - ref[i]) - (tol ? tol[i] : 0);
+        int defect = diff > thresh;
+        dst[i] = defect ? 255 : 0;
+        defects += defect;
+    }
+    return defects;
+}
+
+// ============================================================
+// MEDIANA - REFERÊNCIA ESCALAR
+// ============================================================
+// Corpo comum às versões: ADD16/SUB16(acc, h) somam/subtraem 16 contagens
+// (um segmento do histograma) e FIND16(h, &rest) devolve o primeiro nível
+// cuja contagem acumulada passa de rest, descontando de rest as contagens
+// dos níveis anteriores. kc é o histograma grosso da janela,
+// atualizado a cada pixel; kf[b] (16 níveis do segmento b) vale para a
+// janela centrada em last[b] e só é atualizado quando a busca chega ao
+// segmento b: com as colunas que entraram e saíram desde last[b] ou, se
+// forem mais que as da janela, somando a janela de novo. Contagens por
+// janela <= (2·MEDIAN_MAX_RADIUS + 1)² cabem em 16 bits.
+
+#define MEDIAN_STALE (-(1 << 28))
+
+#define MEDIAN_ROW_TEMPLATE(SUFFIX, TARGET, ADD16, SUB16, FIND16)                  \
+TARGET                                                                              \
+void median_row_##SUFFIX(const uint16_t *fine, const uint16_t *coarse,              \
+                         unsigned char *dst, int width, int radius, int rows) {     \
+    uint16_t kc[16] __attribute__((aligned(32))) = {0};                             \
+    uint16_t kf[256] __attribute__((aligned(32)));                                  \
+    int last[16];                                                                   \
+    for (int b = 0; b < 16; b++) last[b] = MEDIAN_STALE;                            \
+    for (int j = 0; j <= MIN(radius, width - 1); j++) ADD16(kc, coarse + j * 16);   \
+                                                                                    \
+    for (int x = 0; x < width; x++) {                                               \
+        const int lo = MAX(0, x - radius), hi = MIN(width - 1, x + radius);         \
+        if (x > 0 && x + radius < width) ADD16(kc, coarse + (x + radius) * 16);     \
+        if (x > radius) SUB16(kc, coarse + (x - radius - 1) * 16);                  \
+                                                                                    \
+        /* Segmento grosso que contém a mediana */                                  \
+        int rest = (hi - lo + 1) * rows / 2;                                        \
+        const int b = FIND16(kc, &rest);                                            \
+                                                                                    \
+        uint16_t *seg = kf + b * 16;                                                \
+        const uint16_t *col = fine + (size_t)b * width * 16;                        \
+        if (2 * (x - last[b]) > hi - lo + 1) {                                      \
+            memset(seg, 0, 16 * sizeof(uint16_t));                                  \
+            for (int j = lo; j <= hi; j++) ADD16(seg, col + j * 16);                \
+        } else {                                                                    \
+            for (int k = last[b] + 1; k <= x; k++) {                                \
+                if (k + radius < width) ADD16(seg, col + (k + radius) * 16);        \
+                if (k > radius) SUB16(seg, col + (k - radius - 1) * 16);            \
+            }                                                                       \
+        }                                                                           \
+        last[b] = x;                                                                \
+                                                                                    \
+        dst[x] = (unsigned char)(b * 16 + FIND16(seg, &rest));                      \
+    }                                                                               \
+}
+
+static inline void hist16_add_scalar(uint16_t *acc, const uint16_t *h) {
+    for (int i = 0; i < 16; i++) acc[i] = (uint16_t)(acc[i] + h[i]);
+}
+
+static inline void hist16_sub_scalar(uint16_t *acc, const uint16_t *h) {
+    for (int i = 0; i < 16; i++) acc[i] = (uint16_t)(acc[i] - h[i]);
+}
+
+static inline int hist16_find_scalar(const uint16_t *h, int *rest) {
+    int i = 0;
+    while (h[i] <= *rest) *rest -= h[i++];
+    return i;
+}
+
+MEDIAN_ROW_TEMPLATE(scalar, , hist16_add_scalar, hist16_sub_scalar, hist16_find_scalar)
+
+// ============================================================
+// CONVERSÃO DE COR - REFERÊNCIA ESCALAR
+// ============================================================
+
+static inline int color_dot(const int16_t *w, int r, int g, int b) {
+    return (w[0] * r + w[1] * g + w[2] * b + (1 << 14)) >> 15;
+}
+
+static inline unsigned char color_signed8(int v) {
+    return (unsigned char)(MIN(MAX(v, -128), 127) + 128);
+}
+
+void color_matrix_row_scalar(const unsigned char *r, const unsigned char *g,
+                             const unsigned char *b, const int16_t *coef,
+                             unsigned char *dst0, unsigned char *dst1,
+                             unsigned char *dst2, int n) {
+    for (int i = 0; i < n; i++) {
+        dst0[i] = (unsigned char)MIN(MAX(color_dot(coef, r[i], g[i], b[i]), 0), 255);
+        dst1[i] = color_signed8(color_dot(coef + 3, r[i], g[i], b[i]));
+        dst2[i] = color_signed8(color_dot(coef + 6, r[i], g[i], b[i]));
+    }
+}
+
+// Matiz: setor do canal máximo (R, G, B nessa prioridade) e posição no
+// setor em sextos de volta × d, 0 <= num < 6d, arredondada para 256 passos
+// (perto do fim da volta arredonda para 256, que é 0)
+void hsv_row_scalar(const unsigned char *r, const unsigned char *g, const unsigned char *b,
+                    unsigned char *h, unsigned char *s, unsigned char *v, int n) {
+    for (int i = 0; i < n; i++) {
+        int mx = MAX(MAX(r[i], g[i]), b[i]);
+        int d = mx - MIN(MIN(r[i], g[i]), b[i]);
+        int num = mx == r[i] ? g[i] - b[i]
+                : mx == g[i] ? 2 * d + b[i] - r[i]
+                : 4 * d + r[i] - g[i];
+        if (num < 0) num += 6 * d;
+        h[i] = d ? (unsigned char)(((256 * num + 3 * d) / (6 * d)) & 255) : 0;
+        s[i] = mx ? (unsigned char)((255 * d + mx / 2) / mx) : 0;
+        v[i] = (unsigned char)mx;
+    }
+}
+
+// ============================================================
+// CLASSIFICAÇÃO DE COR - REFERÊNCIA ESCALAR
+// ============================================================
+
+static inline int class_lut_offset(int r, int g, int b) {
+    return ((r >> 2) << 12) | ((g >> 2) << 6) | (b >> 2);
+}
+
+void class_row_scalar(const unsigned char *r, const unsigned char *g, const unsigned char *b,
+                      const uint8_t *lut, unsigned char *dst, int n, int classes,
+                      uint32_t *counts) {
+    (void)classes;
+    for (int i = 0; i < n; i++) {
+        int id = lut[class_lut_offset(r[i], g[i], b[i])];
+        dst[i] = (unsigned char)(id * CLASS_LABEL_STEP);
+        counts[id]++;
+    }
+}
+
+// ============================================================
+// PLANAR - REFERÊNCIA ESCALAR
+// ============================================================
+
+void deinterleave_ga_scalar(const unsigned char *src, unsigned char *dst,
+                            size_t plane_stride, int n) {
+    unsigned char *a = dst + plane_stride;
+    for (int i = 0; i < n; i++, src += 2) {
+        dst[i] = src[0];
+        a[i] = src[1];
+    }
+}
+
+void deinterleave_rgb_scalar(const unsigned char *src, unsigned char *dst,
+                             size_t plane_stride, int n) {
+    unsigned char *r = dst, *g = dst + plane_stride, *b = dst + 2 * plane_stride;
+    for (int i = 0; i < n; i++, src += 3) {
+        r[i] = src[0];
+        g[i] = src[1];
+        b[i] = src[2];
+    }
+}
+
+void deinterleave_rgba_scalar(const unsigned char *src, unsigned char *dst,
+                              size_t plane_stride, int n) {
+    unsigned char *r = dst, *g = dst + plane_stride;
+    unsigned char *b = dst + 2 * plane_stride, *a = dst + 3 * plane_stride;
+    for (int i = 0; i < n; i++, src += 4) {
+        r[i] = src[0];
+        g[i] = src[1];
+        b[i] = src[2];
+        a[i] = src[3];
+    }
+}
+
+void interleave_ga_scalar(const unsigned char *src, size_t plane_stride,
+                          unsigned char *dst, int n) {
+    const unsigned char *a = src + plane_stride;
+    for (int i = 0; i < n; i++, dst += 2) {
+        dst[0] = src[i];
+        dst[1] = a[i];
+    }
+}
+
+void interleave_rgb_scalar(const unsigned char *src, size_t plane_stride,
+                           unsigned char *dst, int n) {
+    const unsigned char *r = src, *g = src + plane_stride, *b = src + 2 * plane_stride;
+    for (int i = 0; i < n; i++, dst += 3) {
+        dst[0] = r[i];
+        dst[1] = g[i];
+        dst[2] = b[i];
+    }
+}
+
+void interleave_rgba_scalar(const unsigned char *src, size_t plane_stride,
+                            unsigned char *dst, int n) {
+    const unsigned char *r = src, *g = src + plane_stride;
+    const unsigned char *b = src + 2 * plane_stride, *a = src + 3 * plane_stride;
+    for (int i = 0; i < n; i++, dst += 4) {
+        dst[0] = r[i];
+        dst[1] = g[i];
+        dst[2] = b[i];
+        dst[3] = a[i];
+    }
+}
+
+void deinterleave_scalar(const unsigned char *src, unsigned char *dst,
+                         size_t plane_stride, int n, int channels) {
+    for (int k = 0; k < channels; k++) {
+        unsigned char *plane = dst + (size_t)k * plane_stride;
+        for (int i = 0; i < n; i++) plane[i] = src[(size_t)i * channels + k];
+    }
+}
+
+void interleave_scalar(const unsigned char *src, size_t plane_stride,
+                       unsigned char *dst, int n, int channels) {
+    for (int k = 0; k < channels; k++) {
+        const unsigned char *plane = src + (size_t)k * plane_stride;
+        for (int i = 0; i < n; i++) dst[(size_t)i * channels + k] = plane[i];
+    }
+}
+
+#if FAVIS_X86
+
+// ============================================================
+// MÁSCARAS PSHUFB (deinterleave / reinterleave)
+// ============================================================
+
+// RGB: 16 pixels em 3 vetores de 16 bytes. MASK_<canal><vetor>
+// posiciona os bytes do canal vindos de cada vetor; -1 zera o byte.
+#define MASK_R0  0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+#define MASK_R1 -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1
+#define MASK_R2 -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13
+#define MASK_G0  1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+#define MASK_G1 -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1
+#define MASK_G2 -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14
+#define MASK_B0  2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+#define MASK_B1 -1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1
+#define MASK_B2 -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15
+
+// Replica cada byte de cinza nas 3 posições RGB de saída
+#define MASK_RGB_OUT0  0, 0, 0, 1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4, 4, 5
+#define MASK_RGB_OUT1  5, 5, 6, 6, 6, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10, 10
+#define MASK_RGB_OUT2 10, 11, 11, 11, 12, 12, 12, 13, 13, 13, 14, 14, 14, 15, 15, 15
+
+// RGBA: agrupa 4 pixels como [R0..R3 G0..G3 B0..B3 A0..A3]
+#define MASK_RGBA_GROUP 0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15
+
+// Replica cinza em RGB e zera a posição do alpha
+#define MASK_RGBA_OUT0  0, 0, 0, -1, 1, 1, 1, -1, 2, 2, 2, -1, 3, 3, 3, -1
+#define MASK_RGBA_OUT1  4, 4, 4, -1, 5, 5, 5, -1, 6, 6, 6, -1, 7, 7, 7, -1
+#define MASK_RGBA_OUT2  8, 8, 8, -1, 9, 9, 9, -1, 10, 10, 10, -1, 11, 11, 11, -1
+#define MASK_RGBA_OUT3 12, 12, 12, -1, 13, 13, 13, -1, 14, 14, 14, -1, 15, 15, 15, -1
+
+// Pares de pesos para pmaddwd: (R,G) e (B, arredondamento × 1)
+#define GRAY_PAIR_RG  ((GRAY_WEIGHT_G << 16) | GRAY_WEIGHT_R)
+#define GRAY_PAIR_B1  (((1 << (GRAY_SHIFT - 1)) << 16) | GRAY_WEIGHT_B)
+
+// ============================================================
+// GRAYSCALE - SSSE3 (16 pixels por iteração)
+// ============================================================
+
+// Calcula 4 pixels de luminância em 32 bits a partir de 4 canais em 16 bits
+TARGET_SSSE3
+static inline __m128i gray_quad_ssse3(__m128i rg, __m128i b1) {
+    const __m128i w_rg = _mm_set1_epi32(GRAY_PAIR_RG);
+    const __m128i w_b1 = _mm_set1_epi32(GRAY_PAIR_B1);
+    __m128i sum = _mm_add_epi32(_mm_madd_epi16(rg, w_rg), _mm_madd_epi16(b1, w_b1));
+    return _mm_srli_epi32(sum, GRAY_SHIFT);
+}
+
+// Combina 16 bytes de R, G e B em 16 bytes de cinza
+TARGET_SSSE3
+static inline __m128i gray_mix_ssse3(__m128i r, __m128i g, __m128i b) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+
+    __m128i r_lo = _mm_unpacklo_epi8(r, zero), r_hi = _mm_unpackhi_epi8(r, zero);
+    __m128i g_lo = _mm_unpacklo_epi8(g, zero), g_hi = _mm_unpackhi_epi8(g, zero);
+    __m128i b_lo = _mm_unpacklo_epi8(b, zero), b_hi = _mm_unpackhi_epi8(b, zero);
+
+    __m128i s0 = gray_quad_ssse3(_mm_unpacklo_epi16(r_lo, g_lo), _mm_unpacklo_epi16(b_lo, one));
+    __m128i s1 = gray_quad_ssse3(_mm_unpackhi_epi16(r_lo, g_lo), _mm_unpackhi_epi16(b_lo, one));
+    __m128i s2 = gray_quad_ssse3(_mm_unpacklo_epi16(r_hi, g_hi), _mm_unpacklo_epi16(b_hi, one));
+    __m128i s3 = gray_quad_ssse3(_mm_unpackhi_epi16(r_hi, g_hi), _mm_unpackhi_epi16(b_hi, one));
+
+    return _mm_packus_epi16(_mm_packs_epi32(s0, s1), _mm_packs_epi32(s2, s3));
+}
+
+TARGET_SSSE3
+void gray_row_rgb_ssse3(const unsigned char *src, unsigned char *dst, int n) {
+    int i = 0;
+    for (; i + 16 <= n; i += 16, src += 48, dst += 48) {
+        __m128i v0 = _mm_loadu_si128((const __m128i*)(src));
+        __m128i v1 = _mm_loadu_si128((const __m128i*)(src + 16));
+        __m128i v2 = _mm_loadu_si128((const __m128i*)(src + 32));
+
+        __m128i r = _mm_or_si128(_mm_or_si128(
+                        _mm_shuffle_epi8(v0, _mm_setr_epi8(MASK_R0)),
+                        _mm_shuffle_epi8(v1, _mm_setr_epi8(MASK_R1))),
+                        _mm_shuffle_epi8(v2, _mm_setr_epi8(MASK_R2)));
+        __m128i g = _mm_or_si128(_mm_or_si128(
+                        _mm_shuffle_epi8(v0, _mm_setr_epi8(MASK_G0)),
+                        _mm_shuffle_epi8(v1, _mm_setr_epi8(MASK_G1))),
+                        _mm_shuffle_epi8(v2, _mm_setr_epi8(MASK_G2)));
+        __m128i b = _mm_or_si128(_mm_or_si128(
+                        _mm_shuffle_epi8(v0, _mm_setr_epi8(MASK_B0)),
+                        _mm_shuffle_epi8(v1, _mm_setr_epi8(MASK_B1))),
+                        _mm_shuffle_epi8(v2, _mm_setr_epi8(MASK_B2)));
+
+        __m128i gray = gray_mix_ssse3(r, g, b);
+
+        _mm_storeu_si128((__m128i*)(dst),      _mm_shuffle_epi8(gray, _mm_setr_epi8(MASK_RGB_OUT0)));
+        _mm_storeu_si128((__m128i*)(dst + 16), _mm_shuffle_epi8(gray, _mm_setr_epi8(MASK_RGB_OUT1)));
+        _mm_storeu_si128((__m128i*)(dst + 32), _mm_shuffle_epi8(gray, _mm_setr_epi8(MASK_RGB_OUT2)));
+    }
+    gray_row_rgb_scalar(src, dst, n - i);
+}
+
+TARGET_SSSE3
+void gray_row_rgba_ssse3(const unsigned char *src, unsigned char *dst, int n) {
+    const __m128i group = _mm_setr_epi8(MASK_RGBA_GROUP);
+    const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+
+    int i = 0;
+    for (; i + 16 <= n; i += 16, src += 64, dst += 64) {
+        __m128i v0 = _mm_loadu_si128((const __m128i*)(src));
+        __m128i v1 = _mm_loadu_si128((const __m128i*)(src + 16));
+        __m128i v2 = _mm_loadu_si128((const __m128i*)(src + 32));
+        __m128i v3 = _mm_loadu_si128((const __m128i*)(src + 48));
+
+        // Transposição 4x4 de palavras de 32 bits: [RRRR GGGG BBBB AAAA] × 4
+        __m128i t0 = _mm_shuffle_epi8(v0, group);
+        __m128i t1 = _mm_shuffle_epi8(v1, group);
+        __m128i t2 = _mm_shuffle_epi8(v2, group);
+        __m128i t3 = _mm_shuffle_epi8(v3, group);
+        __m128i rg01 = _mm_unpacklo_epi32(t0, t1), ba01 = _mm_unpackhi_epi32(t0, t1);
+        __m128i rg23 = _mm_unpacklo_epi32(t2, t3), ba23 = _mm_unpackhi_epi32(t2, t3);
+
+        __m128i gray = gray_mix_ssse3(_mm_unpacklo_epi64(rg01, rg23),
+                                      _mm_unpackhi_epi64(rg01, rg23),
+                                      _mm_unpacklo_epi64(ba01, ba23));
+
+        _mm_storeu_si128((__m128i*)(dst), _mm_or_si128(
+            _mm_shuffle_epi8(gray, _mm_setr_epi8(MASK_RGBA_OUT0)), _mm_and_si128(v0, alpha)));
+        _mm_storeu_si128((__m128i*)(dst + 16), _mm_or_si128(
+            _mm_shuffle_epi8(gray, _mm_setr_epi8(MASK_RGBA_OUT1)), _mm_and_si128(v1, alpha)));
+        _mm_storeu_si128((__m128i*)(dst + 32), _mm_or_si128(
+            _mm_shuffle_epi8(gray, _mm_setr_epi8(MASK_RGBA_OUT2)), _mm_and_si128(v2, alpha)));
+        _mm_storeu_si128((__m128i*)(dst + 48), _mm_or_si128(
+            _mm_shuffle_epi8(gray, _mm_setr_epi8(MASK_RGBA_OUT3)), _mm_and_si128(v3, alpha)));
+    }
+    gray_row_rgba_scalar(src, dst, n - i);
+}
+
+// Deinterleave de 16 pixels RGB (48 bytes) em vetores R, G, B
+TARGET_SSSE3
+static inline __m128i gray_rgb16_ssse3(const unsigned char *src) {
+    __m128i v0 = _mm_loadu_si128((const __m128i*)(src));
+    __m128i v1 = _mm_loadu_si128((const __m128i*)(src + 16));
+    __m128i v2 = _mm_loadu_si128((const __m128i*)(src + 32));
+
+    __m128i r = _mm_or_si128(_mm_or_si128(
+                    _mm_shuffle_epi8(v0, _mm_setr_epi8(MASK_R0)),
+                    _mm_shuffle_epi8(v1, _mm_setr_epi8(MASK_R1))),
+                    _mm_shuffle_epi8(v2, _mm_setr_epi8(MASK_R2)));
+    __m128i g = _mm_or_si128(_mm_or_si128(
+                    _mm_shuffle_epi8(v0, _mm_setr_epi8(MASK_G0)),
+                    _mm_shuffle_epi8(v1, _mm_setr_epi8(MASK_G1))),
+                    _mm_shuffle_epi8(v2, _mm_setr_epi8(MASK_G2)));
+    __m128i b = _mm_or_si128(_mm_or_si128(
+                    _mm_shuffle_epi8(v0, _mm_setr_epi8(MASK_B0)),
+                    _mm_shuffle_epi8(v1, _mm_setr_epi8(MASK_B1))),
+                    _mm_shuffle_epi8(v2, _mm_setr_epi8(MASK_B2)));
+    return gray_mix_ssse3(r, g, b);
+}
+
+TARGET_SSSE3
+void gray_plane_rgb_ssse3(const unsigned char *src, unsigned char *dst, int n) {
+    int i = 0;
+    for (; i + 16 <= n; i += 16, src += 48) {
+        _mm_storeu_si128((__m128i*)(dst + i), gray_rgb16_ssse3(src));
+    }
+    gray_plane_rgb_scalar(src, dst + i, n - i);
+}
+
+TARGET_SSSE3
+void gray_plane_rgba_ssse3(const unsigned char *src, unsigned char *dst, int n) {
+    const __m128i group = _mm_setr_epi8(MASK_RGBA_GROUP);
+
+    int i = 0;
+    for (; i + 16 <= n; i += 16, src += 64) {
+        __m128i t0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src)), group);
+        __m128i t1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src + 16)), group);
+        __m128i t2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src + 32)), group);
+        __m128i t3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src + 48)), group);
+        __m128i rg01 = _mm_unpacklo_epi32(t0, t1), ba01 = _mm_unpackhi_epi32(t0, t1);
+        __m128i rg23 = _mm_unpacklo_epi32(t2, t3), ba23 = _mm_unpackhi_epi32(t2, t3);
+
+        __m128i gray = gray_mix_ssse3(_mm_unpacklo_epi64(rg01, rg23),
+                                      _mm_unpackhi_epi64(rg01, rg23),
+                                      _mm_unpacklo_epi64(ba01, ba23));
+        _mm_storeu_si128((__m128i*)(dst + i), gray);
+    }
+    gray_plane_rgba_scalar(src, dst + i, n - i);
+}
+
+// ============================================================
+// GRAYSCALE - AVX2 (32 pixels por iteração)
+// ============================================================
+// pshufb opera dentro de cada metade de 128 bits, então cada lane
+// processa 16 pixels consecutivos com as mesmas máscaras do SSSE3.
+
+#define MASK256(...) _mm256_setr_epi8(__VA_ARGS__, __VA_ARGS__)
+
+TARGET_AVX2
+static inline __m256i load_lanes_avx2(const unsigned char *lo, const unsigned char *hi) {
+    return _mm256_inserti128_si256(
+        _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)lo)),
+        _mm_loadu_si128((const __m128i*)hi), 1);
+}
+
+TARGET_AVX2
+static inline void store_lanes_avx2(unsigned char *lo, unsigned char *hi, __m256i v) {
+    _mm_storeu_si128((__m128i*)lo, _mm256_castsi256_si128(v));
+    _mm_storeu_si128((__m128i*)hi, _mm256_extracti128_si256(v, 1));
+}
+
+TARGET_AVX2
+static inline __m256i gray_quad_avx2(__m256i rg, __m256i b1) {
+    const __m256i w_rg = _mm256_set1_epi32(GRAY_PAIR_RG);
+    const __m256i w_b1 = _mm256_set1_epi32(GRAY_PAIR_B1);
+    __m256i sum = _mm256_add_epi32(_mm256_madd_epi16(rg, w_rg), _mm256_madd_epi16(b1, w_b1));
+    return _mm256_srli_epi32(sum, GRAY_SHIFT);
+}
+
+TARGET_AVX2
+static inline __m256i gray_mix_avx2(__m256i r, __m256i g, __m256i b) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi16(1);
+
+    __m256i r_lo = _mm256_unpacklo_epi8(r, zero), r_hi = _mm256_unpackhi_epi8(r, zero);
+    __m256i g_lo = _mm256_unpacklo_epi8(g, zero), g_hi = _mm256_unpackhi_epi8(g, zero);
+    __m256i b_lo = _mm256_unpacklo_epi8(b, zero), b_hi = _mm256_unpackhi_epi8(b, zero);
+
+    __m256i s0 = gray_quad_avx2(_mm256_unpacklo_epi16(r_lo, g_lo), _mm256_unpacklo_epi16(b_lo, one));
+    __m256i s1 = gray_quad_avx2(_mm256_unpackhi_epi16(r_lo, g_lo), _mm256_unpackhi_epi16(b_lo, one));
+    __m256i s2 = gray_quad_avx2(_mm256_unpacklo_epi16(r_hi, g_hi), _mm256_unpacklo_epi16(b_hi, one));
+    __m256i s3 = gray_quad_avx2(_mm256_unpackhi_epi16(r_hi, g_hi), _mm256_unpackhi_epi16(b_hi, one));
+
+    return _mm256_packus_epi16(_mm256_packs_epi32(s0, s1), _mm256_packs_epi32(s2, s3));
+}
+
+TARGET_AVX2
+void gray_row_rgb_avx2(const unsigned char *src, unsigned char *dst, int n) {
+    int i = 0;
+    for (; i + 32 <= n; i += 32, src += 96, dst += 96) {
+        // Lane 0: pixels 0-15 (bytes 0-47), lane 1: pixels 16-31 (bytes 48-95)
+        __m256i v0 = load_lanes_avx2(src,      src + 48);
+        __m256i v1 = load_lanes_avx2(src + 16, src + 64);
+        __m256i v2 = load_lanes_avx2(src + 32, src + 80);
+
+        __m256i r = _mm256_or_si256(_mm256_or_si256(
+                        _mm256_shuffle_epi8(v0, MASK256(MASK_R0)),
+                        _mm256_shuffle_epi8(v1, MASK256(MASK_R1))),
+                        _mm256_shuffle_epi8(v2, MASK256(MASK_R2)));
+        __m256i g = _mm256_or_si256(_mm256_or_si256(
+                        _mm256_shuffle_epi8(v0, MASK256(MASK_G0)),
+                        _mm256_shuffle_epi8(v1, MASK256(MASK_G1))),
+                        _mm256_shuffle_epi8(v2, MASK256(MASK_G2)));
+        __m256i b = _mm256_or_si256(_mm256_or_si256(
+                        _mm256_shuffle_epi8(v0, MASK256(MASK_B0)),
+                        _mm256_shuffle_epi8(v1, MASK256(MASK_B1))),
+                        _mm256_shuffle_epi8(v2, MASK256(MASK_B2)));
+
+        __m256i gray = gray_mix_avx2(r, g, b);
+
+        store_lanes_avx2(dst,      dst + 48, _mm256_shuffle_epi8(gray, MASK256(MASK_RGB_OUT0)));
+        store_lanes_avx2(dst + 16, dst + 64, _mm256_shuffle_epi8(gray, MASK256(MASK_RGB_OUT1)));
+        store_lanes_avx2(dst + 32, dst + 80, _mm256_shuffle_epi8(gray, MASK256(MASK_RGB_OUT2)));
+    }
+    gray_row_rgb_ssse3(src, dst, n - i);
+}
+
+TARGET_AVX2
+void gray_row_rgba_avx2(const unsigned char *src, unsigned char *dst, int n) {
+    const __m256i group = MASK256(MASK_RGBA_GROUP);
+    const __m256i alpha = _mm256_set1_epi32((int)0xFF000000);
+
+    int i = 0;
+    for (; i + 32 <= n; i += 32, src += 128, dst += 128) {
+        // Lane 0: pixels 0-15 (bytes 0-63), lane 1: pixels 16-31 (bytes 64-127)
+        __m256i v0 = load_lanes_avx2(src,      src + 64);
+        __m256i v1 = load_lanes_avx2(src + 16, src + 80);
+        __m256i v2 = load_lanes_avx2(src + 32, src + 96);
+        __m256i v3 = load_lanes_avx2(src + 48, src + 112);
+
+        __m256i t0 = _mm256_shuffle_epi8(v0, group);
+        __m256i t1 = _mm256_shuffle_epi8(v1, group);
+        __m256i t2 = _mm256_shuffle_epi8(v2, group);
+        __m256i t3 = _mm256_shuffle_epi8(v3, group);
+        __m256i rg01 = _mm256_unpacklo_epi32(t0, t1), ba01 = _mm256_unpackhi_epi32(t0, t1);
+        __m256i rg23 = _mm256_unpacklo_epi32(t2, t3), ba23 = _mm256_unpackhi_epi32(t2, t3);
+
+        __m256i gray = gray_mix_avx2(_mm256_unpacklo_epi64(rg01, rg23),
+                                     _mm256_unpackhi_epi64(rg01, rg23),
+                                     _mm256_unpacklo_epi64(ba01, ba23));
+
+        store_lanes_avx2(dst, dst + 64, _mm256_or_si256(
+            _mm256_shuffle_epi8(gray, MASK256(MASK_RGBA_OUT0)), _mm256_and_si256(v0, alpha)));
+        store_lanes_avx2(dst + 16, dst + 80, _mm256_or_si256(
+            _mm256_shuffle_epi8(gray, MASK256(MASK_RGBA_OUT1)), _mm256_and_si256(v1, alpha)));
+        store_lanes_avx2(dst + 32, dst + 96, _mm256_or_si256(
+            _mm256_shuffle_epi8(gray, MASK256(MASK_RGBA_OUT2)), _mm256_and_si256(v2, alpha)));
+        store_lanes_avx2(dst + 48, dst + 112, _mm256_or_si256(
+            _mm256_shuffle_epi8(gray, MASK256(MASK_RGBA_OUT3)), _mm256_and_si256(v3, alpha)));
+    }
+    gray_row_rgba_ssse3(src, dst, n - i);
+}
+
+TARGET_AVX2
+void gray_plane_rgb_avx2(const unsigned char *src, unsigned char *dst, int n) {
+    int i = 0;
+    for (; i + 32 <= n; i += 32, src += 96) {
+        __m256i v0 = load_lanes_avx2(src,      src + 48);
+        __m256i v1 = load_lanes_avx2(src + 16, src + 64);
+        __m256i v2 = load_lanes_avx2(src + 32, src + 80);
+
+        __m256i r = _mm256_or_si256(_mm256_or_si256(
+                        _mm256_shuffle_epi8(v0, MASK256(MASK_R0)),
+                        _mm256_shuffle_epi8(v1, MASK256(MASK_R1))),
+                        _mm256_shuffle_epi8(v2, MASK256(MASK_R2)));
+        __m256i g = _mm256_or_si256(_mm256_or_si256(
+                        _mm256_shuffle_epi8(v0, MASK256(MASK_G0)),
+                        _mm256_shuffle_epi8(v1, MASK256(MASK_G1))),
+                        _mm256_shuffle_epi8(v2, MASK256(MASK_G2)));
+        __m256i b = _mm256_or_si256(_mm256_or_si256(
+                        _mm256_shuffle_epi8(v0, MASK256(MASK_B0)),
+                        _mm256_shuffle_epi8(v1, MASK256(MASK_B1))),
+                        _mm256_shuffle_epi8(v2, MASK256(MASK_B2)));
+
+        // Lane 0 = pixels 0-15, lane 1 = pixels 16-31: já na ordem de saída
+        _mm256_storeu_si256((__m256i*)(dst + i), gray_mix_avx2(r, g, b));
+    }
+    gray_plane_rgb_ssse3(src, dst + i, n - i);
+}
+
+TARGET_AVX2
+void gray_plane_rgba_avx2(const unsigned char *src, unsigned char *dst, int n) {
+    const __m256i group = MASK256(MASK_RGBA_GROUP);
+
+    int i = 0;
+    for (; i + 32 <= n; i += 32, src += 128) {
+        __m256i t0 = _mm256_shuffle_epi8(load_lanes_avx2(src,      src + 64), group);
+        __m256i t1 = _mm256_shuffle_epi8(load_lanes_avx2(src + 16, src + 80), group);
+        __m256i t2 = _mm256_shuffle_epi8(load_lanes_avx2(src + 32, src + 96), group);
+        __m256i t3 = _mm256_shuffle_epi8(load_lanes_avx2(src + 48, src + 112), group);
+        __m256i rg01 = _mm256_unpacklo_epi32(t0, t1), ba01 = _mm256_unpackhi_epi32(t0, t1);
+        __m256i rg23 = _mm256_unpacklo_epi32(t2, t3), ba23 = _mm256_unpackhi_epi32(t2, t3);
+
+        __m256i gray = gray_mix_avx2(_mm256_unpacklo_epi64(rg01, rg23),
+                                     _mm256_unpackhi_epi64(rg01, rg23),
+                                     _mm256_unpacklo_epi64(ba01, ba23));
+        _mm256_storeu_si256((__m256i*)(dst + i), gray);
+    }
+    gray_plane_rgba_ssse3(src, dst + i, n - i);
+}
+
+// ============================================================
+// BOX BLUR - SSSE3 / AVX2
+// ============================================================
+
+TARGET_SSSE3
+void blur_addsub_row_ssse3(uint32_t *acc, const uint16_t *add, const uint16_t *sub, int n) {
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(add + i));
+        __m128i s = _mm_loadu_si128((const __m128i*)(sub + i));
+        __m128i acc_lo = _mm_loadu_si128((const __m128i*)(acc + i));
+        __m128i acc_hi = _mm_loadu_si128((const __m128i*)(acc + i + 4));
+        acc_lo = _mm_sub_epi32(_mm_add_epi32(acc_lo, _mm_unpacklo_epi16(a, zero)),
+                               _mm_unpacklo_epi16(s, zero));
+        acc_hi = _mm_sub_epi32(_mm_add_epi32(acc_hi, _mm_unpackhi_epi16(a, zero)),
+                               _mm_unpackhi_epi16(s, zero));
+        _mm_storeu_si128((__m128i*)(acc + i), acc_lo);
+        _mm_storeu_si128((__m128i*)(acc + i + 4), acc_hi);
+    }
+    blur_addsub_row_scalar(acc + i, add + i, sub + i, n - i);
+}
+
+// Divisão exata em float: numerador, quociente × área e resto abaixo de
+// 2^24 são representados sem erro. O produto pelo inverso erra o
+// quociente truncado em no máximo 1 perto de inteiros; o resto corrige
+TARGET_SSSE3
+static inline __m128i blur_div4_ssse3(__m128i acc, __m128i half, __m128 area, __m128 inv) {
+    const __m128 one = _mm_set1_ps(1.0f);
+    __m128 num = _mm_cvtepi32_ps(_mm_add_epi32(acc, half));
+    __m128 q = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_mul_ps(num, inv)));
+    __m128 rem = _mm_sub_ps(num, _mm_mul_ps(q, area));
+    q = _mm_add_ps(q, _mm_and_ps(_mm_cmpge_ps(rem, area), one));
+    q = _mm_sub_ps(q, _mm_and_ps(_mm_cmplt_ps(rem, _mm_setzero_ps()), one));
+    return _mm_cvttps_epi32(q);
+}
+
+TARGET_SSSE3
+void blur_scale_row_ssse3(const uint32_t *acc, unsigned char *dst, int n, uint32_t area) {
+    const __m128i half = _mm_set1_epi32((int)(area / 2));
+    const __m128 varea = _mm_set1_ps((float)area);
+    const __m128 inv = _mm_set1_ps(1.0f / (float)area);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i q[4];
+        for (int k = 0; k < 4; k++) {
+            q[k] = blur_div4_ssse3(_mm_loadu_si128((const __m128i*)(acc + i + 4 * k)),
+                                   half, varea, inv);
+        }
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(q[0], q[1]), _mm_packs_epi32(q[2], q[3]));
+        _mm_storeu_si128((__m128i*)(dst + i), packed);
+    }
+    blur_scale_row_scalar(acc + i, dst + i, n - i, area);
+}
+
+// Soma deslizante: diferenças entra/sai em int16, prefixo dentro do
+// registrador (log2 deslocamentos) e o último valor propagado ao próximo bloco
+TARGET_SSSE3
+static inline __m128i blur_hsum8_ssse3(const unsigned char *src, int span, __m128i carry) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i in = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(src + span)), zero);
+    __m128i out = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)src), zero);
+    __m128i d = _mm_sub_epi16(in, out);
+    d = _mm_add_epi16(d, _mm_slli_si128(d, 2));
+    d = _mm_add_epi16(d, _mm_slli_si128(d, 4));
+    d = _mm_add_epi16(d, _mm_slli_si128(d, 8));
+    return _mm_add_epi16(d, carry);
+}
+
+TARGET_SSSE3
+uint16_t blur_hsum_row_ssse3(const unsigned char *src, int span, uint16_t *dst,
+                             int n, uint16_t sum) {
+    const __m128i last = _mm_set1_epi16(0x0F0E);
+    __m128i carry = _mm_set1_epi16((short)sum);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i v = blur_hsum8_ssse3(src + i, span, carry);
+        _mm_storeu_si128((__m128i*)(dst + i), v);
+        carry = _mm_shuffle_epi8(v, last);
+    }
+    sum = (uint16_t)_mm_cvtsi128_si32(carry);
+    return blur_hsum_row_scalar(src + i, span, dst + i, n - i, sum);
+}
+
+TARGET_AVX2
+void blur_addsub_row_avx2(uint32_t *acc, const uint16_t *add, const uint16_t *sub, int n) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i a = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(add + i)));
+        __m256i s = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(sub + i)));
+        __m256i v = _mm256_loadu_si256((const __m256i*)(acc + i));
+        _mm256_storeu_si256((__m256i*)(acc + i), _mm256_sub_epi32(_mm256_add_epi32(v, a), s));
+    }
+    blur_addsub_row_scalar(acc + i, add + i, sub + i, n - i);
+}
+
+// Mesma divisão corrigida de blur_div4_ssse3, 8 colunas
+TARGET_AVX2
+static inline __m256i blur_div8_avx2(__m256i acc, __m256i half, __m256 area, __m256 inv) {
+    const __m256 one = _mm256_set1_ps(1.0f);
+    __m256 num = _mm256_cvtepi32_ps(_mm256_add_epi32(acc, half));
+    __m256 q = _mm256_cvtepi32_ps(_mm256_cvttps_epi32(_mm256_mul_ps(num, inv)));
+    __m256 rem = _mm256_sub_ps(num, _mm256_mul_ps(q, area));
+    q = _mm256_add_ps(q, _mm256_and_ps(_mm256_cmp_ps(rem, area, _CMP_GE_OQ), one));
+    q = _mm256_sub_ps(q, _mm256_and_ps(_mm256_cmp_ps(rem, _mm256_setzero_ps(), _CMP_LT_OQ), one));
+    return _mm256_cvttps_epi32(q);
+}
+
+TARGET_AVX2
+void blur_scale_row_avx2(const uint32_t *acc, unsigned char *dst, int n, uint32_t area) {
+    const __m256i half = _mm256_set1_epi32((int)(area / 2));
+    const __m256 varea = _mm256_set1_ps((float)area);
+    const __m256 inv = _mm256_set1_ps(1.0f / (float)area);
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i q[4];
+        for (int k = 0; k < 4; k++) {
+            q[k] = blur_div8_avx2(_mm256_loadu_si256((const __m256i*)(acc + i + 8 * k)),
+                                  half, varea, inv);
+        }
+        // packs/packus intercalam as lanes; a permutação final restaura a ordem
+        __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(q[0], q[1]),
+                                             _mm256_packs_epi32(q[2], q[3]));
+        packed = _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+        _mm256_storeu_si256((__m256i*)(dst + i), packed);
+    }
+    blur_scale_row_ssse3(acc + i, dst + i, n - i, area);
+}
+
+TARGET_AVX2
+uint16_t blur_hsum_row_avx2(const unsigned char *src, int span, uint16_t *dst,
+                            int n, uint16_t sum) {
+    const __m256i last = _mm256_set1_epi16(0x0706);
+    __m256i carry = _mm256_set1_epi16((short)sum);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i in = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(src + i + span)));
+        __m256i out = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(src + i)));
+        __m256i d = _mm256_sub_epi16(in, out);
+        d = _mm256_add_epi16(d, _mm256_slli_si256(d, 2));
+        d = _mm256_add_epi16(d, _mm256_slli_si256(d, 4));
+        d = _mm256_add_epi16(d, _mm256_slli_si256(d, 8));
+        // Total da lane baixa (elemento 7) somado à lane alta
+        __m256i low_total = _mm256_shuffle_epi8(d, _mm256_set1_epi16(0x0F0E));
+        d = _mm256_add_epi16(d, _mm256_permute2x128_si256(low_total, low_total, 0x08));
+        __m256i v = _mm256_add_epi16(d, carry);
+        _mm256_storeu_si256((__m256i*)(dst + i), v);
+        carry = _mm256_shuffle_epi8(_mm256_permute4x64_epi64(v, 0xFF), last);
+    }
+    sum = (uint16_t)_mm256_extract_epi16(carry, 0);
+    return blur_hsum_row_ssse3(src + i, span, dst + i, n - i, sum);
+}
+
+// ============================================================
+// RESIZE - SSSE3 / AVX2
+// ============================================================
+// Taps processados aos pares com pmaddwd: (a_i, b_i) · (w_a, w_b).
+// Número ímpar de taps usa uma linha nula com peso 0 no último par.
+
+#define WEIGHT_PAIR(wa, wb) ((int)((uint32_t)(uint16_t)(wb) << 16 | (uint16_t)(wa)))
+
+TARGET_SSSE3
+void resize_vert_row_ssse3(const unsigned char *const *rows, const int16_t *weights,
+                           int taps, int16_t *dst, int n) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi32(1 << (RESIZE_VERT_SHIFT - 1));
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i acc0 = round, acc1 = round, acc2 = round, acc3 = round;
+        for (int k = 0; k < taps; k += 2) {
+            __m128i a = _mm_loadu_si128((const __m128i*)(rows[k] + i));
+            __m128i b = zero;
+            __m128i wp;
+            if (k + 1 < taps) {
+                b = _mm_loadu_si128((const __m128i*)(rows[k + 1] + i));
+                wp = _mm_set1_epi32(WEIGHT_PAIR(weights[k], weights[k + 1]));
+            } else {
+                wp = _mm_set1_epi32(WEIGHT_PAIR(weights[k], 0));
+            }
+            __m128i a_lo = _mm_unpacklo_epi8(a, zero), a_hi = _mm_unpackhi_epi8(a, zero);
+            __m128i b_lo = _mm_unpacklo_epi8(b, zero), b_hi = _mm_unpackhi_epi8(b, zero);
+            acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_unpacklo_epi16(a_lo, b_lo), wp));
+            acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_unpackhi_epi16(a_lo, b_lo), wp));
+            acc2 = _mm_add_epi32(acc2, _mm_madd_epi16(_mm_unpacklo_epi16(a_hi, b_hi), wp));
+            acc3 = _mm_add_epi32(acc3, _mm_madd_epi16(_mm_unpackhi_epi16(a_hi, b_hi), wp));
+        }
+        acc0 = _mm_srai_epi32(acc0, RESIZE_VERT_SHIFT);
+        acc1 = _mm_srai_epi32(acc1, RESIZE_VERT_SHIFT);
+        acc2 = _mm_srai_epi32(acc2, RESIZE_VERT_SHIFT);
+        acc3 = _mm_srai_epi32(acc3, RESIZE_VERT_SHIFT);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(acc0, acc1));
+        _mm_storeu_si128((__m128i*)(dst + i + 8), _mm_packs_epi32(acc2, acc3));
+    }
+
+    // Cauda escalar
+    for (; i < n; i++) {
+        int acc = 1 << (RESIZE_VERT_SHIFT - 1);
+        for (int k = 0; k < taps; k++) acc += weights[k] * rows[k][i];
+        dst[i] = (int16_t)(acc >> RESIZE_VERT_SHIFT);
+    }
+}
+
+TARGET_AVX2
+void resize_vert_row_avx2(const unsigned char *const *rows, const int16_t *weights,
+                          int taps, int16_t *dst, int n) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i round = _mm256_set1_epi32(1 << (RESIZE_VERT_SHIFT - 1));
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        // unpacklo/hi por lane + packs por lane preservam a ordem natural
+        __m256i acc_lo = round, acc_hi = round;
+        for (int k = 0; k < taps; k += 2) {
+            __m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(rows[k] + i)));
+            __m256i b = zero;
+            __m256i wp;
+            if (k + 1 < taps) {
+                b = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(rows[k + 1] + i)));
+                wp = _mm256_set1_epi32(WEIGHT_PAIR(weights[k], weights[k + 1]));
+            } else {
+                wp = _mm256_set1_epi32(WEIGHT_PAIR(weights[k], 0));
+            }
+            acc_lo = _mm256_add_epi32(acc_lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), wp));
+            acc_hi = _mm256_add_epi32(acc_hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), wp));
+        }
+        acc_lo = _mm256_srai_epi32(acc_lo, RESIZE_VERT_SHIFT);
+        acc_hi = _mm256_srai_epi32(acc_hi, RESIZE_VERT_SHIFT);
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_packs_epi32(acc_lo, acc_hi));
+    }
+
+    for (; i < n; i++) {
+        int acc = 1 << (RESIZE_VERT_SHIFT - 1);
+        for (int k = 0; k < taps; k++) acc += weights[k] * rows[k][i];
+        dst[i] = (int16_t)(acc >> RESIZE_VERT_SHIFT);
+    }
+}
+
+// ============================================================
+// SOBEL - SSSE3 / AVX2
+// ============================================================
+
+// gx/gy de 8 pixels a partir das colunas esquerda (a), centro (m) e direita (c)
+#define SOBEL_GX(a0, c0, a1, c1, a2, c2, add, sub, sll) \
+    add(add(sub(c0, a0), sll(sub(c1, a1), 1)), sub(c2, a2))
+#define SOBEL_SMOOTH(a, m, c, add, sll) add(add(a, c), sll(m, 1))
+
+TARGET_SSSE3
+void sobel_row_ssse3(const unsigned char *r0, const unsigned char *r1,
+                     const unsigned char *r2, int16_t *gx, int16_t *gy, int n) {
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i a0 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(r0 + i)), zero);
+        __m128i m0 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(r0 + i + 1)), zero);
+        __m128i c0 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(r0 + i + 2)), zero);
+        __m128i a1 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(r1 + i)), zero);
+        __m128i c1 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(r1 + i + 2)), zero);
+        __m128i a2 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(r2 + i)), zero);
+        __m128i m2 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(r2 + i + 1)), zero);
+        __m128i c2 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(r2 + i + 2)), zero);
+
+        __m128i vx = SOBEL_GX(a0, c0, a1, c1, a2, c2, _mm_add_epi16, _mm_sub_epi16, _mm_slli_epi16);
+        __m128i vy = _mm_sub_epi16(SOBEL_SMOOTH(a2, m2, c2, _mm_add_epi16, _mm_slli_epi16),
+                                   SOBEL_SMOOTH(a0, m0, c0, _mm_add_epi16, _mm_slli_epi16));
+        _mm_storeu_si128((__m128i*)(gx + i), vx);
+        _mm_storeu_si128((__m128i*)(gy + i), vy);
+    }
+    sobel_row_scalar(r0 + i, r1 + i, r2 + i, gx + i, gy + i, n - i);
+}
+
+TARGET_SSSE3
+void sobel_mag_l1_ssse3(const int16_t *gx, const int16_t *gy, unsigned char *dst, int n) {
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i lo = _mm_add_epi16(_mm_abs_epi16(_mm_loadu_si128((const __m128i*)(gx + i))),
+                                   _mm_abs_epi16(_mm_loadu_si128((const __m128i*)(gy + i))));
+        __m128i hi = _mm_add_epi16(_mm_abs_epi16(_mm_loadu_si128((const __m128i*)(gx + i + 8))),
+                                   _mm_abs_epi16(_mm_loadu_si128((const __m128i*)(gy + i + 8))));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+    }
+    sobel_mag_l1_scalar(gx + i, gy + i, dst + i, n - i);
+}
+
+// sqrt(gx² + gy²) de 4 pixels: pmaddwd sobre pares (gx, gy) intercalados
+TARGET_SSSE3
+static inline __m128i sobel_l2_quad_ssse3(__m128i xy) {
+    __m128 f = _mm_sqrt_ps(_mm_cvtepi32_ps(_mm_madd_epi16(xy, xy)));
+    return _mm_cvttps_epi32(_mm_add_ps(f, _mm_set1_ps(0.5f)));
+}
+
+TARGET_SSSE3
+void sobel_mag_l2_ssse3(const int16_t *gx, const int16_t *gy, unsigned char *dst, int n) {
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i x0 = _mm_loadu_si128((const __m128i*)(gx + i));
+        __m128i y0 = _mm_loadu_si128((const __m128i*)(gy + i));
+        __m128i x1 = _mm_loadu_si128((const __m128i*)(gx + i + 8));
+        __m128i y1 = _mm_loadu_si128((const __m128i*)(gy + i + 8));
+        __m128i q0 = sobel_l2_quad_ssse3(_mm_unpacklo_epi16(x0, y0));
+        __m128i q1 = sobel_l2_quad_ssse3(_mm_unpackhi_epi16(x0, y0));
+        __m128i q2 = sobel_l2_quad_ssse3(_mm_unpacklo_epi16(x1, y1));
+        __m128i q3 = sobel_l2_quad_ssse3(_mm_unpackhi_epi16(x1, y1));
+        _mm_storeu_si128((__m128i*)(dst + i),
+                         _mm_packus_epi16(_mm_packs_epi32(q0, q1), _mm_packs_epi32(q2, q3)));
+    }
+    sobel_mag_l2_scalar(gx + i, gy + i, dst + i, n - i);
+}
+
+// Setor de 8 pixels em int16 (valores SOBEL_DIR_*)
+TARGET_SSSE3
+static inline __m128i sobel_dir_oct_ssse3(__m128i x, __m128i y) {
+    const __m128i tan = _mm_set1_epi16(SOBEL_TAN_22_5);
+    __m128i ax = _mm_abs_epi16(x), ay = _mm_abs_epi16(y);
+
+    // Máscaras: horizontal (ay <= ax·tan), vertical (ax <= ay·tan), sinais opostos
+    __m128i horiz = _mm_andnot_si128(_mm_cmpgt_epi16(ay, _mm_mulhrs_epi16(ax, tan)), _mm_set1_epi16(-1));
+    __m128i vert = _mm_andnot_si128(_mm_cmpgt_epi16(ax, _mm_mulhrs_epi16(ay, tan)), _mm_set1_epi16(-1));
+    __m128i opposite = _mm_srai_epi16(_mm_xor_si128(x, y), 15);
+
+    __m128i diag = _mm_or_si128(_mm_and_si128(opposite, _mm_set1_epi16(SOBEL_DIR_135)),
+                                _mm_andnot_si128(opposite, _mm_set1_epi16(SOBEL_DIR_45)));
+    __m128i code = _mm_or_si128(_mm_and_si128(vert, _mm_set1_epi16(SOBEL_DIR_90)),
+                                _mm_andnot_si128(vert, diag));
+    return _mm_andnot_si128(horiz, code);    // SOBEL_DIR_0 = 0
+}
+
+TARGET_SSSE3
+void sobel_dir_ssse3(const int16_t *gx, const int16_t *gy, unsigned char *dst, int n) {
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i lo = sobel_dir_oct_ssse3(_mm_loadu_si128((const __m128i*)(gx + i)),
+                                         _mm_loadu_si128((const __m128i*)(gy + i)));
+        __m128i hi = sobel_dir_oct_ssse3(_mm_loadu_si128((const __m128i*)(gx + i + 8)),
+                                         _mm_loadu_si128((const __m128i*)(gy + i + 8)));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+    }
+    sobel_dir_scalar(gx + i, gy + i, dst + i, n - i);
+}
+
+TARGET_AVX2
+static inline __m256i load_u8x16_avx2(const unsigned char *p) {
+    return _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)p));
+}
+
+TARGET_AVX2
+void sobel_row_avx2(const unsigned char *r0, const unsigned char *r1,
+                    const unsigned char *r2, int16_t *gx, int16_t *gy, int n) {
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i a0 = load_u8x16_avx2(r0 + i), m0 = load_u8x16_avx2(r0 + i + 1);
+        __m256i c0 = load_u8x16_avx2(r0 + i + 2);
+        __m256i a1 = load_u8x16_avx2(r1 + i), c1 = load_u8x16_avx2(r1 + i + 2);
+        __m256i a2 = load_u8x16_avx2(r2 + i), m2 = load_u8x16_avx2(r2 + i + 1);
+        __m256i c2 = load_u8x16_avx2(r2 + i + 2);
+
+        __m256i vx = SOBEL_GX(a0, c0, a1, c1, a2, c2,
+                              _mm256_add_epi16, _mm256_sub_epi16, _mm256_slli_epi16);
+        __m256i vy = _mm256_sub_epi16(SOBEL_SMOOTH(a2, m2, c2, _mm256_add_epi16, _mm256_slli_epi16),
+                                      SOBEL_SMOOTH(a0, m0, c0, _mm256_add_epi16, _mm256_slli_epi16));
+        _mm256_storeu_si256((__m256i*)(gx + i), vx);
+        _mm256_storeu_si256((__m256i*)(gy + i), vy);
+    }
+    sobel_row_ssse3(r0 + i, r1 + i, r2 + i, gx + i, gy + i, n - i);
+}
+
+// packus em 256 bits intercala as lanes; 0xD8 restaura a ordem dos pixels
+#define PACKUS_ORDERED_AVX2(lo, hi) _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xD8)
+
+TARGET_AVX2
+void sobel_mag_l1_avx2(const int16_t *gx, const int16_t *gy, unsigned char *dst, int n) {
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i lo = _mm256_add_epi16(_mm256_abs_epi16(_mm256_loadu_si256((const __m256i*)(gx + i))),
+                                      _mm256_abs_epi16(_mm256_loadu_si256((const __m256i*)(gy + i))));
+        __m256i hi = _mm256_add_epi16(_mm256_abs_epi16(_mm256_loadu_si256((const __m256i*)(gx + i + 16))),
+                                      _mm256_abs_epi16(_mm256_loadu_si256((const __m256i*)(gy + i + 16))));
+        _mm256_storeu_si256((__m256i*)(dst + i), PACKUS_ORDERED_AVX2(lo, hi));
+    }
+    sobel_mag_l1_ssse3(gx + i, gy + i, dst + i, n - i);
+}
+
+TARGET_AVX2
+static inline __m256i sobel_l2_oct_avx2(__m256i xy) {
+    __m256 f = _mm256_sqrt_ps(_mm256_cvtepi32_ps(_mm256_madd_epi16(xy, xy)));
+    return _mm256_cvttps_epi32(_mm256_add_ps(f, _mm256_set1_ps(0.5f)));
+}
+
+TARGET_AVX2
+void sobel_mag_l2_avx2(const int16_t *gx, const int16_t *gy, unsigned char *dst, int n) {
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i x0 = _mm256_loadu_si256((const __m256i*)(gx + i));
+        __m256i y0 = _mm256_loadu_si256((const __m256i*)(gy + i));
+        __m256i x1 = _mm256_loadu_si256((const __m256i*)(gx + i + 16));
+        __m256i y1 = _mm256_loadu_si256((const __m256i*)(gy + i + 16));
+        // unpack/packs por lane se anulam: cada metade de 16 bits volta à ordem natural
+        __m256i lo = _mm256_packs_epi32(sobel_l2_oct_avx2(_mm256_unpacklo_epi16(x0, y0)),
+                                        sobel_l2_oct_avx2(_mm256_unpackhi_epi16(x0, y0)));
+        __m256i hi = _mm256_packs_epi32(sobel_l2_oct_avx2(_mm256_unpacklo_epi16(x1, y1)),
+                                        sobel_l2_oct_avx2(_mm256_unpackhi_epi16(x1, y1)));
+        _mm256_storeu_si256((__m256i*)(dst + i), PACKUS_ORDERED_AVX2(lo, hi));
+    }
+    sobel_mag_l2_ssse3(gx + i, gy + i, dst + i, n - i);
+}
+
+TARGET_AVX2
+static inline __m256i sobel_dir_hex_avx2(__m256i x, __m256i y) {
+    const __m256i tan = _mm256_set1_epi16(SOBEL_TAN_22_5);
+    const __m256i ones = _mm256_set1_epi16(-1);
+    __m256i ax = _mm256_abs_epi16(x), ay = _mm256_abs_epi16(y);
+
+    __m256i horiz = _mm256_xor_si256(_mm256_cmpgt_epi16(ay, _mm256_mulhrs_epi16(ax, tan)), ones);
+    __m256i vert = _mm256_xor_si256(_mm256_cmpgt_epi16(ax, _mm256_mulhrs_epi16(ay, tan)), ones);
+    __m256i opposite = _mm256_srai_epi16(_mm256_xor_si256(x, y), 15);
+
+    __m256i diag = _mm256_blendv_epi8(_mm256_set1_epi16(SOBEL_DIR_45),
+                                      _mm256_set1_epi16(SOBEL_DIR_135), opposite);
+    __m256i code = _mm256_blendv_epi8(diag, _mm256_set1_epi16(SOBEL_DIR_90), vert);
+    return _mm256_andnot_si256(horiz, code);
+}
+
+TARGET_AVX2
+void sobel_dir_avx2(const int16_t *gx, const int16_t *gy, unsigned char *dst, int n) {
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i lo = sobel_dir_hex_avx2(_mm256_loadu_si256((const __m256i*)(gx + i)),
+                                        _mm256_loadu_si256((const __m256i*)(gy + i)));
+        __m256i hi = sobel_dir_hex_avx2(_mm256_loadu_si256((const __m256i*)(gx + i + 16)),
+                                        _mm256_loadu_si256((const __m256i*)(gy + i + 16)));
+        _mm256_storeu_si256((__m256i*)(dst + i), PACKUS_ORDERED_AVX2(lo, hi));
+    }
+    sobel_dir_ssse3(gx + i, gy + i, dst + i, n - i);
+}
+
+// ============================================================
+// CANNY - SSSE3 / AVX2
+// ============================================================
+
+TARGET_SSSE3
+void gauss5_vert_row_ssse3(const unsigned char *r0, const unsigned char *r1,
+                           const unsigned char *r2, const unsigned char *r3,
+                           const unsigned char *r4, uint16_t *dst, int n) {
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(r0 + i)), zero);
+        __m128i b = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(r1 + i)), zero);
+        __m128i c = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(r2 + i)), zero);
+        __m128i d = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(r3 + i)), zero);
+        __m128i e = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(r4 + i)), zero);
+        // a + e + 4(b + d) + 6c = a + e + 4(b + c + d) + 2c
+        __m128i v = _mm_add_epi16(_mm_add_epi16(a, e),
+                                  _mm_add_epi16(_mm_slli_epi16(_mm_add_epi16(_mm_add_epi16(b, c), d), 2),
+                                                _mm_slli_epi16(c, 1)));
+        _mm_storeu_si128((__m128i*)(dst + i), v);
+    }
+    gauss5_vert_row_scalar(r0 + i, r1 + i, r2 + i, r3 + i, r4 + i, dst + i, n - i);
+}
+
+TARGET_SSSE3
+void gauss5_horiz_row_ssse3(const uint16_t *src, unsigned char *dst, int n) {
+    const __m128i round = _mm_set1_epi16(1 << (GAUSS5_SHIFT - 1));
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i out[2];
+        for (int k = 0; k < 2; k++) {
+            const uint16_t *s = src + i + 8 * k;
+            __m128i a = _mm_loadu_si128((const __m128i*)(s));
+            __m128i b = _mm_loadu_si128((const __m128i*)(s + 1));
+            __m128i c = _mm_loadu_si128((const __m128i*)(s + 2));
+            __m128i d = _mm_loadu_si128((const __m128i*)(s + 3));
+            __m128i e = _mm_loadu_si128((const __m128i*)(s + 4));
+            // Soma <= 16 × 4080 = 65280: cabe em uint16 sem saturação
+            __m128i v = _mm_add_epi16(_mm_add_epi16(a, e),
+                                      _mm_add_epi16(_mm_slli_epi16(_mm_add_epi16(_mm_add_epi16(b, c), d), 2),
+                                                    _mm_slli_epi16(c, 1)));
+            out[k] = _mm_srli_epi16(_mm_add_epi16(v, round), GAUSS5_SHIFT);
+        }
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(out[0], out[1]));
+    }
+    gauss5_horiz_row_scalar(src + i, dst + i, n - i);
+}
+
+TARGET_SSSE3
+void grad_mag16_row_ssse3(const int16_t *gx, const int16_t *gy, int16_t *dst, int n) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i v = _mm_add_epi16(_mm_abs_epi16(_mm_loadu_si128((const __m128i*)(gx + i))),
+                                  _mm_abs_epi16(_mm_loadu_si128((const __m128i*)(gy + i))));
+        _mm_storeu_si128((__m128i*)(dst + i), v);
+    }
+    grad_mag16_row_scalar(gx + i, gy + i, dst + i, n - i);
+}
+
+// Seleciona por setor (máscaras disjuntas, uma por direção)
+#define NMS_SELECT(and_, or_, d0, d45, d90, d135, v0, v45, v90, v135) \
+    or_(or_(and_(d0, v0), and_(d45, v45)), or_(and_(d90, v90), and_(d135, v135)))
+
+TARGET_SSSE3
+void canny_nms_row_ssse3(const int16_t *m0, const int16_t *m1, const int16_t *m2,
+                         const unsigned char *dir, unsigned char *dst, int n,
+                         int low, int high) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i vlow = _mm_set1_epi16((short)low);
+    const __m128i vhigh = _mm_set1_epi16((short)high);
+    const __m128i weak = _mm_set1_epi16(CANNY_WEAK);
+    const __m128i strong = _mm_set1_epi16(CANNY_STRONG);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i out[2];
+        for (int k = 0; k < 2; k++) {
+            int j = i + 8 * k;
+            __m128i m = _mm_loadu_si128((const __m128i*)(m1 + j + 1));
+            __m128i d = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(dir + j)), zero);
+            __m128i d0 = _mm_cmpeq_epi16(d, _mm_set1_epi16(SOBEL_DIR_0));
+            __m128i d45 = _mm_cmpeq_epi16(d, _mm_set1_epi16(SOBEL_DIR_45));
+            __m128i d90 = _mm_cmpeq_epi16(d, _mm_set1_epi16(SOBEL_DIR_90));
+            __m128i d135 = _mm_cmpeq_epi16(d, _mm_set1_epi16(SOBEL_DIR_135));
+
+            __m128i a = NMS_SELECT(_mm_and_si128, _mm_or_si128, d0, d45, d90, d135,
+                                   _mm_loadu_si128((const __m128i*)(m1 + j)),
+                                   _mm_loadu_si128((const __m128i*)(m0 + j)),
+                                   _mm_loadu_si128((const __m128i*)(m0 + j + 1)),
+                                   _mm_loadu_si128((const __m128i*)(m0 + j + 2)));
+            __m128i b = NMS_SELECT(_mm_and_si128, _mm_or_si128, d0, d45, d90, d135,
+                                   _mm_loadu_si128((const __m128i*)(m1 + j + 2)),
+                                   _mm_loadu_si128((const __m128i*)(m2 + j + 2)),
+                                   _mm_loadu_si128((const __m128i*)(m2 + j + 1)),
+                                   _mm_loadu_si128((const __m128i*)(m2 + j)));
+
+            // m > low && m > a && !(b > m)
+            __m128i keep = _mm_andnot_si128(_mm_cmpgt_epi16(b, m),
+                                            _mm_and_si128(_mm_cmpgt_epi16(m, vlow),
+                                                          _mm_cmpgt_epi16(m, a)));
+            __m128i is_strong = _mm_cmpgt_epi16(m, vhigh);
+            __m128i cls = _mm_or_si128(_mm_and_si128(is_strong, strong), _mm_andnot_si128(is_strong, weak));
+            out[k] = _mm_and_si128(keep, cls);
+        }
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(out[0], out[1]));
+    }
+    canny_nms_row_scalar(m0 + i, m1 + i, m2 + i, dir + i, dst + i, n - i, low, high);
+}
+
+TARGET_AVX2
+void gauss5_vert_row_avx2(const unsigned char *r0, const unsigned char *r1,
+                          const unsigned char *r2, const unsigned char *r3,
+                          const unsigned char *r4, uint16_t *dst, int n) {
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i a = load_u8x16_avx2(r0 + i), b = load_u8x16_avx2(r1 + i);
+        __m256i c = load_u8x16_avx2(r2 + i), d = load_u8x16_avx2(r3 + i);
+        __m256i e = load_u8x16_avx2(r4 + i);
+        __m256i v = _mm256_add_epi16(_mm256_add_epi16(a, e),
+                                     _mm256_add_epi16(_mm256_slli_epi16(_mm256_add_epi16(_mm256_add_epi16(b, c), d), 2),
+                                                      _mm256_slli_epi16(c, 1)));
+        _mm256_storeu_si256((__m256i*)(dst + i), v);
+    }
+    gauss5_vert_row_ssse3(r0 + i, r1 + i, r2 + i, r3 + i, r4 + i, dst + i, n - i);
+}
+
+TARGET_AVX2
+void gauss5_horiz_row_avx2(const uint16_t *src, unsigned char *dst, int n) {
+    const __m256i round = _mm256_set1_epi16(1 << (GAUSS5_SHIFT - 1));
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i out[2];
+        for (int k = 0; k < 2; k++) {
+            const uint16_t *s = src + i + 16 * k;
+            __m256i a = _mm256_loadu_si256((const __m256i*)(s));
+            __m256i b = _mm256_loadu_si256((const __m256i*)(s + 1));
+            __m256i c = _mm256_loadu_si256((const __m256i*)(s + 2));
+            __m256i d = _mm256_loadu_si256((const __m256i*)(s + 3));
+            __m256i e = _mm256_loadu_si256((const __m256i*)(s + 4));
+            __m256i v = _mm256_add_epi16(_mm256_add_epi16(a, e),
+                                         _mm256_add_epi16(_mm256_slli_epi16(_mm256_add_epi16(_mm256_add_epi16(b, c), d), 2),
+                                                          _mm256_slli_epi16(c, 1)));
+            out[k] = _mm256_srli_epi16(_mm256_add_epi16(v, round), GAUSS5_SHIFT);
+        }
+        _mm256_storeu_si256((__m256i*)(dst + i), PACKUS_ORDERED_AVX2(out[0], out[1]));
+    }
+    gauss5_horiz_row_ssse3(src + i, dst + i, n - i);
+}
+
+TARGET_AVX2
+void grad_mag16_row_avx2(const int16_t *gx, const int16_t *gy, int16_t *dst, int n) {
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i v = _mm256_add_epi16(_mm256_abs_epi16(_mm256_loadu_si256((const __m256i*)(gx + i))),
+                                     _mm256_abs_epi16(_mm256_loadu_si256((const __m256i*)(gy + i))));
+        _mm256_storeu_si256((__m256i*)(dst + i), v);
+    }
+    grad_mag16_row_ssse3(gx + i, gy + i, dst + i, n - i);
+}
+
+TARGET_AVX2
+void canny_nms_row_avx2(const int16_t *m0, const int16_t *m1, const int16_t *m2,
+                        const unsigned char *dir, unsigned char *dst, int n,
+                        int low, int high) {
+    const __m256i vlow = _mm256_set1_epi16((short)low);
+    const __m256i vhigh = _mm256_set1_epi16((short)high);
+    const __m256i weak = _mm256_set1_epi16(CANNY_WEAK);
+    const __m256i strong = _mm256_set1_epi16(CANNY_STRONG);
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i out[2];
+        for (int k = 0; k < 2; k++) {
+            int j = i + 16 * k;
+            __m256i m = _mm256_loadu_si256((const __m256i*)(m1 + j + 1));
+            __m256i d = load_u8x16_avx2(dir + j);
+            __m256i d0 = _mm256_cmpeq_epi16(d, _mm256_set1_epi16(SOBEL_DIR_0));
+            __m256i d45 = _mm256_cmpeq_epi16(d, _mm256_set1_epi16(SOBEL_DIR_45));
+            __m256i d90 = _mm256_cmpeq_epi16(d, _mm256_set1_epi16(SOBEL_DIR_90));
+            __m256i d135 = _mm256_cmpeq_epi16(d, _mm256_set1_epi16(SOBEL_DIR_135));
+
+            __m256i a = NMS_SELECT(_mm256_and_si256, _mm256_or_si256, d0, d45, d90, d135,
+                                   _mm256_loadu_si256((const __m256i*)(m1 + j)),
+                                   _mm256_loadu_si256((const __m256i*)(m0 + j)),
+                                   _mm256_loadu_si256((const __m256i*)(m0 + j + 1)),
+                                   _mm256_loadu_si256((const __m256i*)(m0 + j + 2)));
+            __m256i b = NMS_SELECT(_mm256_and_si256, _mm256_or_si256, d0, d45, d90, d135,
+                                   _mm256_loadu_si256((const __m256i*)(m1 + j + 2)),
+                                   _mm256_loadu_si256((const __m256i*)(m2 + j + 2)),
+                                   _mm256_loadu_si256((const __m256i*)(m2 + j + 1)),
+                                   _mm256_loadu_si256((const __m256i*)(m2 + j)));
+
+            __m256i keep = _mm256_andnot_si256(_mm256_cmpgt_epi16(b, m),
+                                               _mm256_and_si256(_mm256_cmpgt_epi16(m, vlow),
+                                                                _mm256_cmpgt_epi16(m, a)));
+            __m256i cls = _mm256_blendv_epi8(weak, strong, _mm256_cmpgt_epi16(m, vhigh));
+            out[k] = _mm256_and_si256(keep, cls);
+        }
+        _mm256_storeu_si256((__m256i*)(dst + i), PACKUS_ORDERED_AVX2(out[0], out[1]));
+    }
+    canny_nms_row_ssse3(m0 + i, m1 + i, m2 + i, dir + i, dst + i, n - i, low, high);
+}
+
+// ============================================================
+// MORFOLOGIA - SSSE3 / AVX2
+// ============================================================
+
+TARGET_SSSE3
+void morph_min_row_ssse3(const unsigned char *a, const unsigned char *b, unsigned char *dst, int n) {
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_min_epu8(_mm_loadu_si128((const __m128i*)(a + i)),
+                                 _mm_loadu_si128((const __m128i*)(b + i)));
+        _mm_storeu_si128((__m128i*)(dst + i), v);
+    }
+    morph_min_row_scalar(a + i, b + i, dst + i, n - i);
+}
+
+TARGET_SSSE3
+void morph_max_row_ssse3(const unsigned char *a, const unsigned char *b, unsigned char *dst, int n) {
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_max_epu8(_mm_loadu_si128((const __m128i*)(a + i)),
+                                 _mm_loadu_si128((const __m128i*)(b + i)));
+        _mm_storeu_si128((__m128i*)(dst + i), v);
+    }
+    morph_max_row_scalar(a + i, b + i, dst + i, n - i);
+}
+
+// Transposição 16x16: quatro rodadas de intercalação das linhas i e i+8.
+// Cada rodada rotaciona de 1 bit o índice (linha:coluna) de 8 bits;
+// após quatro, linha e coluna trocaram de lugar.
+TARGET_SSSE3
+void transpose_u8_ssse3(const unsigned char *src, size_t src_stride,
+                        unsigned char *dst, size_t dst_stride, int rows, int cols) {
+    int r = 0;
+    for (; r + 16 <= rows; r += 16) {
+        int c = 0;
+        for (; c + 16 <= cols; c += 16) {
+            __m128i v[16], t[16];
+            for (int i = 0; i < 16; i++) {
+                v[i] = _mm_loadu_si128((const __m128i*)(src + (r + i) * src_stride + c));
+            }
+            for (int round = 0; round < 4; round++) {
+                for (int i = 0; i < 8; i++) {
+                    t[2 * i] = _mm_unpacklo_epi8(v[i], v[i + 8]);
+                    t[2 * i + 1] = _mm_unpackhi_epi8(v[i], v[i + 8]);
+                }
+                memcpy(v, t, sizeof(v));
+            }
+            for (int i = 0; i < 16; i++) {
+                _mm_storeu_si128((__m128i*)(dst + (c + i) * dst_stride + r), v[i]);
+            }
+        }
+        transpose_u8_scalar(src + r * src_stride + c, src_stride,
+                            dst + c * dst_stride + r, dst_stride, 16, cols - c);
+    }
+    transpose_u8_scalar(src + r * src_stride, src_stride, dst + r, dst_stride, rows - r, cols);
+}
+
+TARGET_AVX2
+void morph_min_row_avx2(const unsigned char *a, const unsigned char *b, unsigned char *dst, int n) {
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_min_epu8(_mm256_loadu_si256((const __m256i*)(a + i)),
+                                    _mm256_loadu_si256((const __m256i*)(b + i)));
+        _mm256_storeu_si256((__m256i*)(dst + i), v);
+    }
+    morph_min_row_ssse3(a + i, b + i, dst + i, n - i);
+}
+
+TARGET_AVX2
+void morph_max_row_avx2(const unsigned char *a, const unsigned char *b, unsigned char *dst, int n) {
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_max_epu8(_mm256_loadu_si256((const __m256i*)(a + i)),
+                                    _mm256_loadu_si256((const __m256i*)(b + i)));
+        _mm256_storeu_si256((__m256i*)(dst + i), v);
+    }
+    morph_max_row_ssse3(a + i, b + i, dst + i, n - i);
+}
+
+// ============================================================
+// IMAGEM INTEGRAL - SSSE3 / AVX2
+// ============================================================
+// Prefixo dentro do registrador por deslocamentos (log2 passos); o
+// acumulado da linha é propagado como o último elemento replicado.
+
+TARGET_SSSE3
+void integral_row_ssse3(const unsigned char *src, const uint32_t *prev, uint32_t *dst, int n) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i carry = zero;
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i b = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i w16[2] = { _mm_unpacklo_epi8(b, zero), _mm_unpackhi_epi8(b, zero) };
+        for (int q = 0; q < 4; q++) {
+            __m128i v = (q & 1) ? _mm_unpackhi_epi16(w16[q >> 1], zero)
+                                : _mm_unpacklo_epi16(w16[q >> 1], zero);
+            v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+            v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+            v = _mm_add_epi32(v, carry);
+            carry = _mm_shuffle_epi32(v, 0xFF);
+            __m128i p = _mm_loadu_si128((const __m128i*)(prev + i + 4 * q));
+            _mm_storeu_si128((__m128i*)(dst + i + 4 * q), _mm_add_epi32(v, p));
+        }
+    }
+    integral_row_tail(src, prev, dst, i, n, (uint32_t)_mm_cvtsi128_si32(carry));
+}
+
+TARGET_SSSE3
+void integral_sq_row_ssse3(const unsigned char *src, const uint64_t *prev, uint64_t *dst, int n) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i carry = zero;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        // x² <= 65025 cabe em uint16
+        __m128i w = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(src + i)), zero);
+        __m128i sq = _mm_mullo_epi16(w, w);
+        __m128i d[2] = { _mm_unpacklo_epi16(sq, zero), _mm_unpackhi_epi16(sq, zero) };
+        for (int q = 0; q < 4; q++) {
+            __m128i v = (q & 1) ? _mm_unpackhi_epi32(d[q >> 1], zero)
+                                : _mm_unpacklo_epi32(d[q >> 1], zero);
+            v = _mm_add_epi64(v, _mm_slli_si128(v, 8));
+            v = _mm_add_epi64(v, carry);
+            carry = _mm_shuffle_epi32(v, 0xEE);
+            __m128i p = _mm_loadu_si128((const __m128i*)(prev + i + 2 * q));
+            _mm_storeu_si128((__m128i*)(dst + i + 2 * q), _mm_add_epi64(v, p));
+        }
+    }
+    uint64_t run;
+    _mm_storel_epi64((__m128i*)&run, carry);
+    integral_sq_row_tail(src, prev, dst, i, n, run);
+}
+
+TARGET_SSSE3
+void box_sum_row_ssse3(const uint32_t *top, const uint32_t *bot, uint32_t *dst, int n, int span) {
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i a = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(bot + i + span)),
+                                  _mm_loadu_si128((const __m128i*)(bot + i)));
+        __m128i b = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(top + i + span)),
+                                  _mm_loadu_si128((const __m128i*)(top + i)));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_sub_epi32(a, b));
+    }
+    box_sum_row_scalar(top + i, bot + i, dst + i, n - i, span);
+}
+
+TARGET_AVX2
+void integral_row_avx2(const unsigned char *src, const uint32_t *prev, uint32_t *dst, int n) {
+    const __m256i last = _mm256_set1_epi32(7);
+    __m256i carry = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i b = _mm_loadu_si128((const __m128i*)(src + i));
+        for (int q = 0; q < 2; q++) {
+            __m256i v = _mm256_cvtepu8_epi32(q ? _mm_srli_si128(b, 8) : b);
+            v = _mm256_add_epi32(v, _mm256_slli_si256(v, 4));
+            v = _mm256_add_epi32(v, _mm256_slli_si256(v, 8));
+            // Total da metade baixa somado à metade alta
+            __m256i lo = _mm256_shuffle_epi32(v, 0xFF);
+            v = _mm256_add_epi32(v, _mm256_permute2x128_si256(lo, lo, 0x08));
+            v = _mm256_add_epi32(v, carry);
+            carry = _mm256_permutevar8x32_epi32(v, last);
+            __m256i p = _mm256_loadu_si256((const __m256i*)(prev + i + 8 * q));
+            _mm256_storeu_si256((__m256i*)(dst + i + 8 * q), _mm256_add_epi32(v, p));
+        }
+    }
+    integral_row_tail(src, prev, dst, i, n, (uint32_t)_mm256_cvtsi256_si32(carry));
+}
+
+TARGET_AVX2
+void integral_sq_row_avx2(const unsigned char *src, const uint64_t *prev, uint64_t *dst, int n) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i carry = zero;
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i w = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(src + i)));
+        __m256i sq = _mm256_mullo_epi16(w, w);
+        __m128i half[2] = { _mm256_castsi256_si128(sq), _mm256_extracti128_si256(sq, 1) };
+        for (int q = 0; q < 4; q++) {
+            __m128i h = half[q >> 1];
+            __m256i v = _mm256_cvtepu16_epi64((q & 1) ? _mm_srli_si128(h, 8) : h);
+            v = _mm256_add_epi64(v, _mm256_slli_si256(v, 8));
+            __m256i lo = _mm256_permute4x64_epi64(v, 0x50);
+            v = _mm256_add_epi64(v, _mm256_blend_epi32(lo, zero, 0x0F));
+            v = _mm256_add_epi64(v, carry);
+            carry = _mm256_permute4x64_epi64(v, 0xFF);
+            __m256i p = _mm256_loadu_si256((const __m256i*)(prev + i + 4 * q));
+            _mm256_storeu_si256((__m256i*)(dst + i + 4 * q), _mm256_add_epi64(v, p));
+        }
+    }
+    uint64_t run = (uint64_t)_mm256_extract_epi64(carry, 0);
+    integral_sq_row_tail(src, prev, dst, i, n, run);
+}
+
+TARGET_AVX2
+void box_sum_row_avx2(const uint32_t *top, const uint32_t *bot, uint32_t *dst, int n, int span) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i a = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i*)(bot + i + span)),
+                                     _mm256_loadu_si256((const __m256i*)(bot + i)));
+        __m256i b = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i*)(top + i + span)),
+                                     _mm256_loadu_si256((const __m256i*)(top + i)));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_sub_epi32(a, b));
+    }
+    box_sum_row_ssse3(top + i, bot + i, dst + i, n - i, span);
+}
+
+// ============================================================
+// TEMPLATE MATCHING - SSSE3 / AVX2
+// ============================================================
+// Produto interno com pmaddwd sobre bytes estendidos para 16 bits: cada
+// soma de par cabe em 32 bits e cada faixa recebe no máximo
+// 2 × 65025 por iteração (sem transbordo até n = 65535).
+
+TARGET_SSSE3
+static inline uint64_t hsum_u32x4_ssse3(__m128i v) {
+    uint32_t lanes[4];
+    _mm_storeu_si128((__m128i*)lanes, v);
+    return (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+TARGET_SSSE3
+uint64_t dot_u8_ssse3(const unsigned char *a, const unsigned char *b, int n) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_unpacklo_epi8(va, zero),
+                                                _mm_unpacklo_epi8(vb, zero)));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_unpackhi_epi8(va, zero),
+                                                _mm_unpackhi_epi8(vb, zero)));
+    }
+    return hsum_u32x4_ssse3(acc) + dot_u8_scalar(a + i, b + i, n - i);
+}
+
+// Soma dos pares horizontais com pmaddubsw (× 1), depois soma das linhas
+TARGET_SSSE3
+void pyr_down_row_ssse3(const unsigned char *r0, const unsigned char *r1,
+                        unsigned char *dst, int n) {
+    const __m128i ones = _mm_set1_epi8(1);
+    const __m128i two = _mm_set1_epi16(2);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const unsigned char *p0 = r0 + 2 * i, *p1 = r1 + 2 * i;
+        __m128i lo = _mm_add_epi16(
+            _mm_maddubs_epi16(_mm_loadu_si128((const __m128i*)p0), ones),
+            _mm_maddubs_epi16(_mm_loadu_si128((const __m128i*)p1), ones));
+        __m128i hi = _mm_add_epi16(
+            _mm_maddubs_epi16(_mm_loadu_si128((const __m128i*)(p0 + 16)), ones),
+            _mm_maddubs_epi16(_mm_loadu_si128((const __m128i*)(p1 + 16)), ones));
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, two), 2);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, two), 2);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+    }
+    pyr_down_row_scalar(r0 + 2 * i, r1 + 2 * i, dst + i, n - i);
+}
+
+// Pares (src[i], src[i+1]) intercalados em 16 bits: um pmaddwd por 4 posições
+TARGET_SSSE3
+void ncc_mac_row_ssse3(const unsigned char *src, int c0, int c1, uint32_t *acc, int n) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i coef = _mm_set1_epi32((c1 << 16) | c0);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(src + i + 1));
+        __m128i lo = _mm_unpacklo_epi8(a, b);
+        __m128i hi = _mm_unpackhi_epi8(a, b);
+        __m128i *out = (__m128i*)(acc + i);
+        __m128i p0 = _mm_madd_epi16(_mm_unpacklo_epi8(lo, zero), coef);
+        __m128i p1 = _mm_madd_epi16(_mm_unpackhi_epi8(lo, zero), coef);
+        __m128i p2 = _mm_madd_epi16(_mm_unpacklo_epi8(hi, zero), coef);
+        __m128i p3 = _mm_madd_epi16(_mm_unpackhi_epi8(hi, zero), coef);
+        _mm_storeu_si128(out, _mm_add_epi32(_mm_loadu_si128(out), p0));
+        _mm_storeu_si128(out + 1, _mm_add_epi32(_mm_loadu_si128(out + 1), p1));
+        _mm_storeu_si128(out + 2, _mm_add_epi32(_mm_loadu_si128(out + 2), p2));
+        _mm_storeu_si128(out + 3, _mm_add_epi32(_mm_loadu_si128(out + 3), p3));
+    }
+    ncc_mac_row_scalar(src + i, c0, c1, acc + i, n - i);
+}
+
+TARGET_AVX2
+uint64_t dot_u8_avx2(const unsigned char *a, const unsigned char *b, int n) {
+    __m256i acc = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i a0 = load_u8x16_avx2(a + i), a1 = load_u8x16_avx2(a + i + 16);
+        __m256i b0 = load_u8x16_avx2(b + i), b1 = load_u8x16_avx2(b + i + 16);
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(a0, b0));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(a1, b1));
+    }
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    return hsum_u32x4_ssse3(half) + dot_u8_ssse3(a + i, b + i, n - i);
+}
+
+TARGET_AVX2
+void pyr_down_row_avx2(const unsigned char *r0, const unsigned char *r1,
+                       unsigned char *dst, int n) {
+    const __m256i ones = _mm256_set1_epi8(1);
+    const __m256i two = _mm256_set1_epi16(2);
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const unsigned char *p0 = r0 + 2 * i, *p1 = r1 + 2 * i;
+        __m256i lo = _mm256_add_epi16(
+            _mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i*)p0), ones),
+            _mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i*)p1), ones));
+        __m256i hi = _mm256_add_epi16(
+            _mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i*)(p0 + 32)), ones),
+            _mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i*)(p1 + 32)), ones));
+        lo = _mm256_srli_epi16(_mm256_add_epi16(lo, two), 2);
+        hi = _mm256_srli_epi16(_mm256_add_epi16(hi, two), 2);
+        _mm256_storeu_si256((__m256i*)(dst + i), PACKUS_ORDERED_AVX2(lo, hi));
+    }
+    pyr_down_row_ssse3(r0 + 2 * i, r1 + 2 * i, dst + i, n - i);
+}
+
+// unpack por faixa de 128 bits: lo = posições 0-3 | 8-11, hi = 4-7 | 12-15
+TARGET_AVX2
+void ncc_mac_row_avx2(const unsigned char *src, int c0, int c1, uint32_t *acc, int n) {
+    const __m256i coef = _mm256_set1_epi32((c1 << 16) | c0);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i a = load_u8x16_avx2(src + i);
+        __m256i b = load_u8x16_avx2(src + i + 1);
+        __m256i lo = _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), coef);
+        __m256i hi = _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), coef);
+        __m256i *out = (__m256i*)(acc + i);
+        _mm256_storeu_si256(out, _mm256_add_epi32(_mm256_loadu_si256(out),
+                                                  _mm256_permute2x128_si256(lo, hi, 0x20)));
+        _mm256_storeu_si256(out + 1, _mm256_add_epi32(_mm256_loadu_si256(out + 1),
+                                                      _mm256_permute2x128_si256(lo, hi, 0x31)));
+    }
+    ncc_mac_row_ssse3(src + i, c0, c1, acc + i, n - i);
+}
+
+// ============================================================
+// THRESHOLD - SSSE3 / AVX2
+// ============================================================
+// x > t  ⇔  subs_epu8(x, t) != 0 (sem comparação sem sinal em SSE/AVX2)
+
+TARGET_SSSE3
+void threshold_row_ssse3(const unsigned char *src, unsigned char *dst, int n, int thresh) {
+    const __m128i t = _mm_set1_epi8((char)thresh);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi8(-1);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i le = _mm_cmpeq_epi8(_mm_subs_epu8(v, t), zero);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_xor_si128(le, ones));
+    }
+    threshold_row_scalar(src + i, dst + i, n - i, thresh);
+}
+
+TARGET_SSSE3
+void threshold_mean_row_ssse3(const unsigned char *src, const unsigned char *mean,
+                              unsigned char *dst, int n, int c) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i vc = _mm_set1_epi16((short)c);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i m = _mm_loadu_si128((const __m128i*)(mean + i));
+        // Em int16: src + c > mean (c pode ser negativo)
+        __m128i lo = _mm_cmpgt_epi16(_mm_add_epi16(_mm_unpacklo_epi8(v, zero), vc),
+                                     _mm_unpacklo_epi8(m, zero));
+        __m128i hi = _mm_cmpgt_epi16(_mm_add_epi16(_mm_unpackhi_epi8(v, zero), vc),
+                                     _mm_unpackhi_epi8(m, zero));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi16(lo, hi));
+    }
+    threshold_mean_row_scalar(src + i, mean + i, dst + i, n - i, c);
+}
+
+TARGET_AVX2
+void threshold_row_avx2(const unsigned char *src, unsigned char *dst, int n, int thresh) {
+    const __m256i t = _mm256_set1_epi8((char)thresh);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ones = _mm256_set1_epi8(-1);
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i le = _mm256_cmpeq_epi8(_mm256_subs_epu8(v, t), zero);
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_xor_si256(le, ones));
+    }
+    threshold_row_ssse3(src + i, dst + i, n - i, thresh);
+}
+
+TARGET_AVX2
+void threshold_mean_row_avx2(const unsigned char *src, const unsigned char *mean,
+                             unsigned char *dst, int n, int c) {
+    const __m256i vc = _mm256_set1_epi16((short)c);
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v0 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(src + i)));
+        __m256i v1 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(src + i + 16)));
+        __m256i m0 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(mean + i)));
+        __m256i m1 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(mean + i + 16)));
+        __m256i lo = _mm256_cmpgt_epi16(_mm256_add_epi16(v0, vc), m0);
+        __m256i hi = _mm256_cmpgt_epi16(_mm256_add_epi16(v1, vc), m1);
+        _mm256_storeu_si256((__m256i*)(dst + i),
+                            _mm256_permute4x64_epi64(_mm256_packs_epi16(lo, hi), 0xD8));
+    }
+    threshold_mean_row_ssse3(src + i, mean + i, dst + i, n - i, c);
+}
+
+// ============================================================
+// LUT - SSSE3 / AVX2
+// ============================================================
+// A tabela de 256 bytes vira 16 tabelas de 16 para pshufb. Cada metade
+// (bit 7 do índice) é resolvida à parte: o índice desce 16 por tabela e,
+// ao ficar negativo, pshufb devolve 0. Assim todas as tabelas até a do
+// nibble alto contribuem; cada uma guarda o XOR com a anterior (soma
+// telescópica) e a metade é escolhida pelo bit 7 no fim. 3 instruções
+// por tabela, ~2x a consulta escalar com AVX2.
+
+static void lut_tables_xor(const unsigned char *lut, unsigned char tables[16][16]) {
+    for (int k = 0; k < 16; k++) {
+        for (int j = 0; j < 16; j++) {
+            tables[k][j] = lut[16 * k + j] ^ (k % 8 ? lut[16 * (k - 1) + j] : 0);
+        }
+    }
+}
+
+TARGET_SSSE3
+void lut_row_ssse3(const unsigned char *src, unsigned char *dst, int n,
+                   const unsigned char *lut, int alpha_stride) {
+    unsigned char tables[16][16];
+    lut_tables_xor(lut, tables);
+    __m128i t[16];
+    for (int k = 0; k < 16; k++) t[k] = _mm_loadu_si128((const __m128i*)tables[k]);
+
+    const __m128i step = _mm_set1_epi8(16);
+    const __m128i high = _mm_set1_epi8((char)0x80);
+    const __m128i keep = alpha_stride == 2 ? _mm_set1_epi16((short)0xFF00) :
+                         alpha_stride == 4 ? _mm_set1_epi32((int)0xFF000000) :
+                         _mm_setzero_si128();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i lo = v, hi = _mm_xor_si128(v, high);
+        __m128i r_lo = _mm_setzero_si128(), r_hi = _mm_setzero_si128();
+        for (int k = 0; k < 8; k++) {
+            r_lo = _mm_xor_si128(r_lo, _mm_shuffle_epi8(t[k], lo));
+            r_hi = _mm_xor_si128(r_hi, _mm_shuffle_epi8(t[k + 8], hi));
+            lo = _mm_sub_epi8(lo, step);
+            hi = _mm_sub_epi8(hi, step);
+        }
+        // Sem blendv no SSSE3: seleção por máscara (bit 7 da entrada, alpha)
+        __m128i sel = _mm_cmplt_epi8(v, _mm_setzero_si128());
+        __m128i r = _mm_or_si128(_mm_and_si128(sel, r_hi), _mm_andnot_si128(sel, r_lo));
+        r = _mm_or_si128(_mm_and_si128(keep, v), _mm_andnot_si128(keep, r));
+        _mm_storeu_si128((__m128i*)(dst + i), r);
+    }
+    lut_row_scalar(src + i, dst + i, n - i, lut, alpha_stride);
+}
+
+TARGET_AVX2
+void lut_row_avx2(const unsigned char *src, unsigned char *dst, int n,
+                  const unsigned char *lut, int alpha_stride) {
+    unsigned char tables[16][16];
+    lut_tables_xor(lut, tables);
+    __m256i t[16];
+    for (int k = 0; k < 16; k++) {
+        t[k] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)tables[k]));
+    }
+
+    const __m256i step = _mm256_set1_epi8(16);
+    const __m256i high = _mm256_set1_epi8((char)0x80);
+    const __m256i keep = alpha_stride == 2 ? _mm256_set1_epi16((short)0xFF00) :
+                         alpha_stride == 4 ? _mm256_set1_epi32((int)0xFF000000) :
+                         _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i lo = v, hi = _mm256_xor_si256(v, high);
+        __m256i r_lo = _mm256_setzero_si256(), r_hi = _mm256_setzero_si256();
+        for (int k = 0; k < 8; k++) {
+            r_lo = _mm256_xor_si256(r_lo, _mm256_shuffle_epi8(t[k], lo));
+            r_hi = _mm256_xor_si256(r_hi, _mm256_shuffle_epi8(t[k + 8], hi));
+            lo = _mm256_sub_epi8(lo, step);
+            hi = _mm256_sub_epi8(hi, step);
+        }
+        __m256i r = _mm256_blendv_epi8(r_lo, r_hi, v);
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_blendv_epi8(r, v, keep));
+    }
+    lut_row_ssse3(src + i, dst + i, n - i, lut, alpha_stride);
+}
+
+// ============================================================
+// REMAP - SSSE3 / AVX2
+// ============================================================
+// Pares (p[x], p[x+1]) de cada canto em 16 bits, um pmaddwd por linha
+// com os pesos (128−fx, fx) já multiplicados pelo peso vertical. O
+// SSSE3 monta os pares com leituras escalares de 16 bits; o AVX2 busca 4 bytes
+// por pixel com gather, com o deslocamento y·stride + x calculado por
+// pmaddwd sobre os pares (x, y) do mapa (stride até INT16_MAX).
+
+// Pesos de 8 pixels: (128−fx, fx)·(128−fy) e (128−fx, fx)·fy em pares de
+// 16 bits (pixels 0-3 em lo, 4-7 em hi); fora da origem em 'outside'
+TARGET_SSSE3
+static inline void remap_weights_ssse3(__m128i f, __m128i *w_top_lo, __m128i *w_top_hi,
+                                       __m128i *w_bot_lo, __m128i *w_bot_hi,
+                                       __m128i *outside) {
+    const __m128i one = _mm_set1_epi16(128);
+    __m128i fx = _mm_and_si128(f, _mm_set1_epi16(0xFF));
+    __m128i fy = _mm_srli_epi16(f, 8);
+    *outside = _mm_cmpeq_epi16(fy, _mm_set1_epi16(0xFF));
+    fy = _mm_min_epi16(fy, one);
+    __m128i ax = _mm_sub_epi16(one, fx), ay = _mm_sub_epi16(one, fy);
+    __m128i hx_lo = _mm_unpacklo_epi16(ax, fx), hx_hi = _mm_unpackhi_epi16(ax, fx);
+    *w_top_lo = _mm_mullo_epi16(hx_lo, _mm_unpacklo_epi16(ay, ay));
+    *w_top_hi = _mm_mullo_epi16(hx_hi, _mm_unpackhi_epi16(ay, ay));
+    *w_bot_lo = _mm_mullo_epi16(hx_lo, _mm_unpacklo_epi16(fy, fy));
+    *w_bot_hi = _mm_mullo_epi16(hx_hi, _mm_unpackhi_epi16(fy, fy));
+}
+
+TARGET_SSSE3
+void remap_row_ssse3(const unsigned char *src, size_t stride, const int16_t *xy,
+                     const uint16_t *frac, unsigned char *dst, int n) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi32(1 << 13);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        // Pares de bytes do canto superior e da linha seguinte
+        uint16_t t[8], b[8];
+        for (int k = 0; k < 8; k++) {
+            const unsigned char *p = src + (size_t)xy[2 * (i + k) + 1] * stride + xy[2 * (i + k)];
+            memcpy(&t[k], p, 2);
+            memcpy(&b[k], p + stride, 2);
+        }
+        __m128i top = _mm_loadu_si128((const __m128i*)t);
+        __m128i bot = _mm_loadu_si128((const __m128i*)b);
+
+        __m128i w_top_lo, w_top_hi, w_bot_lo, w_bot_hi, outside;
+        remap_weights_ssse3(_mm_loadu_si128((const __m128i*)(frac + i)),
+                            &w_top_lo, &w_top_hi, &w_bot_lo, &w_bot_hi, &outside);
+
+        __m128i lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi8(top, zero), w_top_lo),
+                                   _mm_madd_epi16(_mm_unpacklo_epi8(bot, zero), w_bot_lo));
+        __m128i hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi8(top, zero), w_top_hi),
+                                   _mm_madd_epi16(_mm_unpackhi_epi8(bot, zero), w_bot_hi));
+        lo = _mm_srli_epi32(_mm_add_epi32(lo, round), 14);
+        hi = _mm_srli_epi32(_mm_add_epi32(hi, round), 14);
+        __m128i r = _mm_andnot_si128(outside, _mm_packs_epi32(lo, hi));
+        _mm_storel_epi64((__m128i*)(dst + i), _mm_packus_epi16(r, r));
+    }
+    remap_row_scalar(src, stride, xy + 2 * i, frac + i, dst + i, n - i);
+}
+
+TARGET_AVX2
+void remap_row_avx2(const unsigned char *src, size_t stride, const int16_t *xy,
+                    const uint16_t *frac, unsigned char *dst, int n) {
+    if (stride > INT16_MAX) {
+        remap_row_ssse3(src, stride, xy, frac, dst, n);
+        return;
+    }
+
+    const __m256i offset_weights = _mm256_set1_epi32((int)(((uint32_t)stride << 16) | 1));
+    const __m256i pairs = _mm256_setr_epi8(0, -1, 1, -1, 4, -1, 5, -1, 8, -1, 9, -1, 12, -1, 13, -1,
+                                           0, -1, 1, -1, 4, -1, 5, -1, 8, -1, 9, -1, 12, -1, 13, -1);
+    const __m256i one = _mm256_set1_epi32(128);
+    const __m256i round = _mm256_set1_epi32(1 << 13);
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        // x + y·stride de 8 pixels; 4 bytes de cada canto e da linha seguinte
+        __m256i off = _mm256_madd_epi16(_mm256_loadu_si256((const __m256i*)(xy + 2 * i)),
+                                        offset_weights);
+        __m256i top = _mm256_i32gather_epi32((const int*)src, off, 1);
+        __m256i bot = _mm256_i32gather_epi32((const int*)(src + stride), off, 1);
+        top = _mm256_shuffle_epi8(top, pairs);
+        bot = _mm256_shuffle_epi8(bot, pairs);
+
+        // Pesos em pares de 16 bits por pixel (um pixel por lane de 32 bits)
+        __m256i f = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(frac + i)));
+        __m256i fx = _mm256_and_si256(f, _mm256_set1_epi32(0xFF));
+        __m256i fy = _mm256_srli_epi32(f, 8);
+        __m256i outside = _mm256_cmpeq_epi32(fy, _mm256_set1_epi32(0xFF));
+        fy = _mm256_min_epi32(fy, one);
+        __m256i ay = _mm256_sub_epi32(one, fy);
+        __m256i hx = _mm256_or_si256(_mm256_sub_epi32(one, fx), _mm256_slli_epi32(fx, 16));
+        __m256i w_top = _mm256_mullo_epi16(hx, _mm256_or_si256(ay, _mm256_slli_epi32(ay, 16)));
+        __m256i w_bot = _mm256_mullo_epi16(hx, _mm256_or_si256(fy, _mm256_slli_epi32(fy, 16)));
+
+        __m256i s = _mm256_add_epi32(_mm256_madd_epi16(top, w_top), _mm256_madd_epi16(bot, w_bot));
+        s = _mm256_andnot_si256(outside, _mm256_srli_epi32(_mm256_add_epi32(s, round), 14));
+
+        // 8 × int32 → 8 bytes (cada lane contribui com 4)
+        s = _mm256_packus_epi32(s, s);
+        s = _mm256_packus_epi16(s, s);
+        s = _mm256_permutevar8x32_epi32(s, order);
+        _mm_storel_epi64((__m128i*)(dst + i), _mm256_castsi256_si128(s));
+    }
+    remap_row_ssse3(src, stride, xy + 2 * i, frac + i, dst + i, n - i);
+}
+
+// ============================================================
+// CALIBRAÇÃO - SSSE3 / AVX2
+// ============================================================
+// Subtração saturada em 8 bits; (v << 5) · ganho Q10 com pmulhrsw dá
+// (v · ganho + 2^9) >> 10 exato (v << 5 <= 8160 e ganho <= 32767 cabem
+// em int16) e packuswb satura em 255.
+
+TARGET_SSSE3
+void calib_row_ssse3(const unsigned char *src, const unsigned char *dark,
+                     const int16_t *gain, unsigned char *dst, int n) {
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_subs_epu8(_mm_loadu_si128((const __m128i*)(src + i)),
+                                  _mm_loadu_si128((const __m128i*)(dark + i)));
+        __m128i lo = _mm_slli_epi16(_mm_unpacklo_epi8(v, zero), 5);
+        __m128i hi = _mm_slli_epi16(_mm_unpackhi_epi8(v, zero), 5);
+        lo = _mm_mulhrs_epi16(lo, _mm_loadu_si128((const __m128i*)(gain + i)));
+        hi = _mm_mulhrs_epi16(hi, _mm_loadu_si128((const __m128i*)(gain + i + 8)));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+    }
+    calib_row_scalar(src + i, dark + i, gain + i, dst + i, n - i);
+}
+
+TARGET_AVX2
+void calib_row_avx2(const unsigned char *src, const unsigned char *dark,
+                    const int16_t *gain, unsigned char *dst, int n) {
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_subs_epu8(_mm256_loadu_si256((const __m256i*)(src + i)),
+                                     _mm256_loadu_si256((const __m256i*)(dark + i)));
+        // Amostras em ordem (0-15, 16-31) para casar com os ganhos
+        __m256i lo = _mm256_slli_epi16(_mm256_cvtepu8_epi16(_mm256_castsi256_si128(v)), 5);
+        __m256i hi = _mm256_slli_epi16(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(v, 1)), 5);
+        lo = _mm256_mulhrs_epi16(lo, _mm256_loadu_si256((const __m256i*)(gain + i)));
+        hi = _mm256_mulhrs_epi16(hi, _mm256_loadu_si256((const __m256i*)(gain + i + 16)));
+        __m256i r = _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xD8);
+        _mm256_storeu_si256((__m256i*)(dst + i), r);
+    }
+    calib_row_ssse3(src + i, dark + i, gain + i, dst + i, n - i);
+}
+
+// ============================================================
+// DEMOSAICO - SSSE3 / AVX2
+// ============================================================
+// Aritmética em 16 bits (8 pixels por vetor no SSSE3, 16 no AVX2); as
+// colunas da cor da linha e as de verde são calculadas juntas e escolhidas
+// por máscara de paridade (and/andnot/or). A saturação vem do packuswb.
+// Blocos começam em colunas pares: a paridade vale também para a cauda.
+
+#define BAYER_SELECT(m, a, b, and_, andnot_, or_) or_(and_(m, a), andnot_(m, b))
+
+TARGET_SSSE3
+static inline __m128i bayer_load_ssse3(const unsigned char *p) {
+    return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)p), _mm_setzero_si128());
+}
+
+TARGET_SSSE3
+static inline void bayer_store_ssse3(unsigned char *p, __m128i v) {
+    _mm_storel_epi64((__m128i*)p, _mm_packus_epi16(v, v));
+}
+
+// Pixels pares (phase 0) ou ímpares (phase 1) do bloco
+TARGET_SSSE3
+static inline __m128i bayer_site_ssse3(int phase) {
+    return _mm_set1_epi32(phase ? (int)0xFFFF0000u : 0x0000FFFF);
+}
+
+#define SEL128(m, a, b) BAYER_SELECT(m, a, b, _mm_and_si128, _mm_andnot_si128, _mm_or_si128)
+// Diferença de cor (C − G) na coluna i + k
+#define DIFF128(p, q, k) _mm_sub_epi16(bayer_load_ssse3((p) + i + (k)), \
+                                       bayer_load_ssse3((q) + i + (k)))
+
+TARGET_SSSE3
+void bayer_bilinear_row_ssse3(const unsigned char *up, const unsigned char *row,
+                              const unsigned char *dn, unsigned char *own, unsigned char *g,
+                              unsigned char *other, int n, int phase) {
+    const __m128i site = bayer_site_ssse3(phase);
+    const __m128i one = _mm_set1_epi16(1), two = _mm_set1_epi16(2);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i c = bayer_load_ssse3(row + i);
+        __m128i h = _mm_add_epi16(bayer_load_ssse3(row + i - 1), bayer_load_ssse3(row + i + 1));
+        __m128i v = _mm_add_epi16(bayer_load_ssse3(up + i), bayer_load_ssse3(dn + i));
+        __m128i d = _mm_add_epi16(
+            _mm_add_epi16(bayer_load_ssse3(up + i - 1), bayer_load_ssse3(up + i + 1)),
+            _mm_add_epi16(bayer_load_ssse3(dn + i - 1), bayer_load_ssse3(dn + i + 1)));
+
+        __m128i cross = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(h, v), two), 2);
+        __m128i diag = _mm_srli_epi16(_mm_add_epi16(d, two), 2);
+        __m128i horiz = _mm_srli_epi16(_mm_add_epi16(h, one), 1);
+        __m128i vert = _mm_srli_epi16(_mm_add_epi16(v, one), 1);
+        bayer_store_ssse3(own + i, SEL128(site, c, horiz));
+        bayer_store_ssse3(g + i, SEL128(site, cross, c));
+        bayer_store_ssse3(other + i, SEL128(site, diag, vert));
+    }
+    bayer_bilinear_row_scalar(up + i, row + i, dn + i, own + i, g + i, other + i, n - i, phase);
+}
+
+TARGET_SSSE3
+void bayer_green_row_ssse3(const unsigned char *up2, const unsigned char *up,
+                           const unsigned char *row, const unsigned char *dn,
+                           const unsigned char *dn2, unsigned char *g, int n, int phase) {
+    const __m128i site = bayer_site_ssse3(phase);
+    const __m128i one = _mm_set1_epi16(1), two = _mm_set1_epi16(2);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i c = bayer_load_ssse3(row + i);
+        __m128i l = bayer_load_ssse3(row + i - 1), r = bayer_load_ssse3(row + i + 1);
+        __m128i u = bayer_load_ssse3(up + i), d = bayer_load_ssse3(dn + i);
+        __m128i c2 = _mm_add_epi16(c, c);
+        __m128i lap_h = _mm_sub_epi16(c2, _mm_add_epi16(bayer_load_ssse3(row + i - 2),
+                                                        bayer_load_ssse3(row + i + 2)));
+        __m128i lap_v = _mm_sub_epi16(c2, _mm_add_epi16(bayer_load_ssse3(up2 + i),
+                                                        bayer_load_ssse3(dn2 + i)));
+        __m128i grad_h = _mm_add_epi16(_mm_abs_epi16(_mm_sub_epi16(l, r)), _mm_abs_epi16(lap_h));
+        __m128i grad_v = _mm_add_epi16(_mm_abs_epi16(_mm_sub_epi16(u, d)), _mm_abs_epi16(lap_v));
+        __m128i gh = _mm_srai_epi16(_mm_add_epi16(_mm_add_epi16(
+                         _mm_slli_epi16(_mm_add_epi16(l, r), 1), lap_h), two), 2);
+        __m128i gv = _mm_srai_epi16(_mm_add_epi16(_mm_add_epi16(
+                         _mm_slli_epi16(_mm_add_epi16(u, d), 1), lap_v), two), 2);
+        __m128i mean = _mm_srai_epi16(_mm_add_epi16(_mm_add_epi16(gh, gv), one), 1);
+
+        __m128i pick = SEL128(_mm_cmpgt_epi16(grad_h, grad_v), gv, mean);
+        pick = SEL128(_mm_cmplt_epi16(grad_h, grad_v), gh, pick);
+        bayer_store_ssse3(g + i, SEL128(site, pick, c));
+    }
+    bayer_green_row_scalar(up2 + i, up + i, row + i, dn + i, dn2 + i, g + i, n - i, phase);
+}
+
+TARGET_SSSE3
+void bayer_rb_row_ssse3(const unsigned char *up, const unsigned char *row,
+                        const unsigned char *dn, const unsigned char *gu,
+                        const unsigned char *g, const unsigned char *gd,
+                        unsigned char *own, unsigned char *other, int n, int phase) {
+    const __m128i site = bayer_site_ssse3(phase);
+    const __m128i one = _mm_set1_epi16(1), two = _mm_set1_epi16(2);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i gc = bayer_load_ssse3(g + i);
+        __m128i horiz = _mm_add_epi16(DIFF128(row, g, -1), DIFF128(row, g, 1));
+        __m128i vert = _mm_add_epi16(DIFF128(up, gu, 0), DIFF128(dn, gd, 0));
+        __m128i diag = _mm_add_epi16(_mm_add_epi16(DIFF128(up, gu, -1), DIFF128(up, gu, 1)),
+                                     _mm_add_epi16(DIFF128(dn, gd, -1), DIFF128(dn, gd, 1)));
+        horiz = _mm_add_epi16(gc, _mm_srai_epi16(_mm_add_epi16(horiz, one), 1));
+        vert = _mm_add_epi16(gc, _mm_srai_epi16(_mm_add_epi16(vert, one), 1));
+        diag = _mm_add_epi16(gc, _mm_srai_epi16(_mm_add_epi16(diag, two), 2));
+        bayer_store_ssse3(own + i, SEL128(site, bayer_load_ssse3(row + i), horiz));
+        bayer_store_ssse3(other + i, SEL128(site, diag, vert));
+    }
+    bayer_rb_row_scalar(up + i, row + i, dn + i, gu + i, g + i, gd + i, own + i, other + i,
+                        n - i, phase);
+}
+
+TARGET_SSSE3
+void gray_planes_row_ssse3(const unsigned char *r, const unsigned char *g,
+                           const unsigned char *b, unsigned char *dst, int n) {
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = gray_mix_ssse3(_mm_loadu_si128((const __m128i*)(r + i)),
+                                   _mm_loadu_si128((const __m128i*)(g + i)),
+                                   _mm_loadu_si128((const __m128i*)(b + i)));
+        _mm_storeu_si128((__m128i*)(dst + i), v);
+    }
+    gray_planes_row_scalar(r + i, g + i, b + i, dst + i, n - i);
+}
+
+#undef SEL128
+#undef DIFF128
+
+TARGET_AVX2
+static inline void bayer_store_avx2(unsigned char *p, __m256i v) {
+    __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(v, v), 0x08);
+    _mm_storeu_si128((__m128i*)p, _mm256_castsi256_si128(packed));
+}
+
+#define SEL256(m, a, b) BAYER_SELECT(m, a, b, _mm256_and_si256, _mm256_andnot_si256, \
+                                     _mm256_or_si256)
+#define DIFF256(p, q, k) _mm256_sub_epi16(load_u8x16_avx2((p) + i + (k)), \
+                                          load_u8x16_avx2((q) + i + (k)))
+
+TARGET_AVX2
+void bayer_bilinear_row_avx2(const unsigned char *up, const unsigned char *row,
+                             const unsigned char *dn, unsigned char *own, unsigned char *g,
+                             unsigned char *other, int n, int phase) {
+    const __m256i site = _mm256_set1_epi32(phase ? (int)0xFFFF0000u : 0x0000FFFF);
+    const __m256i one = _mm256_set1_epi16(1), two = _mm256_set1_epi16(2);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i c = load_u8x16_avx2(row + i);
+        __m256i h = _mm256_add_epi16(load_u8x16_avx2(row + i - 1), load_u8x16_avx2(row + i + 1));
+        __m256i v = _mm256_add_epi16(load_u8x16_avx2(up + i), load_u8x16_avx2(dn + i));
+        __m256i d = _mm256_add_epi16(
+            _mm256_add_epi16(load_u8x16_avx2(up + i - 1), load_u8x16_avx2(up + i + 1)),
+            _mm256_add_epi16(load_u8x16_avx2(dn + i - 1), load_u8x16_avx2(dn + i + 1)));
+
+        __m256i cross = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(h, v), two), 2);
+        __m256i diag = _mm256_srli_epi16(_mm256_add_epi16(d, two), 2);
+        __m256i horiz = _mm256_srli_epi16(_mm256_add_epi16(h, one), 1);
+        __m256i vert = _mm256_srli_epi16(_mm256_add_epi16(v, one), 1);
+        bayer_store_avx2(own + i, SEL256(site, c, horiz));
+        bayer_store_avx2(g + i, SEL256(site, cross, c));
+        bayer_store_avx2(other + i, SEL256(site, diag, vert));
+    }
+    bayer_bilinear_row_ssse3(up + i, row + i, dn + i, own + i, g + i, other + i, n - i, phase);
+}
+
+TARGET_AVX2
+void bayer_green_row_avx2(const unsigned char *up2, const unsigned char *up,
+                          const unsigned char *row, const unsigned char *dn,
+                          const unsigned char *dn2, unsigned char *g, int n, int phase) {
+    const __m256i site = _mm256_set1_epi32(phase ? (int)0xFFFF0000u : 0x0000FFFF);
+    const __m256i one = _mm256_set1_epi16(1), two = _mm256_set1_epi16(2);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i c = load_u8x16_avx2(row + i);
+        __m256i l = load_u8x16_avx2(row + i - 1), r = load_u8x16_avx2(row + i + 1);
+        __m256i u = load_u8x16_avx2(up + i), d = load_u8x16_avx2(dn + i);
+        __m256i c2 = _mm256_add_epi16(c, c);
+        __m256i lap_h = _mm256_sub_epi16(c2, _mm256_add_epi16(load_u8x16_avx2(row + i - 2),
+                                                              load_u8x16_avx2(row + i + 2)));
+        __m256i lap_v = _mm256_sub_epi16(c2, _mm256_add_epi16(load_u8x16_avx2(up2 + i),
+                                                              load_u8x16_avx2(dn2 + i)));
+        __m256i grad_h = _mm256_add_epi16(_mm256_abs_epi16(_mm256_sub_epi16(l, r)),
+                                          _mm256_abs_epi16(lap_h));
+        __m256i grad_v = _mm256_add_epi16(_mm256_abs_epi16(_mm256_sub_epi16(u, d)),
+                                          _mm256_abs_epi16(lap_v));
+        __m256i gh = _mm256_srai_epi16(_mm256_add_epi16(_mm256_add_epi16(
+                         _mm256_slli_epi16(_mm256_add_epi16(l, r), 1), lap_h), two), 2);
+        __m256i gv = _mm256_srai_epi16(_mm256_add_epi16(_mm256_add_epi16(
+                         _mm256_slli_epi16(_mm256_add_epi16(u, d), 1), lap_v), two), 2);
+        __m256i mean = _mm256_srai_epi16(_mm256_add_epi16(_mm256_add_epi16(gh, gv), one), 1);
+
+        __m256i pick = SEL256(_mm256_cmpgt_epi16(grad_h, grad_v), gv, mean);
+        pick = SEL256(_mm256_cmpgt_epi16(grad_v, grad_h), gh, pick);
+        bayer_store_avx2(g + i, SEL256(site, pick, c));
+    }
+    bayer_green_row_ssse3(up2 + i, up + i, row + i, dn + i, dn2 + i, g + i, n - i, phase);
+}
+
+TARGET_AVX2
+void bayer_rb_row_avx2(const unsigned char *up, const unsigned char *row,
+                       const unsigned char *dn, const unsigned char *gu,
+                       const unsigned char *g, const unsigned char *gd,
+                       unsigned char *own, unsigned char *other, int n, int phase) {
+    const __m256i site = _mm256_set1_epi32(phase ? (int)0xFFFF0000u : 0x0000FFFF);
+    const __m256i one = _mm256_set1_epi16(1), two = _mm256_set1_epi16(2);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i gc = load_u8x16_avx2(g + i);
+        __m256i horiz = _mm256_add_epi16(DIFF256(row, g, -1), DIFF256(row, g, 1));
+        __m256i vert = _mm256_add_epi16(DIFF256(up, gu, 0), DIFF256(dn, gd, 0));
+        __m256i diag = _mm256_add_epi16(_mm256_add_epi16(DIFF256(up, gu, -1), DIFF256(up, gu, 1)),
+                                        _mm256_add_epi16(DIFF256(dn, gd, -1), DIFF256(dn, gd, 1)));
+        horiz = _mm256_add_epi16(gc, _mm256_srai_epi16(_mm256_add_epi16(horiz, one), 1));
+        vert = _mm256_add_epi16(gc, _mm256_srai_epi16(_mm256_add_epi16(vert, one), 1));
+        diag = _mm256_add_epi16(gc, _mm256_srai_epi16(_mm256_add_epi16(diag, two), 2));
+        bayer_store_avx2(own + i, SEL256(site, load_u8x16_avx2(row + i), horiz));
+        bayer_store_avx2(other + i, SEL256(site, diag, vert));
+    }
+    bayer_rb_row_ssse3(up + i, row + i, dn + i, gu + i, g + i, gd + i, own + i, other + i,
+                       n - i, phase);
+}
+
+TARGET_AVX2
+void gray_planes_row_avx2(const unsigned char *r, const unsigned char *g,
+                          const unsigned char *b, unsigned char *dst, int n) {
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = gray_mix_avx2(_mm256_loadu_si256((const __m256i*)(r + i)),
+                                  _mm256_loadu_si256((const __m256i*)(g + i)),
+                                  _mm256_loadu_si256((const __m256i*)(b + i)));
+        _mm256_storeu_si256((__m256i*)(dst + i), v);
+    }
+    gray_planes_row_ssse3(r + i, g + i, b + i, dst + i, n - i);
+}
+
+#undef SEL256
+#undef DIFF256
+#undef BAYER_SELECT
+
+// ============================================================
+// GOLDEN - SSSE3 / AVX2
+// ============================================================
+// |a − b| por duas subtrações saturadas; d > thresh sem comparação com
+// sinal: (d −sat thresh) != 0. A contagem soma o bit baixo da máscara
+// com psadbw (bytes 0/1 somados em palavras de 64 bits).
+
+TARGET_SSSE3
+int golden_row_ssse3(const unsigned char *src, const unsigned char *ref,
+                     const unsigned char *tol, unsigned char *dst, int n, int thresh) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi8(1);
+    const __m128i th = _mm_set1_epi8((char)thresh);
+    __m128i count = zero;
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(ref + i));
+        __m128i d = _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+        if (tol) d = _mm_subs_epu8(d, _mm_loadu_si128((const __m128i*)(tol + i)));
+        __m128i ok = _mm_cmpeq_epi8(_mm_subs_epu8(d, th), zero);
+        __m128i defect = _mm_andnot_si128(ok, _mm_set1_epi8(-1));
+        _mm_storeu_si128((__m128i*)(dst + i), defect);
+        count = _mm_add_epi64(count, _mm_sad_epu8(_mm_and_si128(defect, one), zero));
+    }
+    int defects = _mm_cvtsi128_si32(count) + _mm_cvtsi128_si32(_mm_unpackhi_epi64(count, count));
+    return defects + golden_row_scalar(src + i, ref + i, tol ? tol + i : NULL, dst + i, n - i,
+                                       thresh);
+}
+
+TARGET_AVX2
+int golden_row_avx2(const unsigned char *src, const unsigned char *ref,
+                    const unsigned char *tol, unsigned char *dst, int n, int thresh) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi8(1);
+    const __m256i th = _mm256_set1_epi8((char)thresh);
+    __m256i count = zero;
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(ref + i));
+        __m256i d = _mm256_or_si256(_mm256_subs_epu8(a, b), _mm256_subs_epu8(b, a));
+        if (tol) d = _mm256_subs_epu8(d, _mm256_loadu_si256((const __m256i*)(tol + i)));
+        __m256i ok = _mm256_cmpeq_epi8(_mm256_subs_epu8(d, th), zero);
+        __m256i defect = _mm256_andnot_si256(ok, _mm256_set1_epi8(-1));
+        _mm256_storeu_si256((__m256i*)(dst + i), defect);
+        count = _mm256_add_epi64(count, _mm256_sad_epu8(_mm256_and_si256(defect, one), zero));
+    }
+    __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(count), _mm256_extracti128_si256(count, 1));
+    int defects = _mm_cvtsi128_si32(sum) + _mm_cvtsi128_si32(_mm_unpackhi_epi64(sum, sum));
+    return defects + golden_row_ssse3(src + i, ref + i, tol ? tol + i : NULL, dst + i, n - i,
+                                      thresh);
+}
+
+// ============================================================
+// MEDIANA - SSSE3 / AVX2
+// ============================================================
+// Segmento de 16 contagens: dois vetores de 128 bits ou um de 256. A busca
+// é sem desvios: soma de prefixos em log2(8) deslocamentos por metade (a
+// alta recebe o total da baixa), comparação com rest e o primeiro nível
+// acima dele pela máscara de bytes (2 bits por contagem). Contagens e
+// prefixos <= (2·MEDIAN_MAX_RADIUS + 1)² cabem na comparação com sinal.
+
+TARGET_SSSE3
+static inline void hist16_add_ssse3(uint16_t *acc, const uint16_t *h) {
+    __m128i *a = (__m128i*)acc;
+    const __m128i *b = (const __m128i*)h;
+    _mm_store_si128(a, _mm_add_epi16(_mm_load_si128(a), _mm_loadu_si128(b)));
+    _mm_store_si128(a + 1, _mm_add_epi16(_mm_load_si128(a + 1), _mm_loadu_si128(b + 1)));
+}
+
+TARGET_SSSE3
+static inline void hist16_sub_ssse3(uint16_t *acc, const uint16_t *h) {
+    __m128i *a = (__m128i*)acc;
+    const __m128i *b = (const __m128i*)h;
+    _mm_store_si128(a, _mm_sub_epi16(_mm_load_si128(a), _mm_loadu_si128(b)));
+    _mm_store_si128(a + 1, _mm_sub_epi16(_mm_load_si128(a + 1), _mm_loadu_si128(b + 1)));
+}
+
+TARGET_AVX2
+static inline void hist16_add_avx2(uint16_t *acc, const uint16_t *h) {
+    __m256i *a = (__m256i*)acc;
+    _mm256_store_si256(a, _mm256_add_epi16(_mm256_load_si256(a),
+                                           _mm256_loadu_si256((const __m256i*)h)));
+}
+
+TARGET_AVX2
+static inline void hist16_sub_avx2(uint16_t *acc, const uint16_t *h) {
+    __m256i *a = (__m256i*)acc;
+    _mm256_store_si256(a, _mm256_sub_epi16(_mm256_load_si256(a),
+                                           _mm256_loadu_si256((const __m256i*)h)));
+}
+
+TARGET_SSSE3
+static inline __m128i prefix16_ssse3(__m128i v) {
+    v = _mm_add_epi16(v, _mm_slli_si128(v, 2));
+    v = _mm_add_epi16(v, _mm_slli_si128(v, 4));
+    return _mm_add_epi16(v, _mm_slli_si128(v, 8));
+}
+
+TARGET_SSSE3
+static inline int hist16_find_ssse3(const uint16_t *h, int *rest) {
+    uint16_t prefix[16] __attribute__((aligned(16)));
+    const __m128i *src = (const __m128i*)h;
+    __m128i lo = prefix16_ssse3(_mm_load_si128(src));
+    __m128i hi = prefix16_ssse3(_mm_load_si128(src + 1));
+    hi = _mm_add_epi16(hi, _mm_shuffle_epi8(lo, _mm_set1_epi16(0x0F0E)));
+    const __m128i r = _mm_set1_epi16((short)*rest);
+    unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpgt_epi16(lo, r)) |
+                    ((unsigned)_mm_movemask_epi8(_mm_cmpgt_epi16(hi, r)) << 16);
+    int i = __builtin_ctz(mask) >> 1;
+    _mm_store_si128((__m128i*)prefix, lo);
+    _mm_store_si128((__m128i*)prefix + 1, hi);
+    if (i > 0) *rest -= prefix[i - 1];
+    return i;
+}
+
+TARGET_AVX2
+static inline int hist16_find_avx2(const uint16_t *h, int *rest) {
+    uint16_t prefix[16] __attribute__((aligned(32)));
+    __m256i v = _mm256_load_si256((const __m256i*)h);
+    v = _mm256_add_epi16(v, _mm256_slli_si256(v, 2));
+    v = _mm256_add_epi16(v, _mm256_slli_si256(v, 4));
+    v = _mm256_add_epi16(v, _mm256_slli_si256(v, 8));
+    // Total da metade baixa (contagem 7) somado a cada contagem da alta
+    __m256i low_total = _mm256_permute2x128_si256(v, v, 0x08);
+    v = _mm256_add_epi16(v, _mm256_shuffle_epi8(low_total, _mm256_set1_epi16(0x0F0E)));
+    int mask = _mm256_movemask_epi8(_mm256_cmpgt_epi16(v, _mm256_set1_epi16((short)*rest)));
+    int i = __builtin_ctz((unsigned)mask) >> 1;
+    _mm256_store_si256((__m256i*)prefix, v);
+    if (i > 0) *rest -= prefix[i - 1];
+    return i;
+}
+
+MEDIAN_ROW_TEMPLATE(ssse3, TARGET_SSSE3, hist16_add_ssse3, hist16_sub_ssse3, hist16_find_ssse3)
+MEDIAN_ROW_TEMPLATE(avx2, TARGET_AVX2, hist16_add_avx2, hist16_sub_avx2, hist16_find_avx2)
+
+#undef MEDIAN_ROW_TEMPLATE
+#undef MEDIAN_STALE
+
+// ============================================================
+// CONVERSÃO DE COR - SSSE3 / AVX2
+// ============================================================
+// Matriz: pares (R,G) e (B,1) de cada pixel em pmaddwd com os pares de
+// pesos de cada linha, como no grayscale, com o arredondamento no peso do
+// 1. As saídas com sinal saturam em 8 bits com sinal e o xor 0x80 soma 128.
+// HSV: setor em 16 bits e divisões em float. Numeradores < 2^19 e
+// divisores <= 1530 são exatos em float, e um quociente não inteiro
+// (<= 256) fica a mais de 1/1530 do inteiro seguinte, muito acima do erro de
+// arredondamento: o truncamento reproduz a divisão inteira.
+
+TARGET_SSSE3
+static inline __m128i color_quad_ssse3(__m128i rg, __m128i b1, __m128i w_rg, __m128i w_b1) {
+    __m128i sum = _mm_add_epi32(_mm_madd_epi16(rg, w_rg), _mm_madd_epi16(b1, w_b1));
+    return _mm_srai_epi32(sum, 15);
+}
+
+TARGET_SSSE3
+void color_matrix_row_ssse3(const unsigned char *r, const unsigned char *g,
+                            const unsigned char *b, const int16_t *coef,
+                            unsigned char *dst0, unsigned char *dst1,
+                            unsigned char *dst2, int n) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i bias = _mm_set1_epi8((char)0x80);
+    __m128i w_rg[3], w_b1[3];
+    for (int k = 0; k < 3; k++) {
+        w_rg[k] = _mm_unpacklo_epi16(_mm_set1_epi16(coef[3 * k]), _mm_set1_epi16(coef[3 * k + 1]));
+        w_b1[k] = _mm_unpacklo_epi16(_mm_set1_epi16(coef[3 * k + 2]), _mm_set1_epi16(1 << 14));
+    }
+    unsigned char *dst[3] = {dst0, dst1, dst2};
+
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i rv = _mm_loadu_si128((const __m128i*)(r + i));
+        __m128i gv = _mm_loadu_si128((const __m128i*)(g + i));
+        __m128i bv = _mm_loadu_si128((const __m128i*)(b + i));
+        __m128i r_lo = _mm_unpacklo_epi8(rv, zero), r_hi = _mm_unpackhi_epi8(rv, zero);
+        __m128i g_lo = _mm_unpacklo_epi8(gv, zero), g_hi = _mm_unpackhi_epi8(gv, zero);
+        __m128i b_lo = _mm_unpacklo_epi8(bv, zero), b_hi = _mm_unpackhi_epi8(bv, zero);
+        __m128i rg0 = _mm_unpacklo_epi16(r_lo, g_lo), rg1 = _mm_unpackhi_epi16(r_lo, g_lo);
+        __m128i rg2 = _mm_unpacklo_epi16(r_hi, g_hi), rg3 = _mm_unpackhi_epi16(r_hi, g_hi);
+        __m128i b10 = _mm_unpacklo_epi16(b_lo, one), b11 = _mm_unpackhi_epi16(b_lo, one);
+        __m128i b12 = _mm_unpacklo_epi16(b_hi, one), b13 = _mm_unpackhi_epi16(b_hi, one);
+
+        for (int k = 0; k < 3; k++) {
+            __m128i lo = _mm_packs_epi32(color_quad_ssse3(rg0, b10, w_rg[k], w_b1[k]),
+                                         color_quad_ssse3(rg1, b11, w_rg[k], w_b1[k]));
+            __m128i hi = _mm_packs_epi32(color_quad_ssse3(rg2, b12, w_rg[k], w_b1[k]),
+                                         color_quad_ssse3(rg3, b13, w_rg[k], w_b1[k]));
+            __m128i out = k == 0 ? _mm_packus_epi16(lo, hi)
+                                 : _mm_xor_si128(_mm_packs_epi16(lo, hi), bias);
+            _mm_storeu_si128((__m128i*)(dst[k] + i), out);
+        }
+    }
+    color_matrix_row_scalar(r + i, g + i, b + i, coef, dst0 + i, dst1 + i, dst2 + i, n - i);
+}
+
+TARGET_SSSE3
+static inline __m128i hsv_div_ssse3(__m128i num, __m128i den) {
+    return _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(num), _mm_cvtepi32_ps(den)));
+}
+
+// Matiz e saturação de 8 pixels em 16 bits
+TARGET_SSSE3
+static inline void hsv_oct_ssse3(__m128i r, __m128i g, __m128i b, __m128i *h, __m128i *s) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i w_h = _mm_unpacklo_epi16(_mm_set1_epi16(256), _mm_set1_epi16(3));
+    const __m128i w_s = _mm_unpacklo_epi16(_mm_set1_epi16(255), one);
+
+    __m128i v = _mm_max_epi16(_mm_max_epi16(r, g), b);
+    __m128i d = _mm_sub_epi16(v, _mm_min_epi16(_mm_min_epi16(r, g), b));
+    __m128i is_r = _mm_cmpeq_epi16(v, r);
+    __m128i is_g = _mm_andnot_si128(is_r, _mm_cmpeq_epi16(v, g));
+    __m128i is_b = _mm_andnot_si128(_mm_or_si128(is_r, is_g), _mm_set1_epi16(-1));
+    __m128i num = _mm_or_si128(
+        _mm_or_si128(_mm_and_si128(is_r, _mm_sub_epi16(g, b)),
+                     _mm_and_si128(is_g, _mm_add_epi16(_mm_add_epi16(d, d), _mm_sub_epi16(b, r)))),
+        _mm_and_si128(is_b, _mm_add_epi16(_mm_slli_epi16(d, 2), _mm_sub_epi16(r, g))));
+    __m128i six_d = _mm_mullo_epi16(d, _mm_set1_epi16(6));
+    num = _mm_add_epi16(num, _mm_and_si128(_mm_cmplt_epi16(num, zero), six_d));
+
+    // d = 0 → numerador 0 e divisor 1; v = 0 → d = 0
+    __m128i den_h = _mm_max_epi16(six_d, one);
+    __m128i den_s = _mm_max_epi16(v, one);
+    __m128i vh = _mm_srli_epi16(v, 1);
+    __m128i h0 = hsv_div_ssse3(_mm_madd_epi16(_mm_unpacklo_epi16(num, d), w_h),
+                               _mm_unpacklo_epi16(den_h, zero));
+    __m128i h1 = hsv_div_ssse3(_mm_madd_epi16(_mm_unpackhi_epi16(num, d), w_h),
+                               _mm_unpackhi_epi16(den_h, zero));
+    __m128i s0 = hsv_div_ssse3(_mm_madd_epi16(_mm_unpacklo_epi16(d, vh), w_s),
+                               _mm_unpacklo_epi16(den_s, zero));
+    __m128i s1 = hsv_div_ssse3(_mm_madd_epi16(_mm_unpackhi_epi16(d, vh), w_s),
+                               _mm_unpackhi_epi16(den_s, zero));
+    *h = _mm_and_si128(_mm_packs_epi32(h0, h1), _mm_set1_epi16(255));
+    *s = _mm_packs_epi32(s0, s1);
+}
+
+TARGET_SSSE3
+void hsv_row_ssse3(const unsigned char *r, const unsigned char *g, const unsigned char *b,
+                   unsigned char *h, unsigned char *s, unsigned char *v, int n) {
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i rv = _mm_loadu_si128((const __m128i*)(r + i));
+        __m128i gv = _mm_loadu_si128((const __m128i*)(g + i));
+        __m128i bv = _mm_loadu_si128((const __m128i*)(b + i));
+        __m128i h_lo, s_lo, h_hi, s_hi;
+        hsv_oct_ssse3(_mm_unpacklo_epi8(rv, zero), _mm_unpacklo_epi8(gv, zero),
+                      _mm_unpacklo_epi8(bv, zero), &h_lo, &s_lo);
+        hsv_oct_ssse3(_mm_unpackhi_epi8(rv, zero), _mm_unpackhi_epi8(gv, zero),
+                      _mm_unpackhi_epi8(bv, zero), &h_hi, &s_hi);
+        _mm_storeu_si128((__m128i*)(h + i), _mm_packus_epi16(h_lo, h_hi));
+        _mm_storeu_si128((__m128i*)(s + i), _mm_packus_epi16(s_lo, s_hi));
+        _mm_storeu_si128((__m128i*)(v + i), _mm_max_epu8(_mm_max_epu8(rv, gv), bv));
+    }
+    hsv_row_scalar(r + i, g + i, b + i, h + i, s + i, v + i, n - i);
+}
+
+TARGET_AVX2
+static inline __m256i color_quad_avx2(__m256i rg, __m256i b1, __m256i w_rg, __m256i w_b1) {
+    __m256i sum = _mm256_add_epi32(_mm256_madd_epi16(rg, w_rg), _mm256_madd_epi16(b1, w_b1));
+    return _mm256_srai_epi32(sum, 15);
+}
+
+TARGET_AVX2
+void color_matrix_row_avx2(const unsigned char *r, const unsigned char *g,
+                           const unsigned char *b, const int16_t *coef,
+                           unsigned char *dst0, unsigned char *dst1,
+                           unsigned char *dst2, int n) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi16(1);
+    const __m256i bias = _mm256_set1_epi8((char)0x80);
+    __m256i w_rg[3], w_b1[3];
+    for (int k = 0; k < 3; k++) {
+        w_rg[k] = _mm256_unpacklo_epi16(_mm256_set1_epi16(coef[3 * k]),
+                                        _mm256_set1_epi16(coef[3 * k + 1]));
+        w_b1[k] = _mm256_unpacklo_epi16(_mm256_set1_epi16(coef[3 * k + 2]),
+                                        _mm256_set1_epi16(1 << 14));
+    }
+    unsigned char *dst[3] = {dst0, dst1, dst2};
+
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i rv = _mm256_loadu_si256((const __m256i*)(r + i));
+        __m256i gv = _mm256_loadu_si256((const __m256i*)(g + i));
+        __m256i bv = _mm256_loadu_si256((const __m256i*)(b + i));
+        __m256i r_lo = _mm256_unpacklo_epi8(rv, zero), r_hi = _mm256_unpackhi_epi8(rv, zero);
+        __m256i g_lo = _mm256_unpacklo_epi8(gv, zero), g_hi = _mm256_unpackhi_epi8(gv, zero);
+        __m256i b_lo = _mm256_unpacklo_epi8(bv, zero), b_hi = _mm256_unpackhi_epi8(bv, zero);
+        __m256i rg0 = _mm256_unpacklo_epi16(r_lo, g_lo), rg1 = _mm256_unpackhi_epi16(r_lo, g_lo);
+        __m256i rg2 = _mm256_unpacklo_epi16(r_hi, g_hi), rg3 = _mm256_unpackhi_epi16(r_hi, g_hi);
+        __m256i b10 = _mm256_unpacklo_epi16(b_lo, one), b11 = _mm256_unpackhi_epi16(b_lo, one);
+        __m256i b12 = _mm256_unpacklo_epi16(b_hi, one), b13 = _mm256_unpackhi_epi16(b_hi, one);
+
+        for (int k = 0; k < 3; k++) {
+            __m256i lo = _mm256_packs_epi32(color_quad_avx2(rg0, b10, w_rg[k], w_b1[k]),
+                                            color_quad_avx2(rg1, b11, w_rg[k], w_b1[k]));
+            __m256i hi = _mm256_packs_epi32(color_quad_avx2(rg2, b12, w_rg[k], w_b1[k]),
+                                            color_quad_avx2(rg3, b13, w_rg[k], w_b1[k]));
+            __m256i out = k == 0 ? _mm256_packus_epi16(lo, hi)
+                                 : _mm256_xor_si256(_mm256_packs_epi16(lo, hi), bias);
+            _mm256_storeu_si256((__m256i*)(dst[k] + i), out);
+        }
+    }
+    color_matrix_row_ssse3(r + i, g + i, b + i, coef, dst0 + i, dst1 + i, dst2 + i, n - i);
+}
+
+TARGET_AVX2
+static inline __m256i hsv_div_avx2(__m256i num, __m256i den) {
+    return _mm256_cvttps_epi32(_mm256_div_ps(_mm256_cvtepi32_ps(num), _mm256_cvtepi32_ps(den)));
+}
+
+TARGET_AVX2
+static inline void hsv_oct_avx2(__m256i r, __m256i g, __m256i b, __m256i *h, __m256i *s) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi16(1);
+    const __m256i w_h = _mm256_unpacklo_epi16(_mm256_set1_epi16(256), _mm256_set1_epi16(3));
+    const __m256i w_s = _mm256_unpacklo_epi16(_mm256_set1_epi16(255), one);
+
+    __m256i v = _mm256_max_epi16(_mm256_max_epi16(r, g), b);
+    __m256i d = _mm256_sub_epi16(v, _mm256_min_epi16(_mm256_min_epi16(r, g), b));
+    __m256i is_r = _mm256_cmpeq_epi16(v, r);
+    __m256i is_g = _mm256_andnot_si256(is_r, _mm256_cmpeq_epi16(v, g));
+    __m256i is_b = _mm256_andnot_si256(_mm256_or_si256(is_r, is_g), _mm256_set1_epi16(-1));
+    __m256i num = _mm256_or_si256(
+        _mm256_or_si256(_mm256_and_si256(is_r, _mm256_sub_epi16(g, b)),
+                        _mm256_and_si256(is_g, _mm256_add_epi16(_mm256_add_epi16(d, d),
+                                                                _mm256_sub_epi16(b, r)))),
+        _mm256_and_si256(is_b, _mm256_add_epi16(_mm256_slli_epi16(d, 2), _mm256_sub_epi16(r, g))));
+    __m256i six_d = _mm256_mullo_epi16(d, _mm256_set1_epi16(6));
+    num = _mm256_add_epi16(num, _mm256_and_si256(_mm256_cmpgt_epi16(zero, num), six_d));
+
+    __m256i den_h = _mm256_max_epi16(six_d, one);
+    __m256i den_s = _mm256_max_epi16(v, one);
+    __m256i vh = _mm256_srli_epi16(v, 1);
+    __m256i h0 = hsv_div_avx2(_mm256_madd_epi16(_mm256_unpacklo_epi16(num, d), w_h),
+                              _mm256_unpacklo_epi16(den_h, zero));
+    __m256i h1 = hsv_div_avx2(_mm256_madd_epi16(_mm256_unpackhi_epi16(num, d), w_h),
+                              _mm256_unpackhi_epi16(den_h, zero));
+    __m256i s0 = hsv_div_avx2(_mm256_madd_epi16(_mm256_unpacklo_epi16(d, vh), w_s),
+                              _mm256_unpacklo_epi16(den_s, zero));
+    __m256i s1 = hsv_div_avx2(_mm256_madd_epi16(_mm256_unpackhi_epi16(d, vh), w_s),
+                              _mm256_unpackhi_epi16(den_s, zero));
+    *h = _mm256_and_si256(_mm256_packs_epi32(h0, h1), _mm256_set1_epi16(255));
+    *s = _mm256_packs_epi32(s0, s1);
+}
+
+TARGET_AVX2
+void hsv_row_avx2(const unsigned char *r, const unsigned char *g, const unsigned char *b,
+                  unsigned char *h, unsigned char *s, unsigned char *v, int n) {
+    const __m256i zero = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i rv = _mm256_loadu_si256((const __m256i*)(r + i));
+        __m256i gv = _mm256_loadu_si256((const __m256i*)(g + i));
+        __m256i bv = _mm256_loadu_si256((const __m256i*)(b + i));
+        __m256i h_lo, s_lo, h_hi, s_hi;
+        hsv_oct_avx2(_mm256_unpacklo_epi8(rv, zero), _mm256_unpacklo_epi8(gv, zero),
+                     _mm256_unpacklo_epi8(bv, zero), &h_lo, &s_lo);
+        hsv_oct_avx2(_mm256_unpackhi_epi8(rv, zero), _mm256_unpackhi_epi8(gv, zero),
+                     _mm256_unpackhi_epi8(bv, zero), &h_hi, &s_hi);
+        _mm256_storeu_si256((__m256i*)(h + i), _mm256_packus_epi16(h_lo, h_hi));
+        _mm256_storeu_si256((__m256i*)(s + i), _mm256_packus_epi16(s_lo, s_hi));
+        _mm256_storeu_si256((__m256i*)(v + i), _mm256_max_epu8(_mm256_max_epu8(rv, gv), bv));
+    }
+    hsv_row_ssse3(r + i, g + i, b + i, h + i, s + i, v + i, n - i);
+}
+
+// ============================================================
+// CLASSIFICAÇÃO DE COR - SSSE3 / AVX2
+// ============================================================
+// Índices da LUT em 32 bits: pmaddwd de (r & 0xFC, g & 0xFC) com
+// (1024, 16) mais b >> 2. O AVX2 busca 8 classes por vpgatherdd (4 bytes a
+// partir de cada índice, daí a folga da tabela; vale o byte baixo); o
+// SSSE3 não tem gather e faz as 16 leituras a partir dos índices
+// vetoriais. Contagem no mesmo passo: um acumulador de 8 bits por classe
+// (cmpeq + sub), esvaziado com psadbw a cada 255 vetores; a classe 0 fica
+// com o restante. Rótulo id·17 = id | id << 4 (id <= 15, sem vazar do byte).
+
+TARGET_SSSE3
+static inline uint32_t class_flush_ssse3(__m128i acc) {
+    __m128i sum = _mm_sad_epu8(acc, _mm_setzero_si128());
+    return (uint32_t)(_mm_cvtsi128_si32(sum) + _mm_cvtsi128_si32(_mm_unpackhi_epi64(sum, sum)));
+}
+
+TARGET_SSSE3
+void class_row_ssse3(const unsigned char *r, const unsigned char *g, const unsigned char *b,
+                     const uint8_t *lut, unsigned char *dst, int n, int classes,
+                     uint32_t *counts) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i top6 = _mm_set1_epi16(0xFC);
+    const __m128i w_rg = _mm_unpacklo_epi16(_mm_set1_epi16(1024), _mm_set1_epi16(16));
+    int32_t idx[16] __attribute__((aligned(16)));
+    uint8_t ids[16] __attribute__((aligned(16)));
+
+    int i = 0;
+    while (i + 16 <= n) {
+        __m128i acc[CLASS_MAX + 1];
+        for (int c = 1; c <= classes; c++) acc[c] = zero;
+        const int block = MIN((n - i) / 16, 255);
+        for (int v = 0; v < block; v++, i += 16) {
+            __m128i rv = _mm_loadu_si128((const __m128i*)(r + i));
+            __m128i gv = _mm_loadu_si128((const __m128i*)(g + i));
+            __m128i bv = _mm_loadu_si128((const __m128i*)(b + i));
+            __m128i r_lo = _mm_and_si128(_mm_unpacklo_epi8(rv, zero), top6);
+            __m128i r_hi = _mm_and_si128(_mm_unpackhi_epi8(rv, zero), top6);
+            __m128i g_lo = _mm_and_si128(_mm_unpacklo_epi8(gv, zero), top6);
+            __m128i g_hi = _mm_and_si128(_mm_unpackhi_epi8(gv, zero), top6);
+            __m128i b_lo = _mm_srli_epi16(_mm_unpacklo_epi8(bv, zero), 2);
+            __m128i b_hi = _mm_srli_epi16(_mm_unpackhi_epi8(bv, zero), 2);
+            _mm_store_si128((__m128i*)idx, _mm_add_epi32(
+                _mm_madd_epi16(_mm_unpacklo_epi16(r_lo, g_lo), w_rg), _mm_unpacklo_epi16(b_lo, zero)));
+            _mm_store_si128((__m128i*)(idx + 4), _mm_add_epi32(
+                _mm_madd_epi16(_mm_unpackhi_epi16(r_lo, g_lo), w_rg), _mm_unpackhi_epi16(b_lo, zero)));
+            _mm_store_si128((__m128i*)(idx + 8), _mm_add_epi32(
+                _mm_madd_epi16(_mm_unpacklo_epi16(r_hi, g_hi), w_rg), _mm_unpacklo_epi16(b_hi, zero)));
+            _mm_store_si128((__m128i*)(idx + 12), _mm_add_epi32(
+                _mm_madd_epi16(_mm_unpackhi_epi16(r_hi, g_hi), w_rg), _mm_unpackhi_epi16(b_hi, zero)));
+            for (int k = 0; k < 16; k++) ids[k] = lut[idx[k]];
+
+            __m128i id = _mm_load_si128((const __m128i*)ids);
+            for (int c = 1; c <= classes; c++) {
+                acc[c] = _mm_sub_epi8(acc[c], _mm_cmpeq_epi8(id, _mm_set1_epi8((char)c)));
+            }
+            _mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(id, _mm_slli_epi16(id, 4)));
+        }
+        uint32_t classified = 0;
+        for (int c = 1; c <= classes; c++) {
+            uint32_t count = class_flush_ssse3(acc[c]);
+            counts[c] += count;
+            classified += count;
+        }
+        counts[0] += (uint32_t)block * 16 - classified;
+    }
+    class_row_scalar(r + i, g + i, b + i, lut, dst + i, n - i, classes, counts);
+}
+
+TARGET_AVX2
+static inline uint32_t class_flush_avx2(__m256i acc) {
+    __m256i sum = _mm256_sad_epu8(acc, _mm256_setzero_si256());
+    __m128i half = _mm_add_epi64(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    return (uint32_t)(_mm_cvtsi128_si32(half) + _mm_cvtsi128_si32(_mm_unpackhi_epi64(half, half)));
+}
+
+// Classes de 8 pixels (uma por lane de 32 bits)
+TARGET_AVX2
+static inline __m256i class_gather_avx2(const unsigned char *r, const unsigned char *g,
+                                        const unsigned char *b, const uint8_t *lut) {
+    const __m256i top6 = _mm256_set1_epi32(0xFC);
+    __m256i rv = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)r));
+    __m256i gv = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)g));
+    __m256i bv = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)b));
+    __m256i idx = _mm256_or_si256(_mm256_or_si256(
+                      _mm256_slli_epi32(_mm256_and_si256(rv, top6), 10),
+                      _mm256_slli_epi32(_mm256_and_si256(gv, top6), 4)),
+                      _mm256_srli_epi32(bv, 2));
+    return _mm256_and_si256(_mm256_i32gather_epi32((const int*)lut, idx, 1),
+                            _mm256_set1_epi32(0xFF));
+}
+
+TARGET_AVX2
+void class_row_avx2(const unsigned char *r, const unsigned char *g, const unsigned char *b,
+                    const uint8_t *lut, unsigned char *dst, int n, int classes,
+                    uint32_t *counts) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+    int i = 0;
+    while (i + 32 <= n) {
+        __m256i acc[CLASS_MAX + 1];
+        for (int c = 1; c <= classes; c++) acc[c] = zero;
+        const int block = MIN((n - i) / 32, 255);
+        for (int v = 0; v < block; v++, i += 32) {
+            __m256i c0 = class_gather_avx2(r + i, g + i, b + i, lut);
+            __m256i c1 = class_gather_avx2(r + i + 8, g + i + 8, b + i + 8, lut);
+            __m256i c2 = class_gather_avx2(r + i + 16, g + i + 16, b + i + 16, lut);
+            __m256i c3 = class_gather_avx2(r + i + 24, g + i + 24, b + i + 24, lut);
+            // packs intercala as lanes: grupos de 4 pixels reordenados no fim
+            __m256i id = _mm256_packs_epi16(_mm256_packs_epi32(c0, c1), _mm256_packs_epi32(c2, c3));
+            id = _mm256_permutevar8x32_epi32(id, order);
+
+            for (int c = 1; c <= classes; c++) {
+                acc[c] = _mm256_sub_epi8(acc[c], _mm256_cmpeq_epi8(id, _mm256_set1_epi8((char)c)));
+            }
+            _mm256_storeu_si256((__m256i*)(dst + i), _mm256_or_si256(id, _mm256_slli_epi16(id, 4)));
+        }
+        uint32_t classified = 0;
+        for (int c = 1; c <= classes; c++) {
+            uint32_t count = class_flush_avx2(acc[c]);
+            counts[c] += count;
+            classified += count;
+        }
+        counts[0] += (uint32_t)block * 32 - classified;
+    }
+    class_row_ssse3(r + i, g + i, b + i, lut, dst + i, n - i, classes, counts);
+}
+
+// ============================================================
+// PLANAR - SSSE3 / AVX2
+// ============================================================
+// Separação RGB reutiliza as máscaras MASK_<canal><vetor> do grayscale;
+// RGBA agrupa cada canal em 32 bits (MASK_RGBA_GROUP) e transpõe 4x4.
+// MASK_RGBA_GROUP é a própria inversa, então a intercalação RGBA faz a
+// transposição de volta e aplica a mesma máscara.
+
+// Planos → RGB: MASK_ILV_<canal><vetor de saída>
+#define MASK_ILV_R0  0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1, -1, 5
+#define MASK_ILV_G0 -1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1, -1
+#define MASK_ILV_B0 -1, -1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1
+#define MASK_ILV_R1 -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1, 10, -1
+#define MASK_ILV_G1  5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1, 10
+#define MASK_ILV_B1 -1, 5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1
+#define MASK_ILV_R2 -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1, -1
+#define MASK_ILV_G2 -1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1
+#define MASK_ILV_B2 10, -1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15
+
+#define SHUFFLE3_SSSE3(a, b, c, ma, mb, mc) _mm_or_si128(_mm_or_si128( \
+    _mm_shuffle_epi8(a, _mm_setr_epi8(ma)), _mm_shuffle_epi8(b, _mm_setr_epi8(mb))), \
+    _mm_shuffle_epi8(c, _mm_setr_epi8(mc)))
+#define SHUFFLE3_AVX2(a, b, c, ma, mb, mc) _mm256_or_si256(_mm256_or_si256( \
+    _mm256_shuffle_epi8(a, MASK256(ma)), _mm256_shuffle_epi8(b, MASK256(mb))), \
+    _mm256_shuffle_epi8(c, MASK256(mc)))
+
+// Cinza + alpha: bytes pares/ímpares separados por máscara/deslocamento + packus
+TARGET_SSSE3
+void deinterleave_ga_ssse3(const unsigned char *src, unsigned char *dst,
+                           size_t plane_stride, int n) {
+    const __m128i lo = _mm_set1_epi16(0x00FF);
+    int i = 0;
+    for (; i + 16 <= n; i += 16, src += 32) {
+        __m128i v0 = _mm_loadu_si128((const __m128i*)(src));
+        __m128i v1 = _mm_loadu_si128((const __m128i*)(src + 16));
+        _mm_storeu_si128((__m128i*)(dst + i),
+                         _mm_packus_epi16(_mm_and_si128(v0, lo), _mm_and_si128(v1, lo)));
+        _mm_storeu_si128((__m128i*)(dst + plane_stride + i),
+                         _mm_packus_epi16(_mm_srli_epi16(v0, 8), _mm_srli_epi16(v1, 8)));
+    }
+    deinterleave_ga_scalar(src, dst + i, plane_stride, n - i);
+}
+
+TARGET_SSSE3
+void interleave_ga_ssse3(const unsigned char *src, size_t plane_stride,
+                         unsigned char *dst, int n) {
+    int i = 0;
+    for (; i + 16 <= n; i += 16, dst += 32) {
+        __m128i g = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i a = _mm_loadu_si128((const __m128i*)(src + plane_stride + i));
+        _mm_storeu_si128((__m128i*)(dst), _mm_unpacklo_epi8(g, a));
+        _mm_storeu_si128((__m128i*)(dst + 16), _mm_unpackhi_epi8(g, a));
+    }
+    interleave_ga_scalar(src + i, plane_stride, dst, n - i);
+}
+
+TARGET_SSSE3
+void deinterleave_rgb_ssse3(const unsigned char *src, unsigned char *dst,
+                            size_t plane_stride, int n) {
+    int i = 0;
+    for (; i + 16 <= n; i += 16, src += 48) {
+        __m128i v0 = _mm_loadu_si128((const __m128i*)(src));
+        __m128i v1 = _mm_loadu_si128((const __m128i*)(src + 16));
+        __m128i v2 = _mm_loadu_si128((const __m128i*)(src + 32));
+        _mm_storeu_si128((__m128i*)(dst + i),
+                         SHUFFLE3_SSSE3(v0, v1, v2, MASK_R0, MASK_R1, MASK_R2));
+        _mm_storeu_si128((__m128i*)(dst + plane_stride + i),
+                         SHUFFLE3_SSSE3(v0, v1, v2, MASK_G0, MASK_G1, MASK_G2));
+        _mm_storeu_si128((__m128i*)(dst + 2 * plane_stride + i),
+                         SHUFFLE3_SSSE3(v0, v1, v2, MASK_B0, MASK_B1, MASK_B2));
+    }
+    deinterleave_rgb_scalar(src, dst + i, plane_stride, n - i);
+}
+
+TARGET_SSSE3
+void deinterleave_rgba_ssse3(const unsigned char *src, unsigned char *dst,
+                             size_t plane_stride, int n) {
+    const __m128i group = _mm_setr_epi8(MASK_RGBA_GROUP);
+    int i = 0;
+    for (; i + 16 <= n; i += 16, src += 64) {
+        __m128i t0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src)), group);
+        __m128i t1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src + 16)), group);
+        __m128i t2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src + 32)), group);
+        __m128i t3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src + 48)), group);
+        __m128i rg01 = _mm_unpacklo_epi32(t0, t1), ba01 = _mm_unpackhi_epi32(t0, t1);
+        __m128i rg23 = _mm_unpacklo_epi32(t2, t3), ba23 = _mm_unpackhi_epi32(t2, t3);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_unpacklo_epi64(rg01, rg23));
+        _mm_storeu_si128((__m128i*)(dst + plane_stride + i), _mm_unpackhi_epi64(rg01, rg23));
+        _mm_storeu_si128((__m128i*)(dst + 2 * plane_stride + i), _mm_unpacklo_epi64(ba01, ba23));
+        _mm_storeu_si128((__m128i*)(dst + 3 * plane_stride + i), _mm_unpackhi_epi64(ba01, ba23));
+    }
+    deinterleave_rgba_scalar(src, dst + i, plane_stride, n - i);
+}
+
+TARGET_SSSE3
+void interleave_rgb_ssse3(const unsigned char *src, size_t plane_stride,
+                          unsigned char *dst, int n) {
+    int i = 0;
+    for (; i + 16 <= n; i += 16, dst += 48) {
+        __m128i r = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i g = _mm_loadu_si128((const __m128i*)(src + plane_stride + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(src + 2 * plane_stride + i));
+        _mm_storeu_si128((__m128i*)(dst),
+                         SHUFFLE3_SSSE3(r, g, b, MASK_ILV_R0, MASK_ILV_G0, MASK_ILV_B0));
+        _mm_storeu_si128((__m128i*)(dst + 16),
+                         SHUFFLE3_SSSE3(r, g, b, MASK_ILV_R1, MASK_ILV_G1, MASK_ILV_B1));
+        _mm_storeu_si128((__m128i*)(dst + 32),
+                         SHUFFLE3_SSSE3(r, g, b, MASK_ILV_R2, MASK_ILV_G2, MASK_ILV_B2));
+    }
+    interleave_rgb_scalar(src + i, plane_stride, dst, n - i);
+}
+
+TARGET_SSSE3
+void interleave_rgba_ssse3(const unsigned char *src, size_t plane_stride,
+                           unsigned char *dst, int n) {
+    const __m128i group = _mm_setr_epi8(MASK_RGBA_GROUP);
+    int i = 0;
+    for (; i + 16 <= n; i += 16, dst += 64) {
+        __m128i r = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i g = _mm_loadu_si128((const __m128i*)(src + plane_stride + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(src + 2 * plane_stride + i));
+        __m128i a = _mm_loadu_si128((const __m128i*)(src + 3 * plane_stride + i));
+        __m128i rg_lo = _mm_unpacklo_epi32(r, g), ba_lo = _mm_unpacklo_epi32(b, a);
+        __m128i rg_hi = _mm_unpackhi_epi32(r, g), ba_hi = _mm_unpackhi_epi32(b, a);
+        _mm_storeu_si128((__m128i*)(dst),
+                         _mm_shuffle_epi8(_mm_unpacklo_epi64(rg_lo, ba_lo), group));
+        _mm_storeu_si128((__m128i*)(dst + 16),
+                         _mm_shuffle_epi8(_mm_unpackhi_epi64(rg_lo, ba_lo), group));
+        _mm_storeu_si128((__m128i*)(dst + 32),
+                         _mm_shuffle_epi8(_mm_unpacklo_epi64(rg_hi, ba_hi), group));
+        _mm_storeu_si128((__m128i*)(dst + 48),
+                         _mm_shuffle_epi8(_mm_unpackhi_epi64(rg_hi, ba_hi), group));
+    }
+    interleave_rgba_scalar(src + i, plane_stride, dst, n - i);
+}
+
+TARGET_AVX2
+void deinterleave_ga_avx2(const unsigned char *src, unsigned char *dst,
+                          size_t plane_stride, int n) {
+    const __m256i lo = _mm256_set1_epi16(0x00FF);
+    int i = 0;
+    for (; i + 32 <= n; i += 32, src += 64) {
+        __m256i v0 = _mm256_loadu_si256((const __m256i*)(src));
+        __m256i v1 = _mm256_loadu_si256((const __m256i*)(src + 32));
+        _mm256_storeu_si256((__m256i*)(dst + i), PACKUS_ORDERED_AVX2(
+            _mm256_and_si256(v0, lo), _mm256_and_si256(v1, lo)));
+        _mm256_storeu_si256((__m256i*)(dst + plane_stride + i), PACKUS_ORDERED_AVX2(
+            _mm256_srli_epi16(v0, 8), _mm256_srli_epi16(v1, 8)));
+    }
+    deinterleave_ga_ssse3(src, dst + i, plane_stride, n - i);
+}
+
+TARGET_AVX2
+void interleave_ga_avx2(const unsigned char *src, size_t plane_stride,
+                        unsigned char *dst, int n) {
+    int i = 0;
+    for (; i + 32 <= n; i += 32, dst += 64) {
+        __m256i g = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i a = _mm256_loadu_si256((const __m256i*)(src + plane_stride + i));
+        // unpack por lane: lo = pixels 0-7 | 16-23, hi = 8-15 | 24-31
+        __m256i lo = _mm256_unpacklo_epi8(g, a), hi = _mm256_unpackhi_epi8(g, a);
+        _mm256_storeu_si256((__m256i*)(dst), _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i*)(dst + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    interleave_ga_ssse3(src + i, plane_stride, dst, n - i);
+}
+
+// AVX2: cada lane trata 16 pixels consecutivos (mesmo arranjo do grayscale),
+// então os planos saem em ordem com um store de 32 bytes
+TARGET_AVX2
+void deinterleave_rgb_avx2(const unsigned char *src, unsigned char *dst,
+                           size_t plane_stride, int n) {
+    int i = 0;
+    for (; i + 32 <= n; i += 32, src += 96) {
+        __m256i v0 = load_lanes_avx2(src,      src + 48);
+        __m256i v1 = load_lanes_avx2(src + 16, src + 64);
+        __m256i v2 = load_lanes_avx2(src + 32, src + 80);
+        _mm256_storeu_si256((__m256i*)(dst + i),
+                            SHUFFLE3_AVX2(v0, v1, v2, MASK_R0, MASK_R1, MASK_R2));
+        _mm256_storeu_si256((__m256i*)(dst + plane_stride + i),
+                            SHUFFLE3_AVX2(v0, v1, v2, MASK_G0, MASK_G1, MASK_G2));
+        _mm256_storeu_si256((__m256i*)(dst + 2 * plane_stride + i),
+                            SHUFFLE3_AVX2(v0, v1, v2, MASK_B0, MASK_B1, MASK_B2));
+    }
+    deinterleave_rgb_ssse3(src, dst + i, plane_stride, n - i);
+}
+
+TARGET_AVX2
+void deinterleave_rgba_avx2(const unsigned char *src, unsigned char *dst,
+                            size_t plane_stride, int n) {
+    const __m256i group = MASK256(MASK_RGBA_GROUP);
+    int i = 0;
+    for (; i + 32 <= n; i += 32, src += 128) {
+        __m256i t0 = _mm256_shuffle_epi8(load_lanes_avx2(src,      src + 64), group);
+        __m256i t1 = _mm256_shuffle_epi8(load_lanes_avx2(src + 16, src + 80), group);
+        __m256i t2 = _mm256_shuffle_epi8(load_lanes_avx2(src + 32, src + 96), group);
+        __m256i t3 = _mm256_shuffle_epi8(load_lanes_avx2(src + 48, src + 112), group);
+        __m256i rg01 = _mm256_unpacklo_epi32(t0, t1), ba01 = _mm256_unpackhi_epi32(t0, t1);
+        __m256i rg23 = _mm256_unpacklo_epi32(t2, t3), ba23 = _mm256_unpackhi_epi32(t2, t3);
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_unpacklo_epi64(rg01, rg23));
+        _mm256_storeu_si256((__m256i*)(dst + plane_stride + i), _mm256_unpackhi_epi64(rg01, rg23));
+        _mm256_storeu_si256((__m256i*)(dst + 2 * plane_stride + i), _mm256_unpacklo_epi64(ba01, ba23));
+        _mm256_storeu_si256((__m256i*)(dst + 3 * plane_stride + i), _mm256_unpackhi_epi64(ba01, ba23));
+    }
+    deinterleave_rgba_ssse3(src, dst + i, plane_stride, n - i);
+}
+
+TARGET_AVX2
+void interleave_rgb_avx2(const unsigned char *src, size_t plane_stride,
+                         unsigned char *dst, int n) {
+    int i = 0;
+    for (; i + 32 <= n; i += 32, dst += 96) {
+        __m256i r = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i g = _mm256_loadu_si256((const __m256i*)(src + plane_stride + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(src + 2 * plane_stride + i));
+        store_lanes_avx2(dst,      dst + 48,
+                         SHUFFLE3_AVX2(r, g, b, MASK_ILV_R0, MASK_ILV_G0, MASK_ILV_B0));
+        store_lanes_avx2(dst + 16, dst + 64,
+                         SHUFFLE3_AVX2(r, g, b, MASK_ILV_R1, MASK_ILV_G1, MASK_ILV_B1));
+        store_lanes_avx2(dst + 32, dst + 80,
+                         SHUFFLE3_AVX2(r, g, b, MASK_ILV_R2, MASK_ILV_G2, MASK_ILV_B2));
+    }
+    interleave_rgb_ssse3(src + i, plane_stride, dst, n - i);
+}
+
+TARGET_AVX2
+void interleave_rgba_avx2(const unsigned char *src, size_t plane_stride,
+                          unsigned char *dst, int n) {
+    const __m256i group = MASK256(MASK_RGBA_GROUP);
+    int i = 0;
+    for (; i + 32 <= n; i += 32, dst += 128) {
+        __m256i r = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i g = _mm256_loadu_si256((const __m256i*)(src + plane_stride + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(src + 2 * plane_stride + i));
+        __m256i a = _mm256_loadu_si256((const __m256i*)(src + 3 * plane_stride + i));
+        __m256i rg_lo = _mm256_unpacklo_epi32(r, g), ba_lo = _mm256_unpacklo_epi32(b, a);
+        __m256i rg_hi = _mm256_unpackhi_epi32(r, g), ba_hi = _mm256_unpackhi_epi32(b, a);
+        store_lanes_avx2(dst,      dst + 64,
+                         _mm256_shuffle_epi8(_mm256_unpacklo_epi64(rg_lo, ba_lo), group));
+        store_lanes_avx2(dst + 16, dst + 80,
+                         _mm256_shuffle_epi8(_mm256_unpackhi_epi64(rg_lo, ba_lo), group));
+        store_lanes_avx2(dst + 32, dst + 96,
+                         _mm256_shuffle_epi8(_mm256_unpacklo_epi64(rg_hi, ba_hi), group));
+        store_lanes_avx2(dst + 48, dst + 112,
+                         _mm256_shuffle_epi8(_mm256_unpackhi_epi64(rg_hi, ba_hi), group));
+    }
+    interleave_rgba_ssse3(src + i, plane_stride, dst, n - i);
+}
+
+#endif // FAVIS_X86
@@ -0,0 +1,131 @@
+#include "thread_pool.h"
+
+// ============================================================
+// EXECUÇÃO DE TAREFAS
+// ============================================================
+
+// Consome tarefas do lote atual até esgotar. Retorna quantas executou
+static int pool_drain(thread_pool_t *pool, pool_task_fn fn, void *arg, int num_tasks) {
+    int done = 0;
+    int task;
+    while ((task = __atomic_fetch_add(&pool->next_task, 1, __ATOMIC_RELAXED)) < num_tasks) {
+        fn(arg, task);
+        done++;
+    }
+    return done;
+}
+
+// Um lote só termina quando todas as tarefas foram executadas e nenhuma
+// auxiliar ainda está em pool_drain(): do contrário uma auxiliar atrasada
+// poderia consumir índices do próximo lote com a função do anterior
+static int pool_batch_done(const thread_pool_t *pool) {
+    return pool->tasks_done == pool->num_tasks && pool->active == 0;
+}
+
+static void* pool_thread(void *args) {
+    thread_pool_t *pool = (thread_pool_t*)args;
+    unsigned long seen = 0;
+
+    while (1) {
+        pthread_mutex_lock(&pool->mutex);
+        while (!pool->shutdown && pool->generation == seen) {
+            pthread_cond_wait(&pool->cond_work, &pool->mutex);
+        }
+        if (pool->shutdown) {
+            pthread_mutex_unlock(&pool->mutex);
+            break;
+        }
+        seen = pool->generation;
+        pool_task_fn fn = pool->fn;
+        void *arg = pool->arg;
+        int num_tasks = pool->num_tasks;
+        pool->active++;
+        pthread_mutex_unlock(&pool->mutex);
+
+        int done = pool_drain(pool, fn, arg, num_tasks);
+
+        pthread_mutex_lock(&pool->mutex);
+        pool->tasks_done += done;
+        pool->active--;
+        if (pool_batch_done(pool)) {
+            pthread_cond_broadcast(&pool->cond_done);
+        }
+        pthread_mutex_unlock(&pool->mutex);
+    }
+    return NULL;
+}
+
+// ============================================================
+// CICLO DE VIDA
+// ============================================================
+
+int thread_pool_init(thread_pool_t *pool, int num_threads) {
+    memset(pool, 0, sizeof(*pool));
+    if (num_threads < 1) num_threads = 1;
+    if (num_threads > POOL_MAX_THREADS) num_threads = POOL_MAX_THREADS;
+
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->cond_work, NULL);
+    pthread_cond_init(&pool->cond_done, NULL);
+
+    // A thread chamadora é a primeira do pool
+    pool->num_threads = 1;
+    for (int i = 1; i < num_threads; i++) {
+        if (pthread_create(&pool->threads[i], NULL, pool_thread, pool) != 0) {
+            LOG_ERROR("Falha ao criar thread %d do pool", i);
+            thread_pool_destroy(pool);
+            return -1;
+        }
+        pool->num_threads++;
+    }
+    return 0;
+}
+
+void thread_pool_run(thread_pool_t *pool, pool_task_fn fn, void *arg, int num_tasks) {
+    if (num_tasks <= 0) return;
+
+    // Sem pool, sem auxiliares ou tarefa única: executa direto
+    if (!pool || pool->num_threads == 1 || num_tasks == 1) {
+        for (int i = 0; i < num_tasks; i++) fn(arg, i);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    // Auxiliar que acordou tarde para o lote anterior ainda pode estar lendo next_task
+    while (pool->active > 0) {
+        pthread_cond_wait(&pool->cond_done, &pool->mutex);
+    }
+    pool->fn = fn;
+    pool->arg = arg;
+    pool->num_tasks = num_tasks;
+    pool->next_task = 0;
+    pool->tasks_done = 0;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->cond_work);
+    pthread_mutex_unlock(&pool->mutex);
+
+    int done = pool_drain(pool, fn, arg, num_tasks);
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->tasks_done += done;
+    while (!pool_batch_done(pool)) {
+        pthread_cond_wait(&pool->cond_done, &pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+void thread_pool_destroy(thread_pool_t *pool) {
+    pthread_mutex_lock(&pool->mutex);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->cond_work);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (int i = 1; i < pool->num_threads; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    pool->num_threads = 0;
+
+    pthread_mutex_destroy(&pool->mutex);
+    pthread_cond_destroy(&pool->cond_work);
+    pthread_cond_destroy(&pool->cond_done);
+}
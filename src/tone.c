@@ -0,0 +1,96 @@
+#include "tone.h"
+#include "simd_kernels.h"
+#include <math.h>
+
+// ============================================================
+// COMPOSIÇÃO
+// ============================================================
+
+int tone_enabled(const pipeline_config_t *cfg) {
+    return cfg->tone_gamma != 1.0 || cfg->tone_contrast_low != 0 ||
+           cfg->tone_contrast_high != 255 || cfg->tone_curve_points > 0 ||
+           cfg->tone_invert || cfg->tone_clamp_low != 0 || cfg->tone_clamp_high != 255;
+}
+
+// Curva linear por partes; fora dos pontos extremos vale o extremo
+static double tone_curve(const pipeline_config_t *cfg, double v) {
+    const int n = cfg->tone_curve_points;
+    const unsigned char (*pt)[2] = cfg->tone_curve;
+    if (v <= pt[0][0] / 255.0) return pt[0][1] / 255.0;
+    for (int i = 1; i < n; i++) {
+        double x0 = pt[i - 1][0] / 255.0, x1 = pt[i][0] / 255.0;
+        if (v <= x1) {
+            double t = (v - x0) / (x1 - x0);
+            return (pt[i - 1][1] + t * (pt[i][1] - pt[i - 1][1])) / 255.0;
+        }
+    }
+    return pt[n - 1][1] / 255.0;
+}
+
+// Valor normalizado [0, 1] após todas as operações
+static double tone_eval(const pipeline_config_t *cfg, double v) {
+    // Contraste: [low, high] esticado para a faixa inteira
+    double lo = cfg->tone_contrast_low / 255.0, hi = cfg->tone_contrast_high / 255.0;
+    v = (v - lo) / (hi - lo);
+    v = MIN(1.0, MAX(0.0, v));
+
+    if (cfg->tone_gamma != 1.0) v = pow(v, cfg->tone_gamma);
+    if (cfg->tone_curve_points > 0) v = tone_curve(cfg, v);
+    if (cfg->tone_invert) v = 1.0 - v;
+
+    return MIN(cfg->tone_clamp_high / 255.0, MAX(cfg->tone_clamp_low / 255.0, v));
+}
+
+int tone_lut_build(tone_lut_t *tl, const pipeline_config_t *cfg) {
+    memset(tl, 0, sizeof(*tl));
+    if (!tone_enabled(cfg)) return 0;
+
+    tl->lut16 = (uint16_t*)malloc(65536 * sizeof(uint16_t));
+    if (!tl->lut16) {
+        LOG_ERROR("Falha ao alocar LUT de 16 bits");
+        return -1;
+    }
+    for (int i = 0; i < 256; i++) {
+        tl->lut8[i] = (unsigned char)lround(tone_eval(cfg, i / 255.0) * 255.0);
+    }
+    for (int i = 0; i < 65536; i++) {
+        tl->lut16[i] = (uint16_t)lround(tone_eval(cfg, i / 65535.0) * 65535.0);
+    }
+    tl->active = 1;
+    return 0;
+}
+
+void tone_lut_free(tone_lut_t *tl) {
+    free(tl->lut16);
+    tl->lut16 = NULL;
+    tl->active = 0;
+}
+
+// ============================================================
+// APLICAÇÃO
+// ============================================================
+
+// Cinza + alpha e RGBA: o último canal é alpha
+static inline int tone_alpha_stride(int channels) {
+    return channels == 2 || channels == 4 ? channels : 0;
+}
+
+void tone_rows(const tone_lut_t *tl, const unsigned char *src, unsigned char *dst,
+               int n, int channels) {
+    g_kernels.lut_row(src, dst, n * channels, tl->lut8, tone_alpha_stride(channels));
+}
+
+void tone_rows_u16(const tone_lut_t *tl, const uint16_t *src, uint16_t *dst,
+                   int n, int channels) {
+    // 128 KB de tabela: consulta escalar (sem gather útil para 16 bits)
+    const uint16_t *lut = tl->lut16;
+    const int alpha = tone_alpha_stride(channels);
+    if (!alpha) {
+        for (size_t i = 0; i < (size_t)n * channels; i++) dst[i] = lut[src[i]];
+        return;
+    }
+    for (size_t i = 0; i < (size_t)n * channels; i += alpha) {
+        for (int k = 0; k < alpha - 1; k++) dst[i + k] = lut[src[i + k]];
+        dst[i + alpha - 1] = src[i + alpha - 1];
+    }
+}
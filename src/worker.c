@@ -1,5 +1,7 @@
 #include "worker.h"
 #include "filters.h"
+#include "pipeline.h"
+#include "pipeline16.h"
 #include "ipc_manager.h"
 #include "sync_manager.h"
 
@@ -27,8 +29,96 @@ void update_stats(shared_stats_t *stats, int success, double elapsed_time) {
     mutex_unlock(&stats->mutex);
 }
 
-// Processa uma imagem: carrega, cria threads para filtros, salva
-int process_image(worker_context_t *ctx, const char *filename) {
+// Registra o resultado da imagem no relatório (memória compartilhada)
+static void update_report(shared_stats_t *stats, int task_id, const pipeline_t *pipeline) {
+    if (task_id < 0 || task_id >= MAX_IMAGES) return;
+
+    image_report_t report = { .num_blobs = -1, .num_matches = -1, .golden_defects = -1,
+                              .num_classes = -1 };
+    if (pipeline->blobs) {
+        const blob_set_t *bs = &pipeline->blob_set;
+        report.num_blobs = bs->num_blobs;
+        for (int i = 0; i < bs->num_blobs; i++) {
+            report.blob_area += bs->blobs[i].area;
+            report.largest_blob = MAX(report.largest_blob, bs->blobs[i].area);
+        }
+    }
+    if (pipeline->has_stats) {
+        report.channels = pipeline->channels;
+        for (int k = 0; k < pipeline->channels; k++) {
+            channel_stats_from_hist(pipeline->channel_hist[k], &report.channel[k]);
+        }
+    }
+    if (pipeline->match) {
+        report.num_matches = pipeline->matches.count;
+        for (int i = 0; i < pipeline->matches.count; i++) {
+            report.best_match = MAX(report.best_match, pipeline->matches.items[i].score);
+        }
+    }
+    if (pipeline->golden) {
+        report.golden_defects = pipeline->golden_defects;
+        report.golden_pixels = (long)pipeline->width * pipeline->height;
+    }
+    if (pipeline->classify) {
+        report.num_classes = pipeline->class_lut->classes;
+        memcpy(report.class_counts, pipeline->class_counts, sizeof(report.class_counts));
+    }
+
+    mutex_lock(&stats->mutex);
+    stats->reports[task_id] = report;
+    mutex_unlock(&stats->mutex);
+}
+
+// Salva as saídas em paralelo (uma thread por saída). Retorna 1 se todas ok
+static int save_outputs(worker_context_t *ctx, const char *filename, const char *basename,
+                        const pipeline_output_t *const *outputs, int num_outputs) {
+    pthread_t threads[2 * PIPELINE_MAX_OUTPUTS];
+    thread_args_t args[2 * PIPELINE_MAX_OUTPUTS];
+    int created[2 * PIPELINE_MAX_OUTPUTS] = {0};
+    int all_success = 1;
+    
+    for (int i = 0; i < num_outputs; i++) {
+        const pipeline_output_t *out = outputs[i];
+        args[i].image_data = out->data;
+        args[i].width = out->width;
+        args[i].height = out->height;
+        args[i].channels = out->channels;
+        args[i].depth = out->depth;
+        args[i].filter_type = out->filter_type;
+        args[i].thread_id = i;
+        args[i].worker_id = ctx->worker_id;
+        args[i].success = 0;
+        
+        strncpy(args[i].input_file, filename, MAX_FILENAME - 1);
+        // JPEG só tem 8 bits: saídas de 16 bits vão para PNG
+        snprintf(args[i].output_file, sizeof(args[i].output_file),
+                 "%s/%s_%s.%s", OUTPUT_DIR, basename, out->name,
+                 out->depth == 16 ? "png" : "jpg");
+        
+        if (pthread_create(&threads[i], NULL, thread_save_output, &args[i]) != 0) {
+            LOG_ERROR("Worker %d: Falha ao criar thread %d", ctx->worker_id, i);
+        } else {
+            created[i] = 1;
+        }
+    }
+    
+    // Aguarda todas as threads terminarem
+    for (int i = 0; i < num_outputs; i++) {
+        if (created[i]) pthread_join(threads[i], NULL);
+        
+        const char *name = outputs[i]->name;
+        if (args[i].success) {
+            LOG_WORKER(ctx->worker_id, "  Thread %d: %s ✓", i, name);
+        } else {
+            LOG_WORKER(ctx->worker_id, "  Thread %d: %s ✗", i, name);
+            all_success = 0;
+        }
+    }
+    return all_success;
+}
+
+// Processa uma imagem: carrega, aplica o passo fundido, salva saídas em threads
+int process_image(worker_context_t *ctx, const char *filename, int task_id) {
     struct timespec start, end;
     clock_gettime(CLOCK_MONOTONIC, &start);
     
@@ -38,13 +128,21 @@ int process_image(worker_context_t *ctx, const char *filename) {
     // Adquire semáforo para I/O (leitura)
     sem_acquire(ctx->io_sem);
     
-    // Carrega imagem
+    // Carrega imagem: PNG de 16 bits por amostra segue o caminho de 16 bits,
+    // as demais mantêm o caminho de 8 bits
     int width, height, channels;
-    unsigned char *image = load_image(input_path, &width, &height, &channels);
+    unsigned char *image = NULL;
+    uint16_t *image16 = NULL;
+    int depth16 = image_is_16_bit(input_path);
+    if (depth16) {
+        image16 = load_image_16(input_path, &width, &height, &channels);
+    } else {
+        image = load_image(input_path, &width, &height, &channels);
+    }
     
     sem_release(ctx->io_sem);
     
-    if (!image) {
+    if (!image && !image16) {
         char log_msg[256];
         snprintf(log_msg, sizeof(log_msg), "Falha ao carregar: %s", filename);
         send_log(ctx->pipe_fd, ctx->worker_id, log_msg);
@@ -52,57 +150,93 @@ int process_image(worker_context_t *ctx, const char *filename) {
         return -1;
     }
     
-    LOG_WORKER(ctx->worker_id, "Processando: %s (%dx%d)", filename, width, height);
+    LOG_WORKER(ctx->worker_id, "Processando: %s (%dx%d%s)", filename, width, height,
+               depth16 ? ", 16 bits" : "");
     
     // Prepara nome base para saída
     char basename[MAX_FILENAME];
     get_basename(filename, basename);
     remove_extension(basename);
     
-    // Configura argumentos para as 3 threads
-    pthread_t threads[NUM_THREADS];
-    thread_args_t args[NUM_THREADS];
-    
-    const char *filter_names[] = {"grayscale", "blur", "resize"};
-    void* (*filter_funcs[])(void*) = {thread_grayscale, thread_blur, thread_resize};
-    
-    for (int i = 0; i < NUM_THREADS; i++) {
-        args[i].image_data = image;
-        args[i].width = width;
-        args[i].height = height;
-        args[i].channels = channels;
-        args[i].filter_type = i;
-        args[i].thread_id = i;
-        args[i].worker_id = ctx->worker_id;
-        args[i].success = 0;
+    // 16 bits: filtros com variante de 16 bits sobre a origem completa; os
+    // demais (e as estatísticas) no passo fundido sobre o byte alto
+    pipeline16_t pipeline16;
+    pipeline_config_t config16;
+    const pipeline_config_t *config = ctx->config;
+    memset(&pipeline16, 0, sizeof(pipeline16));
+    if (depth16) {
+        int failed = pipeline16_init(&pipeline16, image16, width, height, channels,
+                                     ctx->config, ctx->resources) != 0 ||
+                     pipeline16_run(&pipeline16, ctx->pool) != 0;
         
-        strncpy(args[i].input_file, filename, MAX_FILENAME - 1);
-        snprintf(args[i].output_file, sizeof(args[i].output_file),
-                 "%s/%s_%s.jpg", OUTPUT_DIR, basename, filter_names[i]);
+        config16 = *ctx->config;
+        config16.filters &= ~PIPELINE16_FILTERS;
+        config = &config16;
+        size_t n = (size_t)width * height * channels;
+        if (!failed && (config16.filters || config16.image_stats)) {
+            failed = (image = (unsigned char*)malloc(n)) == NULL;
+            if (!failed) reduce_u16(image16, image, n);
+        }
+        free_image((unsigned char*)image16);
+        
+        if (failed) {
+            LOG_ERROR("Worker %d: Falha no pipeline de 16 bits (%s)", ctx->worker_id, filename);
+            pipeline16_free(&pipeline16);
+            free(image);
+            update_stats(ctx->stats, 0, 0);
+            return -1;
+        }
     }
     
-    // Cria as 3 threads de filtro
-    for (int i = 0; i < NUM_THREADS; i++) {
-        if (pthread_create(&threads[i], NULL, filter_funcs[i], &args[i]) != 0) {
-            LOG_ERROR("Worker %d: Falha ao criar thread %d", ctx->worker_id, i);
-        }
+    // Passo fundido: todos os filtros habilitados em uma única leitura da origem,
+    // com a imagem dividida em faixas entre as threads do pool
+    pipeline_t pipeline;
+    memset(&pipeline, 0, sizeof(pipeline));
+    if (image && (pipeline_init(&pipeline, image, width, height, channels, config,
+                                ctx->resources) != 0 ||
+                  pipeline_run(&pipeline, ctx->pool) != 0)) {
+        LOG_ERROR("Worker %d: Falha no pipeline (%s)", ctx->worker_id, filename);
+        pipeline_free(&pipeline);
+        pipeline16_free(&pipeline16);
+        if (depth16) free(image); else free_image(image);
+        update_stats(ctx->stats, 0, 0);
+        return -1;
     }
     
-    // Aguarda todas as threads terminarem
+    // Libera imagem original ou a redução a 8 bits (saídas já estão prontas)
+    if (depth16) free(image); else free_image(image);
+    
+    // Medidas de cada blob em CSV; resumo no relatório da execução
     int all_success = 1;
-    for (int i = 0; i < NUM_THREADS; i++) {
-        pthread_join(threads[i], NULL);
-        
-        if (args[i].success) {
-            LOG_WORKER(ctx->worker_id, "  Thread %d: %s ✓", i, filter_names[i]);
-        } else {
-            LOG_WORKER(ctx->worker_id, "  Thread %d: %s ✗", i, filter_names[i]);
+    if (pipeline.blobs) {
+        char csv_path[MAX_PATH];
+        snprintf(csv_path, sizeof(csv_path), "%s/%s_blobs.csv", OUTPUT_DIR, basename);
+        if (blob_write_csv(&pipeline.blob_set, csv_path) != 0) all_success = 0;
+    }
+    if (pipeline.match) {
+        char csv_path[MAX_PATH];
+        snprintf(csv_path, sizeof(csv_path), "%s/%s_match.csv", OUTPUT_DIR, basename);
+        if (match_write_csv(&pipeline.matches, &pipeline.resources->templates, csv_path) != 0) {
             all_success = 0;
         }
     }
+    update_report(ctx->stats, task_id, &pipeline);
     
-    // Libera imagem original
-    free_image(image);
+    // Saídas dos dois pipelines; a máscara que o passo fundido monta para
+    // blobs/morfologia não é salva quando o threshold de 16 bits já existe
+    const pipeline_output_t *outputs[2 * PIPELINE_MAX_OUTPUTS];
+    int num_outputs = 0;
+    for (int i = 0; i < pipeline16.num_outputs; i++) {
+        outputs[num_outputs++] = &pipeline16.outputs[i];
+    }
+    for (int i = 0; i < pipeline.num_outputs; i++) {
+        if (pipeline16.threshold && pipeline.outputs[i].filter_type == FILTER_THRESHOLD) continue;
+        outputs[num_outputs++] = &pipeline.outputs[i];
+    }
+    if (!save_outputs(ctx, filename, basename, outputs, num_outputs)) all_success = 0;
+    
+    pipeline_free(&pipeline);
+    pipeline16_free(&pipeline16);
     
     clock_gettime(CLOCK_MONOTONIC, &end);
     double elapsed = get_time_diff(start, end);
@@ -121,7 +255,8 @@ int process_image(worker_context_t *ctx, const char *filename) {
 }
 
 // Função principal do worker
-void worker_main(int worker_id, int pipe_fd) {
+void worker_main(int worker_id, int pipe_fd, const pipeline_config_t *config,
+                 const calib_t *calib, const class_lut_t *class_lut) {
     LOG_WORKER(worker_id, "PID %d iniciado", getpid());
     
     // Conecta aos recursos IPC
@@ -146,13 +281,45 @@ void worker_main(int worker_id, int pipe_fd) {
         exit(1);
     }
     
+    // Pool de threads para as faixas de cada imagem
+    thread_pool_t pool;
+    if (thread_pool_init(&pool, config->num_threads) != 0) {
+        LOG_ERROR("Worker %d: Falha ao criar pool de threads", worker_id);
+        close_semaphore(io_sem);
+        cleanup_ipc_worker(mq, stats, shm_fd);
+        exit(1);
+    }
+    
+    // Templates e demais dados de apoio: decodificados uma vez, usados por
+    // todas as imagens do worker. Em caso de falha o worker segue consumindo
+    // a fila: as imagens que dependem dos recursos falham no relatório
+    pipeline_resources_t resources;
+    if (pipeline_resources_load(&resources, config) != 0) {
+        LOG_ERROR("Worker %d: Falha ao carregar recursos do pipeline", worker_id);
+    }
+    // Calibração já decodificada pelo coordenador: páginas compartilhadas
+    resources.calib = calib && calib->active ? calib : NULL;
+    // Referências golden: objeto do coordenador mapeado somente leitura
+    golden_set_t golden;
+    memset(&golden, 0, sizeof(golden));
+    golden.fd = -1;
+    if ((config->filters & FILTER_BIT(FILTER_GOLDEN)) && golden_open(&golden) != 0) {
+        LOG_ERROR("Worker %d: Falha ao abrir referências golden", worker_id);
+    }
+    resources.golden = golden.header ? &golden : NULL;
+    // LUT de classes montada pelo coordenador: páginas compartilhadas
+    resources.class_lut = class_lut && class_lut->active ? class_lut : NULL;
+    
     // Contexto do worker
     worker_context_t ctx = {
         .worker_id = worker_id,
         .msg_queue = mq,
         .stats = stats,
         .io_sem = io_sem,
-        .pipe_fd = pipe_fd
+        .pipe_fd = pipe_fd,
+        .config = config,
+        .pool = &pool,
+        .resources = &resources
     };
     
     // Marca como ativo
@@ -180,7 +347,7 @@ void worker_main(int worker_id, int pipe_fd) {
         mutex_unlock(&stats->mutex);
         
         // Processa a imagem
-        process_image(&ctx, msg.filename);
+        process_image(&ctx, msg.filename, msg.task_id);
         
         // Volta para idle
         mutex_lock(&stats->mutex);
@@ -196,6 +363,9 @@ void worker_main(int worker_id, int pipe_fd) {
     mutex_unlock(&stats->mutex);
     
     // Limpeza
+    pipeline_resources_free(&resources);
+    golden_close(&golden);
+    thread_pool_destroy(&pool);
     close_semaphore(io_sem);
     cleanup_ipc_worker(mq, stats, shm_fd);
     close(pipe_fd);
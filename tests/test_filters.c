@@ -0,0 +1,750 @@
+#include "test_util.h"
+#include "simd_kernels.h"
+#include "filters.h"
+#include "integral.h"
+#include "planar.h"
+#include "resize.h"
+#include "blobs.h"
+#include "canny.h"
+#include <math.h>
+
+// Filtros de imagem inteira (caminho planar, SIMD e faixas) contra
+// implementações ingênuas, byte a byte, em cada nível SIMD disponível.
+
+static const char *level_name;
+
+typedef struct { int w, h; } dims_t;
+
+// Tamanhos que cruzam larguras de vetor, imagens de 1 pixel e raios maiores que a imagem
+static const dims_t sizes[] = {
+    { 1, 1 }, { 1, 9 }, { 9, 1 }, { 7, 5 }, { 37, 29 }, { 130, 41 }, { 301, 17 }
+};
+#define NUM_SIZES ((int)(sizeof(sizes) / sizeof(sizes[0])))
+
+#define SAME_IMG(a, b, bytes, what, w, h, c, r)                                 \
+    CHECK(memcmp((a), (b), (bytes)) == 0, "%s %s (%dx%d c=%d r=%d)",            \
+          (what), level_name, (w), (h), (c), (r))
+
+// ============================================================
+// BOX BLUR
+// ============================================================
+// Referência: soma direta da janela truncada nas bordas e média
+// arredondada (soma + n/2) / n
+
+static void naive_blur(const unsigned char *src, unsigned char *dst,
+                       int w, int h, int c, int r) {
+    for (int y = 0; y < h; y++) {
+        int y0 = MAX(0, y - r), y1 = MIN(h - 1, y + r);
+        for (int x = 0; x < w; x++) {
+            int x0 = MAX(0, x - r), x1 = MIN(w - 1, x + r);
+            uint32_t n = (uint32_t)(y1 - y0 + 1) * (uint32_t)(x1 - x0 + 1);
+            for (int ch = 0; ch < c; ch++) {
+                uint32_t sum = 0;
+                for (int yy = y0; yy <= y1; yy++)
+                    for (int xx = x0; xx <= x1; xx++)
+                        sum += src[((size_t)yy * w + xx) * c + ch];
+                dst[((size_t)y * w + x) * c + ch] = (unsigned char)((sum + n / 2) / n);
+            }
+        }
+    }
+}
+
+static void naive_blur_u16(const uint16_t *src, uint16_t *dst, int w, int h, int c, int r) {
+    for (int y = 0; y < h; y++) {
+        int y0 = MAX(0, y - r), y1 = MIN(h - 1, y + r);
+        for (int x = 0; x < w; x++) {
+            int x0 = MAX(0, x - r), x1 = MIN(w - 1, x + r);
+            uint64_t n = (uint64_t)(y1 - y0 + 1) * (uint64_t)(x1 - x0 + 1);
+            for (int ch = 0; ch < c; ch++) {
+                uint64_t sum = 0;
+                for (int yy = y0; yy <= y1; yy++)
+                    for (int xx = x0; xx <= x1; xx++)
+                        sum += src[((size_t)yy * w + xx) * c + ch];
+                dst[((size_t)y * w + x) * c + ch] = (uint16_t)((sum + n / 2) / n);
+            }
+        }
+    }
+}
+
+static const int blur_radii[] = { 0, 1, 2, 3, 7, 20, BLUR_MAX_RADIUS };
+
+static void test_blur(void) {
+    for (int s = 0; s < NUM_SIZES; s++) {
+        int w = sizes[s].w, h = sizes[s].h;
+        for (int c = 1; c <= MAX_CHANNELS; c++) {
+            size_t bytes = (size_t)w * h * c;
+            unsigned char *src = (unsigned char*)test_alloc(bytes);
+            unsigned char *a = (unsigned char*)test_alloc(bytes);
+            unsigned char *b = (unsigned char*)test_alloc(bytes);
+            test_fill(src, bytes);
+
+            for (size_t i = 0; i < sizeof(blur_radii) / sizeof(blur_radii[0]); i++) {
+                int r = blur_radii[i];
+                naive_blur(src, a, w, h, c, r);
+                CHECK(apply_blur(src, b, w, h, c, r) == 0, "apply_blur falhou");
+                SAME_IMG(a, b, bytes, "apply_blur", w, h, c, r);
+            }
+            free(src);
+            free(a);
+            free(b);
+        }
+    }
+}
+
+// Média local pela imagem integral (limiar adaptativo): mesmo arredondamento
+static void test_integral_mean(void) {
+    for (int s = 0; s < NUM_SIZES; s++) {
+        int w = sizes[s].w, h = sizes[s].h;
+        size_t bytes = (size_t)w * h;
+        unsigned char *src = (unsigned char*)test_alloc(bytes);
+        unsigned char *a = (unsigned char*)test_alloc(bytes);
+        unsigned char *b = (unsigned char*)test_alloc(bytes);
+        uint32_t *tmp = (uint32_t*)test_alloc((size_t)w * sizeof(uint32_t));
+        test_fill(src, bytes);
+
+        integral_t ii;
+        if (integral_init(&ii, w, h, 0) != 0) {
+            CHECK(0, "integral_init falhou");
+        } else {
+            integral_build(&ii, src);
+            for (size_t i = 0; i < sizeof(blur_radii) / sizeof(blur_radii[0]); i++) {
+                int r = blur_radii[i];
+                naive_blur(src, a, w, h, 1, r);
+                for (int y = 0; y < h; y++) {
+                    integral_box_mean_row(&ii, y, r, tmp, b + (size_t)y * w);
+                }
+                SAME_IMG(a, b, bytes, "integral_box_mean_row", w, h, 1, r);
+            }
+            integral_free(&ii);
+        }
+        free(src);
+        free(a);
+        free(b);
+        free(tmp);
+    }
+}
+
+// Montagem em faixas (pipeline: cada tile monta suas linhas a partir de
+// zero) e junção, contra a tabela serial. Até MAX_INTEGRAL_BANDS faixas,
+// mais que a altura das imagens baixas (faixas vazias)
+#define MAX_INTEGRAL_BANDS  8
+
+static void test_integral_bands(void) {
+    thread_pool_t pool;
+    if (thread_pool_init(&pool, 3) != 0) {
+        CHECK(0, "thread_pool_init falhou");
+        return;
+    }
+    for (int s = 0; s < NUM_SIZES; s++) {
+        int w = sizes[s].w, h = sizes[s].h;
+        unsigned char *src = (unsigned char*)test_alloc((size_t)w * h);
+        test_fill(src, (size_t)w * h);
+
+        integral_t ref, ii;
+        if (integral_init(&ref, w, h, 1) != 0 || integral_init(&ii, w, h, 1) != 0) {
+            CHECK(0, "integral_init falhou");
+            integral_free(&ref);
+            free(src);
+            continue;
+        }
+        integral_build(&ref, src);
+        size_t entries = (size_t)(h + 1) * ref.stride;
+
+        for (int bands = 1; bands <= MAX_INTEGRAL_BANDS; bands++) {
+            for (int serial = 0; serial <= 1; serial++) {
+                // Lixo nas linhas montadas: toda entrada precisa ser escrita
+                memset(ii.sum + ii.stride, 0xAB, (entries - ii.stride) * sizeof(uint32_t));
+                memset(ii.sqsum + ii.stride, 0xAB, (entries - ii.stride) * sizeof(uint64_t));
+
+                // Faixas em ordem inversa: nenhuma depende da anterior antes da junção
+                for (int b = bands - 1; b >= 0; b--) {
+                    int b0 = h * b / bands, b1 = h * (b + 1) / bands;
+                    integral_rows(&ii, src + (size_t)b0 * w, b0, b1 - b0, b0);
+                }
+                CHECK(integral_merge_bands(&ii, bands, serial ? NULL : &pool) == 0,
+                      "integral_merge_bands falhou");
+                CHECK(memcmp(ref.sum, ii.sum, entries * sizeof(uint32_t)) == 0 &&
+                      memcmp(ref.sqsum, ii.sqsum, entries * sizeof(uint64_t)) == 0,
+                      "integral em %d faixas %s %s (%dx%d)", bands,
+                      serial ? "serial" : "no pool", level_name, w, h);
+            }
+        }
+        integral_free(&ref);
+        integral_free(&ii);
+        free(src);
+    }
+    thread_pool_destroy(&pool);
+}
+
+// Blur de 16 bits em faixas de linhas (como no pipeline com threads)
+static void test_blur_u16(void) {
+    for (int s = 0; s < NUM_SIZES; s++) {
+        int w = sizes[s].w, h = sizes[s].h;
+        for (int c = 1; c <= MAX_CHANNELS; c++) {
+            size_t n = (size_t)w * h * c;
+            uint16_t *src = (uint16_t*)test_alloc(n * sizeof(uint16_t));
+            uint16_t *a = (uint16_t*)test_alloc(n * sizeof(uint16_t));
+            uint16_t *b = (uint16_t*)test_alloc(n * sizeof(uint16_t));
+            for (size_t i = 0; i < n; i++) src[i] = (uint16_t)test_rand();
+
+            for (size_t i = 0; i < sizeof(blur_radii) / sizeof(blur_radii[0]); i++) {
+                int r = blur_radii[i];
+                naive_blur_u16(src, a, w, h, c, r);
+                int split = h / 3;
+                CHECK(blur_rows_u16(src, b, w, h, c, r, 0, split) == 0 &&
+                      blur_rows_u16(src, b + (size_t)split * w * c, w, h, c, r, split, h) == 0,
+                      "blur_rows_u16 falhou");
+                SAME_IMG(a, b, n * sizeof(uint16_t), "blur_rows_u16", w, h, c, r);
+            }
+            free(src);
+            free(a);
+            free(b);
+        }
+    }
+}
+
+// ============================================================
+// PLANOS E FAIXAS
+// ============================================================
+// O pipeline separa cada faixa em planos (planar_load_rows) e alimenta
+// uma instância de stream por faixa de saída; aqui a imagem é dividida
+// em NUM_BANDS faixas da mesma forma.
+
+#define NUM_BANDS   3
+
+static void test_planar_roundtrip(void) {
+    for (int it = 0; it < 32; it++) {
+        int w = test_odd_len(301);
+        for (int c = 1; c <= MAX_CHANNELS; c++) {
+            size_t bytes = (size_t)w * c;
+            size_t stride = planar_stride(w);
+            unsigned char *src = (unsigned char*)test_alloc(bytes);
+            unsigned char *back = (unsigned char*)test_alloc(bytes);
+            unsigned char *planes = (unsigned char*)planar_alloc(stride * c);
+            if (!planes) {
+                CHECK(0, "planar_alloc falhou");
+                free(src);
+                free(back);
+                continue;
+            }
+            test_fill(src, bytes);
+
+            planar_split_row(src, planes, w, c);
+            int ok = ((uintptr_t)planes % PLANAR_ALIGN) == 0;
+            for (int ch = 0; ch < c; ch++) {
+                for (int x = 0; x < w; x++) {
+                    ok &= planes[ch * stride + x] == src[(size_t)x * c + ch];
+                }
+                for (size_t x = w; x < stride; x++) ok &= planes[ch * stride + x] == 0;
+            }
+            CHECK(ok, "planar_split_row %s (w=%d c=%d)", level_name, w, c);
+
+            planar_merge_row(planes, back, w, c);
+            SAME_IMG(src, back, bytes, "planar_merge_row", w, 1, c, 0);
+            free(src);
+            free(back);
+            free(planes);
+        }
+    }
+}
+
+static void blur_banded(const planar_t *pl, unsigned char *dst, int h, int r) {
+    for (int b = 0; b < NUM_BANDS; b++) {
+        blur_stream_t bs;
+        int b0 = h * b / NUM_BANDS, b1 = h * (b + 1) / NUM_BANDS;
+        if (blur_stream_init(&bs, pl->width, h, pl->channels, r, b0, b1) != 0) {
+            CHECK(0, "blur_stream_init falhou");
+            continue;
+        }
+        for (int y = 0; y < h; y++) blur_stream_push(&bs, planar_row(pl, y), y, dst);
+        blur_stream_free(&bs);
+    }
+}
+
+static void test_blur_bands(void) {
+    for (int s = 0; s < NUM_SIZES; s++) {
+        int w = sizes[s].w, h = sizes[s].h;
+        for (int c = 1; c <= MAX_CHANNELS; c++) {
+            size_t bytes = (size_t)w * h * c;
+            unsigned char *src = (unsigned char*)test_alloc(bytes);
+            unsigned char *a = (unsigned char*)test_alloc(bytes);
+            unsigned char *b = (unsigned char*)test_alloc(bytes);
+            test_fill(src, bytes);
+
+            planar_t pl;
+            if (planar_init(&pl, w, h, c) != 0) {
+                CHECK(0, "planar_init falhou");
+            } else {
+                planar_load_rows(&pl, src, 0, h);
+                for (size_t i = 0; i < sizeof(blur_radii) / sizeof(blur_radii[0]); i++) {
+                    int r = blur_radii[i];
+                    naive_blur(src, a, w, h, c, r);
+                    memset(b, 0, bytes);
+                    blur_banded(&pl, b, h, r);
+                    SAME_IMG(a, b, bytes, "blur_stream em faixas", w, h, c, r);
+                }
+                planar_free(&pl);
+            }
+            free(src);
+            free(a);
+            free(b);
+        }
+    }
+}
+
+// ============================================================
+// RESIZE
+// ============================================================
+// Referência: os coeficientes do plano aplicados direto à imagem
+// intercalada, canal a canal (passo vertical em Q7, depois horizontal)
+
+static void naive_resize(const resize_plan_t *plan, const unsigned char *src, int c,
+                         unsigned char *dst) {
+    const resize_axis_t *ax = &plan->x, *ay = &plan->y;
+    const int shift = RESIZE_COEF_BITS + RESIZE_INTER_BITS;
+    int16_t *v = (int16_t*)test_alloc((size_t)plan->src_w * sizeof(int16_t));
+
+    for (int y = 0; y < plan->dst_h; y++) {
+        const int16_t *wy = ay->weight + (size_t)y * ay->taps;
+        for (int ch = 0; ch < c; ch++) {
+            for (int sx = 0; sx < plan->src_w; sx++) {
+                int acc = 1 << (RESIZE_VERT_SHIFT - 1);
+                for (int k = 0; k < ay->taps; k++) {
+                    acc += wy[k] * src[((size_t)(ay->offset[y] + k) * plan->src_w + sx) * c + ch];
+                }
+                v[sx] = (int16_t)(acc >> RESIZE_VERT_SHIFT);
+            }
+            for (int x = 0; x < plan->dst_w; x++) {
+                const int16_t *wx = ax->weight + (size_t)x * ax->taps;
+                int acc = 0;
+                for (int k = 0; k < ax->taps; k++) acc += wx[k] * v[ax->offset[x] + k];
+                int out = (acc + (1 << (shift - 1))) >> shift;
+                dst[((size_t)y * plan->dst_w + x) * c + ch] = (unsigned char)MIN(out, 255);
+            }
+        }
+    }
+    free(v);
+}
+
+typedef struct { int sw, sh, dw, dh; } resize_case_t;
+
+// Ampliação, redução e eixos de 1 pixel. Em modo área, as escalas
+// horizontais 1.5, 2.1, 3.0 e 43 levam a 3, 4, 5 e 44 taps: junto com
+// vizinho (1) e bilinear (2) passam por todas as variantes especializadas
+// do passo horizontal e pela genérica
+static const resize_case_t resize_cases[] = {
+    { 37, 29, 64, 48 }, { 45, 30, 30, 20 }, { 130, 41, 61, 19 }, { 301, 17, 100, 9 },
+    { 301, 17, 7, 3 }, { 9, 1, 20, 3 }, { 1, 9, 5, 2 }, { 64, 64, 64, 64 }
+};
+
+// Variantes do passo horizontal por número de taps (1 a 4; 5 = genérica)
+#define RESIZE_TAP_VARIANTS     5
+
+static void resize_banded(const planar_t *pl, const resize_plan_t *plan, int h,
+                          unsigned char *dst) {
+    for (int b = 0; b < NUM_BANDS; b++) {
+        resize_stream_t rs;
+        int b0 = plan->dst_h * b / NUM_BANDS, b1 = plan->dst_h * (b + 1) / NUM_BANDS;
+        if (resize_stream_init(&rs, plan, pl->channels, b0, b1) != 0) {
+            CHECK(0, "resize_stream_init falhou");
+            continue;
+        }
+        for (int y = 0; y < h; y++) resize_stream_push(&rs, planar_row(pl, y), y, dst);
+        resize_stream_free(&rs);
+    }
+}
+
+static void test_resize(void) {
+    int seen[RESIZE_TAP_VARIANTS + 1][MAX_CHANNELS + 1] = { { 0 } };
+
+    for (size_t i = 0; i < sizeof(resize_cases) / sizeof(resize_cases[0]); i++) {
+        const resize_case_t *rc = &resize_cases[i];
+        for (int mode = RESIZE_NEAREST; mode <= RESIZE_AREA; mode++) {
+            resize_plan_t *plan = resize_plan_get(rc->sw, rc->sh, rc->dw, rc->dh,
+                                                  (resize_mode_t)mode);
+            if (!plan) {
+                CHECK(0, "resize_plan_get falhou");
+                continue;
+            }
+            for (int c = 1; c <= MAX_CHANNELS; c++) {
+                size_t src_bytes = (size_t)rc->sw * rc->sh * c;
+                size_t dst_bytes = (size_t)rc->dw * rc->dh * c;
+                unsigned char *src = (unsigned char*)test_alloc(src_bytes);
+                unsigned char *a = (unsigned char*)test_alloc(dst_bytes);
+                unsigned char *b = NULL;
+                test_fill(src, src_bytes);
+                naive_resize(plan, src, c, a);
+                seen[MIN(plan->x.taps, RESIZE_TAP_VARIANTS)][c] = 1;
+
+                CHECK(apply_resize(src, rc->sw, rc->sh, c, &b, rc->dw, rc->dh, mode) == 0,
+                      "apply_resize falhou");
+                if (b) SAME_IMG(a, b, dst_bytes, "apply_resize", rc->sw, rc->sh, c, mode);
+
+                planar_t pl;
+                if (b && planar_init(&pl, rc->sw, rc->sh, c) == 0) {
+                    planar_load_rows(&pl, src, 0, rc->sh);
+                    memset(b, 0, dst_bytes);
+                    resize_banded(&pl, plan, rc->sh, b);
+                    SAME_IMG(a, b, dst_bytes, "resize_stream em faixas", rc->sw, rc->sh, c, mode);
+                    planar_free(&pl);
+                }
+                free(src);
+                free(a);
+                free(b);
+            }
+            resize_plan_release(plan);
+        }
+    }
+
+    for (int t = 1; t <= RESIZE_TAP_VARIANTS; t++) {
+        for (int c = 1; c <= MAX_CHANNELS; c++) {
+            CHECK(seen[t][c], "resize: variante de %d taps com %d canais não exercitada", t, c);
+        }
+    }
+}
+
+// ============================================================
+// MEDIANA
+// ============================================================
+// Referência: ordena a janela truncada nas bordas (contagem dos 256
+// níveis, recontada do zero a cada pixel) e toma o elemento n/2, a
+// mediana superior quando a janela tem número par de amostras
+
+static void naive_median(const unsigned char *src, unsigned char *dst,
+                         int w, int h, int c, int r) {
+    for (int y = 0; y < h; y++) {
+        int y0 = MAX(0, y - r), y1 = MIN(h - 1, y + r);
+        for (int x = 0; x < w; x++) {
+            int x0 = MAX(0, x - r), x1 = MIN(w - 1, x + r);
+            int n = (y1 - y0 + 1) * (x1 - x0 + 1);
+            for (int ch = 0; ch < c; ch++) {
+                int count[256] = { 0 };
+                for (int yy = y0; yy <= y1; yy++)
+                    for (int xx = x0; xx <= x1; xx++)
+                        count[src[((size_t)yy * w + xx) * c + ch]]++;
+                int v = 0, below = 0;
+                while (below + count[v] <= n / 2) below += count[v++];
+                dst[((size_t)y * w + x) * c + ch] = (unsigned char)v;
+            }
+        }
+    }
+}
+
+static void median_banded(const planar_t *pl, unsigned char *dst, int h, int r) {
+    for (int b = 0; b < NUM_BANDS; b++) {
+        median_stream_t ms;
+        int b0 = h * b / NUM_BANDS, b1 = h * (b + 1) / NUM_BANDS;
+        if (median_stream_init(&ms, pl->width, h, pl->channels, r, b0, b1) != 0) {
+            CHECK(0, "median_stream_init falhou");
+            continue;
+        }
+        for (int y = 0; y < h; y++) median_stream_push(&ms, planar_row(pl, y), y, dst);
+        median_stream_free(&ms);
+    }
+}
+
+static const int median_radii[] = { 0, 1, 2, 3, 5, 8, MEDIAN_MAX_RADIUS };
+
+static void test_median(void) {
+    for (int s = 0; s < NUM_SIZES; s++) {
+        int w = sizes[s].w, h = sizes[s].h;
+        for (int c = 1; c <= MAX_CHANNELS; c++) {
+            size_t bytes = (size_t)w * h * c;
+            unsigned char *src = (unsigned char*)test_alloc(bytes);
+            unsigned char *a = (unsigned char*)test_alloc(bytes);
+            unsigned char *b = (unsigned char*)test_alloc(bytes);
+            // Faixa estreita com valores espalhados: muitos empates na janela
+            for (size_t i = 0; i < bytes; i++) {
+                src[i] = (unsigned char)(test_range(0, 6) ? (uint32_t)test_range(100, 119) : test_rand());
+            }
+
+            planar_t pl;
+            if (planar_init(&pl, w, h, c) != 0) {
+                CHECK(0, "planar_init falhou");
+            } else {
+                planar_load_rows(&pl, src, 0, h);
+                for (size_t i = 0; i < sizeof(median_radii) / sizeof(median_radii[0]); i++) {
+                    int r = median_radii[i];
+                    naive_median(src, a, w, h, c, r);
+                    CHECK(apply_median(src, b, w, h, c, r) == 0, "apply_median falhou");
+                    SAME_IMG(a, b, bytes, "apply_median", w, h, c, r);
+                    memset(b, 0, bytes);
+                    median_banded(&pl, b, h, r);
+                    SAME_IMG(a, b, bytes, "median_stream em faixas", w, h, c, r);
+                }
+                planar_free(&pl);
+            }
+            free(src);
+            free(a);
+            free(b);
+        }
+    }
+}
+
+// ============================================================
+// BLOBS
+// ============================================================
+// Referência: flood fill serial (8-vizinhança) numerando os componentes
+// pela ordem de varredura do primeiro pixel; os de área < min_area são
+// descartados e os demais renumerados em sequência. Máscaras aleatórias e
+// formas em U/pente, que só se unem do outro lado das costuras das faixas.
+
+typedef struct {
+    long area;
+    int x0, y0, x1, y1;
+    double sx, sy;
+} ref_blob_t;
+
+// Retorna o número de componentes mantidos; labels: w × h, blobs: w × h entradas
+static int naive_blobs(const unsigned char *mask, int w, int h, int min_area,
+                       uint32_t *labels, ref_blob_t *blobs) {
+    int *stack = (int*)test_alloc((size_t)w * h * sizeof(int));
+    uint32_t *comp = (uint32_t*)test_alloc((size_t)w * h * sizeof(uint32_t));
+    uint32_t *final = (uint32_t*)test_alloc(((size_t)w * h + 1) * sizeof(uint32_t));
+    ref_blob_t *all = (ref_blob_t*)test_alloc(((size_t)w * h + 1) * sizeof(ref_blob_t));
+    uint32_t count = 0;
+
+    for (int start = 0; start < w * h; start++) {
+        if (!mask[start] || comp[start]) continue;
+        ref_blob_t *b = &all[++count];
+        b->x0 = b->x1 = start % w;
+        b->y0 = b->y1 = start / w;
+        int top = 0;
+        stack[top++] = start;
+        comp[start] = count;
+        while (top) {
+            int i = stack[--top], x = i % w, y = i / w;
+            b->area++;
+            b->sx += x;
+            b->sy += y;
+            b->x0 = MIN(b->x0, x);
+            b->x1 = MAX(b->x1, x);
+            b->y0 = MIN(b->y0, y);
+            b->y1 = MAX(b->y1, y);
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    int nx = x + dx, ny = y + dy;
+                    if (nx < 0 || nx >= w || ny < 0 || ny >= h) continue;
+                    int j = ny * w + nx;
+                    if (mask[j] && !comp[j]) {
+                        comp[j] = count;
+                        stack[top++] = j;
+                    }
+                }
+            }
+        }
+    }
+
+    int kept = 0;
+    for (uint32_t c = 1; c <= count; c++) {
+        if (all[c].area >= min_area) {
+            blobs[kept] = all[c];
+            final[c] = (uint32_t)++kept;
+        }
+    }
+    for (int i = 0; i < w * h; i++) labels[i] = final[comp[i]];
+
+    free(stack);
+    free(comp);
+    free(final);
+    free(all);
+    return kept;
+}
+
+enum { MASK_SPARSE, MASK_DENSE, MASK_COMBS, MASK_ZIGZAG, MASK_KINDS };
+
+static void blob_mask(unsigned char *mask, int w, int h, int kind) {
+    memset(mask, 0, (size_t)w * h);
+    switch (kind) {
+        case MASK_SPARSE:
+        case MASK_DENSE: {
+            int pct = kind == MASK_SPARSE ? 35 : 58;     // 58%: perto da percolação
+            for (int i = 0; i < w * h; i++) mask[i] = test_range(0, 99) < pct ? 255 : 0;
+            break;
+        }
+        case MASK_COMBS:
+            // Dentes verticais unidos só na última linha (U) ou só na primeira (∩)
+            for (int x = 0; x < w; x += 2) {
+                for (int y = 0; y < h; y++) mask[(size_t)y * w + x] = 255;
+            }
+            for (int x = 0; x < w / 2; x++) mask[(size_t)(h - 1) * w + x] = 255;
+            for (int x = w / 2; x < w; x++) mask[x] = 255;
+            break;
+        case MASK_ZIGZAG:
+            // Diagonais que descem e sobem (onda triangular): ligações só
+            // pelos cantos, com lacunas que separam os segmentos
+            for (int x = 0; x < w; x++) {
+                if (x % 9 >= 7) continue;
+                int period = 2 * (h - 1), t = period ? x % period : 0;
+                mask[(size_t)(t < h ? t : period - t) * w + x] = 255;
+            }
+            break;
+    }
+}
+
+static const int blob_tiles[] = { 1, 2, 3, 5, 8 };
+static const dims_t blob_sizes[] = { { 1, 17 }, { 17, 1 }, { 64, 48 }, { 37, 61 }, { 150, 23 } };
+
+static void test_blobs(void) {
+    thread_pool_t pool;
+    if (thread_pool_init(&pool, 4) != 0) {
+        CHECK(0, "thread_pool_init falhou");
+        return;
+    }
+    for (size_t s = 0; s < sizeof(blob_sizes) / sizeof(blob_sizes[0]); s++) {
+        int w = blob_sizes[s].w, h = blob_sizes[s].h;
+        unsigned char *mask = (unsigned char*)test_alloc((size_t)w * h);
+        uint32_t *ref_labels = (uint32_t*)test_alloc((size_t)w * h * sizeof(uint32_t));
+        ref_blob_t *ref = (ref_blob_t*)test_alloc((size_t)w * h * sizeof(ref_blob_t));
+
+        for (int kind = 0; kind < MASK_KINDS; kind++) {
+            blob_mask(mask, w, h, kind);
+            for (int min_area = 1; min_area <= 5; min_area += 4) {
+                int n = naive_blobs(mask, w, h, min_area, ref_labels, ref);
+
+                for (size_t t = 0; t < sizeof(blob_tiles) / sizeof(blob_tiles[0]); t++) {
+                    blob_set_t bs;
+                    if (blob_set_init(&bs, w, h) != 0 ||
+                        blob_label(&bs, mask, min_area, NULL, blob_tiles[t],
+                                   blob_tiles[t] > 1 ? &pool : NULL) != 0) {
+                        CHECK(0, "blob_label falhou");
+                        blob_set_free(&bs);
+                        continue;
+                    }
+                    int ok = bs.num_blobs == n &&
+                             memcmp(bs.labels, ref_labels, (size_t)w * h * sizeof(uint32_t)) == 0;
+                    for (int i = 0; ok && i < n; i++) {
+                        const blob_t *b = &bs.blobs[i];
+                        const ref_blob_t *r = &ref[i];
+                        ok = b->label == (uint32_t)(i + 1) && b->area == r->area &&
+                             b->x0 == r->x0 && b->y0 == r->y0 && b->x1 == r->x1 && b->y1 == r->y1 &&
+                             fabs(b->cx - r->sx / r->area) < 1e-9 &&
+                             fabs(b->cy - r->sy / r->area) < 1e-9;
+                    }
+                    CHECK(ok, "blob_label máscara %d em %d faixas: %d blobs, referência %d "
+                          "(%dx%d min_area=%d)", kind, blob_tiles[t], bs.num_blobs, n, w, h,
+                          min_area);
+                    blob_set_free(&bs);
+                }
+            }
+        }
+        free(mask);
+        free(ref_labels);
+        free(ref);
+    }
+    thread_pool_destroy(&pool);
+}
+
+// ============================================================
+// HISTERESE DO CANNY
+// ============================================================
+// Histerese em faixas contra a serial (1 faixa). A cadeia fraca em
+// zigue-zague diagonal atravessa as costuras várias vezes e só tem
+// semente forte na última faixa: cada travessia exige outra rodada de
+// costuras. O mapa aleatório (fracos perto da percolação) cobre
+// componentes que tocam as costuras em muitos pontos.
+
+#define HYST_W      200
+#define HYST_H      40
+
+// Linha da cadeia na coluna x: onda triangular, só passos diagonais
+static int zigzag_y(int x) {
+    const int period = 2 * (HYST_H - 1);
+    int t = x % period;
+    return t < HYST_H ? t : period - t;
+}
+
+static void hysteresis_map(unsigned char *map, int kind) {
+    memset(map, 0, (size_t)HYST_W * HYST_H);
+    if (kind == 0) {
+        int seed = 0;
+        for (int x = 0; x < HYST_W; x++) {
+            map[(size_t)zigzag_y(x) * HYST_W + x] = CANNY_WEAK;
+            if (zigzag_y(x) == HYST_H - 1) seed = (HYST_H - 1) * HYST_W + x;
+        }
+        map[seed] = CANNY_STRONG;      // Único forte: último vale, última faixa
+        // Fracos isolados, a mais de 2 linhas da cadeia: devem sumir
+        for (int x = 3; x < HYST_W; x += 11) {
+            int y = (zigzag_y(x) + HYST_H / 2) % HYST_H;
+            if (abs(y - zigzag_y(x)) > 2) map[(size_t)y * HYST_W + x] = CANNY_WEAK;
+        }
+    } else {
+        for (int i = 0; i < HYST_W * HYST_H; i++) {
+            int v = test_range(0, 99);
+            map[i] = v < 2 ? CANNY_STRONG : v < 40 ? CANNY_WEAK : 0;
+        }
+    }
+}
+
+static const int hyst_tiles[] = { 2, 3, 4, 7, 8 };
+
+static void test_hysteresis(void) {
+    thread_pool_t pool;
+    if (thread_pool_init(&pool, 4) != 0) {
+        CHECK(0, "thread_pool_init falhou");
+        return;
+    }
+    const size_t bytes = (size_t)HYST_W * HYST_H;
+    unsigned char *map = (unsigned char*)test_alloc(bytes);
+    unsigned char *a = (unsigned char*)test_alloc(bytes);
+    unsigned char *b = (unsigned char*)test_alloc(bytes);
+
+    for (int kind = 0; kind < 2; kind++) {
+        hysteresis_map(map, kind);
+        memcpy(a, map, bytes);
+        CHECK(canny_hysteresis(a, HYST_W, HYST_H, 1, NULL) == 0, "canny_hysteresis falhou");
+
+        if (kind == 0) {
+            // Referência serial: a cadeia inteira vira borda, o resto some
+            int ok = 1;
+            for (int y = 0; y < HYST_H; y++) {
+                for (int x = 0; x < HYST_W; x++) {
+                    ok &= a[(size_t)y * HYST_W + x] == (y == zigzag_y(x) ? 255 : 0);
+                }
+            }
+            CHECK(ok, "histerese serial não promoveu só a cadeia em zigue-zague");
+        }
+
+        for (size_t t = 0; t < sizeof(hyst_tiles) / sizeof(hyst_tiles[0]); t++) {
+            for (int serial = 0; serial <= 1; serial++) {
+                memcpy(b, map, bytes);
+                CHECK(canny_hysteresis(b, HYST_W, HYST_H, hyst_tiles[t],
+                                       serial ? NULL : &pool) == 0, "canny_hysteresis falhou");
+                CHECK(memcmp(a, b, bytes) == 0, "histerese mapa %d em %d faixas %s %s", kind,
+                      hyst_tiles[t], serial ? "serial" : "no pool", level_name);
+            }
+        }
+    }
+    free(map);
+    free(a);
+    free(b);
+    thread_pool_destroy(&pool);
+}
+
+// ============================================================
+// MAIN
+// ============================================================
+
+int main(void) {
+    const simd_level_t levels[3] = { SIMD_SCALAR, SIMD_SSSE3, SIMD_AVX2 };
+    for (int l = 0; l < 3; l++) {
+        level_name = cpu_simd_name(levels[l]);
+        if (cpu_set_simd_level(levels[l]) != levels[l]) {
+            printf("  %s indisponível nesta CPU: pulado\n", level_name);
+            continue;
+        }
+        simd_kernels_select(cpu_simd_level());
+
+        test_blur();
+        test_integral_mean();
+        test_integral_bands();
+        test_blur_u16();
+        test_planar_roundtrip();
+        test_blur_bands();
+        test_resize();
+        test_median();
+        test_blobs();
+        test_hysteresis();
+    }
+    return test_finish("test_filters");
+}
@@ -0,0 +1,724 @@
+#include "test_util.h"
+#include "simd_kernels.h"
+#include "classify.h"
+
+// Cada entrada de g_kernels no nível forçado (SSSE3, AVX2) contra a versão
+// escalar, bit a bit, em linhas aleatórias de comprimento ímpar. Os
+// kernels que aceitam src == dst também são chamados no lugar.
+
+#define ITERS       64      // Linhas aleatórias por kernel e nível
+#define MAX_LEN     301     // Comprimento máximo das linhas comuns
+#define PAD         64      // Folga após cada buffer (leituras além de n)
+
+static simd_kernels_t ref;  // Escalar
+static simd_kernels_t k;    // Nível em teste
+static const char *level_name;
+
+static unsigned char* rand_bytes(size_t n) {
+    unsigned char *p = (unsigned char*)test_alloc(n + PAD);
+    test_fill(p, n + PAD);
+    return p;
+}
+
+static int16_t* rand_i16(size_t n, int lo, int hi) {
+    int16_t *p = (int16_t*)test_alloc((n + PAD) * sizeof(int16_t));
+    for (size_t i = 0; i < n + PAD; i++) p[i] = (int16_t)test_range(lo, hi);
+    return p;
+}
+
+static uint16_t* rand_u16(size_t n, int lo, int hi) {
+    uint16_t *p = (uint16_t*)test_alloc((n + PAD) * sizeof(uint16_t));
+    for (size_t i = 0; i < n + PAD; i++) p[i] = (uint16_t)test_range(lo, hi);
+    return p;
+}
+
+#define SAME(a, b, bytes, what, n) \
+    CHECK(memcmp((a), (b), (bytes)) == 0, "%s %s (n=%d)", (what), level_name, (int)(n))
+
+// ============================================================
+// GRAYSCALE
+// ============================================================
+
+static void test_gray(void) {
+    for (int it = 0; it < ITERS; it++) {
+        int n = test_odd_len(MAX_LEN);
+        for (int c = 3; c <= 4; c++) {
+            size_t bytes = (size_t)n * c;
+            unsigned char *src = rand_bytes(bytes);
+            unsigned char *a = (unsigned char*)test_alloc(bytes + PAD);
+            unsigned char *b = (unsigned char*)test_alloc(bytes + PAD);
+            unsigned char *inplace = (unsigned char*)test_alloc(bytes + PAD);
+            memcpy(inplace, src, bytes);
+
+            gray_row_fn fr = c == 3 ? ref.gray_row_rgb : ref.gray_row_rgba;
+            gray_row_fn fk = c == 3 ? k.gray_row_rgb : k.gray_row_rgba;
+            fr(src, a, n);
+            fk(src, b, n);
+            fk(inplace, inplace, n);
+            SAME(a, b, bytes, "gray_row", n);
+            SAME(a, inplace, bytes, "gray_row no lugar", n);
+
+            memset(a, 0, n);
+            memset(b, 0, n);
+            (c == 3 ? ref.gray_plane_rgb : ref.gray_plane_rgba)(src, a, n);
+            (c == 3 ? k.gray_plane_rgb : k.gray_plane_rgba)(src, b, n);
+            SAME(a, b, n, "gray_plane", n);
+            for (int i = 0; i < n; i++) {
+                const unsigned char *p = src + (size_t)i * c;
+                CHECK(a[i] == gray_pixel(p[0], p[1], p[2]), "gray_plane escalar (i=%d)", i);
+            }
+            free(src);
+            free(a);
+            free(b);
+            free(inplace);
+        }
+    }
+}
+
+// ============================================================
+// BOX BLUR
+// ============================================================
+
+static void test_blur(void) {
+    for (int it = 0; it < ITERS; it++) {
+        int n = test_odd_len(MAX_LEN);
+
+        // Atualização vertical (aritmética módulo 2^32)
+        uint32_t *acc_a = (uint32_t*)test_alloc((n + PAD) * sizeof(uint32_t));
+        uint32_t *acc_b = (uint32_t*)test_alloc((n + PAD) * sizeof(uint32_t));
+        uint16_t *add = rand_u16(n, 0, 65535), *sub = rand_u16(n, 0, 65535);
+        for (int i = 0; i < n; i++) acc_a[i] = acc_b[i] = test_rand() >> 8;
+        ref.blur_addsub_row(acc_a, add, sub, n);
+        k.blur_addsub_row(acc_b, add, sub, n);
+        SAME(acc_a, acc_b, n * sizeof(uint32_t), "blur_addsub_row", n);
+
+        // Normalização: somas de janelas reais (área até 129 × 129), com
+        // múltiplos exatos e meios da área para exercitar o arredondamento
+        uint32_t area = (uint32_t)(test_range(1, 2 * BLUR_MAX_RADIUS + 1) *
+                                   test_range(1, 2 * BLUR_MAX_RADIUS + 1));
+        for (int i = 0; i < n; i++) {
+            uint32_t q = (uint32_t)test_range(0, 254);
+            switch (test_range(0, 3)) {
+                case 0:  acc_a[i] = q * area; break;
+                case 1:  acc_a[i] = q * area + (area - 1) / 2; break;
+                case 2:  acc_a[i] = q * area + (area + 1) / 2; break;
+                default: acc_a[i] = (uint32_t)test_range(0, (int)area * 255); break;
+            }
+        }
+        unsigned char *a = (unsigned char*)test_alloc(n + PAD), *b = (unsigned char*)test_alloc(n + PAD);
+        ref.blur_scale_row(acc_a, a, n, area);
+        k.blur_scale_row(acc_a, b, n, area);
+        SAME(a, b, n, "blur_scale_row", n);
+        for (int i = 0; i < n; i++) {
+            CHECK(a[i] == (acc_a[i] + area / 2) / area, "blur_scale_row escalar (%u/%u)",
+                  acc_a[i], area);
+        }
+
+        // Soma deslizante horizontal
+        int span = 2 * test_range(0, BLUR_MAX_RADIUS) + 1;
+        unsigned char *src = rand_bytes((size_t)n + span);
+        uint16_t *ha = rand_u16(n, 0, 0), *hb = rand_u16(n, 0, 0);
+        uint16_t sum = (uint16_t)test_rand();
+        uint16_t ra = ref.blur_hsum_row(src, span, ha, n, sum);
+        uint16_t rb = k.blur_hsum_row(src, span, hb, n, sum);
+        CHECK(ra == rb, "blur_hsum_row retorno %s (n=%d)", level_name, n);
+        SAME(ha, hb, n * sizeof(uint16_t), "blur_hsum_row", n);
+
+        free(acc_a);
+        free(acc_b);
+        free(add);
+        free(sub);
+        free(a);
+        free(b);
+        free(src);
+        free(ha);
+        free(hb);
+    }
+}
+
+// ============================================================
+// RESIZE
+// ============================================================
+
+static void test_resize(void) {
+    for (int it = 0; it < ITERS; it++) {
+        int n = test_odd_len(MAX_LEN);
+        int taps = test_range(1, 9);
+        unsigned char *rows[9];
+        int16_t weights[9];
+        int left = 1 << RESIZE_COEF_BITS;
+        for (int t = 0; t < taps; t++) {
+            rows[t] = rand_bytes(n);
+            weights[t] = (int16_t)(t + 1 < taps ? test_range(0, left) : left);
+            left -= weights[t];
+        }
+        int16_t *a = rand_i16(n, 0, 0), *b = rand_i16(n, 0, 0);
+        ref.resize_vert_row((const unsigned char *const *)rows, weights, taps, a, n);
+        k.resize_vert_row((const unsigned char *const *)rows, weights, taps, b, n);
+        SAME(a, b, n * sizeof(int16_t), "resize_vert_row", n);
+        for (int t = 0; t < taps; t++) free(rows[t]);
+        free(a);
+        free(b);
+    }
+}
+
+// ============================================================
+// SOBEL / CANNY
+// ============================================================
+
+static void test_sobel(void) {
+    for (int it = 0; it < ITERS; it++) {
+        int n = test_odd_len(MAX_LEN);
+        unsigned char *r0 = rand_bytes(n + 2), *r1 = rand_bytes(n + 2), *r2 = rand_bytes(n + 2);
+        int16_t *gxa = rand_i16(n, 0, 0), *gya = rand_i16(n, 0, 0);
+        int16_t *gxb = rand_i16(n, 0, 0), *gyb = rand_i16(n, 0, 0);
+        ref.sobel_row(r0, r1, r2, gxa, gya, n);
+        k.sobel_row(r0, r1, r2, gxb, gyb, n);
+        SAME(gxa, gxb, n * sizeof(int16_t), "sobel_row gx", n);
+        SAME(gya, gyb, n * sizeof(int16_t), "sobel_row gy", n);
+
+        // Saídas sobre gradientes quaisquer dentro de ±1020
+        int16_t *gx = rand_i16(n, -1020, 1020), *gy = rand_i16(n, -1020, 1020);
+        unsigned char *a = (unsigned char*)test_alloc(n + PAD), *b = (unsigned char*)test_alloc(n + PAD);
+        const sobel_out_fn outs_ref[3] = { ref.sobel_mag_l1, ref.sobel_mag_l2, ref.sobel_dir };
+        const sobel_out_fn outs_k[3] = { k.sobel_mag_l1, k.sobel_mag_l2, k.sobel_dir };
+        const char *names[3] = { "sobel_mag_l1", "sobel_mag_l2", "sobel_dir" };
+        for (int o = 0; o < 3; o++) {
+            outs_ref[o](gx, gy, a, n);
+            outs_k[o](gx, gy, b, n);
+            SAME(a, b, n, names[o], n);
+        }
+
+        int16_t *ma = rand_i16(n, 0, 0), *mb = rand_i16(n, 0, 0);
+        ref.grad_mag16_row(gx, gy, ma, n);
+        k.grad_mag16_row(gx, gy, mb, n);
+        SAME(ma, mb, n * sizeof(int16_t), "grad_mag16_row", n);
+
+        free(r0);
+        free(r1);
+        free(r2);
+        free(gxa);
+        free(gya);
+        free(gxb);
+        free(gyb);
+        free(gx);
+        free(gy);
+        free(a);
+        free(b);
+        free(ma);
+        free(mb);
+    }
+}
+
+static void test_canny(void) {
+    static const unsigned char dirs[4] = { SOBEL_DIR_0, SOBEL_DIR_45, SOBEL_DIR_90, SOBEL_DIR_135 };
+    for (int it = 0; it < ITERS; it++) {
+        int n = test_odd_len(MAX_LEN);
+        unsigned char *rows[5];
+        for (int r = 0; r < 5; r++) rows[r] = rand_bytes(n);
+        uint16_t *va = rand_u16(n + 4, 0, 0), *vb = rand_u16(n + 4, 0, 0);
+        ref.gauss5_vert_row(rows[0], rows[1], rows[2], rows[3], rows[4], va, n);
+        k.gauss5_vert_row(rows[0], rows[1], rows[2], rows[3], rows[4], vb, n);
+        SAME(va, vb, n * sizeof(uint16_t), "gauss5_vert_row", n);
+
+        // Horizontal: entrada com 2 elementos de borda em cada lado
+        uint16_t *h = rand_u16(n + 4, 0, 4080);
+        unsigned char *a = (unsigned char*)test_alloc(n + PAD), *b = (unsigned char*)test_alloc(n + PAD);
+        ref.gauss5_horiz_row(h, a, n);
+        k.gauss5_horiz_row(h, b, n);
+        SAME(a, b, n, "gauss5_horiz_row", n);
+
+        // NMS: magnitudes com borda de 1 elemento, poucos níveis para empates
+        int16_t *m[3];
+        for (int r = 0; r < 3; r++) m[r] = rand_i16(n + 2, 0, it & 1 ? 2040 : 8);
+        unsigned char *dir = (unsigned char*)test_alloc(n + PAD);
+        for (int i = 0; i < n; i++) dir[i] = dirs[test_range(0, 3)];
+        int low = test_range(0, it & 1 ? 300 : 4), high = low + test_range(0, it & 1 ? 600 : 4);
+        ref.canny_nms_row(m[0], m[1], m[2], dir, a, n, low, high);
+        k.canny_nms_row(m[0], m[1], m[2], dir, b, n, low, high);
+        SAME(a, b, n, "canny_nms_row", n);
+
+        for (int r = 0; r < 5; r++) free(rows[r]);
+        for (int r = 0; r < 3; r++) free(m[r]);
+        free(va);
+        free(vb);
+        free(h);
+        free(a);
+        free(b);
+        free(dir);
+    }
+}
+
+// ============================================================
+// MORFOLOGIA
+// ============================================================
+
+static void test_morph(void) {
+    for (int it = 0; it < ITERS; it++) {
+        int n = test_odd_len(MAX_LEN);
+        unsigned char *x = rand_bytes(n), *y = rand_bytes(n);
+        unsigned char *a = (unsigned char*)test_alloc(n + PAD), *b = (unsigned char*)test_alloc(n + PAD);
+        unsigned char *inplace = (unsigned char*)test_alloc(n + PAD);
+        for (int op = 0; op < 2; op++) {
+            morph_row_fn fr = op ? ref.morph_max_row : ref.morph_min_row;
+            morph_row_fn fk = op ? k.morph_max_row : k.morph_min_row;
+            fr(x, y, a, n);
+            fk(x, y, b, n);
+            memcpy(inplace, x, n);
+            fk(inplace, y, inplace, n);
+            SAME(a, b, n, op ? "morph_max_row" : "morph_min_row", n);
+            SAME(a, inplace, n, op ? "morph_max_row no lugar" : "morph_min_row no lugar", n);
+        }
+
+        // Transposição de blocos com larguras e alturas quaisquer
+        int rows = test_range(1, 70), cols = test_range(1, 70);
+        size_t ss = cols + test_range(0, 9), ds = rows + test_range(0, 9);
+        unsigned char *src = rand_bytes(rows * ss);
+        unsigned char *ta = (unsigned char*)test_alloc(cols * ds + PAD);
+        unsigned char *tb = (unsigned char*)test_alloc(cols * ds + PAD);
+        ref.transpose_u8(src, ss, ta, ds, rows, cols);
+        k.transpose_u8(src, ss, tb, ds, rows, cols);
+        SAME(ta, tb, cols * ds, "transpose_u8", rows * cols);
+
+        free(x);
+        free(y);
+        free(a);
+        free(b);
+        free(inplace);
+        free(src);
+        free(ta);
+        free(tb);
+    }
+}
+
+// ============================================================
+// IMAGEM INTEGRAL
+// ============================================================
+
+static void test_integral(void) {
+    for (int it = 0; it < ITERS; it++) {
+        int n = test_odd_len(MAX_LEN);
+        unsigned char *src = rand_bytes(n);
+        uint32_t *prev = (uint32_t*)test_alloc((n + PAD) * sizeof(uint32_t));
+        uint64_t *prev_sq = (uint64_t*)test_alloc((n + PAD) * sizeof(uint64_t));
+        for (int i = 0; i < n; i++) {
+            prev[i] = test_rand();
+            prev_sq[i] = ((uint64_t)test_rand() << 20) | test_rand();
+        }
+        uint32_t *a = (uint32_t*)test_alloc((n + PAD) * sizeof(uint32_t));
+        uint32_t *b = (uint32_t*)test_alloc((n + PAD) * sizeof(uint32_t));
+        ref.integral_row(src, prev, a, n);
+        k.integral_row(src, prev, b, n);
+        SAME(a, b, n * sizeof(uint32_t), "integral_row", n);
+
+        uint64_t *qa = (uint64_t*)test_alloc((n + PAD) * sizeof(uint64_t));
+        uint64_t *qb = (uint64_t*)test_alloc((n + PAD) * sizeof(uint64_t));
+        ref.integral_sq_row(src, prev_sq, qa, n);
+        k.integral_sq_row(src, prev_sq, qb, n);
+        SAME(qa, qb, n * sizeof(uint64_t), "integral_sq_row", n);
+
+        // Soma de caixa: linhas da integral com span colunas a mais
+        int span = test_range(1, 2 * BLUR_MAX_RADIUS + 1);
+        uint32_t *top = (uint32_t*)test_alloc((n + span + PAD) * sizeof(uint32_t));
+        uint32_t *bot = (uint32_t*)test_alloc((n + span + PAD) * sizeof(uint32_t));
+        for (int i = 0; i < n + span; i++) {
+            top[i] = test_rand();
+            bot[i] = test_rand();
+        }
+        ref.box_sum_row(top, bot, a, n, span);
+        k.box_sum_row(top, bot, b, n, span);
+        SAME(a, b, n * sizeof(uint32_t), "box_sum_row", n);
+
+        free(src);
+        free(prev);
+        free(prev_sq);
+        free(a);
+        free(b);
+        free(qa);
+        free(qb);
+        free(top);
+        free(bot);
+    }
+}
+
+// ============================================================
+// TEMPLATE MATCHING
+// ============================================================
+
+static void test_match(void) {
+    for (int it = 0; it < ITERS; it++) {
+        // Produto interno até o limite de 65535 elementos
+        int n = it == 0 ? 65535 : test_odd_len(it & 1 ? 4097 : MAX_LEN);
+        unsigned char *x = rand_bytes(n), *y = rand_bytes(n);
+        if (it == 0) {
+            memset(x, 255, n);
+            memset(y, 255, n);
+        }
+        CHECK(ref.dot_u8(x, y, n) == k.dot_u8(x, y, n), "dot_u8 %s (n=%d)", level_name, n);
+        free(x);
+        free(y);
+
+        n = test_odd_len(MAX_LEN);
+        unsigned char *r0 = rand_bytes(2 * n), *r1 = rand_bytes(2 * n);
+        unsigned char *a = (unsigned char*)test_alloc(n + PAD), *b = (unsigned char*)test_alloc(n + PAD);
+        ref.pyr_down_row(r0, r1, a, n);
+        k.pyr_down_row(r0, r1, b, n);
+        SAME(a, b, n, "pyr_down_row", n);
+
+        int c0 = test_range(0, 255), c1 = test_range(0, 255);
+        uint32_t *acc_a = (uint32_t*)test_alloc((n + PAD) * sizeof(uint32_t));
+        uint32_t *acc_b = (uint32_t*)test_alloc((n + PAD) * sizeof(uint32_t));
+        for (int i = 0; i < n; i++) acc_a[i] = acc_b[i] = test_rand() >> 4;
+        ref.ncc_mac_row(r0, c0, c1, acc_a, n);
+        k.ncc_mac_row(r0, c0, c1, acc_b, n);
+        SAME(acc_a, acc_b, n * sizeof(uint32_t), "ncc_mac_row", n);
+
+        free(r0);
+        free(r1);
+        free(a);
+        free(b);
+        free(acc_a);
+        free(acc_b);
+    }
+}
+
+// ============================================================
+// THRESHOLD / LUT
+// ============================================================
+
+static void test_threshold(void) {
+    for (int it = 0; it < ITERS; it++) {
+        int n = test_odd_len(MAX_LEN);
+        unsigned char *src = rand_bytes(n), *mean = rand_bytes(n);
+        unsigned char *a = (unsigned char*)test_alloc(n + PAD), *b = (unsigned char*)test_alloc(n + PAD);
+        int thresh = test_range(0, 255);
+        ref.threshold_row(src, a, n, thresh);
+        k.threshold_row(src, b, n, thresh);
+        SAME(a, b, n, "threshold_row", n);
+
+        int c = test_range(-40, 40);
+        ref.threshold_mean_row(src, mean, a, n, c);
+        k.threshold_mean_row(src, mean, b, n, c);
+        SAME(a, b, n, "threshold_mean_row", n);
+        free(src);
+        free(mean);
+        free(a);
+        free(b);
+    }
+}
+
+static void test_lut(void) {
+    static const int alpha_strides[3] = { 0, 2, 4 };
+    unsigned char lut[256];
+    for (int it = 0; it < ITERS; it++) {
+        test_fill(lut, sizeof(lut));
+        int stride = alpha_strides[it % 3];
+        int n = test_odd_len(MAX_LEN) * (stride ? stride : 1);
+        unsigned char *src = rand_bytes(n);
+        unsigned char *a = (unsigned char*)test_alloc(n + PAD), *b = (unsigned char*)test_alloc(n + PAD);
+        unsigned char *inplace = (unsigned char*)test_alloc(n + PAD);
+        memcpy(inplace, src, n);
+        ref.lut_row(src, a, n, lut, stride);
+        k.lut_row(src, b, n, lut, stride);
+        k.lut_row(inplace, inplace, n, lut, stride);
+        SAME(a, b, n, "lut_row", n);
+        SAME(a, inplace, n, "lut_row no lugar", n);
+        free(src);
+        free(a);
+        free(b);
+        free(inplace);
+    }
+}
+
+// ============================================================
+// REMAP / CALIBRAÇÃO
+// ============================================================
+
+static void test_remap(void) {
+    const int w = 97, h = 9;
+    const size_t stride = w + 13;
+    unsigned char *img = rand_bytes(stride * h);
+    for (int it = 0; it < ITERS; it++) {
+        int n = test_odd_len(MAX_LEN);
+        int16_t *xy = rand_i16(2 * (size_t)n, 0, 0);
+        uint16_t *frac = rand_u16(n, 0, 0);
+        for (int i = 0; i < n; i++) {
+            xy[2 * i] = (int16_t)test_range(0, w - 2);
+            xy[2 * i + 1] = (int16_t)test_range(0, h - 2);
+            int fy = test_range(0, 9) == 0 ? 0xFF : test_range(0, 128);
+            frac[i] = (uint16_t)(test_range(0, 128) | fy << 8);
+        }
+        unsigned char *a = (unsigned char*)test_alloc(n + PAD), *b = (unsigned char*)test_alloc(n + PAD);
+        ref.remap_row(img, stride, xy, frac, a, n);
+        k.remap_row(img, stride, xy, frac, b, n);
+        SAME(a, b, n, "remap_row", n);
+        free(xy);
+        free(frac);
+        free(a);
+        free(b);
+    }
+    free(img);
+}
+
+static void test_calib(void) {
+    for (int it = 0; it < ITERS; it++) {
+        int n = test_odd_len(MAX_LEN);
+        unsigned char *src = rand_bytes(n), *dark = rand_bytes(n);
+        int16_t *gain = rand_i16(n, 0, it & 1 ? 32767 : 2048);
+        unsigned char *a = (unsigned char*)test_alloc(n + PAD), *b = (unsigned char*)test_alloc(n + PAD);
+        unsigned char *inplace = (unsigned char*)test_alloc(n + PAD);
+        memcpy(inplace, src, n);
+        ref.calib_row(src, dark, gain, a, n);
+        k.calib_row(src, dark, gain, b, n);
+        k.calib_row(inplace, dark, gain, inplace, n);
+        SAME(a, b, n, "calib_row", n);
+        SAME(a, inplace, n, "calib_row no lugar", n);
+        free(src);
+        free(dark);
+        free(gain);
+        free(a);
+        free(b);
+        free(inplace);
+    }
+}
+
+// ============================================================
+// DEMOSAICO
+// ============================================================
+
+static void test_bayer(void) {
+    for (int it = 0; it < ITERS; it++) {
+        int n = test_odd_len(MAX_LEN);
+        int phase = it & 1;
+        // Linhas brutas com margem de 2 amostras e de verde com margem de 1
+        unsigned char *raw[5], *green[3];
+        for (int r = 0; r < 5; r++) raw[r] = rand_bytes(n + 4);
+        for (int r = 0; r < 3; r++) green[r] = rand_bytes(n + 2);
+        const unsigned char *up2 = raw[0] + 2, *up = raw[1] + 2, *row = raw[2] + 2;
+        const unsigned char *dn = raw[3] + 2, *dn2 = raw[4] + 2;
+        const unsigned char *gu = green[0] + 1, *gc = green[1] + 1, *gd = green[2] + 1;
+
+        unsigned char *out[2][3];
+        for (int l = 0; l < 2; l++) {
+            for (int o = 0; o < 3; o++) out[l][o] = (unsigned char*)test_alloc(n + PAD);
+        }
+        ref.bayer_bilinear_row(up, row, dn, out[0][0], out[0][1], out[0][2], n, phase);
+        k.bayer_bilinear_row(up, row, dn, out[1][0], out[1][1], out[1][2], n, phase);
+        for (int o = 0; o < 3; o++) SAME(out[0][o], out[1][o], n, "bayer_bilinear_row", n);
+
+        ref.bayer_green_row(up2, up, row, dn, dn2, out[0][1], n, phase);
+        k.bayer_green_row(up2, up, row, dn, dn2, out[1][1], n, phase);
+        SAME(out[0][1], out[1][1], n, "bayer_green_row", n);
+
+        ref.bayer_rb_row(up, row, dn, gu, gc, gd, out[0][0], out[0][2], n, phase);
+        k.bayer_rb_row(up, row, dn, gu, gc, gd, out[1][0], out[1][2], n, phase);
+        SAME(out[0][0], out[1][0], n, "bayer_rb_row own", n);
+        SAME(out[0][2], out[1][2], n, "bayer_rb_row other", n);
+
+        ref.gray_planes_row(up, row, dn, out[0][0], n);
+        k.gray_planes_row(up, row, dn, out[1][0], n);
+        SAME(out[0][0], out[1][0], n, "gray_planes_row", n);
+
+        for (int r = 0; r < 5; r++) free(raw[r]);
+        for (int r = 0; r < 3; r++) free(green[r]);
+        for (int l = 0; l < 2; l++) {
+            for (int o = 0; o < 3; o++) free(out[l][o]);
+        }
+    }
+}
+
+// ============================================================
+// GOLDEN / MEDIANA
+// ============================================================
+
+static void test_golden(void) {
+    for (int it = 0; it < ITERS; it++) {
+        int n = test_odd_len(MAX_LEN);
+        unsigned char *src = rand_bytes(n), *refimg = rand_bytes(n), *tol = rand_bytes(n);
+        for (int i = 0; i < n; i++) tol[i] &= 31;
+        unsigned char *a = (unsigned char*)test_alloc(n + PAD), *b = (unsigned char*)test_alloc(n + PAD);
+        const unsigned char *t = it & 1 ? tol : NULL;
+        int thresh = test_range(0, 255);
+        int ca = ref.golden_row(src, refimg, t, a, n, thresh);
+        int cb = k.golden_row(src, refimg, t, b, n, thresh);
+        CHECK(ca == cb, "golden_row contagem %s (n=%d)", level_name, n);
+        SAME(a, b, n, "golden_row", n);
+        free(src);
+        free(refimg);
+        free(tol);
+        free(a);
+        free(b);
+    }
+}
+
+static void test_median(void) {
+    for (int it = 0; it < ITERS; it++) {
+        int width = test_odd_len(MAX_LEN);
+        int radius = test_range(0, MEDIAN_MAX_RADIUS);
+        int rows = test_range(1, 2 * radius + 1);
+        // Histogramas de coluna de 'rows' linhas (poucos níveis a cada 2 iterações)
+        uint16_t *fine = (uint16_t*)test_alloc((size_t)16 * width * 16 * sizeof(uint16_t));
+        uint16_t *coarse = (uint16_t*)test_alloc((size_t)width * 16 * sizeof(uint16_t));
+        for (int y = 0; y < rows; y++) {
+            for (int x = 0; x < width; x++) {
+                int v = it & 1 ? (int)(test_rand() & 255) : 120 + test_range(0, 20);
+                fine[((size_t)(v >> 4) * width + x) * 16 + (v & 15)]++;
+                coarse[(size_t)x * 16 + (v >> 4)]++;
+            }
+        }
+        unsigned char *a = (unsigned char*)test_alloc(width + PAD), *b = (unsigned char*)test_alloc(width + PAD);
+        ref.median_row(fine, coarse, a, width, radius, rows);
+        k.median_row(fine, coarse, b, width, radius, rows);
+        SAME(a, b, width, "median_row", width);
+        free(fine);
+        free(coarse);
+        free(a);
+        free(b);
+    }
+}
+
+// ============================================================
+// COR / CLASSIFICAÇÃO
+// ============================================================
+
+static void test_color(void) {
+    // Matrizes de colorspace.c (YCbCr BT.601 e Lab aproximado)
+    static const int16_t coefs[2][9] = {
+        { GRAY_WEIGHT_R, GRAY_WEIGHT_G, GRAY_WEIGHT_B,
+          -5529, -10855, 16384, 16384, -13720, -2664 },
+        { 6969, 23434, 2365, 14217, -21777, 7560, 5009, 15567, -20576 },
+    };
+    for (int it = 0; it < ITERS; it++) {
+        int n = test_odd_len(MAX_LEN);
+        unsigned char *r = rand_bytes(n), *g = rand_bytes(n), *b = rand_bytes(n);
+        // Cinzas e máximos empatados exercitam os casos especiais do HSV
+        if (it % 3 == 0) memcpy(g, r, n);
+        if (it % 5 == 0) memcpy(b, r, n);
+        unsigned char *out[2][3];
+        for (int l = 0; l < 2; l++) {
+            for (int o = 0; o < 3; o++) out[l][o] = (unsigned char*)test_alloc(n + PAD);
+        }
+        const int16_t *coef = coefs[it & 1];
+        ref.color_matrix_row(r, g, b, coef, out[0][0], out[0][1], out[0][2], n);
+        k.color_matrix_row(r, g, b, coef, out[1][0], out[1][1], out[1][2], n);
+        for (int o = 0; o < 3; o++) SAME(out[0][o], out[1][o], n, "color_matrix_row", n);
+
+        ref.hsv_row(r, g, b, out[0][0], out[0][1], out[0][2], n);
+        k.hsv_row(r, g, b, out[1][0], out[1][1], out[1][2], n);
+        for (int o = 0; o < 3; o++) SAME(out[0][o], out[1][o], n, "hsv_row", n);
+
+        free(r);
+        free(g);
+        free(b);
+        for (int l = 0; l < 2; l++) {
+            for (int o = 0; o < 3; o++) free(out[l][o]);
+        }
+    }
+}
+
+static void test_classify(void) {
+    const size_t lut_size = CLASS_LUT_SIZE;
+    uint8_t *lut = (uint8_t*)test_alloc(lut_size + PAD);
+    for (int it = 0; it < ITERS; it++) {
+        int classes = test_range(1, CLASS_MAX);
+        for (size_t i = 0; i < lut_size; i++) lut[i] = (uint8_t)(test_rand() % (classes + 1));
+        // Linhas longas atravessam o descarregamento dos contadores de byte
+        int n = test_odd_len(it % 8 == 0 ? 9001 : MAX_LEN);
+        unsigned char *r = rand_bytes(n), *g = rand_bytes(n), *b = rand_bytes(n);
+        unsigned char *da = (unsigned char*)test_alloc(n + PAD), *db = (unsigned char*)test_alloc(n + PAD);
+        uint32_t ca[CLASS_MAX + 1], cb[CLASS_MAX + 1];
+        for (int c = 0; c <= CLASS_MAX; c++) ca[c] = cb[c] = (uint32_t)c;
+        ref.class_row(r, g, b, lut, da, n, classes, ca);
+        k.class_row(r, g, b, lut, db, n, classes, cb);
+        SAME(da, db, n, "class_row", n);
+        SAME(ca, cb, sizeof(ca), "class_row contagens", n);
+        free(r);
+        free(g);
+        free(b);
+        free(da);
+        free(db);
+    }
+    free(lut);
+}
+
+// ============================================================
+// PLANAR
+// ============================================================
+
+static void test_planar(void) {
+    for (int it = 0; it < ITERS; it++) {
+        int n = test_odd_len(MAX_LEN);
+        size_t plane_stride = n + test_range(0, 70);
+        for (int c = 2; c <= 4; c++) {
+            deinterleave_fn dr = c == 2 ? ref.deinterleave_ga : c == 3 ? ref.deinterleave_rgb
+                                                                       : ref.deinterleave_rgba;
+            deinterleave_fn dk = c == 2 ? k.deinterleave_ga : c == 3 ? k.deinterleave_rgb
+                                                                     : k.deinterleave_rgba;
+            interleave_fn ir = c == 2 ? ref.interleave_ga : c == 3 ? ref.interleave_rgb
+                                                                   : ref.interleave_rgba;
+            interleave_fn ik = c == 2 ? k.interleave_ga : c == 3 ? k.interleave_rgb
+                                                                 : k.interleave_rgba;
+            size_t bytes = (size_t)n * c, planes = plane_stride * c;
+            unsigned char *src = rand_bytes(bytes);
+            unsigned char *pa = (unsigned char*)test_alloc(planes + PAD);
+            unsigned char *pb = (unsigned char*)test_alloc(planes + PAD);
+            dr(src, pa, plane_stride, n);
+            dk(src, pb, plane_stride, n);
+            SAME(pa, pb, planes, "deinterleave", n);
+
+            unsigned char *ia = (unsigned char*)test_alloc(bytes + PAD);
+            unsigned char *ib = (unsigned char*)test_alloc(bytes + PAD);
+            ir(pa, plane_stride, ia, n);
+            ik(pa, plane_stride, ib, n);
+            SAME(ia, ib, bytes, "interleave", n);
+            SAME(ia, src, bytes, "interleave(deinterleave)", n);
+            free(src);
+            free(pa);
+            free(pb);
+            free(ia);
+            free(ib);
+        }
+    }
+}
+
+// ============================================================
+// MAIN
+// ============================================================
+
+int main(void) {
+    simd_kernels_select(SIMD_SCALAR);
+    ref = g_kernels;
+
+    const simd_level_t levels[2] = { SIMD_SSSE3, SIMD_AVX2 };
+    for (int l = 0; l < 2; l++) {
+        level_name = cpu_simd_name(levels[l]);
+        if (cpu_set_simd_level(levels[l]) != levels[l]) {
+            printf("  %s indisponível nesta CPU: pulado\n", level_name);
+            continue;
+        }
+        simd_kernels_select(cpu_simd_level());
+        k = g_kernels;
+
+        test_gray();
+        test_blur();
+        test_resize();
+        test_sobel();
+        test_canny();
+        test_morph();
+        test_integral();
+        test_match();
+        test_threshold();
+        test_lut();
+        test_remap();
+        test_calib();
+        test_bayer();
+        test_golden();
+        test_median();
+        test_color();
+        test_classify();
+        test_planar();
+        printf("  kernels %s contra escalar: %s\n", level_name,
+               test_failures ? "FALHA" : "ok");
+    }
+    return test_finish("test_kernels");
+}
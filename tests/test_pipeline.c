@@ -0,0 +1,141 @@
+#include "test_util.h"
+#include "config.h"
+#include "filters.h"
+#include "pipeline.h"
+#include "match.h"
+#include "thread_pool.h"
+#include <math.h>
+#include <unistd.h>
+
+// Estágios de imagem inteira executados pelo pipeline_run (faixas, threads
+// e segunda fase) contra referências ingênuas, com 1 e várias threads.
+
+static const int thread_counts[] = { 1, 2, 4 };
+#define NUM_THREAD_COUNTS ((int)(sizeof(thread_counts) / sizeof(thread_counts[0])))
+
+// ============================================================
+// TEMPLATE MATCHING
+// ============================================================
+// O template é um recorte exato da imagem, salvo em PNG e carregado pelo
+// mesmo caminho do worker (pipeline_resources_load). Referência: NCC em
+// double, direto das somas da janela.
+
+#define MATCH_IMG_W     200
+#define MATCH_IMG_H     160
+#define MATCH_TPL_W     70      // Lados >= 4·MATCH_COARSE_SIDE: três níveis
+#define MATCH_TPL_H     66
+#define MATCH_TPL_X     113
+#define MATCH_TPL_Y     71
+#define MATCH_TEXTURE_RADIUS 4
+
+static double naive_ncc(const unsigned char *luma, int w, const unsigned char *tpl,
+                        int tw, int th, int x, int y) {
+    double n = (double)tw * th, si = 0, sq = 0, st = 0, stt = 0, dot = 0;
+    for (int r = 0; r < th; r++) {
+        for (int c = 0; c < tw; c++) {
+            double i = luma[(size_t)(y + r) * w + x + c], t = tpl[(size_t)r * tw + c];
+            si += i;
+            sq += i * i;
+            st += t;
+            stt += t * t;
+            dot += i * t;
+        }
+    }
+    double var = (n * sq - si * si) * (n * stt - st * st);
+    return var > 0 ? (n * dot - si * st) / sqrt(var) : 0.0;
+}
+
+static void test_match(void) {
+    const int w = MATCH_IMG_W, h = MATCH_IMG_H;
+    char path[] = "/tmp/favis_test_tpl_XXXXXX.png";
+    int fd = mkstemps(path, 4);
+    if (fd < 0) {
+        CHECK(0, "mkstemps falhou");
+        return;
+    }
+    close(fd);
+
+    // Cinza sem correções (luminância = origem) e RGB (plano de luminância próprio)
+    for (int c = 1; c <= 3; c += 2) {
+        unsigned char *img = (unsigned char*)test_alloc((size_t)w * h * c);
+        unsigned char *luma = (unsigned char*)test_alloc((size_t)w * h);
+        unsigned char *crop = (unsigned char*)test_alloc((size_t)MATCH_TPL_W * MATCH_TPL_H * c);
+        unsigned char *tpl = (unsigned char*)test_alloc((size_t)MATCH_TPL_W * MATCH_TPL_H);
+        // Ruído suavizado: textura que sobrevive à redução até o nível grosso
+        unsigned char *noise = (unsigned char*)test_alloc((size_t)w * h * c);
+        test_fill(noise, (size_t)w * h * c);
+        CHECK(apply_blur(noise, img, w, h, c, MATCH_TEXTURE_RADIUS) == 0, "apply_blur falhou");
+        free(noise);
+        luma_rows(img, luma, w * h, c);
+        for (int r = 0; r < MATCH_TPL_H; r++) {
+            memcpy(crop + (size_t)r * MATCH_TPL_W * c,
+                   img + ((size_t)(MATCH_TPL_Y + r) * w + MATCH_TPL_X) * c,
+                   (size_t)MATCH_TPL_W * c);
+            memcpy(tpl + (size_t)r * MATCH_TPL_W,
+                   luma + (size_t)(MATCH_TPL_Y + r) * w + MATCH_TPL_X, MATCH_TPL_W);
+        }
+
+        pipeline_config_t cfg;
+        pipeline_resources_t res;
+        config_init(&cfg);
+        cfg.image_stats = 0;
+        if (save_image(path, crop, MATCH_TPL_W, MATCH_TPL_H, c) != 0 ||
+            config_set(&cfg, "filters", "match") != 0 ||
+            config_set(&cfg, "templates", path) != 0 ||
+            pipeline_resources_load(&res, &cfg) != 0) {
+            CHECK(0, "preparação do match falhou (c=%d)", c);
+        } else {
+            CHECK(res.templates.templates[0].levels == 3, "template com %d níveis (esperado 3)",
+                  res.templates.templates[0].levels);
+
+            for (int i = 0; i < NUM_THREAD_COUNTS; i++) {
+                thread_pool_t pool;
+                pipeline_t p;
+                int threads = thread_counts[i];
+                if (thread_pool_init(&pool, threads) != 0) {
+                    CHECK(0, "thread_pool_init falhou");
+                    continue;
+                }
+                if (pipeline_init(&p, img, w, h, c, &cfg, &res) != 0 ||
+                    pipeline_run(&p, &pool) != 0) {
+                    CHECK(0, "pipeline falhou (c=%d, %d threads)", c, threads);
+                    thread_pool_destroy(&pool);
+                    continue;
+                }
+
+                int found = 0;
+                for (int m = 0; m < p.matches.count; m++) {
+                    const match_t *mt = &p.matches.items[m];
+                    double ref = naive_ncc(luma, w, tpl, MATCH_TPL_W, MATCH_TPL_H, mt->x, mt->y);
+                    CHECK(fabs(mt->score - ref) < 1e-9 && mt->score >= cfg.match_threshold,
+                          "match (%d,%d) score %.6f, referência %.6f (c=%d, %d threads)",
+                          mt->x, mt->y, mt->score, ref, c, threads);
+                    if (mt->x == MATCH_TPL_X && mt->y == MATCH_TPL_Y && mt->score >= 0.999) {
+                        found = 1;
+                    }
+                }
+                CHECK(found, "recorte em (%d,%d) não encontrado: %d ocorrências (c=%d, %d threads)",
+                      MATCH_TPL_X, MATCH_TPL_Y, p.matches.count, c, threads);
+
+                pipeline_free(&p);
+                thread_pool_destroy(&pool);
+            }
+            pipeline_resources_free(&res);
+        }
+        free(img);
+        free(luma);
+        free(crop);
+        free(tpl);
+    }
+    unlink(path);
+}
+
+// ============================================================
+// MAIN
+// ============================================================
+
+int main(void) {
+    filters_init();
+    test_match();
+    return test_finish("test_pipeline");
+}
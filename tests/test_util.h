@@ -0,0 +1,66 @@
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+#include "common.h"
+#include "cpu_dispatch.h"
+
+// Apoio mínimo dos testes (make test): cada verificação que falha é
+// registrada em test_failures e o main devolve o total como status.
+
+static int test_failures = 0;
+
+#define CHECK(cond, ...)                                                    \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            if (test_failures++ < 20) {                                     \
+                fprintf(stderr, "  FALHA %s:%d: ", __FILE__, __LINE__);     \
+                fprintf(stderr, __VA_ARGS__);                               \
+                fprintf(stderr, "\n");                                      \
+            }                                                               \
+        }                                                                   \
+    } while (0)
+
+// Gerador determinístico (xorshift32): mesma sequência em toda máquina
+static uint32_t test_rng_state = 0x9E3779B9u;
+
+static inline uint32_t test_rand(void) {
+    uint32_t x = test_rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return test_rng_state = x;
+}
+
+// Inteiro uniforme em [lo, hi]
+static inline int test_range(int lo, int hi) {
+    return lo + (int)(test_rand() % (uint32_t)(hi - lo + 1));
+}
+
+// Comprimento ímpar de linha: cruza as larguras de vetor e deixa cauda
+static inline int test_odd_len(int max) {
+    return 2 * test_range(0, (max - 1) / 2) + 1;
+}
+
+static inline void test_fill(unsigned char *buf, size_t n) {
+    for (size_t i = 0; i < n; i++) buf[i] = (unsigned char)test_rand();
+}
+
+static inline void* test_alloc(size_t bytes) {
+    void *p = calloc(1, bytes ? bytes : 1);
+    if (!p) {
+        fprintf(stderr, "Falha ao alocar %zu bytes\n", bytes);
+        exit(2);
+    }
+    return p;
+}
+
+static inline int test_finish(const char *name) {
+    if (test_failures) {
+        printf("%s: %d falha(s)\n", name, test_failures);
+        return 1;
+    }
+    printf("%s: ok\n", name);
+    return 0;
+}
+
+#endif // TEST_UTIL_H